@@ -74,13 +74,33 @@ typedef struct tcp_sockopt_s {
 
     /* Timeouts in us */
     uint32_t tcpo_rto;
+    uint32_t tcpo_rto_min;
+    uint32_t tcpo_rto_max;
     uint32_t tcpo_fin_to;
     uint32_t tcpo_twait_to;
     uint32_t tcpo_orphan_to;
+    uint32_t tcpo_ack_delay_to;
+
+    /* tpg_tcp_cong_control_t */
+    uint8_t  tcpo_cong_control;
+
+    /* tpg_tcp_close_mode_t */
+    uint8_t  tcpo_close_mode;
+
+    /* Window scale shift we advertise (0 if we don't scale). */
+    uint8_t  tcpo_win_scale;
+
+    /* Path MTU clamp, the MSS we advertise is derived from it (0 if unset). */
+    uint16_t tcpo_pmtu;
 
     /* Flags */
     uint32_t tcpo_skip_timewait : 1;
     uint32_t tcpo_ack_delay : 1;
+    uint32_t tcpo_sack : 1;
+    uint32_t tcpo_timestamps : 1;
+    uint32_t tcpo_tso : 1;
+    uint32_t tcpo_syn_cookies : 1;
+    uint32_t tcpo_fast_open : 1;
 
 } tcp_sockopt_t;
 
@@ -109,6 +129,7 @@ typedef struct eth_sockopt_s {
     uint8_t ethso_tx_offload_ipv4_cksum : 1;
     uint8_t ethso_tx_offload_tcp_cksum  : 1;
     uint8_t ethso_tx_offload_udp_cksum  : 1;
+    uint8_t ethso_tx_offload_tcp_tso    : 1;
 
 } eth_sockopt_t;
 
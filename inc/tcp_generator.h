@@ -202,6 +202,10 @@ typedef TAILQ_HEAD(tcp_test_cb_list_s, l4_control_block_s) tlkp_test_cb_list_t;
 #include "tpg_timestamp.h"
 #include "tpg_data.h"
 #include "tpg_tcp_data.h"
+#include "tpg_tcp_cc.h"
+#include "tpg_tcp_options.h"
+#include "tpg_tcp_syncookie.h"
+#include "tpg_tcp_fastopen.h"
 #include "tpg_tcp_lookup.h"
 #include "tpg_udp_lookup.h"
 
@@ -62,14 +62,46 @@
 
 STATS_GLOBAL_DECLARE(tpg_arp_statistics_t);
 
+/*****************************************************************************
+ * ARP module message types.
+ ****************************************************************************/
+enum arp_msg_types {
+
+    MSG_TYPE_DEF_START_MARKER(ARP),
+    MSG_ARP_TABLE_RESIZE,
+    MSG_ARP_TABLE_UPDATE,
+    MSG_TYPE_DEF_END_MARKER(ARP),
+
+};
+
+MSG_TYPE_MAX_CHECK(ARP);
+
+/*****************************************************************************
+ * ARP module message definitions.
+ ****************************************************************************/
+typedef struct arp_table_msg_s {
+
+    uint32_t atm_eth_port;
+    uint32_t atm_capacity;
+
+} __tpg_msg arp_table_msg_t;
+
+typedef arp_table_msg_t arp_table_resize_msg_t;
+typedef arp_table_msg_t arp_table_update_msg_t;
+
 /*****************************************************************************
  * ARP table handling definitions
  ****************************************************************************/
 /*
- * Currently ARP table size is small, as we only need to store the default
- * gw's ARP entry and our own ARPs.
+ * Per port ARP tables are open addressing (linear probing) hash tables keyed
+ * on (ip, vlan_id). The capacity (maximum number of entries) is configurable
+ * through the port options. The number of slots is the capacity rounded up
+ * to a power of 2 and doubled so probe sequences stay short even when the
+ * table is full.
  */
-#define TPG_ARP_PORT_TABLE_SIZE    24
+#define TPG_ARP_TABLE_SIZE_DEFAULT 1024
+#define TPG_ARP_TABLE_SIZE_MIN     16
+#define TPG_ARP_TABLE_SIZE_MAX     (1024 * 1024)
 
 #define TPG_ARP_UINT64_MAC_MASK    0x0000FFFFFFFFFFFF
 #define TPG_ARP_UINT64_FLAGS_MASK  (~TPG_ARP_UINT64_MAC_MASK)
@@ -77,6 +109,8 @@ STATS_GLOBAL_DECLARE(tpg_arp_statistics_t);
 #define TPG_ARP_FLAG_IN_USE        0x0001000000000000
 #define TPG_ARP_FLAG_INCOMPLETE    0x0002000000000000
 #define TPG_ARP_FLAG_LOCAL         0x0004000000000000
+/* Slot used to hold an entry that was deleted. Lookups must probe past it. */
+#define TPG_ARP_FLAG_DELETED       0x0008000000000000
 
 #define ARP_IS_FLAG_SET(arp, flag) ((((arp)->ae_mac_flags &      \
                                     TPG_ARP_UINT64_FLAGS_MASK) & \
@@ -89,6 +123,15 @@ typedef struct arp_entry_s {
 
 } arp_entry_t;
 
+typedef struct arp_table_s {
+
+    uint32_t    at_capacity;   /* Max number of entries in use. */
+    uint32_t    at_mask;       /* Number of slots - 1. */
+    uint32_t    at_count;      /* Number of entries in use. */
+
+    arp_entry_t at_entries[0] __rte_cache_aligned;
+
+} arp_table_t;
 
 static inline void arp_set_entry_in_use(arp_entry_t *arp)
 {
@@ -139,6 +182,11 @@ static inline uint64_t arp_get_entry_flags(arp_entry_t *arp)
     return arp->ae_mac_flags & TPG_ARP_UINT64_FLAGS_MASK;
 }
 
+static inline bool arp_is_entry_free(arp_entry_t *arp)
+{
+    return !ARP_IS_FLAG_SET(arp, TPG_ARP_FLAG_IN_USE | TPG_ARP_FLAG_DELETED);
+}
+
 #define TPG_ARP_MAC_NOT_FOUND TPG_ARP_FLAG_INCOMPLETE
 
 /*****************************************************************************
@@ -155,6 +203,8 @@ extern bool             arp_add_local(uint32_t port, uint32_t ip,
                                       uint16_t vlan_id);
 extern bool             arp_delete_local(uint32_t port, uint32_t ip,
                                          uint16_t vlan_id);
+extern int              arp_set_table_size(uint32_t port, uint32_t capacity);
+extern uint32_t         arp_get_table_size(uint32_t port);
 extern bool             arp_send_arp_request(uint32_t port, uint32_t local_ip,
                                        uint32_t remote_ip, uint16_t vlan_tci);
 extern bool             arp_send_grat_arp_request(uint32_t port, uint32_t ip,
@@ -202,7 +202,9 @@ enum {
 #define GCFG_MSGQ_SIZE                 (4096)
 
 /*
- * The default values for the TCP timer wheels (in useconds).
+ * The default values for the TCP timer wheels (in useconds). The wheels are
+ * hierarchical so the step only determines the precision, not the memory
+ * footprint.
  */
 #define GCFG_SLOW_TMR_MAX              (60 * 1000000) /* 1 min */
 #define GCFG_SLOW_TMR_STEP             100000   /* 100ms */
@@ -211,16 +213,22 @@ enum {
 #define GCFG_RTO_TMR_STEP              50        /* 50us */
 
 #define GCFG_TEST_TMR_MAX              (30 * 60 * 1000000) /* 30 min */
-#define GCFG_TEST_TMR_STEP             100       /* 100us */
+#define GCFG_TEST_TMR_STEP             1         /* 1us */
 
 #define GCFG_TMR_MAX_RUN_US            10000     /* 10ms */
-#define GCFG_TMR_MAX_RUN_CNT           10000     /* max 10K tcb timers in one shot */
+/* Timers left over when the budget runs out fire on the next packet loop
+ * iteration. Each callback might build and send packets so keep the per
+ * wheel budget small enough for all wheels together to stay well below an
+ * RX ring worth of processing time.
+ */
+#define GCFG_TMR_MAX_RUN_CNT           2048      /* max timers per wheel per advance */
 #define GCFG_TMR_STEP_ADVANCE          25        /* us */
 
 /*
  * The default values for TCP Data processing.
  */
 #define GCFG_TCP_SEGS_PER_SEND         1
+#define GCFG_TCP_SACK_SCOREBOARD_SIZE  8 /* SACKed ranges tracked per TCB */
 
 /*
  * Test management defaults.
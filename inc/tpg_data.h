@@ -234,6 +234,7 @@ struct rte_mbuf *data_adj_chain(struct rte_mbuf *mbuf, uint32_t len)
     struct rte_mbuf *prev;
     struct rte_mbuf *next;
     uint32_t         new_pkt_len = mbuf->pkt_len - len;
+    uint16_t         nb_segs = mbuf->nb_segs;
     void            *ret;
 
     ret = rte_pktmbuf_adj(mbuf, len);
@@ -246,6 +247,8 @@ struct rte_mbuf *data_adj_chain(struct rte_mbuf *mbuf, uint32_t len)
         next = mbuf->next;
         if (next) {
             pkt_mbuf_free_seg(mbuf);
+            next->pkt_len = new_pkt_len;
+            next->nb_segs = nb_segs - 1;
             return next;
         }
         return mbuf;
@@ -256,6 +259,7 @@ struct rte_mbuf *data_adj_chain(struct rte_mbuf *mbuf, uint32_t len)
         len -= mbuf->data_len;
         mbuf = mbuf->next;
         pkt_mbuf_free_seg(prev);
+        nb_segs--;
     }
 
     if (len != 0) {
@@ -263,8 +267,10 @@ struct rte_mbuf *data_adj_chain(struct rte_mbuf *mbuf, uint32_t len)
         rte_pktmbuf_adj(mbuf, len);
     }
 
-    if (mbuf)
+    if (mbuf) {
         mbuf->pkt_len = new_pkt_len;
+        mbuf->nb_segs = nb_segs;
+    }
 
     return mbuf;
 }
@@ -106,10 +106,16 @@ extern bool             eth_init(void);
 extern void             eth_lcore_init(uint32_t lcore_id);
 extern struct rte_mbuf *eth_receive_pkt(packet_control_block_t *pcb,
                                         struct rte_mbuf *mbuf);
+extern uint16_t         eth_build_hdr(l4_control_block_t *l4_cb,
+                                      uint64_t dst_mac,
+                                      uint64_t src_mac,
+                                      uint16_t ether_type,
+                                      void *hdr);
 extern struct rte_mbuf *eth_build_hdr_mbuf(l4_control_block_t *l4_cb,
                                            uint64_t dst_mac,
                                            uint64_t src_mac,
                                            uint16_t ether_type);
+extern struct rte_mbuf *eth_build_hdr_mbuf_from_tmpl(l4_control_block_t *l4_cb);
 extern void             vlan_store_sockopt(vlan_sockopt_t *dest,
                                           const tpg_vlan_sockopt_t *options);
 extern void             vlan_load_sockopt(tpg_vlan_sockopt_t *dest,
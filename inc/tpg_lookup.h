@@ -61,60 +61,117 @@
 #define _H_TPG_LOOKUP_
 
 /*****************************************************************************
- * Session hash buckets
+ * Session hash table
+ *      Per lcore bucketized cuckoo hash shared by all ports. Each bucket is
+ *      exactly one cache line and stores the 16 bit signatures and control
+ *      block pointers inline so a miss costs at most two bucket reads and
+ *      the control block is only touched on a signature match.
+ *      Every session lives in one of its two candidate buckets. The
+ *      alternative bucket is computed from the current bucket and the
+ *      signature so entries can be moved without touching the control block.
+ *      The tables are only accessed by the owning lcore, no locking needed.
  ****************************************************************************/
-/*
- * Size should be a ^2 value, so modulo is easy to get hash bucket,
- * now we use 20 bits.
- */
-#define TPG_HASH_BUCKET_BIT_SIZE 20
-#define TPG_HASH_BUCKET_SIZE     (1 << TPG_HASH_BUCKET_BIT_SIZE)
-#define TPG_HASH_BUCKET_MASK     (TPG_HASH_BUCKET_SIZE - 1)
+#define TLKP_HT_BUCKET_ENTRIES  6
+#define TLKP_HT_MIN_BUCKETS     64
+#define TLKP_HT_MAX_KICKS       256
 
-/* The proper modulo fun should be `(((uint32_t)hash) & TPG_HASH_BUCKET_MASK)`
- * but this actually affects a lot performance, so we decided to use a simpler
- * function.
- */
-#define TPG_HASH_MOD(hash)                                                     \
-    (((((uint32_t)(hash)) >> TPG_HASH_BUCKET_BIT_SIZE) ^ ((uint32_t)(hash))) & \
-     TPG_HASH_BUCKET_MASK)
+/* Max number of lookups resolved in a single bulk pass. */
+#define TLKP_HT_BULK_SIZE       32
+
+typedef struct tlkp_ht_bucket_s {
+
+    uint16_t            hb_sig[TLKP_HT_BUCKET_ENTRIES];
+    uint32_t            hb_unused;
+    l4_control_block_t *hb_cb[TLKP_HT_BUCKET_ENTRIES];
+
+} __rte_cache_aligned tlkp_ht_bucket_t;
+
+static_assert(sizeof(tlkp_ht_bucket_t) == RTE_CACHE_LINE_SIZE,
+              "Session hash bucket must fit in a cache line");
+
+typedef struct tlkp_htable_s {
+
+    tlkp_ht_bucket_t *ht_buckets;
+    uint32_t          ht_bucket_mask;
+    uint32_t          ht_count;
+
+    /* Bumped on every insert/delete. Lookups done ahead of time (RX burst
+     * pipeline) are only reused if the table didn't change in between.
+     */
+    uint32_t          ht_add_gen;
+    uint32_t          ht_del_gen;
+    int               ht_socket;
+    const char       *ht_name;
+
+} tlkp_htable_t;
+
+/* Bulk lookup key, all fields in the same order as tlkp_find_v4_cb(). */
+typedef struct tlkp_v4_key_s {
+
+    uint32_t tk_phys_port;
+    uint32_t tk_l4_hash;
+    uint32_t tk_local_addr;
+    uint32_t tk_remote_addr;
+    uint16_t tk_local_port;
+    uint16_t tk_remote_port;
+
+} tlkp_v4_key_t;
 
 /*****************************************************************************
- * Lookup hash definitions
+ * Control block recycle stack
+ *      Per lcore, per test case LIFO of freed server control blocks. Closed
+ *      sessions are pushed here instead of going back to the mempool and
+ *      the next clone pops the most recently used (cache hot) one. The stack
+ *      is refilled/drained from/to the mempool in bulks of
+ *      TLKP_CB_RECYCLE_BULK and flushed when the test case is stopped.
  ****************************************************************************/
-typedef struct l4_control_block_s {
+#define TLKP_CB_RECYCLE_SIZE    64
+#define TLKP_CB_RECYCLE_BULK    (TLKP_CB_RECYCLE_SIZE / 2)
 
-#if defined(TPG_L4_CB_DEBUG)
-    uint32_t         l4cb_id;
-#endif /* defined(TPG_L4_CB_DEBUG) */
+typedef struct tlkp_cb_recycle_s {
 
-    /*
-     * Lookup hash linkage
-     */
-    LIST_ENTRY(l4_control_block_s)  l4cb_hash_bucket_entry;
+    uint32_t  cr_count;
+    void     *cr_cbs[TLKP_CB_RECYCLE_SIZE];
 
-    /*
-     * TPG tests linkage.
-     */
-    TAILQ_ENTRY(l4_control_block_s) l4cb_test_list_entry;
+} tlkp_cb_recycle_t;
 
-    /*
-     * TPG test timer linkage.
-     */
-    tmr_list_entry(l4_control_block_s) l4cb_test_tmr_entry;
+/*****************************************************************************
+ * Cached L2/L3 header template
+ ****************************************************************************/
+/*
+ * Worst case: Ethernet + single VLAN tag + IPv4 header without options.
+ * Control blocks that need IPv4 options (TX timestamping) don't use the
+ * template.
+ */
+#define L4CB_HDR_TMPL_MAX_SIZE \
+    (sizeof(struct rte_ether_hdr) + sizeof(struct rte_vlan_hdr) + \
+     sizeof(struct rte_ipv4_hdr))
 
-    /*
-     * Test state-machine information
-     */
-    test_sm_state_t  l4cb_test_state;
+typedef struct l4_hdr_tmpl_s {
 
-    /* Physical control block address. If the phys address can't be computed
-     * (e.g., non-contiguous mempools) this field will be RTE_BAD_PHYS_ADDR.
+    uint8_t  ht_data[L4CB_HDR_TMPL_MAX_SIZE];
+
+    /* route_v4_nh_gen() at the time the template was built. Generation 0
+     * is never used by the route module so a zeroed template is stale.
      */
-    phys_addr_t      l4cb_phys_addr;
+    uint32_t ht_gen;
+
+    /* Raw (not complemented) IPv4 header checksum with total_length = 0. */
+    uint16_t ht_ip_cksum;
+
+    uint8_t  ht_l2_len;
+    uint8_t  ht_len;
+
+} __rte_cache_aligned l4_hdr_tmpl_t;
+
+/*****************************************************************************
+ * Lookup hash definitions
+ ****************************************************************************/
+typedef struct l4_control_block_s {
 
     /*
-     * Port and test information.
+     * Everything the session lookup compares (and the RX path needs right
+     * after the lookup) lives in the first cache line.
      */
     uint32_t         l4cb_rx_hash;
 #if defined(TPG_L4_CB_TX_HASH)
@@ -124,12 +181,6 @@ typedef struct l4_control_block_s {
     uint16_t         l4cb_interface;
     uint16_t         l4cb_test_case_id;
 
-    /* Socket options. */
-    sockopt_t        l4cb_sockopt;
-
-    /* Application level state storage. */
-    app_data_t       l4cb_app_data;
-
     /*
      * Address information
      */
@@ -140,6 +191,16 @@ typedef struct l4_control_block_s {
     tpg_ip_t         l4cb_src_addr;
     tpg_ip_t         l4cb_dst_addr;
 
+    /* Socket options, shared by all the sessions of a test case (they point
+     * to the per core test case config).
+     */
+    const sockopt_t *l4cb_sockopt;
+
+    /*
+     * Test state-machine information
+     */
+    test_sm_state_t  l4cb_test_state;
+
     /*
      * Flags.
      */
@@ -147,9 +208,38 @@ typedef struct l4_control_block_s {
     uint32_t         l4cb_valid            :1; /* Only with TPG_L4_CB_DEBUG */
     /* uint32_t      l4cb_unused           :30; */
 
+#if defined(TPG_L4_CB_DEBUG)
+    uint32_t         l4cb_id;
+#endif /* defined(TPG_L4_CB_DEBUG) */
+
+    /*
+     * TPG tests linkage.
+     */
+    TAILQ_ENTRY(l4_control_block_s) l4cb_test_list_entry;
+
+    /*
+     * TPG test timer linkage.
+     */
+    tmr_entry_t      l4cb_test_tmr_entry;
+
+    /* Physical control block address. If the phys address can't be computed
+     * (e.g., non-contiguous mempools) this field will be RTE_BAD_PHYS_ADDR.
+     */
+    phys_addr_t      l4cb_phys_addr;
+
+    /* Application level state storage. */
+    app_data_t       l4cb_app_data;
+
+    /*
+     * Prebuilt Ethernet/VLAN/IPv4 headers (see ipv4_build_hdr_mbuf()).
+     */
+    l4_hdr_tmpl_t    l4cb_hdr_tmpl;
+
 } l4_control_block_t;
 
-typedef LIST_HEAD(tlkp_hash_bucket_s, l4_control_block_s) tlkp_hash_bucket_t;
+static_assert(offsetof(l4_control_block_t, l4cb_sockopt) +
+                sizeof(const sockopt_t *) <= RTE_CACHE_LINE_SIZE,
+              "L4 control block lookup fields must fit in a cache line");
 
 /* Useful for extracting the l4cb_tx_hash from the control block. */
 #if defined(TPG_L4_CB_TX_HASH)
@@ -173,16 +263,33 @@ extern uint32_t tlkp_get_qindex_from_hash(uint32_t hash, uint32_t phys_port);
 
 extern bool tlkp_init(void);
 
-extern l4_control_block_t *tlkp_find_v4_cb(tlkp_hash_bucket_t *htable,
+extern void tlkp_htable_init(tlkp_htable_t *htable, const char *name,
+                             uint32_t entries,
+                             int socket);
+
+extern l4_control_block_t *tlkp_find_v4_cb(tlkp_htable_t *htable,
                                            uint32_t phys_port, uint32_t l4_hash,
                                            uint32_t local_addr, uint32_t remote_addr,
                                            uint16_t local_port, uint16_t remote_port);
 
-extern int tlkp_add_cb(tlkp_hash_bucket_t *htable, l4_control_block_t *cb);
+extern void tlkp_find_v4_cb_bulk(tlkp_htable_t *htable,
+                                 const tlkp_v4_key_t *keys,
+                                 l4_control_block_t **cbs,
+                                 uint32_t count);
+
+extern int tlkp_add_cb(tlkp_htable_t *htable, l4_control_block_t *cb);
 
-extern int tlkp_delete_cb(tlkp_hash_bucket_t *htable,
+extern int tlkp_delete_cb(tlkp_htable_t *htable,
                           l4_control_block_t *cb);
 
+extern uint32_t tlkp_cb_recycle_refill(tlkp_cb_recycle_t *recycle,
+                                       struct rte_mempool *mp,
+                                       size_t l4_cb_offset);
+
+extern void tlkp_cb_recycle_drain(tlkp_cb_recycle_t *recycle,
+                                  struct rte_mempool *mp,
+                                  uint32_t count);
+
 extern void tlkp_init_cb(l4_control_block_t *l4_cb,
                          uint32_t local_addr, uint32_t remote_addr,
                          uint16_t local_port, uint16_t remote_port,
@@ -195,6 +302,17 @@ extern void tlkp_init_cb(l4_control_block_t *l4_cb,
 /*****************************************************************************
  * Inlines for l4_control_block_t
  ****************************************************************************/
+/*****************************************************************************
+ * l4_cb_hdr_tmpl_invalidate()
+ *      Forces a rebuild of the cached headers on the next transmit. Must be
+ *      called whenever the addresses of the control block change.
+ ****************************************************************************/
+static inline __attribute__((__always_inline__))
+void l4_cb_hdr_tmpl_invalidate(l4_control_block_t *cb)
+{
+    cb->l4cb_hdr_tmpl.ht_gen = 0;
+}
+
 #if defined(TPG_L4_CB_DEBUG)
 /*****************************************************************************
  * l4_cb_valid()
@@ -401,13 +519,52 @@ void tlkp_alloc_cb_init(void *container, l4_control_block_t *cb,
 }
 
 /*****************************************************************************
- * tlkp_get_hash_bucket()
+ * tlkp_ht_hash()
+ *      The RSS hash alone is a bad bucket index: all sessions served by an
+ *      lcore share the bits used for queue selection. Mix it (together with
+ *      the port, the table is shared by all ports) before using it.
  ****************************************************************************/
-static inline tlkp_hash_bucket_t *tlkp_get_hash_bucket(tlkp_hash_bucket_t *htable,
-                                                       uint32_t phys_port,
-                                                       uint32_t hash)
+static inline __attribute__((__always_inline__))
+uint64_t tlkp_ht_hash(uint32_t phys_port, uint32_t l4_hash)
 {
-    return htable + (phys_port * TPG_HASH_BUCKET_SIZE) + TPG_HASH_MOD(hash);
+    return (((uint64_t)phys_port << 32) | l4_hash) * 0x9E3779B97F4A7C15ULL;
+}
+
+static inline __attribute__((__always_inline__))
+uint32_t tlkp_ht_hash_bucket(const tlkp_htable_t *htable, uint64_t hash)
+{
+    return (uint32_t)(hash >> 32) & htable->ht_bucket_mask;
+}
+
+static inline __attribute__((__always_inline__))
+uint16_t tlkp_ht_hash_sig(uint64_t hash)
+{
+    return (uint16_t)(hash >> 16);
+}
+
+/*****************************************************************************
+ * tlkp_ht_alt_bucket()
+ *      Symmetric: tlkp_ht_alt_bucket(tlkp_ht_alt_bucket(b, sig), sig) == b.
+ *      The low bit is always flipped so the two buckets never collide.
+ ****************************************************************************/
+static inline __attribute__((__always_inline__))
+uint32_t tlkp_ht_alt_bucket(const tlkp_htable_t *htable, uint32_t bucket,
+                            uint16_t sig)
+{
+    return (bucket ^ (((uint32_t)sig * 0x5bd1e995u) | 1)) &
+                htable->ht_bucket_mask;
+}
+
+/*****************************************************************************
+ * tlkp_ht_lookup_gen()
+ *      A positive lookup result only goes stale if something was deleted in
+ *      the meantime, a negative one only if something was added.
+ ****************************************************************************/
+static inline __attribute__((__always_inline__))
+uint32_t tlkp_ht_lookup_gen(const tlkp_htable_t *htable,
+                            const l4_control_block_t *cb)
+{
+    return cb != NULL ? htable->ht_del_gen : htable->ht_add_gen;
 }
 
 /*****************************************************************************
@@ -415,27 +572,25 @@ static inline tlkp_hash_bucket_t *tlkp_get_hash_bucket(tlkp_hash_bucket_t *htabl
  ****************************************************************************/
 typedef bool (*tlkp_walk_v4_cb_t)(l4_control_block_t *cb, void *arg);
 
-static inline void tlkp_walk_v4(tlkp_hash_bucket_t *htable,
+static inline void tlkp_walk_v4(tlkp_htable_t *htable,
                                 uint32_t phys_port,
                                 tlkp_walk_v4_cb_t callback,
                                 void *arg)
 {
-    tlkp_hash_bucket_t *bucket;
-    tlkp_hash_bucket_t *end;
-
-    bucket = htable + (phys_port * TPG_HASH_BUCKET_SIZE);
-    end = bucket + TPG_HASH_BUCKET_SIZE;
+    uint32_t            bucket;
+    uint32_t            i;
+    l4_control_block_t *cb;
 
-    for (; bucket != end; bucket++) {
-        l4_control_block_t *cb = bucket->lh_first;
+    /* Deleting the current entry is safe, deletes never move entries. */
+    for (bucket = 0; bucket <= htable->ht_bucket_mask; bucket++) {
+        for (i = 0; i < TLKP_HT_BUCKET_ENTRIES; i++) {
+            cb = htable->ht_buckets[bucket].hb_cb[i];
 
-        /* LIST_FOREACH is not safe for deletion. */
-        while (cb) {
-            l4_control_block_t *nxt = cb->l4cb_hash_bucket_entry.le_next;
+            if (cb == NULL || cb->l4cb_interface != phys_port)
+                continue;
 
             if (!callback(cb, arg))
                 return;
-            cb = nxt;
         }
     }
 }
@@ -70,6 +70,7 @@ enum msg_modules {
     MSG_TRACE_MODULE = MSG_MODULE_MIN,
     MSG_TRACE_FILTER_MODULE,
     MSG_ROUTE_MODULE,
+    MSG_ARP_MODULE,
     MSG_TESTS_MODULE,
     MSG_TEST_MGMT_MODULE,
     MSG_PKTLOOP_MODULE,
@@ -74,6 +74,15 @@ typedef struct packet_control_block_s {
     /* true if we stored if fore more processing (e.g, tcp) */
     uint32_t             pcb_mbuf_stored:1;
 
+    /* true if the session was already looked up for the whole RX burst. */
+    uint32_t             pcb_l4cb_valid:1;
+
+    /* Session lookup table generation at the time of the burst lookup. */
+    uint32_t             pcb_l4cb_gen;
+
+    /* TCB/UCB found by the burst lookup (NULL if none). */
+    void                *pcb_l4cb;
+
     struct rte_mbuf     *pcb_mbuf;
 
     union {
@@ -92,7 +101,11 @@ typedef struct packet_control_block_s {
     uint16_t             pcb_l5_len;
 
     uint64_t             pcb_tstamp;
-    sockopt_t           *pcb_sockopt;
+
+    /* Control block that consumed the packet (NULL if none or if it was
+     * freed while processing the packet).
+     */
+    l4_control_block_t  *pcb_rx_cb;
 
 } packet_control_block_t;
 
@@ -110,7 +123,8 @@ void pcb_minimal_init(packet_control_block_t *pcb, uint32_t core_index,
     pcb->pcb_hash_valid = false;
 
     pcb->pcb_mbuf_stored = false;
-    pcb->pcb_sockopt = NULL;
+    pcb->pcb_l4cb_valid = false;
+    pcb->pcb_rx_cb = NULL;
 }
 
 #endif /* _H_TPG_PCB_ */
@@ -64,9 +64,10 @@
 /*****************************************************************************
  * Definitions
  ****************************************************************************/
-#define PORT_CMDLINE_OPTIONS()            \
-    CMDLINE_OPT_ARG("qmap", true),        \
-    CMDLINE_OPT_ARG("qmap-default", true)
+#define PORT_CMDLINE_OPTIONS()             \
+    CMDLINE_OPT_ARG("qmap", true),         \
+    CMDLINE_OPT_ARG("qmap-default", true), \
+    CMDLINE_OPT_ARG("lro", false)
 
 #define PORT_CMDLINE_PARSER() \
     CMDLINE_ARG_PARSER(port_handle_cmdline_opt, port_handle_cmdline,                \
@@ -75,7 +76,8 @@
 "  --qmap-default max-c:       Maximize the number of independent cores handling\n" \
 "                              each physical port.\n"                               \
 "  --qmap-default max-q:       Maximize the number of transmit queues per\n"        \
-"                              physical port.\n")
+"                              physical port.\n"                                    \
+"  --lro:                      Enable TCP LRO on the ports that support it.\n")
 
 /*****************************************************************************
  * Port core mask - for each core in a mask we allocate an RX HW queue and a
@@ -150,6 +152,9 @@ typedef struct port_info_s {
     uint16_t                pi_ring_if : 1;
     uint16_t                pi_kni_if  : 1;
 
+    /* True if received TCP segments should be coalesced (GRO). */
+    uint16_t                pi_gro     : 1;
+
 } port_info_t;
 
 /*****************************************************************************
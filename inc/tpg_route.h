@@ -72,6 +72,8 @@ enum route_msg_types {
     MSG_ROUTE_INTF_DEL,
     MSG_ROUTE_GW_ADD,
     MSG_ROUTE_GW_DEL,
+    MSG_ROUTE_STATIC_ADD,
+    MSG_ROUTE_STATIC_DEL,
     MSG_TYPE_DEF_END_MARKER(ROUTE),
 
 };
@@ -104,6 +106,18 @@ typedef struct route_gw_msg_s {
 typedef route_gw_msg_t route_gw_add_msg_t;
 typedef route_gw_msg_t route_gw_del_msg_t;
 
+typedef struct route_static_msg_s {
+
+    uint32_t rsm_eth_port;
+    tpg_ip_t rsm_net;
+    tpg_ip_t rsm_mask;
+    tpg_ip_t rsm_gw;
+
+} __tpg_msg route_static_msg_t;
+
+typedef route_static_msg_t route_static_add_msg_t;
+typedef route_static_msg_t route_static_del_msg_t;
+
 /*****************************************************************************
  * Type definitions for tpg_route.
  ****************************************************************************/
@@ -114,6 +128,7 @@ typedef struct route_entry_s {
     tpg_ip_t re_nh;
 
     uint32_t re_flags;
+    uint16_t re_vlan_id; /* Local entries only: VLAN of the interface. */
 } route_entry_t;
 
 typedef struct gw_per_vlan_s {
@@ -134,10 +149,42 @@ typedef struct gw_per_vlan_s {
         .re_flags = (flags),           \
     })
 
-/* TODO */
-#define TPG_ROUTE_PORT_TABLE_SIZE (TPG_ARP_PORT_TABLE_SIZE / 2)
+/*
+ * Per port route entries. The first TPG_TEST_MAX_L3_INTF entries hold the
+ * directly connected (local) networks, the rest hold the static routes.
+ * The per port LPM table stores indices in this array as next hops.
+ */
+#define TPG_ROUTE_LOCAL_BASE      0
+#define TPG_ROUTE_STATIC_BASE     TPG_TEST_MAX_L3_INTF
+#define TPG_ROUTE_PORT_TABLE_SIZE (TPG_TEST_MAX_L3_INTF + TPG_TEST_MAX_L3_ROUTE)
 #define TPG_GW_PORT_VLAN_SIZE     TPG_TEST_MAX_L3_INTF
 
+/* Each route longer than /24 needs its own tbl8 group in the LPM. */
+#define TPG_ROUTE_LPM_TBL8_CNT    TPG_TEST_MAX_L3_ROUTE
+
+/*****************************************************************************
+ * Next hop generation.
+ *      Bumped (on the port default core) every time the ARP or routing
+ *      information of a port changes. Anything caching next hop resolution
+ *      results (e.g., l4cb_hdr_tmpl) must revalidate when the generation moves.
+ *      Generation 0 is reserved for "never resolved".
+ ****************************************************************************/
+extern volatile uint32_t *route_nh_gen_per_port;
+
+static inline uint32_t route_v4_nh_gen(uint32_t port)
+{
+    return route_nh_gen_per_port[port];
+}
+
+static inline void route_v4_nh_gen_bump(uint32_t port)
+{
+    /* Make sure the table updates are visible before the new generation. */
+    rte_smp_wmb();
+    route_nh_gen_per_port[port]++;
+    if (unlikely(route_nh_gen_per_port[port] == 0))
+        route_nh_gen_per_port[port] = 1;
+}
+
 /*****************************************************************************
  * External's for tpg_route.c
  ****************************************************************************/
@@ -152,6 +199,10 @@ extern int            route_v4_intf_del(uint32_t port, tpg_ip_t ip,
                                         tpg_ip_t gw);
 extern int            route_v4_gw_add(uint32_t port, tpg_ip_t gw);
 extern int            route_v4_gw_del(uint32_t port, tpg_ip_t gw);
+extern int            route_v4_static_add(uint32_t port, tpg_ip_t net,
+                                          tpg_ip_t mask, tpg_ip_t gw);
+extern int            route_v4_static_del(uint32_t port, tpg_ip_t net,
+                                          tpg_ip_t mask, tpg_ip_t gw);
 extern uint64_t       route_v4_nh_lookup(uint32_t port, uint32_t dest,
                                          uint16_t vlan_id);
 extern route_entry_t *route_v4_find_local(uint32_t port, uint32_t dest);
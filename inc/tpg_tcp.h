@@ -71,19 +71,118 @@ typedef struct tcb_retrans_s {
     uint32_t         tr_total_size;
 } tcb_retrans_t;
 
+/*****************************************************************************
+ * TCP SACK scoreboard definitions
+ ****************************************************************************/
+#define TCB_SACK_SCOREBOARD_SIZE GCFG_TCP_SACK_SCOREBOARD_SIZE
+
+typedef struct tcb_sack_blk_s {
+    uint32_t tsb_start;
+    uint32_t tsb_end;   /* First sequence after the block. */
+} tcb_sack_blk_t;
+
+/* Ranges above SND.UNA that the peer reported as received. Sorted and
+ * without overlaps.
+ */
+typedef struct tcb_sack_s {
+    tcb_sack_blk_t ts_blks[TCB_SACK_SCOREBOARD_SIZE];
+    uint32_t       ts_cnt;
+    uint32_t       ts_high_rxt; /* RFC 6675 HighRxt: end of the last hole
+                                 * retransmission in the current recovery.
+                                 */
+} tcb_sack_t;
+
+/*****************************************************************************
+ * TCP RTT estimation (RFC 6298)
+ ****************************************************************************/
+typedef struct tcb_rtt_s {
+    uint32_t trtt_srtt;   /* Smoothed RTT in us, 0 until the first sample. */
+    uint32_t trtt_rttvar; /* RTT variation in us. */
+    uint32_t trtt_rto;    /* Current RTO in us (without backoff). */
+
+    /* Karn's algorithm: only one segment is timed at a time and the
+     * measurement is discarded if the segment is retransmitted.
+     */
+    uint32_t trtt_seq;    /* First sequence after the timed segment. */
+    uint64_t trtt_start;  /* Send timestamp in cycles, 0 if not timing. */
+} tcb_rtt_t;
+
+/*****************************************************************************
+ * TCP Congestion control per algorithm state
+ ****************************************************************************/
+typedef struct tcb_cc_newreno_s {
+    /* Bytes acked since the last congestion avoidance increase. */
+    uint32_t nr_bytes_acked;
+} tcb_cc_newreno_t;
+
+typedef struct tcb_cc_cubic_s {
+    uint32_t cu_w_max;       /* cwnd before the last reduction (bytes). */
+    uint32_t cu_w_est;       /* TCP friendly region cwnd estimate (bytes). */
+    uint32_t cu_k;           /* Time to grow back to cu_w_max (ms). */
+    uint32_t cu_epoch_start; /* Start of the congestion avoidance epoch (ms). */
+    bool     cu_epoch_valid;
+} tcb_cc_cubic_t;
+
+typedef union tcb_cc_u {
+    tcb_cc_newreno_t cc_newreno;
+    tcb_cc_cubic_t   cc_cubic;
+} tcb_cc_t;
+
+/*****************************************************************************
+ * TCP Fast Open (RFC 7413) per session state
+ ****************************************************************************/
+#define TCP_FASTOPEN_COOKIE_MAX 16
+
+typedef struct tcb_tfo_s {
+    /* Client: the cookie we send in the SYN (empty for a cookie request).
+     * Server: the cookie we send in the SYN/ACK.
+     */
+    uint8_t tt_cookie[TCP_FASTOPEN_COOKIE_MAX];
+    uint8_t tt_cookie_len;
+
+    uint8_t tt_send_opt    :1; /* Our SYN (or SYN/ACK) carries the option. */
+    uint8_t tt_syn_pending :1; /* Client: the SYN waits for the first data. */
+    uint8_t tt_early_conn  :1; /* Client: connected before the SYN/ACK. */
+    uint8_t tt_cookie_ok   :1; /* Server: the SYN had a valid cookie. */
+    uint8_t tt_syn_data    :1; /* Data sent (client) or accepted (server)
+                                * with the SYN.
+                                */
+} tcb_tfo_t;
+
 /*****************************************************************************
  * TCP Receive buffer definitions
  ****************************************************************************/
+/* Out of order data is kept in an AVL tree of disjoint, non adjacent
+ * blocks keyed by their start sequence number so that reordering doesn't
+ * get more expensive as the window grows.
+ */
 typedef struct tcb_buf_hdr_s {
-    LIST_ENTRY(tcb_buf_hdr_s) tbh_entry;
-
+    struct tcb_buf_hdr_s *tbh_left;
+    struct tcb_buf_hdr_s *tbh_right;
 
     struct rte_mbuf *tbh_mbuf;
+    struct rte_mbuf *tbh_last_mbuf; /* Avoids walking the chain on merge. */
     uint64_t         tbh_tstamp;
     uint32_t         tbh_seg_seq;
+    uint32_t         tbh_height;
 } tcb_buf_hdr_t;
 
-typedef LIST_HEAD(tcb_buf_hdr_entry_s, tcb_buf_hdr_s) tcb_buf_entry_t;
+typedef struct tcb_buf_tree_s {
+    tcb_buf_hdr_t *tbt_root;
+    uint32_t       tbt_cnt;
+} tcb_buf_tree_t;
+
+/*****************************************************************************
+ * Returns the sequence number following the 'a' rcv_buffer
+ ****************************************************************************/
+#define TCB_RCVBUF_END(a) \
+    ((a)->tbh_seg_seq + (a)->tbh_mbuf->pkt_len)
+
+/*****************************************************************************
+ * Checks if there's any out of order data stored
+ ****************************************************************************/
+#define TCB_RCVBUF_EMPTY(tcb) \
+    ((tcb)->tcb_rcv_buf.tbt_root == NULL)
 
 /*****************************************************************************
  * Checks if the start of the 'a' rcv_buffer is before the start of 'b'
@@ -130,6 +229,10 @@ typedef struct tcb_snd_s {
     uint32_t wl1;
     uint32_t wl2;
     uint32_t iss;
+
+    /* Congestion control (bytes), see tpg_tcp_cc.h. */
+    uint32_t cwnd;
+    uint32_t ssthresh;
 } tcb_snd_t;
 
 typedef struct tcb_rcv_s {
@@ -141,74 +244,184 @@ typedef struct tcb_rcv_s {
 
 typedef struct tcp_control_block_s {
     /*
-     * Generic L4 control block.
+     * Generic L4 control block. The session lookup fields are in its first
+     * cache line.
      */
     l4_control_block_t tcb_l4;
 
     /*
-     * TCP slow timer linkage (slow wait/keep-alive/etc.)
+     * Everything touched by the RX segment processing fast path, in a single
+     * cache line.
      */
-    tmr_list_entry(tcp_control_block_s) tcb_slow_tmr_entry;
+    struct {
+        /*
+         * TCP state-machine information
+         */
+        tcpState_t     tcb_state;
+
+        /*
+         * TCP send receive pointers.
+         */
+        tcb_snd_t      tcb_snd;
+        tcb_rcv_t      tcb_rcv;
+
+        /*
+         * TCB flags
+         */
+        uint32_t       tcb_active           :1;
+        uint32_t       tcb_consume_all_data :1;
+        uint32_t       tcb_malloced         :1;
+        uint32_t       tcb_on_slow_list     :1;
+        uint32_t       tcb_on_rto_list      :1;
+        /* The tcb is linked in the RTO wheel (maybe lazily cancelled). */
+        uint32_t       tcb_rto_linked       :1;
+
+        uint32_t       tcb_trace            :1;
+
+        uint32_t       tcb_retrans_cnt      :8;
+        uint32_t       tcb_fin_rcvd         :1;
+
+        uint32_t       tcb_rst_rcvd         :1;
+
+        /* RFC 7323 window scaling: only used if both sides agreed. */
+        uint32_t       tcb_wscale_ok        :1;
+        uint32_t       tcb_snd_wscale       :4;
+        uint32_t       tcb_rcv_wscale       :4;
+
+        /* RFC 2018 selective acknowledgements: both sides agreed. */
+        uint32_t       tcb_sack_ok          :1;
+
+        /* Fast recovery in progress (RFC 5681, RFC 6582). */
+        uint32_t       tcb_in_recovery      :1;
+
+        /* RFC 7323 timestamps: both sides agreed. */
+        uint32_t       tcb_ts_ok            :1;
+
+        /* An ACK is queued for the end of the current RX burst. */
+        uint32_t       tcb_ack_pending      :1;
+        uint32_t       tcb_on_delack_list   :1;
+
+        /* Closed in rst-after-data mode, waiting for our data to be acked
+         * (or for the end of the RX burst).
+         */
+        uint32_t       tcb_rst_close        :1;
+
+        uint32_t       tcb_rcv_fin_seq;
+    } __rte_cache_aligned;
 
     /*
-     * TCP retrans timer linkage
+     * Colder state: only touched when data is (re)transmitted, out of order
+     * data is received or when timers are (re)armed.
      */
-    tmr_list_entry(tcp_control_block_s) tcb_retrans_tmr_entry;
 
     /*
-     * TCP state-machine information
+     * Retrans information.
      */
-    tcpState_t         tcb_state;
+    tcb_retrans_t      tcb_retrans;
 
     /*
-     * TCP send receive pointers.
+     * SACK scoreboard (only used if tcb_sack_ok).
      */
-    tcb_snd_t          tcb_snd;
-    tcb_rcv_t          tcb_rcv;
+    tcb_sack_t         tcb_sack;
 
     /*
-     * Retrans information.
+     * Congestion control algorithm state.
      */
-    tcb_retrans_t      tcb_retrans;
+    tcb_cc_t           tcb_cc;
+
+    /*
+     * RTT estimator and current retransmission timeout.
+     */
+    tcb_rtt_t          tcb_rtt;
+
+    /*
+     * Maximum segment size we send: our MSS limited by the one the peer
+     * advertised.
+     */
+    uint32_t           tcb_snd_mss;
+
+    /*
+     * Fast retransmit/recovery state.
+     */
+    uint32_t           tcb_dup_acks;
+    uint32_t           tcb_recover;  /* SND.NXT when the last recovery started. */
+
+    /*
+     * Go-back-N after a timeout: next sequence to resend and SND.NXT when
+     * the timeout fired. Equal when there's nothing left to resend.
+     */
+    uint32_t           tcb_rto_nxt;
+    uint32_t           tcb_rto_end;
 
     /*
      * Receive buffer information.
      */
-    tcb_buf_entry_t    tcb_rcv_buf;
+    tcb_buf_tree_t     tcb_rcv_buf;
+
+    /* Start of the last out of order segment we received, its block is
+     * reported first in the SACK option.
+     */
+    uint32_t           tcb_rcv_buf_recent;
+
+    /* RFC 7323 TS.Recent: the peer timestamp we echo back. */
+    uint32_t           tcb_ts_recent;
 
     /*
-     * TCB flags
+     * TCP Fast Open state (only used if enabled for the test case).
      */
-    uint32_t           tcb_active           :1;
-    uint32_t           tcb_consume_all_data :1;
-    uint32_t           tcb_malloced         :1;
-    uint32_t           tcb_on_slow_list     :1;
-    uint32_t           tcb_on_rto_list      :1;
+    tcb_tfo_t          tcb_tfo;
 
-    uint32_t           tcb_trace            :1;
+    /*
+     * TCP slow timer linkage (slow wait/keep-alive/etc.)
+     */
+    tmr_entry_t        tcb_slow_tmr_entry;
 
-    uint32_t           tcb_retrans_cnt      :8;
-    uint32_t           tcb_fin_rcvd         :1;
+    /*
+     * TCP retrans timer linkage
+     */
+    tmr_entry_t        tcb_retrans_tmr_entry;
 
-    uint32_t           tcb_rst_rcvd         :1;
+    /* RTO expiry in retrans timer wheel ticks. It might be later than the
+     * wheel entry expiry, see tcp_timer_rto_set().
+     */
+    uint64_t           tcb_rto_deadline;
 
-    /* uint32_t        tcb_unused           :17; */
+    /*
+     * TCP delayed ACK timer linkage
+     */
+    tmr_entry_t        tcb_delack_tmr_entry;
 
-    uint32_t           tcb_rcv_fin_seq;
+    /* RCV.NXT carried by the last ACK we sent. */
+    uint32_t           tcb_rcv_acked;
 
 } tcp_control_block_t;
 
+static_assert(offsetof(tcp_control_block_t, tcb_rcv_fin_seq) +
+                sizeof(uint32_t) -
+                offsetof(tcp_control_block_t, tcb_state) <= RTE_CACHE_LINE_SIZE,
+              "TCB fast path fields must fit in a cache line");
+
 #define TCB_SLOW_TMR_IS_SET(tcb) ((tcb)->tcb_on_slow_list)
 #define TCB_RTO_TMR_IS_SET(tcb)  ((tcb)->tcb_on_rto_list)
+#define TCB_DELACK_TMR_IS_SET(tcb) ((tcb)->tcb_on_delack_list)
+
+/* RFC 5681: duplicate ACKs that trigger a fast retransmit. */
+#define TCP_DUP_ACK_THRESH 3
 
 /* Maximum values for TCP configurable options. */
-#define TCP_MAX_WINDOW_SIZE  65535
+#define TCP_MAX_WINDOW_SIZE  (16 * 1024 * 1024)
 #define TCP_MAX_RETRY_CNT      128
 
 #define TCP_MAX_RTO_MS       10000
 #define TCP_MAX_FIN_TO_MS     1000
 #define TCP_MAX_TWAIT_TO_MS  10000
 #define TCP_MAX_ORPHAN_TO_MS  2000
+/* RFC 1122: an ACK must not be delayed more than 0.5 seconds. */
+#define TCP_MAX_ACK_DELAY_MS   500
+
+/* RFC 7323: the window field is 16 bits wide, the shift is at most 14. */
+#define TCP_MAX_UNSCALED_WINDOW_SIZE 65535
+#define TCP_MAX_WIN_SCALE               14
 
 
 /*****************************************************************************
@@ -242,17 +455,69 @@ static inline void tcb_buf_hdr_init(tcb_buf_hdr_t *hdr, struct rte_mbuf *mbuf,
                                     uint32_t tcp_seg_seq)
 {
     hdr->tbh_mbuf = mbuf,
+    hdr->tbh_last_mbuf = rte_pktmbuf_lastseg(mbuf);
     hdr->tbh_tstamp = tstamp;
     hdr->tbh_seg_seq = tcp_seg_seq;
 }
 
+/*****************************************************************************
+ * tcb_buf_hdr_merge()
+ *      Appends the data of 'src' to 'dest'. Large windows can accumulate
+ *      long chains of out of order data so we don't walk them.
+ ****************************************************************************/
+static inline void tcb_buf_hdr_merge(tcb_buf_hdr_t *dest,
+                                     const tcb_buf_hdr_t *src)
+{
+    dest->tbh_last_mbuf->next = src->tbh_mbuf;
+    dest->tbh_last_mbuf = src->tbh_last_mbuf;
+    dest->tbh_mbuf->nb_segs += src->tbh_mbuf->nb_segs;
+    dest->tbh_mbuf->pkt_len += src->tbh_mbuf->pkt_len;
+}
+
+/*****************************************************************************
+ * tcp_seg_wnd()
+ *      The window advertised by the peer in 'tcp'. The window field of SYN
+ *      segments is never scaled.
+ ****************************************************************************/
+static inline uint32_t tcp_seg_wnd(const tcp_control_block_t *tcb,
+                                   const struct rte_tcp_hdr *tcp)
+{
+    if (unlikely((tcp->tcp_flags & RTE_TCP_SYN_FLAG) != 0))
+        return rte_be_to_cpu_16(tcp->rx_win);
+
+    return (uint32_t)rte_be_to_cpu_16(tcp->rx_win) << tcb->tcb_snd_wscale;
+}
+
+/*****************************************************************************
+ * tcp_adv_wnd()
+ *      The window field we should send in a segment with 'flags'.
+ ****************************************************************************/
+static inline uint16_t tcp_adv_wnd(const tcp_control_block_t *tcb,
+                                   uint32_t flags)
+{
+    if (unlikely((flags & RTE_TCP_SYN_FLAG) != 0))
+        return TPG_MIN(tcb->tcb_rcv.wnd, TCP_MAX_UNSCALED_WINDOW_SIZE);
+
+    return TPG_MIN(tcb->tcb_rcv.wnd >> tcb->tcb_rcv_wscale,
+                   TCP_MAX_UNSCALED_WINDOW_SIZE);
+}
+
+/*****************************************************************************
+ * tcp_snd_wnd()
+ *      The window we're allowed to use: the minimum between the peer's
+ *      receive window and the congestion window.
+ ****************************************************************************/
+static inline uint32_t tcp_snd_wnd(const tcp_control_block_t *tcb)
+{
+    return TPG_MIN(tcb->tcb_snd.wnd, tcb->tcb_snd.cwnd);
+}
+
 /*****************************************************************************
  * tcp_snd_win_full()
  ****************************************************************************/
 static inline bool tcp_snd_win_full(tcp_control_block_t *tcb)
 {
-    return SEG_EQ(tcb->tcb_snd.wnd,
-                  SEG_DIFF(tcb->tcb_snd.nxt, tcb->tcb_snd.una));
+    return SEG_DIFF(tcb->tcb_snd.nxt, tcb->tcb_snd.una) >= tcp_snd_wnd(tcb);
 }
 
 /*****************************************************************************
@@ -262,6 +527,9 @@ static inline bool tcp_snd_win_full(tcp_control_block_t *tcb)
 STATS_GLOBAL_DECLARE(tpg_tcp_statistics_t);
 STATS_LOCAL_DECLARE(tpg_tcp_statistics_t);
 
+/* Session whose segment is currently processed by the state machine. */
+RTE_DECLARE_PER_LCORE(tcp_control_block_t *, tcp_rx_tcb);
+
 /*****************************************************************************
  * Externals for tpg_tcp.c
  ****************************************************************************/
@@ -271,6 +539,7 @@ extern void             tcp_store_sockopt(tcp_sockopt_t *dest,
                                           const tpg_tcp_sockopt_t *options);
 extern void             tcp_load_sockopt(tpg_tcp_sockopt_t *dest,
                                          const tcp_sockopt_t *options);
+extern const char      *tcp_close_mode_name(tpg_tcp_close_mode_t mode);
 extern struct rte_mbuf *tcp_receive_pkt(packet_control_block_t *pcb,
                                         struct rte_mbuf *mbuf);
 extern bool             tcp_send_data_pkt(tcp_control_block_t *tcb,
@@ -283,6 +552,10 @@ extern bool             tcp_send_ctrl_pkt_with_sseq(tcp_control_block_t *tcb,
                                                     uint32_t sseq,
                                                     uint32_t flags);
 extern bool             tcp_send_ack_pkt(tcp_control_block_t *tcb);
+extern void             tcp_send_ack_burst(tcp_control_block_t *tcb);
+extern void             tcp_send_ack_delayed(tcp_control_block_t *tcb);
+extern void             tcp_rst_close_burst(tcp_control_block_t *tcb);
+extern void             tcp_ack_flush(void);
 extern int              tcp_open_v4_connection(tcp_control_block_t **tcb,
                                                uint32_t eth_port,
                                                uint32_t src_ip_addr,
@@ -318,6 +591,7 @@ extern tcp_control_block_t *tcb_clone(tcp_control_block_t *tcb);
  ****************************************************************************/
 #define TCP_BUILD_FLAG_MASK    0x0000ffff
 #define TCP_BUILD_FLAG_USE_ISS 0x00010000
+#define TCP_BUILD_FLAG_TSO     0x00020000
 
  /*****************************************************************************
  * Flags for tcp_send_v4()
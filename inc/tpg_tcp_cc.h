@@ -0,0 +1,161 @@
+/*
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER
+ *
+ * Copyright (c) 2026, Juniper Networks, Inc. All rights reserved.
+ *
+ *
+ * The contents of this file are subject to the terms of the BSD 3 clause
+ * License (the "License"). You may not use this file except in compliance
+ * with the License.
+ *
+ * You can obtain a copy of the license at
+ * https://github.com/Juniper/warp17/blob/master/LICENSE.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from this
+ * software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * File name:
+ *     tpg_tcp_cc.h
+ *
+ * Description:
+ *     TCP congestion control.
+ *
+ * Author:
+ *     Dumitru Ceara, Eelco Chaudron
+ *
+ * Initial Created:
+ *     10/17/2026
+ *
+ * Notes:
+ *     The algorithms only decide how tcb_snd.cwnd and tcb_snd.ssthresh evolve.
+ *     The state machine reports the events (new data acked, loss detected,
+ *     retransmission timeout) and enforces the window when sending.
+ *
+ */
+
+/*****************************************************************************
+ * Multiple include protection
+ ****************************************************************************/
+#ifndef _H_TPG_TCP_CC_
+#define _H_TPG_TCP_CC_
+
+/*****************************************************************************
+ * Definitions
+ ****************************************************************************/
+/* RFC 6928: IW = min(10 * MSS, max(2 * MSS, 14600)). */
+#define TCP_CC_INIT_WND(mss) \
+    TPG_MIN(10 * (mss), TPG_MAX(2 * (mss), 14600))
+
+/* RFC 5681: loss window after a retransmission timeout. */
+#define TCP_CC_LOSS_WND(mss) (mss)
+
+/* RFC 5681: ssthresh after a loss, based on the data in flight. */
+#define TCP_CC_LOSS_SSTHRESH(flight, mss) \
+    TPG_MAX((flight) / 2, 2 * (mss))
+
+typedef struct tcp_cc_ops_s {
+
+    /* Called when the connection is (re)initialized. */
+    void (*cco_init)(tcp_control_block_t *tcb, uint32_t mss);
+
+    /* Called when an ACK acknowledges new data. */
+    void (*cco_ack)(tcp_control_block_t *tcb, uint32_t acked, uint32_t mss);
+
+    /* Called when a loss is detected without a timeout (i.e., through
+     * duplicate ACKs) before entering fast recovery.
+     */
+    void (*cco_loss)(tcp_control_block_t *tcb, uint32_t mss);
+
+    /* Called when the retransmission timer fires. 'first' is false for
+     * consecutive timeouts of the same data.
+     */
+    void (*cco_rto)(tcp_control_block_t *tcb, bool first, uint32_t mss);
+
+} tcp_cc_ops_t;
+
+/*****************************************************************************
+ * Globals for tpg_tcp_cc.c
+ ****************************************************************************/
+extern const tcp_cc_ops_t *tcp_cc_algos[TCP_CONG_CONTROL__TCP_CONG_CONTROL_MAX];
+
+/*****************************************************************************
+ * Externals for tpg_tcp_cc.c
+ ****************************************************************************/
+extern const char *tcp_cc_name(tpg_tcp_cong_control_t algo);
+
+/*****************************************************************************
+ * tcp_cc_ops()
+ ****************************************************************************/
+static inline const tcp_cc_ops_t *tcp_cc_ops(const tcp_control_block_t *tcb)
+{
+    const tcp_sockopt_t *tcp_opts = tcp_get_sockopt(tcb->tcb_l4.l4cb_sockopt);
+
+    return tcp_cc_algos[tcp_opts->tcpo_cong_control];
+}
+
+/*****************************************************************************
+ * tcp_cc_flight_size()
+ ****************************************************************************/
+static inline uint32_t tcp_cc_flight_size(const tcp_control_block_t *tcb)
+{
+    return SEG_DIFF(tcb->tcb_snd.nxt, tcb->tcb_snd.una);
+}
+
+/*****************************************************************************
+ * tcp_cc_init()
+ ****************************************************************************/
+static inline void tcp_cc_init(tcp_control_block_t *tcb)
+{
+    tcp_cc_ops(tcb)->cco_init(tcb, TCB_MTU(tcb));
+}
+
+/*****************************************************************************
+ * tcp_cc_ack()
+ ****************************************************************************/
+static inline void tcp_cc_ack(tcp_control_block_t *tcb, uint32_t acked)
+{
+    tcp_cc_ops(tcb)->cco_ack(tcb, acked, TCB_MTU(tcb));
+}
+
+/*****************************************************************************
+ * tcp_cc_loss()
+ ****************************************************************************/
+static inline void tcp_cc_loss(tcp_control_block_t *tcb)
+{
+    tcp_cc_ops(tcb)->cco_loss(tcb, TCB_MTU(tcb));
+}
+
+/*****************************************************************************
+ * tcp_cc_rto()
+ ****************************************************************************/
+static inline void tcp_cc_rto(tcp_control_block_t *tcb, bool first)
+{
+    tcp_cc_ops(tcb)->cco_rto(tcb, first, TCB_MTU(tcb));
+}
+
+#endif /* _H_TPG_TCP_CC_ */
+
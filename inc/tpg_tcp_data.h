@@ -76,17 +76,32 @@
 static_assert(sizeof(tcb_buf_hdr_t) <= TCB_MIN_HDRS_SZ,
               "Not enough headroom in the mbuf!");
 
-#define TCP_MTU(port_info, sockopt)                                         \
-    ((port_info)->pi_mtu - ipv4_get_sockopt((sockopt))->ip4so_hdr_opt_len - \
-     vlan_get_sockopt((sockopt))->vlanso_hdr_opt_len -                      \
+/* Smallest path MTU that still leaves room for TCP_OPT_MSS_MIN bytes. */
+#define TCP_MIN_PMTU (TCB_MIN_HDRS_SZ + TCP_OPT_MSS_MIN)
+
+/* The port MTU, clamped by the per test case path MTU if configured. */
+#define TCP_PATH_MTU(port_info, sockopt)                          \
+    ((tcp_get_sockopt((sockopt))->tcpo_pmtu != 0) ?               \
+     TPG_MIN((port_info)->pi_mtu,                                 \
+             tcp_get_sockopt((sockopt))->tcpo_pmtu) :             \
+     (port_info)->pi_mtu)
+
+#define TCP_MTU(port_info, sockopt)                                  \
+    (TCP_PATH_MTU((port_info), (sockopt)) -                          \
+     ipv4_get_sockopt((sockopt))->ip4so_hdr_opt_len -                \
+     vlan_get_sockopt((sockopt))->vlanso_hdr_opt_len -               \
      TCB_MIN_HDRS_SZ)
 
 #define TCP_GLOBAL_MTU(port, sockopt) \
     TCP_MTU(&port_dev_info[(port)], (sockopt))
 
-#define TCB_MTU(tcb)                                                           \
+/* The MSS we advertise. */
+#define TCB_LOCAL_MSS(tcb)                                                     \
     TCP_MTU(&RTE_PER_LCORE(local_port_dev_info)[(tcb)->tcb_l4.l4cb_interface], \
-    &(tcb)->tcb_l4.l4cb_sockopt)
+    (tcb)->tcb_l4.l4cb_sockopt)
+
+/* The maximum payload we send in a segment (options included). */
+#define TCB_MTU(tcb) ((tcb)->tcb_snd_mss)
 
 /*****************************************************************************
  * TCP Send related macros
@@ -99,17 +114,32 @@ static_assert(sizeof(tcb_buf_hdr_t) <= TCB_MIN_HDRS_SZ,
 
 #define TCB_SEGS_PER_SEND GCFG_TCP_SEGS_PER_SEND
 
-#define TCP_AVAIL_SEND(port_info, sockopt, retrans_size)         \
-    TPG_MIN(TCB_MAX_TX_BUF_SZ(sockopt) - (retrans_size),         \
-            TCB_SEGS_PER_SEND * TCP_MTU((port_info), (sockopt)))
+/* Large sends: the payload of a TSO super packet must fit an IPv4 packet
+ * together with the biggest IP and TCP headers (options included).
+ */
+#define TCP_LARGE_SEND_MAX_LEN (UINT16_MAX - 2 * 60)
+
+#define TCP_LARGE_SEND(sockopt) (tcp_get_sockopt((sockopt))->tcpo_tso)
+
+/* The NIC segments large sends. Otherwise they're segmented in software. */
+#define TCP_HW_TSO(sockopt) \
+    (TCP_LARGE_SEND(sockopt) && (sockopt)->so_eth.ethso_tx_offload_tcp_tso)
+
+#define TCP_MAX_SEND(sockopt, mss)                   \
+    (TCP_LARGE_SEND(sockopt) ? TCP_LARGE_SEND_MAX_LEN : \
+                               TCB_SEGS_PER_SEND * (mss))
+
+#define TCP_AVAIL_SEND(port_info, sockopt, retrans_size)            \
+    TPG_MIN(TCB_MAX_TX_BUF_SZ(sockopt) - (retrans_size),            \
+            TCP_MAX_SEND((sockopt), TCP_MTU((port_info), (sockopt))))
 
 #define TCP_GLOBAL_AVAIL_SEND(port, sockopt) \
     TCP_AVAIL_SEND(&port_dev_info[(port)], (sockopt), 0)
 
-#define TCB_AVAIL_SEND(tcb)                                                           \
-    TCP_AVAIL_SEND(&RTE_PER_LCORE(local_port_dev_info)[(tcb)->tcb_l4.l4cb_interface], \
-                   &(tcb)->tcb_l4.l4cb_sockopt,                                       \
-                   (tcb)->tcb_retrans.tr_total_size)
+#define TCB_AVAIL_SEND(tcb)                                               \
+    TPG_MIN(TCB_MAX_TX_BUF_SZ((tcb)->tcb_l4.l4cb_sockopt) -               \
+            (tcb)->tcb_retrans.tr_total_size,                             \
+            TCP_MAX_SEND((tcb)->tcb_l4.l4cb_sockopt, TCB_MTU(tcb)))
 
 /* TODO: we only support PUSH SEND for now but when we support more this should
  * be rethought.
@@ -117,14 +147,36 @@ static_assert(sizeof(tcb_buf_hdr_t) <= TCB_MIN_HDRS_SZ,
 #define TCB_PSH_THRESH(tcb) TCB_MTU(tcb)
 
 extern int      tcp_data_send(tcp_control_block_t *tcb, tsm_data_arg_t *data);
+extern int      tcp_data_send_syn(tcp_control_block_t *tcb,
+                                  tsm_data_arg_t *data);
+
+extern uint32_t tcp_data_send_unsent(tcp_control_block_t *tcb,
+                                     uint32_t snd_flags);
 
 extern uint32_t tcp_data_handle(tcp_control_block_t *tcb,
                                 packet_control_block_t *pcb,
                                 uint32_t seg_seq,
                                 uint32_t seg_len,
                                 bool urgent);
+extern uint32_t tcp_data_handle_in_order(tcp_control_block_t *tcb,
+                                         packet_control_block_t *pcb,
+                                         uint32_t seg_len);
+
+extern const tcb_buf_hdr_t *tcp_data_rcvbuf_lookup(const tcp_control_block_t *tcb,
+                                                   uint32_t seq);
+extern uint32_t tcp_data_rcvbuf_blocks(const tcp_control_block_t *tcb,
+                                       const tcb_buf_hdr_t **blocks,
+                                       uint32_t max_cnt);
+extern void     tcp_data_rcvbuf_free(tcp_control_block_t *tcb);
 
 extern uint32_t tcp_data_retrans(tcp_control_block_t *tcb);
+extern uint32_t tcp_data_retrans_next(tcp_control_block_t *tcb);
+
+extern uint32_t tcp_data_fast_retrans(tcp_control_block_t *tcb);
+extern uint32_t tcp_data_sack_retrans(tcp_control_block_t *tcb);
+
+extern void     tcp_data_sack_update(tcp_control_block_t *tcb, uint32_t start,
+                                     uint32_t end);
 
 extern void tcp_data_walk_segs(tcp_control_block_t *tcb);
 
@@ -0,0 +1,91 @@
+/*
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER
+ *
+ * Copyright (c) 2026, Juniper Networks, Inc. All rights reserved.
+ *
+ *
+ * The contents of this file are subject to the terms of the BSD 3 clause
+ * License (the "License"). You may not use this file except in compliance
+ * with the License.
+ *
+ * You can obtain a copy of the license at
+ * https://github.com/Juniper/warp17/blob/master/LICENSE.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from this
+ * software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * File name:
+ *     tpg_tcp_fastopen.h
+ *
+ * Description:
+ *     TCP Fast Open (RFC 7413).
+ *
+ * Author:
+ *     Dumitru Ceara, Eelco Chaudron
+ *
+ * Initial Created:
+ *     10/17/2026
+ *
+ * Notes:
+ *     Server cookies are a keyed hash of the client IP. Clients keep the
+ *     cookies they got in a direct mapped per core cache indexed by the
+ *     client/server IP pair.
+ *
+ */
+
+/*****************************************************************************
+ * Multiple include protection
+ ****************************************************************************/
+#ifndef _H_TPG_TCP_FASTOPEN_
+#define _H_TPG_TCP_FASTOPEN_
+
+/*****************************************************************************
+ * Definitions
+ ****************************************************************************/
+/* Length of the cookies we generate. */
+#define TCP_FASTOPEN_COOKIE_LEN  8
+
+/* Client cookie cache entries per core (power of 2). */
+#define TCP_FASTOPEN_CACHE_SIZE  1024
+
+typedef struct tcp_fastopen_cache_entry_s {
+    uint32_t tfc_client_ip;
+    uint32_t tfc_server_ip;
+    uint8_t  tfc_cookie_len; /* 0 if the entry is not used. */
+    uint8_t  tfc_cookie[TCP_OPT_TFO_COOKIE_FIT];
+} tcp_fastopen_cache_entry_t;
+
+/*****************************************************************************
+ * Externals for tpg_tcp_fastopen.c
+ ****************************************************************************/
+extern void tcp_fastopen_init(void);
+extern void tcp_fastopen_open(tcp_control_block_t *tcb);
+extern void tcp_fastopen_negotiate(tcp_control_block_t *tcb,
+                                   const tcp_hdr_opts_t *opts);
+
+#endif /* _H_TPG_TCP_FASTOPEN_ */
+
@@ -65,6 +65,39 @@
  ****************************************************************************/
 #define TCB_CHECK(tcb) (L4_CB_CHECK(&(tcb)->tcb_l4), TCB_SEG_CHECK(tcb))
 
+/*****************************************************************************
+ * TIME_WAIT records
+ *      Sessions entering TIME_WAIT give their TCB back to the pool right away
+ *      and only keep a compact record until the 2MSL timeout expires. The
+ *      records are allocated from a per lcore FIFO ring (so reclaiming
+ *      expired records is just a matter of advancing the head) and indexed
+ *      by an open addressing hash (linear probing) of ring slots.
+ ****************************************************************************/
+#define TLKP_TW_EXPIRY_BITS  24
+#define TLKP_TW_EXPIRY_MASK  ((1u << TLKP_TW_EXPIRY_BITS) - 1)
+#define TLKP_TW_PORT_INVALID 0xFF
+
+typedef struct tlkp_tw_entry_s {
+
+    uint32_t tw_local_addr;
+    uint32_t tw_remote_addr;
+    uint16_t tw_local_port;
+    uint16_t tw_remote_port;
+    uint32_t tw_snd_nxt;
+    uint32_t tw_rcv_nxt;
+
+    uint32_t tw_expiry    :24; /* in ms, wraps around. */
+    uint32_t tw_phys_port :8;  /* TLKP_TW_PORT_INVALID if unused. */
+
+    uint32_t tw_test_case_id; /* Records are flushed when the test stops. */
+
+} tlkp_tw_entry_t;
+
+static_assert(sizeof(tlkp_tw_entry_t) == 28,
+              "TIME_WAIT records must stay compact");
+static_assert(TPG_ETH_DEV_MAX < TLKP_TW_PORT_INVALID,
+              "TIME_WAIT records can't store the port id");
+
 /*****************************************************************************
  * External's for tpg_tcp_lookup.c
  ****************************************************************************/
@@ -73,10 +106,30 @@ extern int                  tlkp_delete_tcb(tcp_control_block_t *tcb);
 extern tcp_control_block_t *tlkp_find_v4_tcb(uint32_t phys_port, uint32_t l4_hash,
                                              uint32_t src_addr, uint32_t dst_addr,
                                              uint16_t src_port, uint16_t dst_port);
+extern void                 tlkp_find_v4_tcb_bulk(const tlkp_v4_key_t *keys,
+                                                  tcp_control_block_t **tcbs,
+                                                  uint32_t count);
+extern void                 tlkp_rx_burst_tcb(packet_control_block_t **pcbs,
+                                              const tlkp_v4_key_t *keys,
+                                              uint32_t count);
+extern bool                 tlkp_pcb_tcb_get(packet_control_block_t *pcb,
+                                             tcp_control_block_t **tcb);
 extern void                 tlkp_walk_tcb(uint32_t phys_port,
                                           tlkp_walk_v4_cb_t callback,
                                           void *arg);
 
+extern bool                 tlkp_add_tw(tcp_control_block_t *tcb,
+                                        uint32_t timeout_us);
+extern tlkp_tw_entry_t     *tlkp_find_v4_tw(uint32_t phys_port,
+                                            uint32_t local_addr,
+                                            uint32_t remote_addr,
+                                            uint16_t local_port,
+                                            uint16_t remote_port);
+extern void                 tlkp_delete_tw(tlkp_tw_entry_t *tw);
+extern void                 tlkp_tw_expire(void);
+extern void                 tlkp_tw_flush(uint32_t eth_port,
+                                          uint32_t test_case_id);
+
 extern bool                 tlkp_tcp_init(void);
 extern void                 tlkp_tcp_lcore_init(uint32_t lcore_id);
 extern void                 tlkp_preinit_tcb(struct rte_mempool *mp,
@@ -103,6 +156,11 @@ extern void                 tlkp_init_tcb_client(tcp_control_block_t *tcb,
                                                  sockopt_t *sockopt,
                                                  uint32_t flags);
 extern void                 tlkp_free_tcb(tcp_control_block_t *tcb);
+extern tcp_control_block_t *tlkp_recycle_alloc_tcb(uint32_t eth_port,
+                                                   uint32_t test_case_id);
+extern void                 tlkp_recycle_free_tcb(tcp_control_block_t *tcb);
+extern void                 tlkp_recycle_flush_tcbs(uint32_t eth_port,
+                                                    uint32_t test_case_id);
 extern unsigned int         tlkp_total_tcbs_allocated(void);
 
 #endif /* _H_TPG_TCP_LOOKUP_ */
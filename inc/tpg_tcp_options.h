@@ -0,0 +1,146 @@
+/*
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER
+ *
+ * Copyright (c) 2026, Juniper Networks, Inc. All rights reserved.
+ *
+ *
+ * The contents of this file are subject to the terms of the BSD 3 clause
+ * License (the "License"). You may not use this file except in compliance
+ * with the License.
+ *
+ * You can obtain a copy of the license at
+ * https://github.com/Juniper/warp17/blob/master/LICENSE.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from this
+ * software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * File name:
+ *     tpg_tcp_options.h
+ *
+ * Description:
+ *     TCP header options encoding/decoding.
+ *
+ * Author:
+ *     Dumitru Ceara, Eelco Chaudron
+ *
+ * Initial Created:
+ *     10/17/2026
+ *
+ * Notes:
+ *     Options are only negotiated on SYN and SYN/ACK segments. The result of
+ *     the negotiation is stored in the TCB.
+ *
+ */
+
+/*****************************************************************************
+ * Multiple include protection
+ ****************************************************************************/
+#ifndef _H_TPG_TCP_OPTIONS_
+#define _H_TPG_TCP_OPTIONS_
+
+/*****************************************************************************
+ * Definitions
+ ****************************************************************************/
+#define TCP_OPT_KIND_EOL       0
+#define TCP_OPT_KIND_NOP       1
+#define TCP_OPT_KIND_MSS       2
+#define TCP_OPT_KIND_WSCALE    3
+#define TCP_OPT_KIND_SACK_PERM 4
+#define TCP_OPT_KIND_SACK      5
+#define TCP_OPT_KIND_TS        8
+#define TCP_OPT_KIND_TFO      34
+
+#define TCP_OPT_LEN_MSS        4
+#define TCP_OPT_LEN_WSCALE     3
+#define TCP_OPT_LEN_SACK_PERM  2
+#define TCP_OPT_LEN_SACK_BLK   8
+#define TCP_OPT_LEN_TS        10
+
+/* Room for 4 blocks in 40 bytes (including the 2 NOPs for alignment). Only 3
+ * fit if the timestamps option is also present.
+ */
+#define TCP_OPT_SACK_MAX_BLKS     4
+#define TCP_OPT_SACK_MAX_BLKS_TS  3
+
+/* RFC 9293 (3.7.1): MSS to assume if the peer didn't send the option. Lower
+ * values are ignored as they wouldn't leave room for data next to the
+ * maximum 40 bytes of options.
+ */
+#define TCP_OPT_MSS_DEFAULT  536
+#define TCP_OPT_MSS_MIN       64
+
+#define TCP_OPT_LEN_SACK(blk_cnt) (2 + (blk_cnt) * TCP_OPT_LEN_SACK_BLK)
+#define TCP_OPT_LEN_TFO(cookie_len) (2 + (cookie_len))
+
+/* The data offset field allows at most 40 bytes of options. */
+#define TCP_OPT_MAX_LEN       40
+
+/* RFC 7413: cookies are 4 to 16 bytes long. Next to all the other SYN
+ * options (24 bytes) only 14 bytes are left.
+ */
+#define TCP_OPT_TFO_COOKIE_MIN  4
+#define TCP_OPT_TFO_COOKIE_FIT 14
+
+typedef struct tcp_hdr_opts_s {
+
+    uint32_t       tho_mss_present    :1;
+    uint32_t       tho_wscale_present :1;
+    uint32_t       tho_sack_perm      :1;
+    uint32_t       tho_ts_present     :1;
+    uint32_t       tho_tfo_present    :1;
+
+    uint8_t        tho_wscale;
+    uint16_t       tho_mss;
+
+    uint32_t       tho_tsval;
+    uint32_t       tho_tsecr;
+
+    uint32_t       tho_sack_cnt;
+    tcb_sack_blk_t tho_sack_blks[TCP_OPT_SACK_MAX_BLKS];
+
+    uint8_t        tho_tfo_len;
+    uint8_t        tho_tfo_cookie[TCP_FASTOPEN_COOKIE_MAX];
+
+} tcp_hdr_opts_t;
+
+/*****************************************************************************
+ * Externals for tpg_tcp_options.c
+ ****************************************************************************/
+extern void     tcp_hdr_opts_parse(const struct rte_tcp_hdr *tcp,
+                                   tcp_hdr_opts_t *opts);
+extern void     tcp_hdr_opts_negotiate(tcp_control_block_t *tcb,
+                                       const struct rte_tcp_hdr *tcp);
+extern void     tcp_hdr_opts_process(tcp_control_block_t *tcb,
+                                     const packet_control_block_t *pcb);
+extern uint32_t tcp_hdr_opts_len(const tcp_control_block_t *tcb,
+                                 uint32_t flags);
+extern void     tcp_hdr_opts_build(const tcp_control_block_t *tcb,
+                                   uint32_t flags,
+                                   uint8_t *buf);
+
+#endif /* _H_TPG_TCP_OPTIONS_ */
+
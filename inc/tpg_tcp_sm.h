@@ -161,9 +161,14 @@ extern void tsm_initialize_statemachine(tcp_control_block_t *tcb, bool active);
 extern void tsm_terminate_statemachine(tcp_control_block_t *tcb);
 extern int  tsm_dispatch_net_event(tcp_control_block_t *tcb, tcpEvent_t event,
                                    packet_control_block_t *pcb);
+extern bool tsm_fast_path(tcp_control_block_t *tcb,
+                          packet_control_block_t *pcb);
+extern bool tsm_rst_close_deferred(tcp_control_block_t *tcb);
 extern int  tsm_dispatch_event(tcp_control_block_t *tcb, tcpEvent_t event,
                                void *tsm_arg);
 
+extern void tsm_rtt_sample(tcp_control_block_t *tcb, uint32_t rtt_us);
+
 extern int         tsm_str_to_state(const char *state_str);
 extern const char *tsm_get_event_str(tcpEvent_t event);
 
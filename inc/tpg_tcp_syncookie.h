@@ -0,0 +1,93 @@
+/*
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER
+ *
+ * Copyright (c) 2026, Juniper Networks, Inc. All rights reserved.
+ *
+ *
+ * The contents of this file are subject to the terms of the BSD 3 clause
+ * License (the "License"). You may not use this file except in compliance
+ * with the License.
+ *
+ * You can obtain a copy of the license at
+ * https://github.com/Juniper/warp17/blob/master/LICENSE.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from this
+ * software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *
+ * File name:
+ *     tpg_tcp_syncookie.h
+ *
+ * Description:
+ *     Stateless TCP SYN cookies.
+ *
+ * Author:
+ *     Dumitru Ceara, Eelco Chaudron
+ *
+ * Initial Created:
+ *     10/17/2026
+ *
+ * Notes:
+ *     The cookie is the ISN of the SYN/ACK:
+ *         H1(tuple) + IRS + (count << 24) + ((H2(tuple, count) + data) & mask)
+ *     where 'count' is a coarse clock and 'data' encodes the options that
+ *     were negotiated on the SYN.
+ *
+ */
+
+/*****************************************************************************
+ * Multiple include protection
+ ****************************************************************************/
+#ifndef _H_TPG_TCP_SYNCOOKIE_
+#define _H_TPG_TCP_SYNCOOKIE_
+
+/*****************************************************************************
+ * Definitions
+ ****************************************************************************/
+#define TCP_SYNCOOKIE_BITS        24
+#define TCP_SYNCOOKIE_MASK        ((1u << TCP_SYNCOOKIE_BITS) - 1)
+#define TCP_SYNCOOKIE_COUNT_MASK  (UINT32_MAX >> TCP_SYNCOOKIE_BITS)
+
+/* The counter ticks every 64 seconds, cookies older than 2 ticks are
+ * rejected.
+ */
+#define TCP_SYNCOOKIE_PERIOD_S    64
+#define TCP_SYNCOOKIE_MAX_AGE     2
+
+/* Encoded data: MSS table index, peer window scale and SACK permitted. */
+#define TCP_SYNCOOKIE_MSS_BITS    3
+#define TCP_SYNCOOKIE_WSCALE_BITS 4
+#define TCP_SYNCOOKIE_WSCALE_NONE ((1u << TCP_SYNCOOKIE_WSCALE_BITS) - 1)
+#define TCP_SYNCOOKIE_DATA_BITS   \
+    (TCP_SYNCOOKIE_MSS_BITS + TCP_SYNCOOKIE_WSCALE_BITS + 1)
+
+/*****************************************************************************
+ * Externals for tpg_tcp_syncookie.c
+ ****************************************************************************/
+extern void     tcp_syncookie_init(void);
+extern uint32_t tcp_syncookie_make(const tcp_control_block_t *tcb);
+extern bool     tcp_syncookie_check(tcp_control_block_t *tcb, uint32_t cookie);
+
+#endif /* _H_TPG_TCP_SYNCOOKIE_ */
+
@@ -146,6 +146,13 @@ struct test_env_s {
 
     tpg_port_cfg_t        te_port_cfg;
 
+    /* Static routes are kept out of te_port_cfg as there can be up to
+     * TPG_TEST_MAX_L3_ROUTE of them. The array itself is allocated in
+     * test_mgmt_init_env().
+     */
+    tpg_l3_route_t       *te_l3_routes;
+    uint32_t              te_l3_routes_count;
+
     struct {
 
         tpg_test_case_t        cfg;
@@ -70,6 +70,7 @@ test_init_defaults(tpg_test_case_t *te, tpg_test_case_type_t type,
                    uint32_t eth_port,
                    uint32_t test_case_id);
 /*
+ * Replaces the whole port config and flushes the static routes of the port.
  * Returns:
  *  -EINVAL when arguments are wrong.
  *  -EALREADY: tests already started on port.
@@ -110,6 +111,30 @@ extern __tpg_api_func int
 test_mgmt_add_port_cfg_l3_gw(uint32_t eth_port, tpg_ip_t *gw,
                              printer_arg_t *printer_arg);
 
+/*
+ * Returns:
+ *  -ENOMEM: TPG_TEST_MAX_L3_ROUTE reached.
+ *  -EEXIST: route to the same prefix already configured.
+ *  -EALREADY: tests already started on port
+ *  -EINVAL: when arguments are wrong or the gateway is not on one of the
+ *           L3 interfaces configured on the port.
+ *  0 on success.
+ */
+extern __tpg_api_func int
+test_mgmt_add_port_cfg_l3_route(uint32_t eth_port,
+                                const tpg_l3_route_t *l3_route,
+                                printer_arg_t *printer_arg);
+
+/*
+ * Returns:
+ *  NULL when the port doesn't exist.
+ *  Pointer to the static routes of the port otherwise, *count is set to the
+ *  number of routes.
+ */
+extern __tpg_api_func const tpg_l3_route_t *
+test_mgmt_get_port_cfg_l3_routes(uint32_t eth_port, uint32_t *count,
+                                 printer_arg_t *printer_arg);
+
 /*
  * Returns:
  *  -ENOMEM: testcase id >= TPG_TEST_MAX_ENTRIES
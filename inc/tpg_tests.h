@@ -298,6 +298,10 @@ typedef void     (*test_case_session_purge_cb_t)(l4_control_block_t *l4_cb);
 typedef void     (*test_case_htable_walk_cb_t)(uint32_t eth_port,
                                                tlkp_walk_v4_cb_t walk_callback,
                                                void *arg);
+typedef void     (*test_case_recycle_flush_cb_t)(uint32_t eth_port,
+                                                 uint32_t test_case_id);
+typedef void     (*test_case_tw_flush_cb_t)(uint32_t eth_port,
+                                            uint32_t test_case_id);
 
 /*****************************************************************************
  * Test message (OPEN/CLOSE/SEND) pool definitions
@@ -65,57 +65,68 @@ STATS_GLOBAL_DECLARE(tpg_timer_statistics_t);
 
 /*****************************************************************************
  * Timer definitions
+ *      Hierarchical timing wheels: TMR_WHEEL_LEVELS levels of
+ *      TMR_WHEEL_LEVEL_SLOTS slots each. A level N slot covers
+ *      TMR_WHEEL_LEVEL_SLOTS^N ticks. Timers further away than the lowest
+ *      level span are stored in the upper levels and are moved down
+ *      (cascaded) when the wheel reaches their slot. Every timer stores its
+ *      exact expiry tick so cascading never loses precision.
  ****************************************************************************/
+#define TMR_WHEEL_LEVELS        4
+#define TMR_WHEEL_LEVEL_BITS    8
+#define TMR_WHEEL_LEVEL_SLOTS   (1 << TMR_WHEEL_LEVEL_BITS)
+#define TMR_WHEEL_LEVEL_MASK    (TMR_WHEEL_LEVEL_SLOTS - 1)
+
 typedef struct tmr_list_head_s {
     void *tlh_first;
 } tmr_list_head_t;
 
-#define tmr_list_entry(type)                \
-    struct {                                \
-        __typeof__(struct type)  *tle_next; \
-        __typeof__(struct type) **tle_prev; \
-    }
+/* Embedded in the control blocks, linking them in the wheel slots. */
+typedef struct tmr_entry_s {
+    void     *tle_next;   /* Next control block in the slot. */
+    void    **tle_prev;   /* 'tle_next' of the previous entry (or list head). */
+    uint64_t  tle_expiry; /* In wheel ticks. */
+} tmr_entry_t;
 
 #define TMR_LIST_INIT(head) \
     ((head)->tlh_first = NULL)
 
-#define TMR_LIST_INSERT_HEAD(head, ctr_type, elm, field)           \
-    do {                                                           \
-        __typeof__(ctr_type) *ctr = (__typeof__(ctr_type) *)(elm); \
-        __typeof__(ctr_type) *head_ctr =                           \
-                (__typeof__(ctr_type) *)((head)->tlh_first);       \
-        ctr->field.tle_next = (head)->tlh_first;                   \
-        if (ctr->field.tle_next != NULL)                           \
-            head_ctr->field.tle_prev = &ctr->field.tle_next;       \
-        (head)->tlh_first = (elm);                                 \
-        ctr->field.tle_prev =                                      \
-            ((__typeof__(ctr_type) **)(&(head)->tlh_first));       \
-} while (0)
-
-#define TMR_LIST_REMOVE(ctr_type, elm, field)                      \
-    do {                                                           \
-        __typeof__(ctr_type) *ctr = (__typeof__(ctr_type) *)(elm); \
-        if (ctr->field.tle_next != NULL) {                         \
-            __typeof__(ctr_type) *nxt =                            \
-                (__typeof__(ctr_type) *)ctr->field.tle_next;       \
-            nxt->field.tle_prev = ctr->field.tle_prev;             \
-        }                                                          \
-        *ctr->field.tle_prev = ctr->field.tle_next;                \
-} while (0)
-
-typedef tmr_list_head_t tmr_wheel_bucket_t;
+typedef void (*tmr_cb_t)(void *entry);
+
+typedef struct tmr_wheel_level_s {
+
+    /* Slots that might be non-empty (cleared lazily). */
+    uint64_t         twl_bmp[TMR_WHEEL_LEVEL_SLOTS / 64];
+
+    tmr_list_head_t  twl_slots[TMR_WHEEL_LEVEL_SLOTS];
+
+} tmr_wheel_level_t;
 
 typedef struct tmr_wheel_s {
 
-    uint32_t            tw_size;
+    /* Step (tick) in useconds. */
+    uint32_t          tw_step;
+
+    /* Offset of the tmr_entry_t in the control blocks. */
+    uint32_t          tw_entry_offset;
 
-    /* Step in useconds. */
-    uint32_t            tw_step;
-    uint32_t            tw_current;
+    /* Offset of the l4_control_block_t in the control blocks. */
+    uint32_t          tw_l4cb_offset;
 
-    uint64_t            tw_last_advance;
+    uint64_t          tw_max_timeout_us;
 
-    tmr_wheel_bucket_t *tw_wheel;
+    /* Next tick to be processed. */
+    uint64_t          tw_current;
+    uint64_t          tw_last_advance;
+
+    uint32_t          tw_count;
+
+    /* Set if the last advance ran out of budget before catching up. */
+    bool              tw_backlog;
+
+    tmr_cb_t          tw_cb;
+
+    tmr_wheel_level_t tw_levels[TMR_WHEEL_LEVELS];
 
 } tmr_wheel_t;
 
@@ -129,10 +140,15 @@ extern void time_advance(void);
 
 extern int  tcp_timer_rto_set(l4_control_block_t *l4_cb, uint32_t timeout_us);
 extern int  tcp_timer_rto_cancel(l4_control_block_t *l4_cb);
+extern void tcp_timer_rto_release(l4_control_block_t *l4_cb);
 
 extern int  tcp_timer_slow_set(l4_control_block_t *l4_cb, uint32_t timeout_us);
 extern int  tcp_timer_slow_cancel(l4_control_block_t *l4_cb);
 
+extern int  tcp_timer_delack_set(l4_control_block_t *l4_cb,
+                                 uint32_t timeout_us);
+extern int  tcp_timer_delack_cancel(l4_control_block_t *l4_cb);
+
 extern int  l4cb_timer_test_set(l4_control_block_t *l4_cb, uint32_t timeout_us);
 extern int  l4cb_timer_test_cancel(l4_control_block_t *l4_cb);
 #endif /* _H_TPG_TIMER_ */
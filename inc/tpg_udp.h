@@ -116,7 +116,7 @@ typedef struct udp_control_block_s {
 
 #define UCB_MTU(ucb)                                                           \
     UDP_MTU(&RTE_PER_LCORE(local_port_dev_info)[(ucb)->ucb_l4.l4cb_interface], \
-            &(ucb)->ucb_l4.l4cb_sockopt)
+            (ucb)->ucb_l4.l4cb_sockopt)
 
 /*****************************************************************************
  * Globals for tpg_udp.c
@@ -75,6 +75,14 @@ extern int                  tlkp_delete_ucb(udp_control_block_t *ucb);
 extern udp_control_block_t *tlkp_find_v4_ucb(uint32_t phys_port, uint32_t l4_hash,
                                              uint32_t src_addr, uint32_t dst_addr,
                                              uint16_t src_port, uint16_t dst_port);
+extern void                 tlkp_find_v4_ucb_bulk(const tlkp_v4_key_t *keys,
+                                                  udp_control_block_t **ucbs,
+                                                  uint32_t count);
+extern void                 tlkp_rx_burst_ucb(packet_control_block_t **pcbs,
+                                              const tlkp_v4_key_t *keys,
+                                              uint32_t count);
+extern bool                 tlkp_pcb_ucb_get(packet_control_block_t *pcb,
+                                             udp_control_block_t **ucb);
 extern void                 tlkp_walk_ucb(uint32_t phys_port,
                                           tlkp_walk_v4_cb_t callback,
                                           void *arg);
@@ -105,6 +113,11 @@ extern void                 tlkp_init_ucb_client(udp_control_block_t *tcb,
                                                  sockopt_t *sockopt,
                                                  uint32_t flags);
 extern void                 tlkp_free_ucb(udp_control_block_t *ucb);
+extern udp_control_block_t *tlkp_recycle_alloc_ucb(uint32_t eth_port,
+                                                   uint32_t test_case_id);
+extern void                 tlkp_recycle_free_ucb(udp_control_block_t *ucb);
+extern void                 tlkp_recycle_flush_ucbs(uint32_t eth_port,
+                                                    uint32_t test_case_id);
 extern unsigned int         tlkp_total_ucbs_allocated(void);
 
 #endif /* _H_TPG_UDP_LOOKUP_ */
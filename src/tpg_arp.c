@@ -71,6 +71,7 @@
  * Include files
  ****************************************************************************/
 #include <rte_arp.h>
+#include <rte_jhash.h>
 
 #include "tcp_generator.h"
 
@@ -83,17 +84,17 @@
 STATS_DEFINE(tpg_arp_statistics_t);
 
 /* ARP tables should be stored per port in memory allocated from the same socket
- * as the port. For global access we use an array of arrays indexed by port
- * (arp_per_port_tables). Each entry is an array of ARP entries allocated from
- * memory on the same socket as the port.
+ * as the port. For global access we use an array of tables indexed by port
+ * (arp_per_port_tables). Each entry is a hash table of ARP entries allocated
+ * from memory on the same socket as the port.
  */
-static arp_entry_t **arp_per_port_tables;
+static arp_table_t **arp_per_port_tables;
 /* Each lcore stores a clone of the global array (but allocated in its own
  * local memory). Assuming that in the ideal case ports are only handled by
  * cores that are on the same socket as the ports, this should give the fastest
  * memory access.
  */
-static RTE_DEFINE_PER_LCORE(arp_entry_t **, arp_local_per_port_tables);
+static RTE_DEFINE_PER_LCORE(arp_table_t **, arp_local_per_port_tables);
 
 static uint8_t arp_bcast_addr[RTE_ETHER_ADDR_LEN] = {
     0xff, 0xff, 0xff, 0xff, 0xff, 0xff
@@ -126,10 +127,12 @@ static void cmd_show_arp_entries_parsed(void *parsed_result __rte_unused,
 
     for (port = 0; port < rte_eth_dev_count_avail(); port++) {
 
-        int          entry;
-        arp_entry_t *port_entries = arp_per_port_tables[port];
+        uint32_t     entry;
+        arp_table_t *table = arp_per_port_tables[port];
+        arp_entry_t *port_entries = &table->at_entries[0];
 
-        cmdline_printf(cl, "ARP table for port %u:\n\n", port);
+        cmdline_printf(cl, "ARP table for port %u (%"PRIu32"/%"PRIu32" entries):\n\n",
+                       port, table->at_count, table->at_capacity);
         cmdline_printf(cl, "IPv4             MAC address        Age         Flags  Vlan-id\n");
         cmdline_printf(cl, "---------------  -----------------  ----------  -----  -------\n");
 
@@ -138,7 +141,7 @@ static void cmd_show_arp_entries_parsed(void *parsed_result __rte_unused,
          *   for trouble shooting ;)
          */
 
-        for (entry = 0; entry < TPG_ARP_PORT_TABLE_SIZE; entry++) {
+        for (entry = 0; entry <= table->at_mask; entry++) {
 
             if (arp_is_entry_in_use(&port_entries[entry])) {
                 char ip_str[16];
@@ -308,6 +311,11 @@ static void cmd_show_arp_statistics_parsed(void *parsed_result __rte_unused,
                          port,
                          option);
 
+        SHOW_32BIT_STATS("Table full", tpg_arp_statistics_t,
+                         as_tbl_full,
+                         port,
+                         option);
+
         cmdline_printf(cl, "\n");
     }
 
@@ -380,12 +388,216 @@ static cmdline_parse_ctx_t cli_ctx[] = {
     NULL,
 };
 
+/*****************************************************************************
+ * arp_hash()
+ ****************************************************************************/
+static inline uint32_t arp_hash(uint32_t ip, uint16_t vlan_id)
+{
+    return rte_jhash_2words(ip, vlan_id, 0);
+}
+
+/*****************************************************************************
+ * arp_table_alloc()
+ ****************************************************************************/
+static arp_table_t *arp_table_alloc(uint32_t capacity, int socket)
+{
+    arp_table_t *table;
+    uint32_t     slots;
+
+    slots = rte_align32pow2(capacity) * 2;
+
+    table = rte_zmalloc_socket("arp_table_port",
+                               sizeof(*table) +
+                               slots * sizeof(table->at_entries[0]),
+                               RTE_CACHE_LINE_SIZE,
+                               socket);
+    if (table == NULL)
+        return NULL;
+
+    table->at_capacity = capacity;
+    table->at_mask = slots - 1;
+    table->at_count = 0;
+
+    return table;
+}
+
+/*****************************************************************************
+ * arp_table_probe()
+ *      Walks the probe sequence for (ip, vlan_id). Returns the matching entry
+ *      if any. Otherwise, if "free_entry" is set, it's filled with the first
+ *      slot that can be used for inserting (ip, vlan_id).
+ ****************************************************************************/
+static inline arp_entry_t *arp_table_probe(arp_table_t *table, uint32_t ip,
+                                           uint16_t vlan_id,
+                                           arp_entry_t **free_entry)
+{
+    arp_entry_t *entry;
+    uint32_t     idx;
+    uint32_t     probe;
+
+    if (free_entry)
+        *free_entry = NULL;
+
+    idx = arp_hash(ip, vlan_id) & table->at_mask;
+
+    for (probe = 0; probe <= table->at_mask;
+            probe++, idx = (idx + 1) & table->at_mask) {
+
+        entry = &table->at_entries[idx];
+
+        if (arp_is_entry_in_use(entry)) {
+            if (entry->ae_ip_address == ip && entry->ae_vlan_id == vlan_id)
+                return entry;
+
+            continue;
+        }
+
+        if (free_entry && *free_entry == NULL)
+            *free_entry = entry;
+
+        /* An empty (never used) slot terminates the probe sequence. */
+        if (arp_is_entry_free(entry))
+            return NULL;
+    }
+
+    return NULL;
+}
+
+/*****************************************************************************
+ * arp_table_insert()
+ *      Inserts a new entry in the table. The caller must make sure that
+ *      (ip, vlan_id) is not already in the table and that there's room for
+ *      the new entry. Lockless readers on other cores will only see the entry
+ *      once it's completely initialized.
+ ****************************************************************************/
+static arp_entry_t *arp_table_insert(arp_table_t *table,
+                                     arp_entry_t *free_entry,
+                                     uint32_t ip,
+                                     uint16_t vlan_id,
+                                     uint64_t mac_flags)
+{
+    free_entry->ae_ip_address = ip;
+    free_entry->ae_vlan_id = vlan_id;
+
+    /* The flags (IN_USE) are set in one go, after everything else is
+     * visible.
+     */
+    rte_smp_wmb();
+    free_entry->ae_mac_flags = mac_flags | TPG_ARP_FLAG_IN_USE;
+
+    table->at_count++;
+    return free_entry;
+}
+
+/*****************************************************************************
+ * arp_table_remove()
+ ****************************************************************************/
+static void arp_table_remove(arp_table_t *table, arp_entry_t *entry)
+{
+    uint32_t idx;
+
+    idx = entry - &table->at_entries[0];
+
+    /* If the next slot was never used then no probe sequence goes through
+     * this slot so it can be marked as free. Otherwise leave a tombstone
+     * behind.
+     */
+    if (!arp_is_entry_free(&table->at_entries[(idx + 1) & table->at_mask])) {
+        entry->ae_mac_flags = TPG_ARP_FLAG_DELETED;
+        table->at_count--;
+        return;
+    }
+
+    entry->ae_mac_flags = 0;
+    table->at_count--;
+
+    /* Clear the tombstones that are not needed anymore. */
+    for (idx = (idx - 1) & table->at_mask;
+            ARP_IS_FLAG_SET(&table->at_entries[idx], TPG_ARP_FLAG_DELETED);
+            idx = (idx - 1) & table->at_mask) {
+        table->at_entries[idx].ae_mac_flags = 0;
+    }
+}
+
+/*****************************************************************************
+ * arp_table_resize_cb()
+ *      Runs on the default core of the port (the only ARP table writer).
+ ****************************************************************************/
+static int arp_table_resize_cb(uint16_t msgid, uint16_t lcore, void *msg)
+{
+    arp_table_resize_msg_t *resize_msg;
+    arp_table_t            *old_table;
+    arp_table_t            *new_table;
+    arp_entry_t            *free_entry;
+    uint32_t                port;
+    uint32_t                i;
+
+    if (MSG_INVALID(msgid, msg, MSG_ARP_TABLE_RESIZE))
+        return -EINVAL;
+
+    resize_msg = msg;
+    port = resize_msg->atm_eth_port;
+
+    assert(PORT_CORE_DEFAULT(port) == lcore);
+
+    old_table = arp_per_port_tables[port];
+    if (old_table->at_count > resize_msg->atm_capacity)
+        return -ENOSPC;
+
+    new_table = arp_table_alloc(resize_msg->atm_capacity,
+                                port_dev_info[port].pi_numa_node);
+    if (new_table == NULL)
+        return -ENOMEM;
+
+    for (i = 0; i <= old_table->at_mask; i++) {
+        arp_entry_t *entry = &old_table->at_entries[i];
+
+        if (!arp_is_entry_in_use(entry))
+            continue;
+
+        arp_table_probe(new_table, entry->ae_ip_address, entry->ae_vlan_id,
+                        &free_entry);
+        arp_table_insert(new_table, free_entry, entry->ae_ip_address,
+                         entry->ae_vlan_id,
+                         arp_get_entry_flags(entry) |
+                         arp_get_mac_from_entry_as_uint64(entry));
+    }
+
+    /* Publish the new table. The other cores will pick it up when they
+     * process MSG_ARP_TABLE_UPDATE.
+     */
+    rte_smp_wmb();
+    arp_per_port_tables[port] = new_table;
+    RTE_PER_LCORE(arp_local_per_port_tables)[port] = new_table;
+
+    return 0;
+}
+
+/*****************************************************************************
+ * arp_table_update_cb()
+ ****************************************************************************/
+static int arp_table_update_cb(uint16_t msgid, uint16_t lcore __rte_unused,
+                               void *msg)
+{
+    arp_table_update_msg_t *update_msg;
+
+    if (MSG_INVALID(msgid, msg, MSG_ARP_TABLE_UPDATE))
+        return -EINVAL;
+
+    update_msg = msg;
+
+    RTE_PER_LCORE(arp_local_per_port_tables)[update_msg->atm_eth_port] =
+        arp_per_port_tables[update_msg->atm_eth_port];
+    return 0;
+}
+
 /*****************************************************************************
  * arp_init()
  ****************************************************************************/
 bool arp_init(void)
 {
     uint32_t port;
+    int      error;
 
     /*
      * Add ARP module CLI commands
@@ -417,15 +629,9 @@ bool arp_init(void)
     }
 
     for (port = 0; port < rte_eth_dev_count_avail(); port++) {
-        uint32_t port_socket;
-
-        port_socket = port_dev_info[port].pi_numa_node;
         arp_per_port_tables[port] =
-            rte_zmalloc_socket("arp_table_port",
-                               TPG_ARP_PORT_TABLE_SIZE *
-                               sizeof(*arp_per_port_tables[port]),
-                               RTE_CACHE_LINE_SIZE,
-                               port_socket);
+            arp_table_alloc(TPG_ARP_TABLE_SIZE_DEFAULT,
+                            port_dev_info[port].pi_numa_node);
         if (arp_per_port_tables[port] == NULL) {
             RTE_LOG(ERR, USER1,
                     "ERROR: Failed allocating per port ARP table memory!\n");
@@ -433,7 +639,27 @@ bool arp_init(void)
         }
     }
 
-    return true;
+    /*
+     * Register TPG MSG handlers.
+     */
+    while (true) {
+
+        error = msg_register_handler(MSG_ARP_TABLE_RESIZE,
+                                     arp_table_resize_cb);
+        if (error)
+            break;
+        error = msg_register_handler(MSG_ARP_TABLE_UPDATE,
+                                     arp_table_update_cb);
+        if (error)
+            break;
+
+        return true;
+    }
+
+    RTE_LOG(ERR, USER1, "Failed to register ARP msg handler: %s(%d)\n",
+            rte_strerror(-error), -error);
+
+    return false;
 }
 
 /*****************************************************************************
@@ -472,90 +698,71 @@ void arp_lcore_init(uint32_t lcore_id)
  * arp_update_entry()
  ****************************************************************************/
 static bool arp_update_entry(uint32_t port, uint32_t ip, uint64_t mac, bool local,
-                             uint32_t vlan_id)
+                             uint16_t vlan_id)
 {
-    int          i;
-    bool         rc = true;
-    arp_entry_t *update_entry = NULL;
-    arp_entry_t *free_entry = NULL;
-    arp_entry_t *port_entries = RTE_PER_LCORE(arp_local_per_port_tables)[port];
-
-    for (i = 0; i < TPG_ARP_PORT_TABLE_SIZE; i++) {
-        if (!arp_is_entry_in_use(&port_entries[i])) {
-            if (free_entry == NULL)
-                free_entry = &port_entries[i];
-
-            continue;
-        }
-
-        if (ip == port_entries[i].ae_ip_address) {
-            update_entry = &port_entries[i];
-            break;
+    arp_table_t *table = RTE_PER_LCORE(arp_local_per_port_tables)[port];
+    arp_entry_t *update_entry;
+    arp_entry_t *free_entry;
+
+    update_entry = arp_table_probe(table, ip, vlan_id, &free_entry);
+
+    if (update_entry == NULL) {
+        if (unlikely(free_entry == NULL ||
+                     table->at_count >= table->at_capacity)) {
+            RTE_LOG(ERR, USER2, "[%d:%s()] DBG: ARP table for port %d full!\n",
+                    rte_lcore_index(rte_lcore_id()),  __func__, port);
+            INC_STATS(STATS_LOCAL(tpg_arp_statistics_t, port), as_tbl_full);
+            return false;
         }
-    }
-
-    if (i >= TPG_ARP_PORT_TABLE_SIZE && free_entry == NULL) {
-
-        RTE_LOG(ERR, USER2, "[%d:%s()] DBG: ARP table for port %d full!\n",
-                rte_lcore_index(rte_lcore_id()),  __func__, port);
-
-        rc = false;
 
+        /*
+         * Use new entry, and add it...
+         */
+        update_entry = arp_table_insert(table, free_entry, ip, vlan_id,
+                                        (mac & TPG_ARP_UINT64_MAC_MASK) |
+                                        (local ? TPG_ARP_FLAG_LOCAL : 0));
     } else {
-
-        if (free_entry != NULL) {
-            /*
-             * Use new entry, and add it...
-             */
-            update_entry = free_entry;
-            update_entry->ae_ip_address = ip;
-            update_entry->ae_mac_flags = 0;
-            if (local)
-                update_entry->ae_mac_flags |= TPG_ARP_FLAG_LOCAL;
+        if (arp_get_mac_from_entry_as_uint64(update_entry) == mac) {
+            /* Plain refresh, nothing changed for the cached headers. */
+            return true;
         }
 
         arp_set_mac_in_entry_as_uint64(update_entry, mac);
-        update_entry->ae_vlan_id = vlan_id;
-
-        if (free_entry != NULL)
-            arp_set_entry_in_use(update_entry);
+        free_entry = NULL;
+    }
 
-        RTE_LOG(DEBUG, USER2,
-                "[%d:%s()] DBG: %s ARP entry for IP %u.%u.%u.%u (local = %d) on port %d\n",
-                rte_lcore_index(rte_lcore_id()),  __func__,
-                free_entry == update_entry ? "Added" : "Updated",
-                (update_entry->ae_ip_address >> 24) & 0xff,
-                (update_entry->ae_ip_address >> 16) & 0xff,
-                (update_entry->ae_ip_address >>  8) & 0xff,
-                (update_entry->ae_ip_address >>  0) & 0xff,
-                local,
-                port);
+    route_v4_nh_gen_bump(port);
 
-    }
+    RTE_LOG(DEBUG, USER2,
+            "[%d:%s()] DBG: %s ARP entry for IP %u.%u.%u.%u (local = %d) on port %d\n",
+            rte_lcore_index(rte_lcore_id()),  __func__,
+            free_entry == update_entry ? "Added" : "Updated",
+            (update_entry->ae_ip_address >> 24) & 0xff,
+            (update_entry->ae_ip_address >> 16) & 0xff,
+            (update_entry->ae_ip_address >>  8) & 0xff,
+            (update_entry->ae_ip_address >>  0) & 0xff,
+            local,
+            port);
 
-    return rc;
+    return true;
 }
 
 /*****************************************************************************
  * arp_delete_entry()
- * NOTE: this is really slow but we assume we only do ARP processing in the
- *       beginning of the tests!
+ * NOTE: we assume we only do ARP processing in the beginning of the tests!
  ****************************************************************************/
-static bool arp_delete_entry(uint32_t port, uint32_t ip)
+static bool arp_delete_entry(uint32_t port, uint32_t ip, uint16_t vlan_id)
 {
-    int          i;
-    arp_entry_t *port_entries = RTE_PER_LCORE(arp_local_per_port_tables)[port];
-
-    for (i = 0; i < TPG_ARP_PORT_TABLE_SIZE; i++) {
-        if (arp_is_entry_in_use(&port_entries[i]) &&
-            port_entries[i].ae_ip_address == ip) {
+    arp_table_t *table = RTE_PER_LCORE(arp_local_per_port_tables)[port];
+    arp_entry_t *entry;
 
-            arp_clear_entry_in_use(&port_entries[i]);
-            return true;
-        }
-    }
+    entry = arp_table_probe(table, ip, vlan_id, NULL);
+    if (entry == NULL)
+        return false;
 
-    return false;
+    arp_table_remove(table, entry);
+    route_v4_nh_gen_bump(port);
+    return true;
 }
 
 /*****************************************************************************
@@ -768,19 +975,8 @@ bool arp_send_grat_arp_reply(uint32_t port, uint32_t ip, uint16_t vlan_tci)
  ****************************************************************************/
 static arp_entry_t *arp_lookup(uint32_t port, uint32_t ip, uint16_t vlan_id)
 {
-    int          i;
-    arp_entry_t *port_entries = RTE_PER_LCORE(arp_local_per_port_tables)[port];
-
-    for (i = 0; i < TPG_ARP_PORT_TABLE_SIZE; i++) {
-        if (arp_is_entry_in_use(&port_entries[i]) &&
-            port_entries[i].ae_ip_address == ip &&
-            port_entries[i].ae_vlan_id == vlan_id) {
-
-            return &port_entries[i];
-        }
-    }
-
-    return NULL;
+    return arp_table_probe(RTE_PER_LCORE(arp_local_per_port_tables)[port],
+                           ip, vlan_id, NULL);
 }
 
 /*****************************************************************************
@@ -826,7 +1022,85 @@ bool arp_delete_local(uint32_t port, uint32_t ip, uint16_t vlan_id)
 
     local_arp->ae_mac_flags &= ~TPG_ARP_FLAG_LOCAL;
 
-    return arp_delete_entry(port, ip);
+    return arp_delete_entry(port, ip, vlan_id);
+}
+
+/*****************************************************************************
+ * arp_set_table_size()
+ *      Resizes the ARP table of a port. Should only be called while no tests
+ *      are running on the port.
+ ****************************************************************************/
+int arp_set_table_size(uint32_t port, uint32_t capacity)
+{
+    MSG_LOCAL_DEFINE(arp_table_msg_t, msg);
+    arp_table_msg_t *table_msg;
+    arp_table_t     *old_table;
+    msg_t           *msgp;
+    uint32_t         core;
+    int              error;
+
+    if (capacity < TPG_ARP_TABLE_SIZE_MIN || capacity > TPG_ARP_TABLE_SIZE_MAX)
+        return -EINVAL;
+
+    /* Nothing to do, don't reallocate a table that might be in use. */
+    old_table = arp_per_port_tables[port];
+    if (old_table->at_capacity == capacity)
+        return 0;
+
+    if (old_table->at_count > capacity) {
+        RTE_LOG(ERR, USER1,
+                "ERROR: ARP table on port %"PRIu32" already has %"PRIu32" entries!\n",
+                port, old_table->at_count);
+        return -ENOSPC;
+    }
+
+    msgp = MSG_LOCAL(msg);
+
+    msg_init(msgp, MSG_ARP_TABLE_RESIZE, PORT_CORE_DEFAULT(port), 0);
+
+    table_msg = MSG_INNER(arp_table_msg_t, msgp);
+    table_msg->atm_eth_port = port;
+    table_msg->atm_capacity = capacity;
+
+    /* BLOCK waiting for msg to be processed */
+    error = msg_send(msgp, 0);
+    if (error)
+        TPG_ERROR_ABORT("ERROR: Failed to send ARP resize msg: %s(%d)!\n",
+                        rte_strerror(-error), -error);
+
+    if (arp_per_port_tables[port] == old_table) {
+        RTE_LOG(ERR, USER1,
+                "ERROR: Failed to resize ARP table on port %"PRIu32" to %"PRIu32" entries!\n",
+                port, capacity);
+        return -ENOMEM;
+    }
+
+    /* Make all the packet cores switch to the new table. As messages are
+     * processed synchronously, once we're done nobody references the old
+     * table anymore.
+     */
+    RTE_LCORE_FOREACH_SLAVE(core) {
+        if (!cfg_is_pkt_core(core))
+            continue;
+
+        msg_init(msgp, MSG_ARP_TABLE_UPDATE, core, 0);
+
+        error = msg_send(msgp, 0);
+        if (error)
+            TPG_ERROR_ABORT("ERROR: Failed to send ARP update msg: %s(%d)!\n",
+                            rte_strerror(-error), -error);
+    }
+
+    rte_free(old_table);
+    return 0;
+}
+
+/*****************************************************************************
+ * arp_get_table_size()
+ ****************************************************************************/
+uint32_t arp_get_table_size(uint32_t port)
+{
+    return arp_per_port_tables[port]->at_capacity;
 }
 
 /*****************************************************************************
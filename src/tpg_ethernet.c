@@ -262,17 +262,11 @@ void eth_lcore_init(uint32_t lcore_id)
 }
 
 /*****************************************************************************
- * eth_build_hdr_mbuf()
+ * eth_alloc_hdr_mbuf()
  ****************************************************************************/
-struct rte_mbuf *eth_build_hdr_mbuf(l4_control_block_t *l4_cb,
-                                    uint64_t dst_mac,
-                                    uint64_t src_mac,
-                                    uint16_t ether_type)
+static struct rte_mbuf *eth_alloc_hdr_mbuf(uint32_t port)
 {
-    struct rte_ether_hdr *eth;
-    struct rte_mbuf      *mbuf;
-    struct rte_vlan_hdr  *tag_hdr;
-    uint32_t port = l4_cb->l4cb_interface;
+    struct rte_mbuf *mbuf;
 
     mbuf = pkt_mbuf_alloc(mem_get_mbuf_local_pool_tx_hdr());
     if (unlikely(!mbuf)) {
@@ -288,17 +282,21 @@ struct rte_mbuf *eth_build_hdr_mbuf(l4_control_block_t *l4_cb,
     }
 
     mbuf->port = port;
+    return mbuf;
+}
 
-    /*
-     * Build ethernet header
-     */
-    eth = (struct rte_ether_hdr *)
-        rte_pktmbuf_append(mbuf, sizeof(struct rte_ether_hdr));
-
-    if (unlikely(!eth)) {
-        pkt_mbuf_free(mbuf);
-        return NULL;
-    }
+/*****************************************************************************
+ * eth_build_hdr()
+ *      Writes the ethernet (and optional VLAN) header at "hdr" and returns
+ *      its length. "hdr" must have room for an ethernet header and one tag.
+ ****************************************************************************/
+uint16_t eth_build_hdr(l4_control_block_t *l4_cb, uint64_t dst_mac,
+                       uint64_t src_mac,
+                       uint16_t ether_type,
+                       void *hdr)
+{
+    struct rte_ether_hdr *eth = hdr;
+    struct rte_vlan_hdr  *tag_hdr;
 
     eth_uint64_to_mac(dst_mac, eth->d_addr.addr_bytes);
     eth_uint64_to_mac(src_mac, eth->s_addr.addr_bytes);
@@ -306,36 +304,81 @@ struct rte_mbuf *eth_build_hdr_mbuf(l4_control_block_t *l4_cb,
     /*
      * Build the Vlan header if vlan is configured by user
      */
-    if (l4_cb->l4cb_sockopt.so_vlan.vlanso_hdr_opt_len > 0) {
+    if (l4_cb->l4cb_sockopt->so_vlan.vlanso_hdr_opt_len > 0) {
         eth->ether_type = rte_cpu_to_be_16(RTE_ETHER_TYPE_VLAN);
 
-        tag_hdr =
-            (struct rte_vlan_hdr *)rte_pktmbuf_append(mbuf,
-                                                      sizeof(struct rte_vlan_hdr));
-
-        if (unlikely(!tag_hdr)) {
-            pkt_mbuf_free(mbuf);
-            return NULL;
-        }
-
+        tag_hdr = (struct rte_vlan_hdr *)(eth + 1);
         tag_hdr->vlan_tci =
-            rte_cpu_to_be_16((l4_cb->l4cb_sockopt.so_vlan.vlanso_id |
-                                (l4_cb->l4cb_sockopt.so_vlan.vlanso_pri <<
+            rte_cpu_to_be_16((l4_cb->l4cb_sockopt->so_vlan.vlanso_id |
+                                (l4_cb->l4cb_sockopt->so_vlan.vlanso_pri <<
                                  VLAN_PRIO_SHIFT)));
         tag_hdr->eth_proto = rte_cpu_to_be_16(ether_type);
     } else {
         eth->ether_type = rte_cpu_to_be_16(ether_type);
     }
 
-    if (true) {
-        /*
-         * We assume hardware checksum calculation for ip/tcp, to
-         * support this we need to set the correct l2 header size.
-         */
-        mbuf->l2_len = sizeof(struct rte_ether_hdr) +
-                           l4_cb->l4cb_sockopt.so_vlan.vlanso_hdr_opt_len;
+    return sizeof(struct rte_ether_hdr) +
+                l4_cb->l4cb_sockopt->so_vlan.vlanso_hdr_opt_len;
+}
+
+/*****************************************************************************
+ * eth_build_hdr_mbuf()
+ ****************************************************************************/
+struct rte_mbuf *eth_build_hdr_mbuf(l4_control_block_t *l4_cb,
+                                    uint64_t dst_mac,
+                                    uint64_t src_mac,
+                                    uint16_t ether_type)
+{
+    struct rte_mbuf *mbuf;
+    void            *hdr;
+    uint16_t         l2_len;
+
+    mbuf = eth_alloc_hdr_mbuf(l4_cb->l4cb_interface);
+    if (unlikely(!mbuf))
+        return NULL;
+
+    l2_len = sizeof(struct rte_ether_hdr) +
+                l4_cb->l4cb_sockopt->so_vlan.vlanso_hdr_opt_len;
+
+    hdr = rte_pktmbuf_append(mbuf, l2_len);
+    if (unlikely(!hdr)) {
+        pkt_mbuf_free(mbuf);
+        return NULL;
     }
 
+    /*
+     * We assume hardware checksum calculation for ip/tcp, to
+     * support this we need to set the correct l2 header size.
+     */
+    mbuf->l2_len = eth_build_hdr(l4_cb, dst_mac, src_mac, ether_type, hdr);
+
+    return mbuf;
+}
+
+/*****************************************************************************
+ * eth_build_hdr_mbuf_from_tmpl()
+ *      Allocates a header mbuf and copies the cached L2/L3 headers of the
+ *      control block into it. The caller must make sure the template is valid.
+ ****************************************************************************/
+struct rte_mbuf *eth_build_hdr_mbuf_from_tmpl(l4_control_block_t *l4_cb)
+{
+    l4_hdr_tmpl_t   *tmpl = &l4_cb->l4cb_hdr_tmpl;
+    struct rte_mbuf *mbuf;
+    void            *hdr;
+
+    mbuf = eth_alloc_hdr_mbuf(l4_cb->l4cb_interface);
+    if (unlikely(!mbuf))
+        return NULL;
+
+    hdr = rte_pktmbuf_append(mbuf, tmpl->ht_len);
+    if (unlikely(!hdr)) {
+        pkt_mbuf_free(mbuf);
+        return NULL;
+    }
+
+    rte_memcpy(hdr, &tmpl->ht_data[0], tmpl->ht_len);
+    mbuf->l2_len = tmpl->ht_l2_len;
+
     return mbuf;
 }
 
@@ -521,7 +521,7 @@ static struct rte_ipv4_hdr *ipv4_build_hdr(l4_control_block_t *l4_cb,
 {
     struct rte_ipv4_hdr *ip_hdr;
     uint16_t         ip_hdr_len = sizeof(struct rte_ipv4_hdr);
-    sockopt_t       *sockopt = &l4_cb->l4cb_sockopt;
+    const sockopt_t *sockopt = l4_cb->l4cb_sockopt;
 
     if (unlikely(ref_ip_hdr != NULL))
         TPG_ERROR_ABORT("TODO: No reference IPv4 header supported!\n");
@@ -589,6 +589,126 @@ static struct rte_ipv4_hdr *ipv4_build_hdr(l4_control_block_t *l4_cb,
     return ip_hdr;
 }
 
+/*****************************************************************************
+ * ipv4_nh_mac_lookup()
+ ****************************************************************************/
+static uint64_t ipv4_nh_mac_lookup(l4_control_block_t *l4_cb)
+{
+    if (TPG_IP_MCAST(&l4_cb->l4cb_dst_addr))
+        return ipv4_mcast_addr_to_eth(l4_cb->l4cb_dst_addr.ip_v4);
+
+    return route_v4_nh_lookup(l4_cb->l4cb_interface,
+                              l4_cb->l4cb_dst_addr.ip_v4,
+                              l4_cb->l4cb_sockopt->so_vlan.vlanso_id);
+}
+
+/*****************************************************************************
+ * ipv4_build_hdr_tmpl()
+ *      (Re)builds the cached Ethernet/VLAN/IPv4 headers of the control block.
+ *      The IPv4 total length and checksum are patched per packet.
+ ****************************************************************************/
+static bool ipv4_build_hdr_tmpl(l4_control_block_t *l4_cb, uint8_t protocol)
+{
+    l4_hdr_tmpl_t       *tmpl = &l4_cb->l4cb_hdr_tmpl;
+    struct rte_ipv4_hdr *ip_hdr;
+    port_info_t         *port_info;
+    uint64_t             dst_mac;
+    uint32_t             gen;
+    uint16_t             l2_len;
+
+    /* Snapshot the generation before resolving the next hop. If the tables
+     * change in between we'll just rebuild again on the next packet.
+     */
+    gen = route_v4_nh_gen(l4_cb->l4cb_interface);
+    rte_smp_rmb();
+
+    dst_mac = ipv4_nh_mac_lookup(l4_cb);
+    if (unlikely(dst_mac == TPG_ARP_MAC_NOT_FOUND))
+        return false;
+
+    port_info = &RTE_PER_LCORE(local_port_dev_info)[l4_cb->l4cb_interface];
+
+    l2_len = eth_build_hdr(l4_cb, dst_mac, port_info->pi_mac_addr,
+                           RTE_ETHER_TYPE_IPV4,
+                           &tmpl->ht_data[0]);
+
+    ip_hdr = (struct rte_ipv4_hdr *)&tmpl->ht_data[l2_len];
+    ip_hdr->version_ihl = (4 << 4) | (sizeof(*ip_hdr) >> 2);
+    ip_hdr->type_of_service = l4_cb->l4cb_sockopt->so_ipv4.ip4so_tos;
+    ip_hdr->total_length = 0;
+    ip_hdr->packet_id = 0;
+    ip_hdr->fragment_offset = rte_cpu_to_be_16(0);
+    ip_hdr->time_to_live = 60;
+    ip_hdr->next_proto_id = protocol;
+    ip_hdr->src_addr = rte_cpu_to_be_32(l4_cb->l4cb_src_addr.ip_v4);
+    ip_hdr->dst_addr = rte_cpu_to_be_32(l4_cb->l4cb_dst_addr.ip_v4);
+    ip_hdr->hdr_checksum = 0;
+
+    tmpl->ht_ip_cksum = rte_raw_cksum(ip_hdr, sizeof(*ip_hdr));
+    tmpl->ht_l2_len = l2_len;
+    tmpl->ht_len = l2_len + sizeof(*ip_hdr);
+    tmpl->ht_gen = gen;
+
+    return true;
+}
+
+/*****************************************************************************
+ * ipv4_build_hdr_mbuf_from_tmpl()
+ ****************************************************************************/
+static struct rte_mbuf *ipv4_build_hdr_mbuf_from_tmpl(l4_control_block_t *l4_cb,
+                                                      uint8_t protocol,
+                                                      uint16_t l4_len,
+                                                      struct rte_ipv4_hdr **ip_hdr_p)
+{
+    l4_hdr_tmpl_t       *tmpl = &l4_cb->l4cb_hdr_tmpl;
+    struct rte_mbuf     *mbuf;
+    struct rte_ipv4_hdr *ip_hdr;
+    uint16_t             total_length;
+
+    if (unlikely(tmpl->ht_gen != route_v4_nh_gen(l4_cb->l4cb_interface))) {
+        /*
+         * Normally we should queue the packet if the ARP is not there yet
+         * however here we want high volume of traffic, and the ARP should
+         * be there before we start testing.
+         */
+        if (unlikely(!ipv4_build_hdr_tmpl(l4_cb, protocol)))
+            return NULL;
+    }
+
+    mbuf = eth_build_hdr_mbuf_from_tmpl(l4_cb);
+    if (unlikely(!mbuf))
+        return NULL;
+
+    ip_hdr = rte_pktmbuf_mtod_offset(mbuf, struct rte_ipv4_hdr *,
+                                     tmpl->ht_l2_len);
+
+    total_length = rte_cpu_to_be_16(sizeof(*ip_hdr) + l4_len);
+    ip_hdr->total_length = total_length;
+
+    mbuf->l3_len = sizeof(*ip_hdr);
+
+#if !defined(TPG_SW_CHECKSUMMING)
+    if (true) {
+#else
+    if (l4_cb->l4cb_sockopt->so_eth.ethso_tx_offload_ipv4_cksum) {
+#endif /* !defined(TPG_SW_CHECKSUMMING) */
+        mbuf->ol_flags |= PKT_TX_IP_CKSUM;
+    } else {
+        uint32_t cksum;
+
+        /* The only field that changed since the template was built is the
+         * total length so just add it to the precomputed sum.
+         */
+        cksum = (uint32_t)tmpl->ht_ip_cksum + total_length;
+        cksum = (cksum & 0xFFFF) + (cksum >> 16);
+
+        ip_hdr->hdr_checksum = (cksum == 0xFFFF) ? cksum : ~cksum;
+    }
+
+    *ip_hdr_p = ip_hdr;
+    return mbuf;
+}
+
 /*****************************************************************************
  * ipv4_build_hdr_mbuf()
  ****************************************************************************/
@@ -602,20 +722,21 @@ struct rte_mbuf *ipv4_build_hdr_mbuf(l4_control_block_t *l4_cb,
     uint64_t         dst_mac;
     uint64_t         src_mac;
 
+    /* Unless we need per packet IPv4 options the headers never change for
+     * the lifetime of the control block so use the cached version.
+     */
+    if (likely(!l4_cb->l4cb_sockopt->so_ipv4.ip4so_tx_tstamp)) {
+        return ipv4_build_hdr_mbuf_from_tmpl(l4_cb, protocol, l4_len,
+                                             ip_hdr_p);
+    }
+
     /* TODO: normally we should have L2 information in the control block.
      * However, for now we only support Ethernet.
      */
     port_info = &RTE_PER_LCORE(local_port_dev_info)[l4_cb->l4cb_interface];
     src_mac = port_info->pi_mac_addr;
 
-    if (!TPG_IP_MCAST(&l4_cb->l4cb_dst_addr)) {
-        dst_mac = route_v4_nh_lookup(l4_cb->l4cb_interface,
-                                     l4_cb->l4cb_dst_addr.ip_v4,
-                                     l4_cb->l4cb_sockopt.so_vlan.vlanso_id);
-    } else {
-        dst_mac = ipv4_mcast_addr_to_eth(l4_cb->l4cb_dst_addr.ip_v4);
-    }
-
+    dst_mac = ipv4_nh_mac_lookup(l4_cb);
     if (unlikely(dst_mac == TPG_ARP_MAC_NOT_FOUND)) {
         /*
          * Normally we should queue the packet if the ARP is not there yet
@@ -829,7 +950,7 @@ struct rte_mbuf *ipv4_receive_pkt(packet_control_block_t *pcb,
     else if (ip_hdr->next_proto_id == IPPROTO_UDP)
         mbuf = udp_receive_pkt(pcb, mbuf);
 
-    if (pcb->pcb_sockopt)
+    if (pcb->pcb_rx_cb)
         ipv4_latency_check(pcb, ipv4_tstamp_value);
 
     return mbuf;
@@ -909,10 +1030,8 @@ static uint64_t ipv4_parse_option_timestamp(struct rte_mbuf *mbuf,
  ****************************************************************************/
 static void ipv4_latency_check(packet_control_block_t *pcb, uint64_t tstamp)
 {
-    l4_control_block_t *l4cb = NULL;
+    l4_control_block_t *l4cb = pcb->pcb_rx_cb;
 
-    if (pcb->pcb_sockopt->so_ipv4.ip4so_rx_tstamp && pcb->pcb_tstamp) {
-        l4cb = container_of(pcb->pcb_sockopt, l4_control_block_t, l4cb_sockopt);
+    if (l4cb->l4cb_sockopt->so_ipv4.ip4so_rx_tstamp && pcb->pcb_tstamp)
         test_update_latency(l4cb, tstamp, pcb->pcb_tstamp);
-    }
 }
@@ -153,41 +153,305 @@ bool tlkp_init(void)
     return true;
 }
 
+/*****************************************************************************
+ * tlkp_ht_alloc_buckets()
+ ****************************************************************************/
+static tlkp_ht_bucket_t *tlkp_ht_alloc_buckets(const char *name,
+                                               uint32_t bucket_cnt,
+                                               int socket)
+{
+    return rte_zmalloc_socket(name, bucket_cnt * sizeof(tlkp_ht_bucket_t),
+                              RTE_CACHE_LINE_SIZE,
+                              socket);
+}
+
+/*****************************************************************************
+ * tlkp_ht_bucket_add()
+ ****************************************************************************/
+static inline bool tlkp_ht_bucket_add(tlkp_ht_bucket_t *bucket, uint16_t sig,
+                                      l4_control_block_t *cb)
+{
+    uint32_t i;
+
+    for (i = 0; i < TLKP_HT_BUCKET_ENTRIES; i++) {
+        if (bucket->hb_cb[i] == NULL) {
+            bucket->hb_sig[i] = sig;
+            bucket->hb_cb[i] = cb;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/*****************************************************************************
+ * tlkp_ht_insert()
+ *      Cuckoo insert. On failure 'cb' is updated to point to the control
+ *      block that couldn't be placed (not necessarily the one we started
+ *      with!).
+ ****************************************************************************/
+static bool tlkp_ht_insert(tlkp_htable_t *htable, l4_control_block_t **cb)
+{
+    l4_control_block_t *victim;
+    uint64_t            hash;
+    uint32_t            bucket;
+    uint32_t            kick;
+    uint32_t            slot;
+    uint16_t            sig;
+
+    hash = tlkp_ht_hash((*cb)->l4cb_interface, (*cb)->l4cb_rx_hash);
+    sig = tlkp_ht_hash_sig(hash);
+    bucket = tlkp_ht_hash_bucket(htable, hash);
+
+    if (tlkp_ht_bucket_add(&htable->ht_buckets[bucket], sig, *cb))
+        return true;
+
+    bucket = tlkp_ht_alt_bucket(htable, bucket, sig);
+    if (tlkp_ht_bucket_add(&htable->ht_buckets[bucket], sig, *cb))
+        return true;
+
+    /* Both buckets full, start kicking entries out to their alternative
+     * buckets.
+     */
+    for (kick = 0; kick < TLKP_HT_MAX_KICKS; kick++) {
+        tlkp_ht_bucket_t *b = &htable->ht_buckets[bucket];
+        uint16_t          victim_sig;
+
+        slot = (sig + kick) % TLKP_HT_BUCKET_ENTRIES;
+
+        victim = b->hb_cb[slot];
+        victim_sig = b->hb_sig[slot];
+        b->hb_cb[slot] = *cb;
+        b->hb_sig[slot] = sig;
+
+        *cb = victim;
+        sig = victim_sig;
+        bucket = tlkp_ht_alt_bucket(htable, bucket, sig);
+
+        if (tlkp_ht_bucket_add(&htable->ht_buckets[bucket], sig, *cb))
+            return true;
+    }
+
+    return false;
+}
+
+/*****************************************************************************
+ * tlkp_ht_grow()
+ *      Doubles the number of buckets (more if needed) and moves all the
+ *      entries plus 'cb' to the new buckets.
+ ****************************************************************************/
+static int tlkp_ht_grow(tlkp_htable_t *htable, l4_control_block_t *cb)
+{
+    tlkp_htable_t       new_htable = *htable;
+    l4_control_block_t *entry;
+    uint32_t            bucket;
+    uint32_t            i;
+
+    for (;;) {
+        new_htable.ht_bucket_mask = (new_htable.ht_bucket_mask << 1) | 1;
+        new_htable.ht_buckets =
+            tlkp_ht_alloc_buckets(htable->ht_name,
+                                  new_htable.ht_bucket_mask + 1,
+                                  htable->ht_socket);
+        if (new_htable.ht_buckets == NULL)
+            return -ENOMEM;
+
+        RTE_LOG(INFO, USER1,
+                "[%d]: Growing %s to %"PRIu32" buckets (%"PRIu32" entries)\n",
+                rte_lcore_index(rte_lcore_id()),
+                htable->ht_name,
+                new_htable.ht_bucket_mask + 1,
+                htable->ht_count + 1);
+
+        entry = cb;
+        if (!tlkp_ht_insert(&new_htable, &entry))
+            goto retry;
+
+        for (bucket = 0; bucket <= htable->ht_bucket_mask; bucket++) {
+            for (i = 0; i < TLKP_HT_BUCKET_ENTRIES; i++) {
+                entry = htable->ht_buckets[bucket].hb_cb[i];
+                if (entry == NULL)
+                    continue;
+
+                if (!tlkp_ht_insert(&new_htable, &entry))
+                    goto retry;
+            }
+        }
+
+        rte_free(htable->ht_buckets);
+        htable->ht_buckets = new_htable.ht_buckets;
+        htable->ht_bucket_mask = new_htable.ht_bucket_mask;
+        return 0;
+
+retry:
+        rte_free(new_htable.ht_buckets);
+    }
+}
+
+/*****************************************************************************
+ * tlkp_htable_init()
+ *      Sizes the table for 'entries' sessions at a load factor of at most
+ *      80%. The table grows if more sessions are added.
+ ****************************************************************************/
+void tlkp_htable_init(tlkp_htable_t *htable, const char *name,
+                      uint32_t entries,
+                      int socket)
+{
+    uint32_t bucket_cnt;
+
+    bucket_cnt = (entries + TLKP_HT_BUCKET_ENTRIES - 1) /
+                    TLKP_HT_BUCKET_ENTRIES;
+    bucket_cnt = rte_align32pow2(bucket_cnt + bucket_cnt / 4);
+    if (bucket_cnt < TLKP_HT_MIN_BUCKETS)
+        bucket_cnt = TLKP_HT_MIN_BUCKETS;
+
+    htable->ht_name = name;
+    htable->ht_socket = socket;
+    htable->ht_count = 0;
+    htable->ht_add_gen = 0;
+    htable->ht_del_gen = 0;
+    htable->ht_bucket_mask = bucket_cnt - 1;
+    htable->ht_buckets = tlkp_ht_alloc_buckets(name, bucket_cnt, socket);
+    if (htable->ht_buckets == NULL) {
+        TPG_ERROR_ABORT("[%d]: Failed to allocate %s (%"PRIu32" buckets)!\n",
+                        rte_lcore_index(rte_lcore_id()), name, bucket_cnt);
+    }
+}
+
+/*****************************************************************************
+ * tlkp_ht_bucket_find()
+ ****************************************************************************/
+static inline __attribute__((__always_inline__))
+l4_control_block_t *tlkp_ht_bucket_find(const tlkp_ht_bucket_t *bucket,
+                                        uint16_t sig,
+                                        uint32_t phys_port, uint32_t l4_hash,
+                                        uint32_t local_addr,
+                                        uint32_t remote_addr,
+                                        uint16_t local_port,
+                                        uint16_t remote_port)
+{
+    l4_control_block_t *cb;
+    uint32_t            i;
+
+    for (i = 0; i < TLKP_HT_BUCKET_ENTRIES; i++) {
+        if (bucket->hb_sig[i] != sig)
+            continue;
+
+        cb = bucket->hb_cb[i];
+        if (cb != NULL &&
+                l4_hash == cb->l4cb_rx_hash &&
+                local_port == cb->l4cb_src_port &&
+                remote_port == cb->l4cb_dst_port &&
+                local_addr == cb->l4cb_src_addr.ip_v4 &&
+                remote_addr == cb->l4cb_dst_addr.ip_v4 &&
+                phys_port == cb->l4cb_interface)
+            return cb;
+    }
+
+    return NULL;
+}
+
 /*****************************************************************************
  * tlkp_find_v4_cb()
  ****************************************************************************/
-l4_control_block_t *tlkp_find_v4_cb(tlkp_hash_bucket_t *htable,
+l4_control_block_t *tlkp_find_v4_cb(tlkp_htable_t *htable,
                                     uint32_t phys_port, uint32_t l4_hash,
                                     uint32_t local_addr, uint32_t remote_addr,
                                     uint16_t local_port, uint16_t remote_port)
 {
-    l4_control_block_t *cb = NULL;
-    tlkp_hash_bucket_t *bucket;
-
-    bucket = tlkp_get_hash_bucket(htable, phys_port, l4_hash);
-
-    LIST_FOREACH(cb, bucket, l4cb_hash_bucket_entry) {
-        if (l4_hash == cb->l4cb_rx_hash &&
-            local_port == cb->l4cb_src_port &&
-            remote_port == cb->l4cb_dst_port &&
-            local_addr == cb->l4cb_src_addr.ip_v4 &&
-            remote_addr == cb->l4cb_dst_addr.ip_v4) {
-            /*
-             * cb holds cb to return...
-             */
-            break;
+    l4_control_block_t *cb;
+    uint64_t            hash;
+    uint32_t            bucket;
+    uint16_t            sig;
+
+    hash = tlkp_ht_hash(phys_port, l4_hash);
+    sig = tlkp_ht_hash_sig(hash);
+    bucket = tlkp_ht_hash_bucket(htable, hash);
+
+    cb = tlkp_ht_bucket_find(&htable->ht_buckets[bucket], sig, phys_port,
+                             l4_hash,
+                             local_addr,
+                             remote_addr,
+                             local_port,
+                             remote_port);
+    if (cb)
+        return cb;
+
+    bucket = tlkp_ht_alt_bucket(htable, bucket, sig);
+    return tlkp_ht_bucket_find(&htable->ht_buckets[bucket], sig, phys_port,
+                               l4_hash,
+                               local_addr,
+                               remote_addr,
+                               local_port,
+                               remote_port);
+}
+
+/*****************************************************************************
+ * tlkp_find_v4_cb_bulk()
+ *      Same as tlkp_find_v4_cb() for 'count' keys. All the buckets of a
+ *      batch are prefetched before any of them is searched. cbs[i] is set to
+ *      NULL if keys[i] is not found.
+ ****************************************************************************/
+void tlkp_find_v4_cb_bulk(tlkp_htable_t *htable, const tlkp_v4_key_t *keys,
+                          l4_control_block_t **cbs,
+                          uint32_t count)
+{
+    uint32_t buckets[TLKP_HT_BULK_SIZE];
+    uint32_t alt_buckets[TLKP_HT_BULK_SIZE];
+    uint16_t sigs[TLKP_HT_BULK_SIZE];
+    uint32_t burst;
+    uint32_t i;
+
+    while (count) {
+        burst = RTE_MIN(count, (uint32_t)TLKP_HT_BULK_SIZE);
+
+        for (i = 0; i < burst; i++) {
+            uint64_t hash = tlkp_ht_hash(keys[i].tk_phys_port,
+                                         keys[i].tk_l4_hash);
+
+            sigs[i] = tlkp_ht_hash_sig(hash);
+            buckets[i] = tlkp_ht_hash_bucket(htable, hash);
+            alt_buckets[i] = tlkp_ht_alt_bucket(htable, buckets[i], sigs[i]);
+
+            rte_prefetch0(&htable->ht_buckets[buckets[i]]);
+            rte_prefetch0(&htable->ht_buckets[alt_buckets[i]]);
         }
-    }
 
-    return cb;
+        for (i = 0; i < burst; i++) {
+            cbs[i] = tlkp_ht_bucket_find(&htable->ht_buckets[buckets[i]],
+                                         sigs[i],
+                                         keys[i].tk_phys_port,
+                                         keys[i].tk_l4_hash,
+                                         keys[i].tk_local_addr,
+                                         keys[i].tk_remote_addr,
+                                         keys[i].tk_local_port,
+                                         keys[i].tk_remote_port);
+            if (cbs[i])
+                continue;
+
+            cbs[i] = tlkp_ht_bucket_find(&htable->ht_buckets[alt_buckets[i]],
+                                         sigs[i],
+                                         keys[i].tk_phys_port,
+                                         keys[i].tk_l4_hash,
+                                         keys[i].tk_local_addr,
+                                         keys[i].tk_remote_addr,
+                                         keys[i].tk_local_port,
+                                         keys[i].tk_remote_port);
+        }
+
+        keys += burst;
+        cbs += burst;
+        count -= burst;
+    }
 }
 
 /*****************************************************************************
  * tlkp_add_cb()
  ****************************************************************************/
-int tlkp_add_cb(tlkp_hash_bucket_t *htable, l4_control_block_t *cb)
+int tlkp_add_cb(tlkp_htable_t *htable, l4_control_block_t *cb)
 {
-    tlkp_hash_bucket_t *bucket;
+    l4_control_block_t *homeless = cb;
+    int                 error;
 
     if (cb == NULL)
         return -EINVAL;
@@ -197,34 +461,120 @@ int tlkp_add_cb(tlkp_hash_bucket_t *htable, l4_control_block_t *cb)
               cb->l4cb_interface,
               cb->l4cb_rx_hash);
 
-    bucket = tlkp_get_hash_bucket(htable, cb->l4cb_interface, cb->l4cb_rx_hash);
-
     /* TODO: Add duplicate check */
-    LIST_INSERT_HEAD(bucket, cb, l4cb_hash_bucket_entry);
+    if (unlikely(!tlkp_ht_insert(htable, &homeless))) {
+        /* 'homeless' is now out of the table, rehash everything. */
+        error = tlkp_ht_grow(htable, homeless);
+        if (error) {
+            /* If it's not the new cb then we can't put it back. */
+            if (homeless != cb)
+                TPG_ERROR_ABORT("[%d]: Failed to grow %s!\n",
+                                rte_lcore_index(rte_lcore_id()),
+                                htable->ht_name);
+            return error;
+        }
+    }
 
+    htable->ht_count++;
+    htable->ht_add_gen++;
     return 0;
 }
 
 /*****************************************************************************
  * tlkp_delete_cb()
  ****************************************************************************/
-int tlkp_delete_cb(tlkp_hash_bucket_t *htable __rte_unused,
-                   l4_control_block_t *cb)
+int tlkp_delete_cb(tlkp_htable_t *htable, l4_control_block_t *cb)
 {
+    tlkp_ht_bucket_t *bucket;
+    uint64_t          hash;
+    uint32_t          bucket_idx;
+    uint32_t          i;
+    uint16_t          sig;
+
     if (cb == NULL)
         return -EINVAL;
 
-    /*
-     * TODO: Do we need to add some form of protection, i.e. make sure the
-     *       cb is realy part of the hash bucket?
-     */
-    LIST_REMOVE(cb, l4cb_hash_bucket_entry);
+    hash = tlkp_ht_hash(cb->l4cb_interface, cb->l4cb_rx_hash);
+    sig = tlkp_ht_hash_sig(hash);
+    bucket_idx = tlkp_ht_hash_bucket(htable, hash);
+
+    bucket = &htable->ht_buckets[bucket_idx];
+    for (i = 0; i < TLKP_HT_BUCKET_ENTRIES; i++) {
+        if (bucket->hb_cb[i] == cb)
+            goto found;
+    }
 
+    bucket = &htable->ht_buckets[tlkp_ht_alt_bucket(htable, bucket_idx, sig)];
+    for (i = 0; i < TLKP_HT_BUCKET_ENTRIES; i++) {
+        if (bucket->hb_cb[i] == cb)
+            goto found;
+    }
+
+    return -ENOENT;
+
+found:
+    bucket->hb_cb[i] = NULL;
+    htable->ht_count--;
+    htable->ht_del_gen++;
     return 0;
 }
 
+/*****************************************************************************
+ * tlkp_cb_recycle_refill()
+ *      Pulls TLKP_CB_RECYCLE_BULK control blocks from the mempool in one go.
+ *      The physical address only depends on the object so it's computed
+ *      once here and stays valid for as long as the control block is
+ *      recycled. Returns the number of control blocks added (0 if the pool
+ *      can't satisfy the whole bulk).
+ ****************************************************************************/
+uint32_t tlkp_cb_recycle_refill(tlkp_cb_recycle_t *recycle,
+                                struct rte_mempool *mp,
+                                size_t l4_cb_offset)
+{
+    l4_control_block_t *cb;
+    uint32_t            i;
+
+    if (rte_mempool_generic_get(mp, &recycle->cr_cbs[recycle->cr_count],
+                                TLKP_CB_RECYCLE_BULK,
+                                NULL))
+        return 0;
+
+    for (i = 0; i < TLKP_CB_RECYCLE_BULK; i++) {
+        void *container = recycle->cr_cbs[recycle->cr_count + i];
+
+        cb = RTE_PTR_ADD(container, l4_cb_offset);
+        cb->l4cb_phys_addr = rte_mempool_virt2iova(container) + l4_cb_offset;
+    }
+
+    recycle->cr_count += TLKP_CB_RECYCLE_BULK;
+    return TLKP_CB_RECYCLE_BULK;
+}
+
+/*****************************************************************************
+ * tlkp_cb_recycle_drain()
+ *      Returns the 'count' least recently freed control blocks to the
+ *      mempool in one go.
+ ****************************************************************************/
+void tlkp_cb_recycle_drain(tlkp_cb_recycle_t *recycle, struct rte_mempool *mp,
+                           uint32_t count)
+{
+    if (count > recycle->cr_count)
+        count = recycle->cr_count;
+
+    if (count == 0)
+        return;
+
+    rte_mempool_generic_put(mp, &recycle->cr_cbs[0], count, NULL);
+
+    recycle->cr_count -= count;
+    memmove(&recycle->cr_cbs[0], &recycle->cr_cbs[count],
+            recycle->cr_count * sizeof(recycle->cr_cbs[0]));
+}
+
 /*****************************************************************************
  * tlkp_init_cb()
+ *      'sockopt' is not copied so it must stay valid for the lifetime of the
+ *      control block.
  ****************************************************************************/
 void tlkp_init_cb(l4_control_block_t *l4_cb, uint32_t local_addr,
                   uint32_t remote_addr,
@@ -249,8 +599,10 @@ void tlkp_init_cb(l4_control_block_t *l4_cb, uint32_t local_addr,
 
     l4_cb->l4cb_app_data.ad_type = app_id;
 
-    /* Struct copy! */
-    l4_cb->l4cb_sockopt = *sockopt;
+    /* Shared by all the sessions of the test case. */
+    l4_cb->l4cb_sockopt = sockopt;
+
+    l4_cb_hdr_tmpl_invalidate(l4_cb);
 
     if (flags & TPG_CB_USE_L4_HASH_FLAG)
         l4_cb->l4cb_rx_hash = l4_hash;
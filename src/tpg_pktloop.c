@@ -64,7 +64,21 @@
 /*****************************************************************************
  * Definitions
  ****************************************************************************/
+/* Maximum number of TCP flows coalesced in parallel within an RX burst. */
+#define PKT_RX_GRO_MAX_FLOWS 8
 
+/* Per flow coalescing state while walking an RX burst. */
+typedef struct pkt_rx_gro_flow_s {
+
+    void                *prgf_l4cb;     /* TCB owning the flow. */
+    struct rte_mbuf     *prgf_mbuf;     /* Packet segments are merged into. */
+    struct rte_ipv4_hdr *prgf_ip_hdr;
+    struct rte_tcp_hdr  *prgf_tcp_hdr;
+    uint32_t             prgf_next_seq; /* Sequence the next segment must have. */
+    uint16_t             prgf_ip_len;   /* IP total length of the head packet. */
+    uint16_t             prgf_hdrs_len; /* L2 + L3 + L4 header length. */
+
+} pkt_rx_gro_flow_t;
 
 /*****************************************************************************
  * Static per lcore globals.
@@ -412,6 +426,394 @@ static uint16_t pkt_rx_burst(uint8_t port_id, uint16_t queue_id,
     return no_rx_buffers;
 }
 
+/*****************************************************************************
+ * pkt_rx_parse_v4_key()
+ *      Peeks at the headers of a received packet (without adjusting the
+ *      mbuf) and fills in the session lookup key. Returns the L4 protocol or
+ *      0 if the packet should just go through the regular per packet lookup
+ *      (e.g., non IPv4, fragments, headers split across segments).
+ ****************************************************************************/
+static uint8_t pkt_rx_parse_v4_key(packet_control_block_t *pcb,
+                                   tlkp_v4_key_t *key)
+{
+    struct rte_mbuf      *mbuf = pcb->pcb_mbuf;
+    struct rte_ether_hdr *eth_hdr;
+    struct rte_ipv4_hdr  *ip_hdr;
+    uint16_t             *l4_ports; /* Same layout for TCP and UDP. */
+    uint32_t              data_len;
+    uint32_t              offset;
+    uint16_t              etype;
+
+    data_len = rte_pktmbuf_data_len(mbuf);
+    if (unlikely(data_len < sizeof(*eth_hdr)))
+        return 0;
+
+    eth_hdr = rte_pktmbuf_mtod(mbuf, struct rte_ether_hdr *);
+    etype = eth_hdr->ether_type;
+    offset = sizeof(*eth_hdr);
+
+    while (unlikely(etype == rte_cpu_to_be_16(RTE_ETHER_TYPE_VLAN))) {
+        struct rte_vlan_hdr *tag_hdr;
+
+        if (unlikely(data_len < offset + sizeof(*tag_hdr)))
+            return 0;
+
+        tag_hdr = rte_pktmbuf_mtod_offset(mbuf, struct rte_vlan_hdr *,
+                                          offset);
+        etype = tag_hdr->eth_proto;
+        offset += sizeof(*tag_hdr);
+    }
+
+    if (unlikely(etype != rte_cpu_to_be_16(RTE_ETHER_TYPE_IPV4)))
+        return 0;
+
+    if (unlikely(data_len < offset + sizeof(*ip_hdr)))
+        return 0;
+
+    ip_hdr = rte_pktmbuf_mtod_offset(mbuf, struct rte_ipv4_hdr *, offset);
+    if (unlikely((ip_hdr->version_ihl & 0xF0) != 0x40))
+        return 0;
+
+    /* Fragments are looked up after reassembly. */
+    if (unlikely((ip_hdr->fragment_offset &
+                    rte_cpu_to_be_16(RTE_IPV4_HDR_MF_FLAG |
+                                     RTE_IPV4_HDR_OFFSET_MASK)) != 0))
+        return 0;
+
+    if (unlikely(ip_hdr->next_proto_id != IPPROTO_TCP &&
+                 ip_hdr->next_proto_id != IPPROTO_UDP))
+        return 0;
+
+    offset += (ip_hdr->version_ihl & 0x0F) << 2;
+    if (unlikely(data_len < offset + 2 * sizeof(*l4_ports)))
+        return 0;
+
+    l4_ports = rte_pktmbuf_mtod_offset(mbuf, uint16_t *, offset);
+
+    /* Must match the hash computed by tcp/udp_receive_pkt(). */
+    if (likely((mbuf->ol_flags & PKT_RX_RSS_HASH) != 0))
+        key->tk_l4_hash = mbuf->hash.rss;
+    else
+        key->tk_l4_hash = tlkp_calc_pkt_hash(ip_hdr->src_addr,
+                                             ip_hdr->dst_addr,
+                                             l4_ports[0],
+                                             l4_ports[1]);
+
+    key->tk_phys_port = pcb->pcb_port;
+    key->tk_local_addr = rte_be_to_cpu_32(ip_hdr->dst_addr);
+    key->tk_remote_addr = rte_be_to_cpu_32(ip_hdr->src_addr);
+    key->tk_local_port = rte_be_to_cpu_16(l4_ports[1]);
+    key->tk_remote_port = rte_be_to_cpu_16(l4_ports[0]);
+
+    return ip_hdr->next_proto_id;
+}
+
+/*****************************************************************************
+ * pkt_rx_burst_lookup()
+ *      Staged session lookup for a whole RX burst:
+ *      - prefetch the packet headers
+ *      - parse all the lookup keys
+ *      - bulk lookup (prefetches all the hash buckets before searching them)
+ *        and prefetch the control blocks that were found.
+ *      By the time the state machines run for each packet the TCB/UCB
+ *      should already be in cache.
+ ****************************************************************************/
+static void pkt_rx_burst_lookup(packet_control_block_t *pcbs, uint32_t count)
+{
+    packet_control_block_t *tcp_pcbs[TPG_RX_BURST_SIZE];
+    packet_control_block_t *udp_pcbs[TPG_RX_BURST_SIZE];
+    tlkp_v4_key_t           tcp_keys[TPG_RX_BURST_SIZE];
+    tlkp_v4_key_t           udp_keys[TPG_RX_BURST_SIZE];
+    uint32_t                tcp_cnt = 0;
+    uint32_t                udp_cnt = 0;
+    uint32_t                i;
+
+    for (i = 0; i < count; i++)
+        rte_prefetch0(rte_pktmbuf_mtod(pcbs[i].pcb_mbuf, void *));
+
+    for (i = 0; i < count; i++) {
+        switch (pkt_rx_parse_v4_key(&pcbs[i], &tcp_keys[tcp_cnt])) {
+        case IPPROTO_TCP:
+            tcp_pcbs[tcp_cnt++] = &pcbs[i];
+            break;
+        case IPPROTO_UDP:
+            /* Parsed in the TCP slot, move it over. */
+            udp_keys[udp_cnt] = tcp_keys[tcp_cnt];
+            udp_pcbs[udp_cnt++] = &pcbs[i];
+            break;
+        default:
+            break;
+        }
+    }
+
+    if (tcp_cnt)
+        tlkp_rx_burst_tcb(tcp_pcbs, tcp_keys, tcp_cnt);
+
+    if (udp_cnt)
+        tlkp_rx_burst_ucb(udp_pcbs, udp_keys, udp_cnt);
+}
+
+/*****************************************************************************
+ * pkt_rx_gro_parse()
+ *      Peeks at the headers of a TCP packet that is a candidate for
+ *      coalescing. Returns false if the packet can't be coalesced (e.g.,
+ *      non TCP, headers split across segments, no payload, checksums not
+ *      validated by the NIC).
+ ****************************************************************************/
+static bool pkt_rx_gro_parse(struct rte_mbuf *mbuf,
+                             struct rte_ipv4_hdr **ip_hdr_p,
+                             struct rte_tcp_hdr **tcp_hdr_p,
+                             uint16_t *hdrs_len_p,
+                             uint16_t *l5_len_p)
+{
+    struct rte_ether_hdr *eth_hdr;
+    struct rte_ipv4_hdr  *ip_hdr;
+    struct rte_tcp_hdr   *tcp_hdr;
+    uint32_t              data_len;
+    uint32_t              offset;
+    uint16_t              etype;
+    uint16_t              ip_hdr_len;
+    uint16_t              tcp_hdr_len;
+    uint16_t              ip_len;
+
+    if ((mbuf->ol_flags & PKT_RX_IP_CKSUM_MASK) != PKT_RX_IP_CKSUM_GOOD ||
+            (mbuf->ol_flags & PKT_RX_L4_CKSUM_MASK) != PKT_RX_L4_CKSUM_GOOD)
+        return false;
+
+    data_len = rte_pktmbuf_data_len(mbuf);
+    if (unlikely(data_len < sizeof(*eth_hdr)))
+        return false;
+
+    eth_hdr = rte_pktmbuf_mtod(mbuf, struct rte_ether_hdr *);
+    etype = eth_hdr->ether_type;
+    offset = sizeof(*eth_hdr);
+
+    while (unlikely(etype == rte_cpu_to_be_16(RTE_ETHER_TYPE_VLAN))) {
+        struct rte_vlan_hdr *tag_hdr;
+
+        if (unlikely(data_len < offset + sizeof(*tag_hdr)))
+            return false;
+
+        tag_hdr = rte_pktmbuf_mtod_offset(mbuf, struct rte_vlan_hdr *,
+                                          offset);
+        etype = tag_hdr->eth_proto;
+        offset += sizeof(*tag_hdr);
+    }
+
+    if (unlikely(etype != rte_cpu_to_be_16(RTE_ETHER_TYPE_IPV4)))
+        return false;
+
+    if (unlikely(data_len < offset + sizeof(*ip_hdr)))
+        return false;
+
+    ip_hdr = rte_pktmbuf_mtod_offset(mbuf, struct rte_ipv4_hdr *, offset);
+    if (ip_hdr->next_proto_id != IPPROTO_TCP)
+        return false;
+
+    ip_hdr_len = (ip_hdr->version_ihl & 0x0F) << 2;
+    if (unlikely(data_len < offset + ip_hdr_len + sizeof(*tcp_hdr)))
+        return false;
+
+    tcp_hdr = rte_pktmbuf_mtod_offset(mbuf, struct rte_tcp_hdr *,
+                                      offset + ip_hdr_len);
+    tcp_hdr_len = (tcp_hdr->data_off >> 4) << 2;
+    if (unlikely(tcp_hdr_len < sizeof(*tcp_hdr) ||
+                 data_len < offset + ip_hdr_len + tcp_hdr_len))
+        return false;
+
+    ip_len = rte_be_to_cpu_16(ip_hdr->total_length);
+    if (unlikely(ip_len <= ip_hdr_len + tcp_hdr_len ||
+                 offset + ip_len > rte_pktmbuf_pkt_len(mbuf)))
+        return false;
+
+    *ip_hdr_p = ip_hdr;
+    *tcp_hdr_p = tcp_hdr;
+    *hdrs_len_p = offset + ip_hdr_len + tcp_hdr_len;
+    *l5_len_p = ip_len - ip_hdr_len - tcp_hdr_len;
+    return true;
+}
+
+/*****************************************************************************
+ * pkt_rx_gro_merge()
+ *      Appends the payload of 'mbuf' to the head packet of the flow if the
+ *      segment is the in sequence continuation of the head and carries the
+ *      same ACK, window and options. Returns true if the payload was merged
+ *      (in which case 'mbuf' is now part of the head chain).
+ ****************************************************************************/
+static bool pkt_rx_gro_merge(pkt_rx_gro_flow_t *flow, struct rte_mbuf *mbuf,
+                             struct rte_ipv4_hdr *ip_hdr,
+                             struct rte_tcp_hdr *tcp_hdr,
+                             uint16_t hdrs_len,
+                             uint16_t l5_len)
+{
+    struct rte_mbuf *head = flow->prgf_mbuf;
+    uint16_t         tcp_opts_len;
+
+    if (rte_be_to_cpu_32(tcp_hdr->sent_seq) != flow->prgf_next_seq ||
+            tcp_hdr->recv_ack != flow->prgf_tcp_hdr->recv_ack ||
+            tcp_hdr->rx_win != flow->prgf_tcp_hdr->rx_win ||
+            tcp_hdr->data_off != flow->prgf_tcp_hdr->data_off ||
+            ip_hdr->version_ihl != flow->prgf_ip_hdr->version_ihl ||
+            hdrs_len != flow->prgf_hdrs_len)
+        return false;
+
+    tcp_opts_len = ((tcp_hdr->data_off >> 4) << 2) - sizeof(*tcp_hdr);
+    if (tcp_opts_len != 0 &&
+            memcmp(tcp_hdr + 1, flow->prgf_tcp_hdr + 1, tcp_opts_len) != 0)
+        return false;
+
+    if ((uint32_t)flow->prgf_ip_len + l5_len > UINT16_MAX)
+        return false;
+
+    if (head->nb_segs + mbuf->nb_segs > RTE_MBUF_MAX_NB_SEGS)
+        return false;
+
+    /* Keep at least some payload in the first segment so we don't chain
+     * empty segments.
+     */
+    if (rte_pktmbuf_data_len(mbuf) <= hdrs_len)
+        return false;
+
+    /* Drop any L2 padding and then the headers. */
+    if (rte_pktmbuf_trim(mbuf,
+                         rte_pktmbuf_pkt_len(mbuf) - hdrs_len - l5_len) != 0)
+        return false;
+
+    rte_pktmbuf_adj(mbuf, hdrs_len);
+
+    if (rte_pktmbuf_chain(head, mbuf) != 0)
+        return false;
+
+    flow->prgf_ip_len += l5_len;
+    flow->prgf_next_seq += l5_len;
+
+    flow->prgf_ip_hdr->total_length = rte_cpu_to_be_16(flow->prgf_ip_len);
+    flow->prgf_ip_hdr->hdr_checksum = 0;
+    flow->prgf_ip_hdr->hdr_checksum = rte_ipv4_cksum(flow->prgf_ip_hdr);
+
+    /* The L4 checksum was already validated by the NIC for each segment. */
+    flow->prgf_tcp_hdr->tcp_flags |= (tcp_hdr->tcp_flags & RTE_TCP_PSH_FLAG);
+    return true;
+}
+
+/*****************************************************************************
+ * pkt_rx_burst_gro()
+ *      Coalesces in sequence TCP data segments of the same session within
+ *      an RX burst so that the TCP state machine processes (and ACKs) them
+ *      only once. Relies on the results of pkt_rx_burst_lookup() to
+ *      identify the flows. Only pure ACK segments (PSH allowed on the last
+ *      merged one) with payload are coalesced. Any other packet of a flow
+ *      closes the flow so the order of the segments is preserved.
+ *      Returns the new number of packets in the burst.
+ ****************************************************************************/
+static uint32_t pkt_rx_burst_gro(packet_control_block_t *pcbs,
+                                 struct rte_mbuf **buf,
+                                 uint32_t count,
+                                 tpg_port_statistics_t *stats)
+{
+    pkt_rx_gro_flow_t flows[PKT_RX_GRO_MAX_FLOWS];
+    uint32_t          flow_cnt = 0;
+    uint32_t          flow_evict = 0;
+    uint32_t          merged = 0;
+    uint32_t          i;
+    uint32_t          f;
+
+    for (i = 0; i < count; i++) {
+        packet_control_block_t *pcb = &pcbs[i];
+        struct rte_ipv4_hdr    *ip_hdr;
+        struct rte_tcp_hdr     *tcp_hdr;
+        pkt_rx_gro_flow_t      *flow;
+        uint16_t                hdrs_len;
+        uint16_t                l5_len;
+        uint8_t                 flags;
+
+        /* Not looked up (e.g., fragments): we don't know which flow it
+         * belongs to so stop coalescing altogether.
+         */
+        if (unlikely(!pcb->pcb_l4cb_valid)) {
+            flow_cnt = 0;
+            continue;
+        }
+
+        if (pcb->pcb_l4cb == NULL)
+            continue;
+
+        for (f = 0; f < flow_cnt; f++) {
+            if (flows[f].prgf_l4cb == pcb->pcb_l4cb)
+                break;
+        }
+        flow = (f < flow_cnt) ? &flows[f] : NULL;
+
+        if (!pkt_rx_gro_parse(pcb->pcb_mbuf, &ip_hdr, &tcp_hdr, &hdrs_len,
+                              &l5_len)) {
+            if (flow)
+                *flow = flows[--flow_cnt];
+            continue;
+        }
+
+        flags = tcp_hdr->tcp_flags;
+
+        if (flow && (flags == RTE_TCP_ACK_FLAG ||
+                     flags == (RTE_TCP_ACK_FLAG | RTE_TCP_PSH_FLAG)) &&
+                pkt_rx_gro_merge(flow, pcb->pcb_mbuf, ip_hdr, tcp_hdr,
+                                 hdrs_len,
+                                 l5_len)) {
+            INC_STATS(stats, ps_gro_merged);
+            pcb->pcb_mbuf = NULL;
+            merged++;
+
+            /* Nothing can be appended after a PSH. */
+            if (flags & RTE_TCP_PSH_FLAG)
+                *flow = flows[--flow_cnt];
+            continue;
+        }
+
+        /* Only pure ACK segments can start a new coalesced packet. Drop the
+         * L2 padding now so payload can be appended right after it.
+         */
+        if (flags != RTE_TCP_ACK_FLAG ||
+                rte_pktmbuf_trim(pcb->pcb_mbuf,
+                                 rte_pktmbuf_pkt_len(pcb->pcb_mbuf) -
+                                 hdrs_len - l5_len) != 0) {
+            if (flow)
+                *flow = flows[--flow_cnt];
+            continue;
+        }
+
+        if (!flow) {
+            if (flow_cnt < PKT_RX_GRO_MAX_FLOWS)
+                flow = &flows[flow_cnt++];
+            else
+                flow = &flows[flow_evict++ % PKT_RX_GRO_MAX_FLOWS];
+        }
+
+        flow->prgf_l4cb = pcb->pcb_l4cb;
+        flow->prgf_mbuf = pcb->pcb_mbuf;
+        flow->prgf_ip_hdr = ip_hdr;
+        flow->prgf_tcp_hdr = tcp_hdr;
+        flow->prgf_next_seq = rte_be_to_cpu_32(tcp_hdr->sent_seq) + l5_len;
+        flow->prgf_ip_len = rte_be_to_cpu_16(ip_hdr->total_length);
+        flow->prgf_hdrs_len = hdrs_len;
+    }
+
+    if (likely(merged == 0))
+        return count;
+
+    /* Squeeze out the packets that were merged. */
+    for (i = 0, f = 0; i < count; i++) {
+        if (pcbs[i].pcb_mbuf == NULL)
+            continue;
+
+        if (f != i) {
+            pcbs[f] = pcbs[i];
+            buf[f] = buf[i];
+        }
+        f++;
+    }
+
+    return f;
+}
+
 /*****************************************************************************
  * pkt_loop_add_port()
  ****************************************************************************/
@@ -615,6 +1017,9 @@ int pkt_receive_loop(void *arg __rte_unused)
         /* Work some TPG timers. */
         time_advance();
 
+        /* Reclaim expired TCP TIME_WAIT records. */
+        tlkp_tw_expire();
+
         /* Poll for messages from other modules/cores. */
         error = msg_poll();
         if (error)
@@ -640,20 +1045,29 @@ int pkt_receive_loop(void *arg __rte_unused)
                  * setup PCB
                  */
                 pcb_minimal_init(&pcbs[i], lcore_index, port, buf[i]);
+
+                /* Account before GRO so merged packets are counted too. */
+                INC_STATS(&port_stats[port], ps_received_pkts);
+                INC_STATS_VAL(&port_stats[port], ps_received_bytes,
+                              rte_pktmbuf_pkt_len(buf[i]));
             }
 
             if (unlikely(tstamp_rx_is_running(port, qidx)))
                 tstamp_pktloop_rx_pkt_burst(port, qidx, buf, pcbs,
                                             no_rx_buffers);
 
+            pkt_rx_burst_lookup(pcbs, no_rx_buffers);
+
+            /* Timestamped packets must reach the stack one by one. */
+            if (RTE_PER_LCORE(pktloop_port_info)[qidx].lpi_port_info->pi_gro &&
+                    likely(!tstamp_rx_is_running(port, qidx)))
+                no_rx_buffers = pkt_rx_burst_gro(pcbs, buf, no_rx_buffers,
+                                                 &port_stats[port]);
+
             for (i = 0; i < no_rx_buffers; i++) {
                 /*
                  * Hand off packet to ethernet driver, as we only support ethernet
                  */
-                INC_STATS(&port_stats[port], ps_received_pkts);
-                INC_STATS_VAL(&port_stats[port], ps_received_bytes,
-                              rte_pktmbuf_pkt_len(buf[i]));
-
                 PKT_TRACE(&pcbs[i], PKT_RX, DEBUG,
                           "port=%d qid=%d len=%u, ol_flags=0x%16.16"PRIX64", nb_segs=%u",
                           port,
@@ -674,6 +1088,9 @@ int pkt_receive_loop(void *arg __rte_unused)
                     pkt_mbuf_free(ret_mbuf);
             }
 
+            /* One cumulative ACK per session for the whole burst. */
+            tcp_ack_flush();
+
             /* Flush the bulk tx queue in case we still have packets pending. */
             pkt_flush_tx_q(port, &port_stats[port]);
         }
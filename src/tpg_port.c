@@ -82,6 +82,9 @@ static char       *qmap_args[TPG_ETH_DEV_MAX + 1];
 static uint32_t    qmap_args_cnt;
 static const char *qmap_default;
 
+/* True if TCP LRO should be enabled on the ports that support it. */
+static bool        port_lro;
+
 /* Define PORT global statistics. Each thread has its own set of locally
  * allocated stats which are accessible through STATS_GLOBAL(type, core, port).
  */
@@ -344,6 +347,7 @@ static void port_store_conn_options_internal(uint32_t port,
 {
     /* Store the port configuration in our own structures. */
     port_dev_info[port].pi_mtu = options->po_mtu;
+    port_dev_info[port].pi_gro = options->po_gro;
 
     /* Tell the packet cores to update their local copy. */
     port_request_update(port, MSG_PKTLOOP_UPDATE_PORT_DEV_INFO);
@@ -501,6 +505,7 @@ static bool port_setup_port(uint8_t port)
             .offloads = DEV_TX_OFFLOAD_IPV4_CKSUM |
                         DEV_TX_OFFLOAD_UDP_CKSUM |
                         DEV_TX_OFFLOAD_TCP_CKSUM |
+                        DEV_TX_OFFLOAD_TCP_TSO |
                         DEV_TX_OFFLOAD_MULTI_SEGS,
             .mq_mode = ETH_MQ_TX_NONE,
         }
@@ -574,6 +579,22 @@ static bool port_setup_port(uint8_t port)
             DEV_TX_OFFLOAD_TCP_CKSUM)
         default_port_config.txmode.offloads &= ~DEV_TX_OFFLOAD_TCP_CKSUM;
 
+    if ((port_dev_info[port].pi_dev_info.tx_offload_capa & DEV_TX_OFFLOAD_TCP_TSO) !=
+            DEV_TX_OFFLOAD_TCP_TSO)
+        default_port_config.txmode.offloads &= ~DEV_TX_OFFLOAD_TCP_TSO;
+
+    if (port_lro) {
+        if ((port_dev_info[port].pi_dev_info.rx_offload_capa & DEV_RX_OFFLOAD_TCP_LRO) ==
+                DEV_RX_OFFLOAD_TCP_LRO) {
+            default_port_config.rxmode.offloads |= DEV_RX_OFFLOAD_TCP_LRO;
+            default_port_config.rxmode.max_lro_pkt_size =
+                port_dev_info[port].pi_dev_info.max_lro_pkt_size;
+        } else {
+            RTE_LOG(WARNING, USER1,
+                    "WARNING: Port %u doesn't support TCP LRO!\n", port);
+        }
+    }
+
     RTE_LOG(INFO, USER1, "[%s()] Initializing Ethernet port %u.\n", __func__,
             port);
 
@@ -1127,6 +1148,12 @@ int port_set_conn_options(uint32_t port, tpg_port_options_t *options)
     struct rte_eth_link link;
     int                 rc;
 
+    if (options->has_po_arp_table_size) {
+        rc = arp_set_table_size(port, options->po_arp_table_size);
+        if (rc)
+            return rc;
+    }
+
     rc = port_set_conn_options_internal(port, options);
     if (rc)
         return rc;
@@ -1149,6 +1176,9 @@ int port_set_conn_options(uint32_t port, tpg_port_options_t *options)
 void port_get_conn_options(uint32_t port, tpg_port_options_t *out)
 {
     TPG_XLATE_OPTIONAL_SET_FIELD(out, po_mtu, port_dev_info[port].pi_mtu);
+    TPG_XLATE_OPTIONAL_SET_FIELD(out, po_arp_table_size,
+                                 arp_get_table_size(port));
+    TPG_XLATE_OPTIONAL_SET_FIELD(out, po_gro, port_dev_info[port].pi_gro);
 }
 
 /*****************************************************************************
@@ -1186,6 +1216,11 @@ cmdline_arg_parser_res_t port_handle_cmdline_opt(const char *opt_name,
         return CAPR_CONSUMED;
     }
 
+    if (strncmp(opt_name, "lro", strlen("lro") + 1) == 0) {
+        port_lro = true;
+        return CAPR_CONSUMED;
+    }
+
     return CAPR_IGNORED;
 }
 
@@ -1350,6 +1385,13 @@ static void cmd_show_port_statistics_parsed(void *parsed_result __rte_unused,
                          option);
 
         cmdline_printf(cl, "\n");
+
+        SHOW_64BIT_STATS("GRO merged", tpg_port_statistics_t,
+                         ps_gro_merged,
+                         port,
+                         option);
+
+        cmdline_printf(cl, "\n");
     }
 
     if (option == 'd') {
@@ -51,12 +51,16 @@
  *     08/24/2015
  *
  * Notes:
- *
+ *     Routes are stored per port in an LPM (DIR-24-8) table whose next hops
+ *     are indices in the per port route entry array. As with the ARP table,
+ *     updates only happen on the port's default core.
  */
 
 /*****************************************************************************
  * Include files
  ****************************************************************************/
+#include <rte_lpm.h>
+
 #include "tcp_generator.h"
 
 /*****************************************************************************
@@ -67,15 +71,36 @@
  */
 STATS_DEFINE(tpg_route_statistics_t);
 
-static route_entry_t *route_per_port_table; /* local_intf[port][entries] */
-static route_entry_t *default_gw_per_port;  /* default_gw[port] */
-static gw_per_vlan_t *gw_per_port_per_vlan; /* gw[port][vlan] */
+static route_entry_t   *route_per_port_table; /* entries[port][entries] */
+static struct rte_lpm **route_lpm_per_port;   /* lpm[port] */
+static route_entry_t   *default_gw_per_port;  /* default_gw[port] */
+static gw_per_vlan_t   *gw_per_port_per_vlan; /* gw[port][vlan] */
+
+volatile uint32_t *route_nh_gen_per_port;   /* nh_gen[port] */
 
 /*****************************************************************************
  * Forward declarations
  ****************************************************************************/
 static cmdline_parse_ctx_t cli_ctx[];
 
+/*****************************************************************************
+ * route_port_entries()
+ ****************************************************************************/
+static inline route_entry_t *route_port_entries(uint32_t port)
+{
+    return route_per_port_table + (TPG_ROUTE_PORT_TABLE_SIZE * port);
+}
+
+/*****************************************************************************
+ * route_v4_mask_depth()
+ *      Masks are validated by the management layer so counting the set bits
+ *      gives us the prefix length.
+ ****************************************************************************/
+static inline uint8_t route_v4_mask_depth(uint32_t mask)
+{
+    return __builtin_popcount(mask);
+}
+
 /*****************************************************************************
  * Find out the index of the corresponding GW in the gw_per_port_per_vlan
  ****************************************************************************/
@@ -94,65 +119,138 @@ tpg_ip_t *route_v4_find_gw_port_vlan(uint32_t port, uint32_t vlan_id)
 }
 
 /*****************************************************************************
- * route_update_entry()
+ * route_find_prefix()
+ *      Returns the index of the first entry in [start, end) matching the
+ *      net/mask prefix (skipping 'skip_idx') or -1 if none is found.
  ****************************************************************************/
-static bool route_update_entry(uint32_t port, tpg_ip_t *net, tpg_ip_t *mask,
-                               tpg_ip_t *nh, uint32_t flags)
+static int route_find_prefix(uint32_t port, uint32_t start, uint32_t end,
+                             uint32_t net, uint32_t mask, uint32_t skip_idx)
 {
-    int            i;
-    route_entry_t *update_entry = NULL;
-    route_entry_t *free_entry = NULL;
-    route_entry_t *port_entries = route_per_port_table +
-                                      (TPG_ROUTE_PORT_TABLE_SIZE * port);
+    uint32_t       i;
+    route_entry_t *port_entries = route_port_entries(port);
+
+    for (i = start; i < end; i++) {
+        if (i == skip_idx)
+            continue;
+
+        if (ROUTE_IS_FLAG_SET(&port_entries[i], ROUTE_FLAG_IN_USE) &&
+                port_entries[i].re_mask.ip_v4 == mask &&
+                (port_entries[i].re_net.ip_v4 & mask) == (net & mask))
+            return i;
+    }
+
+    return -1;
+}
+
+/*****************************************************************************
+ * route_lpm_del_entry()
+ *      Removes the LPM rule pointing to entry 'idx'. If other entries share
+ *      the same prefix (e.g., multiple local IPs in the same network) the rule
+ *      is moved to the first of them instead.
+ ****************************************************************************/
+static void route_lpm_del_entry(uint32_t port, uint32_t idx)
+{
+    route_entry_t *re = &route_port_entries(port)[idx];
+    uint8_t        depth = route_v4_mask_depth(re->re_mask.ip_v4);
+    uint32_t       nh_idx;
+    int            other_idx;
+
+    if (depth == 0)
+        return;
+
+    if (rte_lpm_is_rule_present(route_lpm_per_port[port], re->re_net.ip_v4,
+                                depth,
+                                &nh_idx) != 1 || nh_idx != idx)
+        return;
+
+    other_idx = route_find_prefix(port, 0, TPG_ROUTE_PORT_TABLE_SIZE,
+                                  re->re_net.ip_v4,
+                                  re->re_mask.ip_v4,
+                                  idx);
+    if (other_idx >= 0)
+        rte_lpm_add(route_lpm_per_port[port], re->re_net.ip_v4, depth,
+                    other_idx);
+    else
+        rte_lpm_delete(route_lpm_per_port[port], re->re_net.ip_v4, depth);
+}
 
-    for (i = 0; i < TPG_ROUTE_PORT_TABLE_SIZE; i++) {
+/*****************************************************************************
+ * route_local_add()
+ ****************************************************************************/
+static bool route_local_add(uint32_t port, tpg_ip_t *ip, tpg_ip_t *mask,
+                            uint16_t vlan_id)
+{
+    route_entry_t *port_entries = route_port_entries(port);
+    int            free_idx = -1;
+    uint32_t       nh_idx;
+    uint32_t       i;
+    uint8_t        depth;
+
+    for (i = TPG_ROUTE_LOCAL_BASE; i < TPG_ROUTE_STATIC_BASE; i++) {
         if (!ROUTE_IS_FLAG_SET(&port_entries[i], ROUTE_FLAG_IN_USE)) {
-            if (free_entry == NULL)
-                free_entry = &port_entries[i];
+            if (free_idx < 0)
+                free_idx = i;
 
             continue;
         }
 
-        /* No ECMP support! */
-        if (net->ip_v4 == port_entries[i].re_net.ip_v4 &&
-                mask->ip_v4 == port_entries[i].re_mask.ip_v4) {
-            update_entry = &port_entries[i];
-            break;
-        }
+        /* No ECMP support! Interface already installed. */
+        if (ip->ip_v4 == port_entries[i].re_net.ip_v4 &&
+                mask->ip_v4 == port_entries[i].re_mask.ip_v4)
+            return true;
     }
 
-    if (i >= TPG_ROUTE_PORT_TABLE_SIZE && free_entry == NULL) {
+    if (free_idx < 0) {
         INC_STATS(STATS_LOCAL(tpg_route_statistics_t, port), rs_tbl_full);
         return false;
     }
 
-    if (free_entry != NULL) {
-        /*
-         * Use new entry, and add it...
-         */
-        update_entry = free_entry;
-        update_entry->re_flags |= ROUTE_FLAG_IN_USE;
+    port_entries[free_idx] = ROUTE_V4(ip->ip_v4, mask->ip_v4,
+                                      RTE_IPV4(0, 0, 0, 0),
+                                      ROUTE_FLAG_IN_USE | ROUTE_FLAG_LOCAL);
+    port_entries[free_idx].re_vlan_id = vlan_id;
+
+    /* A 0.0.0.0 mask can't be stored in the LPM. route_v4_find_local() will
+     * find it through the local entries anyway.
+     */
+    depth = route_v4_mask_depth(mask->ip_v4);
+    if (depth == 0)
+        return true;
+
+    /* Keep the rule pointing to the first local IP in the network. Directly
+     * connected networks shadow static routes to the same prefix.
+     */
+    if (rte_lpm_is_rule_present(route_lpm_per_port[port], ip->ip_v4, depth,
+                                &nh_idx) == 1 &&
+            ROUTE_IS_FLAG_SET(&port_entries[nh_idx], ROUTE_FLAG_LOCAL))
+        return true;
+
+    /* Make sure the entry is visible before the LPM rule. */
+    rte_smp_wmb();
+    if (rte_lpm_add(route_lpm_per_port[port], ip->ip_v4, depth,
+                    free_idx) != 0) {
+        port_entries[free_idx].re_flags = 0;
+        INC_STATS(STATS_LOCAL(tpg_route_statistics_t, port), rs_tbl_full);
+        return false;
     }
-    *update_entry = ROUTE_V4(net->ip_v4, mask->ip_v4, nh->ip_v4,
-                             (update_entry->re_flags | flags));
 
     return true;
 }
 
 /*****************************************************************************
- * route_rem_entry()
+ * route_local_del()
  ****************************************************************************/
-static bool route_rem_entry(uint32_t port, tpg_ip_t *net, tpg_ip_t *mask)
+static bool route_local_del(uint32_t port, tpg_ip_t *ip, tpg_ip_t *mask)
 {
-    int            i;
-    route_entry_t *port_entries = route_per_port_table +
-                                  (TPG_ROUTE_PORT_TABLE_SIZE * port);
+    route_entry_t *port_entries = route_port_entries(port);
+    uint32_t       i;
 
-    for (i = 0; i < TPG_ROUTE_PORT_TABLE_SIZE; i++) {
+    for (i = TPG_ROUTE_LOCAL_BASE; i < TPG_ROUTE_STATIC_BASE; i++) {
         if (ROUTE_IS_FLAG_SET(&port_entries[i], ROUTE_FLAG_IN_USE) &&
-                port_entries[i].re_net.ip_v4 == net->ip_v4 &&
+                port_entries[i].re_net.ip_v4 == ip->ip_v4 &&
                 port_entries[i].re_mask.ip_v4 == mask->ip_v4) {
-            port_entries[i].re_flags &= ~ROUTE_FLAG_IN_USE;
+            route_lpm_del_entry(port, i);
+            port_entries[i].re_flags = 0;
             return true;
         }
     }
@@ -160,6 +258,96 @@ static bool route_rem_entry(uint32_t port, tpg_ip_t *net, tpg_ip_t *mask)
     return false;
 }
 
+/*****************************************************************************
+ * route_static_add()
+ *      Returns 0 on success, -EEXIST if the prefix is a directly connected
+ *      network and -ENOMEM if the table is full.
+ *      'gw_known' is set to true if other static routes already use the
+ *      same next hop.
+ ****************************************************************************/
+static int route_static_add(uint32_t port, tpg_ip_t *net, tpg_ip_t *mask,
+                            tpg_ip_t *gw,
+                            bool *gw_known)
+{
+    route_entry_t *port_entries = route_port_entries(port);
+    int            idx = -1;
+    uint32_t       nh_idx;
+    uint32_t       i;
+    uint8_t        depth;
+
+    depth = route_v4_mask_depth(mask->ip_v4);
+    if (depth == 0)
+        return -EINVAL;
+
+    *gw_known = false;
+
+    if (rte_lpm_is_rule_present(route_lpm_per_port[port], net->ip_v4, depth,
+                                &nh_idx) == 1) {
+        if (ROUTE_IS_FLAG_SET(&port_entries[nh_idx], ROUTE_FLAG_LOCAL)) {
+            INC_STATS(STATS_LOCAL(tpg_route_statistics_t, port),
+                      rs_route_exists);
+            return -EEXIST;
+        }
+
+        /* No ECMP support! Just update the next hop. */
+        idx = nh_idx;
+    }
+
+    for (i = TPG_ROUTE_STATIC_BASE; i < TPG_ROUTE_PORT_TABLE_SIZE; i++) {
+        if (!ROUTE_IS_FLAG_SET(&port_entries[i], ROUTE_FLAG_IN_USE)) {
+            if (idx < 0)
+                idx = i;
+
+            continue;
+        }
+
+        if (port_entries[i].re_nh.ip_v4 == gw->ip_v4) {
+            *gw_known = true;
+            if (idx >= 0)
+                break;
+        }
+    }
+
+    if (idx < 0) {
+        INC_STATS(STATS_LOCAL(tpg_route_statistics_t, port), rs_tbl_full);
+        return -ENOMEM;
+    }
+
+    port_entries[idx] = ROUTE_V4(net->ip_v4 & mask->ip_v4, mask->ip_v4,
+                                 gw->ip_v4,
+                                 ROUTE_FLAG_IN_USE);
+
+    /* Make sure the entry is visible before the LPM rule. */
+    rte_smp_wmb();
+    if (rte_lpm_add(route_lpm_per_port[port], net->ip_v4, depth, idx) != 0) {
+        port_entries[idx].re_flags = 0;
+        INC_STATS(STATS_LOCAL(tpg_route_statistics_t, port), rs_tbl_full);
+        return -ENOMEM;
+    }
+
+    return 0;
+}
+
+/*****************************************************************************
+ * route_static_del()
+ ****************************************************************************/
+static bool route_static_del(uint32_t port, tpg_ip_t *net, tpg_ip_t *mask)
+{
+    int idx;
+
+    idx = route_find_prefix(port, TPG_ROUTE_STATIC_BASE,
+                            TPG_ROUTE_PORT_TABLE_SIZE,
+                            net->ip_v4,
+                            mask->ip_v4,
+                            TPG_ROUTE_PORT_TABLE_SIZE);
+    if (idx < 0)
+        return false;
+
+    route_lpm_del_entry(port, idx);
+    route_port_entries(port)[idx].re_flags = 0;
+    return true;
+}
+
 /*****************************************************************************
  * route_intf_add_cb()
  ****************************************************************************/
@@ -187,10 +375,9 @@ static int route_intf_add_cb(uint16_t msgid, uint16_t lcore, void *msg)
     }
 
     nh_zero = TPG_IPV4(RTE_IPV4(0, 0, 0, 0));
-    if (!route_update_entry(add_msg->rim_eth_port, &add_msg->rim_ip,
-                            &add_msg->rim_mask,
-                            &nh_zero,
-                            ROUTE_FLAG_LOCAL)) {
+    if (!route_local_add(add_msg->rim_eth_port, &add_msg->rim_ip,
+                         &add_msg->rim_mask,
+                         add_msg->rim_vlan_id)) {
         INC_STATS(STATS_LOCAL(tpg_route_statistics_t, add_msg->rim_eth_port),
                   rs_intf_nomem);
         return -ENOMEM;
@@ -200,6 +387,8 @@ static int route_intf_add_cb(uint16_t msgid, uint16_t lcore, void *msg)
     INC_STATS(STATS_LOCAL(tpg_route_statistics_t, add_msg->rim_eth_port),
               rs_intf_add);
 
+    route_v4_nh_gen_bump(add_msg->rim_eth_port);
+
     arp_send_grat_arp_request(add_msg->rim_eth_port, add_msg->rim_ip.ip_v4,
                               add_msg->rim_vlan_id);
     arp_send_grat_arp_reply(add_msg->rim_eth_port, add_msg->rim_ip.ip_v4,
@@ -250,7 +439,7 @@ static int route_intf_del_cb(uint16_t msgid, uint16_t lcore __rte_unused,
         return -ENOENT;
     }
 
-    if (!route_rem_entry(del_msg->rim_eth_port, &del_msg->rim_ip,
+    if (!route_local_del(del_msg->rim_eth_port, &del_msg->rim_ip,
                          &del_msg->rim_mask)) {
         INC_STATS(STATS_LOCAL(tpg_route_statistics_t, del_msg->rim_eth_port),
                   rs_intf_notfound);
@@ -260,6 +449,8 @@ static int route_intf_del_cb(uint16_t msgid, uint16_t lcore __rte_unused,
     INC_STATS(STATS_LOCAL(tpg_route_statistics_t, del_msg->rim_eth_port),
               rs_intf_del);
 
+    route_v4_nh_gen_bump(del_msg->rim_eth_port);
+
     return 0;
 }
 
@@ -287,6 +478,8 @@ static int route_gw_add_cb(uint16_t msgid, uint16_t lcore, void *msg)
 
     INC_STATS(STATS_LOCAL(tpg_route_statistics_t, port), rs_gw_add);
 
+    route_v4_nh_gen_bump(port);
+
     /* Find local network matching default gw. */
     local_intf = route_v4_find_local(port,
                                      default_gw_per_port[port].re_nh.ip_v4);
@@ -331,6 +524,93 @@ static int route_gw_del_cb(uint16_t msgid, uint16_t lcore __rte_unused,
     INC_STATS(STATS_LOCAL(tpg_route_statistics_t, port), rs_gw_del);
 
     default_gw_per_port[port].re_flags &= ~ROUTE_FLAG_IN_USE;
+    route_v4_nh_gen_bump(port);
+
+    return 0;
+}
+
+/*****************************************************************************
+ * route_static_add_cb()
+ ****************************************************************************/
+static int route_static_add_cb(uint16_t msgid, uint16_t lcore, void *msg)
+{
+    route_static_add_msg_t *add_msg;
+    uint32_t                port;
+    route_entry_t          *local_intf;
+    bool                    gw_known;
+    int                     error;
+
+    if (MSG_INVALID(msgid, msg, MSG_ROUTE_STATIC_ADD))
+        return -EINVAL;
+
+    add_msg = msg;
+    port = add_msg->rsm_eth_port;
+
+    assert(PORT_CORE_DEFAULT(port) == lcore);
+
+    /* Don't touch the LPM table if the gateway isn't directly reachable. */
+    local_intf = route_v4_find_local(port, add_msg->rsm_gw.ip_v4);
+    if (!local_intf) {
+        INC_STATS(STATS_LOCAL(tpg_route_statistics_t, port), rs_gw_nointf);
+        return -EINVAL;
+    }
+
+    error = route_static_add(port, &add_msg->rsm_net, &add_msg->rsm_mask,
+                             &add_msg->rsm_gw,
+                             &gw_known);
+    if (error)
+        return error;
+
+    INC_STATS(STATS_LOCAL(tpg_route_statistics_t, port), rs_route_add);
+
+    route_v4_nh_gen_bump(port);
+
+    /* Next hops are usually shared by many routes, only ask once. */
+    if (gw_known)
+        return 0;
+
+    /* Sessions resolve the next hop on the VLAN of their interface. */
+    if (arp_lookup_mac(port, add_msg->rsm_gw.ip_v4,
+                       local_intf->re_vlan_id) != TPG_ARP_MAC_NOT_FOUND)
+        return 0;
+
+    arp_send_arp_request(port, local_intf->re_net.ip_v4,
+                         add_msg->rsm_gw.ip_v4,
+                         local_intf->re_vlan_id);
+
+    /*
+     * Flush the bulk tx queue to make sure the ARPs are sent.
+     */
+    pkt_flush_tx_q(port, STATS_LOCAL(tpg_port_statistics_t, port));
+    return 0;
+}
+
+/*****************************************************************************
+ * route_static_del_cb()
+ ****************************************************************************/
+static int route_static_del_cb(uint16_t msgid, uint16_t lcore __rte_unused,
+                               void *msg)
+{
+    route_static_del_msg_t *del_msg;
+    uint32_t                port;
+
+    if (MSG_INVALID(msgid, msg, MSG_ROUTE_STATIC_DEL))
+        return -EINVAL;
+
+    del_msg = msg;
+    port = del_msg->rsm_eth_port;
+
+    assert(PORT_CORE_DEFAULT(port) == lcore);
+
+    if (!route_static_del(port, &del_msg->rsm_net, &del_msg->rsm_mask)) {
+        INC_STATS(STATS_LOCAL(tpg_route_statistics_t, port),
+                  rs_route_not_found);
+        return -ENOENT;
+    }
+
+    INC_STATS(STATS_LOCAL(tpg_route_statistics_t, port), rs_route_del);
+
+    route_v4_nh_gen_bump(port);
 
     return 0;
 }
@@ -340,7 +620,8 @@ static int route_gw_del_cb(uint16_t msgid, uint16_t lcore __rte_unused,
  ****************************************************************************/
 bool route_init(void)
 {
-    int error;
+    uint32_t port;
+    int      error;
 
     /*
      * Add ROUTE module CLI commands
@@ -363,6 +644,35 @@ bool route_init(void)
         return false;
     }
 
+    route_lpm_per_port = rte_zmalloc("route_lpm_per_port",
+                                     rte_eth_dev_count_avail() *
+                                     sizeof(*route_lpm_per_port),
+                                     0);
+    if (route_lpm_per_port == NULL) {
+        RTE_LOG(ERR, USER1, "ERROR: Failed allocating ROUTE LPM memory!\n");
+        return false;
+    }
+
+    for (port = 0; port < rte_eth_dev_count_avail(); port++) {
+        struct rte_lpm_config lpm_cfg = {
+            .max_rules = TPG_ROUTE_PORT_TABLE_SIZE,
+            .number_tbl8s = TPG_ROUTE_LPM_TBL8_CNT,
+            .flags = 0,
+        };
+        char lpm_name[RTE_LPM_NAMESIZE];
+
+        snprintf(lpm_name, sizeof(lpm_name), "route_lpm_%"PRIu32, port);
+        route_lpm_per_port[port] = rte_lpm_create(lpm_name,
+                                                  rte_eth_dev_socket_id(port),
+                                                  &lpm_cfg);
+        if (route_lpm_per_port[port] == NULL) {
+            RTE_LOG(ERR, USER1,
+                    "ERROR: Failed allocating ROUTE LPM for port %"PRIu32": %s(%d)!\n",
+                    port, rte_strerror(rte_errno), rte_errno);
+            return false;
+        }
+    }
+
     gw_per_port_per_vlan = rte_zmalloc("gw_per_port_per_vlan",
                                        rte_eth_dev_count_avail() *
                                        TPG_GW_PORT_VLAN_SIZE *
@@ -383,6 +693,19 @@ bool route_init(void)
         return false;
     }
 
+    route_nh_gen_per_port = rte_zmalloc("route_nh_gen_per_port",
+                                        rte_eth_dev_count_avail() *
+                                        sizeof(*route_nh_gen_per_port),
+                                        RTE_CACHE_LINE_SIZE);
+    if (route_nh_gen_per_port == NULL) {
+        RTE_LOG(ERR, USER1,
+                "ERROR: Failed allocating next hop generation memory!\n");
+        return false;
+    }
+
+    for (port = 0; port < rte_eth_dev_count_avail(); port++)
+        route_nh_gen_per_port[port] = 1;
+
     /*
      * Allocate memory for ROUTE statistics, and clear all of them
      */
@@ -409,6 +732,14 @@ bool route_init(void)
         error = msg_register_handler(MSG_ROUTE_GW_DEL, route_gw_del_cb);
         if (error)
             break;
+        error = msg_register_handler(MSG_ROUTE_STATIC_ADD,
+                                     route_static_add_cb);
+        if (error)
+            break;
+        error = msg_register_handler(MSG_ROUTE_STATIC_DEL,
+                                     route_static_del_cb);
+        if (error)
+            break;
 
         return true;
     }
@@ -556,17 +887,86 @@ int route_v4_gw_del(uint32_t port, tpg_ip_t gw)
 }
 
 /*****************************************************************************
- * route_v4_nh_lookup()
- *  NOTES: the function directly returns the MAC address of the nexthop.
+ * route_v4_static_add()
  ****************************************************************************/
-uint64_t route_v4_nh_lookup(uint32_t port, uint32_t dest, uint16_t vlan_id)
+int route_v4_static_add(uint32_t port, tpg_ip_t net, tpg_ip_t mask,
+                        tpg_ip_t gw)
+{
+    MSG_LOCAL_DEFINE(route_static_add_msg_t, msg);
+    route_static_add_msg_t *add_msg;
+    msg_t                  *msgp;
+    int                     error;
+
+    msgp = MSG_LOCAL(msg);
+
+    msg_init(msgp, MSG_ROUTE_STATIC_ADD, PORT_CORE_DEFAULT(port), 0);
+
+    add_msg = MSG_INNER(route_static_add_msg_t, msgp);
+    add_msg->rsm_eth_port = port;
+    add_msg->rsm_net = net;
+    add_msg->rsm_mask = mask;
+    add_msg->rsm_gw = gw;
+
+    /* BLOCK waiting for msg to be processed */
+    error = msg_send(msgp, 0);
+    if (error)
+        TPG_ERROR_ABORT("ERROR: Failed to send static route add msg: %s(%d)!\n",
+                        rte_strerror(-error), -error);
+
+    return 0;
+}
+
+/*****************************************************************************
+ * route_v4_static_del()
+ ****************************************************************************/
+int route_v4_static_del(uint32_t port, tpg_ip_t net, tpg_ip_t mask,
+                        tpg_ip_t gw)
+{
+    MSG_LOCAL_DEFINE(route_static_del_msg_t, msg);
+    route_static_del_msg_t *del_msg;
+    msg_t                  *msgp;
+    int                     error;
+
+    msgp = MSG_LOCAL(msg);
+
+    msg_init(msgp, MSG_ROUTE_STATIC_DEL, PORT_CORE_DEFAULT(port), 0);
+
+    del_msg = MSG_INNER(route_static_del_msg_t, msgp);
+    del_msg->rsm_eth_port = port;
+    del_msg->rsm_net = net;
+    del_msg->rsm_mask = mask;
+    del_msg->rsm_gw = gw;
+
+    /* BLOCK waiting for msg to be processed */
+    error = msg_send(msgp, 0);
+    if (error)
+        TPG_ERROR_ABORT("ERROR: Failed to send static route del msg: %s(%d)!\n",
+                        rte_strerror(-error), -error);
+
+    return 0;
+}
+
+/*****************************************************************************
+ * route_v4_nh_resolve()
+ *      Resolves the next hop MAC once the LPM lookup is done. 're' is the
+ *      matching route entry or NULL if the LPM lookup failed.
+ ****************************************************************************/
+static inline uint64_t route_v4_nh_resolve(uint32_t port, uint32_t dest,
+                                           uint16_t vlan_id,
+                                           const route_entry_t *re)
 {
     uint64_t  nh_mac;
     tpg_ip_t *gw;
 
-    /* TODO: lookup directly connected networks.
-     * For now we use a hack and look for the ARP in case the destination
-     * is directly connected.
+    /* Static routes take precedence as long as their next hop is resolved. */
+    if (re != NULL && !ROUTE_IS_FLAG_SET(re, ROUTE_FLAG_LOCAL)) {
+        nh_mac = arp_lookup_mac(port, re->re_nh.ip_v4, vlan_id);
+        if (likely(nh_mac != TPG_ARP_MAC_NOT_FOUND))
+            return nh_mac;
+    }
+
+    /* For directly connected networks we use a hack and look for the ARP
+     * of the destination.
      */
     nh_mac = arp_lookup_mac(port, dest, vlan_id);
     if (nh_mac != TPG_ARP_MAC_NOT_FOUND)
@@ -592,16 +992,39 @@ uint64_t route_v4_nh_lookup(uint32_t port, uint32_t dest, uint16_t vlan_id)
     return nh_mac;
 }
 
+/*****************************************************************************
+ * route_v4_nh_lookup()
+ *  NOTES: the function directly returns the MAC address of the nexthop.
+ ****************************************************************************/
+uint64_t route_v4_nh_lookup(uint32_t port, uint32_t dest, uint16_t vlan_id)
+{
+    const route_entry_t *re = NULL;
+    uint32_t             idx;
+
+    if (rte_lpm_lookup(route_lpm_per_port[port], dest, &idx) == 0)
+        re = &route_port_entries(port)[idx];
+
+    return route_v4_nh_resolve(port, dest, vlan_id, re);
+}
+
 /*****************************************************************************
  * route_v4_find_local()
  ****************************************************************************/
 route_entry_t *route_v4_find_local(uint32_t port, uint32_t dest)
 {
     int            i;
-    route_entry_t *port_entries = route_per_port_table +
-                                  (TPG_ROUTE_PORT_TABLE_SIZE * port);
+    uint32_t       idx;
+    route_entry_t *port_entries = route_port_entries(port);
 
-    for (i = 0; i < TPG_ROUTE_PORT_TABLE_SIZE; i++) {
+    if (rte_lpm_lookup(route_lpm_per_port[port], dest, &idx) == 0 &&
+            ROUTE_IS_FLAG_SET(&port_entries[idx], ROUTE_FLAG_IN_USE) &&
+            ROUTE_IS_FLAG_SET(&port_entries[idx], ROUTE_FLAG_LOCAL))
+        return &port_entries[idx];
+
+    /* The network might be shadowed by a more specific static route or might
+     * not be in the LPM at all (0.0.0.0 mask). Walk the local entries.
+     */
+    for (i = TPG_ROUTE_LOCAL_BASE; i < TPG_ROUTE_STATIC_BASE; i++) {
         if (ROUTE_IS_FLAG_SET(&port_entries[i], ROUTE_FLAG_IN_USE) &&
                 ROUTE_IS_FLAG_SET(&port_entries[i], ROUTE_FLAG_LOCAL) &&
                 ((port_entries[i].re_net.ip_v4 & port_entries[i].re_mask.ip_v4) ==
@@ -683,6 +1106,14 @@ static void cmd_show_route_statistics_parsed(void *parsed_result __rte_unused,
                          port,
                          option);
 
+        SHOW_32BIT_STATS("Route Add", tpg_route_statistics_t, rs_route_add,
+                         port,
+                         option);
+
+        SHOW_32BIT_STATS("Route Del", tpg_route_statistics_t, rs_route_del,
+                         port,
+                         option);
+
         cmdline_printf(cl, "\n");
 
         SHOW_32BIT_STATS("Route Tbl Full", tpg_route_statistics_t, rs_tbl_full,
@@ -713,6 +1144,11 @@ static void cmd_show_route_statistics_parsed(void *parsed_result __rte_unused,
                          port,
                          option);
 
+        SHOW_32BIT_STATS("Route exists", tpg_route_statistics_t,
+                         rs_route_exists,
+                         port,
+                         option);
+
         cmdline_printf(cl, "\n");
     }
 
@@ -119,6 +119,16 @@ static void tpg_rpc__configure_l3_gw(Warp17_Service *service,
                                      Error_Closure closure,
                                      void *closure_data);
 
+static void tpg_rpc__configure_l3_route(Warp17_Service *service,
+                                        const L3RouteArg *input,
+                                        Error_Closure closure,
+                                        void *closure_data);
+
+static void tpg_rpc__get_l3_routes(Warp17_Service *service,
+                                   const L3RoutesArg *input,
+                                   L3RoutesResult_Closure closure,
+                                   void *closure_data);
+
 static void tpg_rpc__configure_test_case(Warp17_Service *service,
                                          const TestCase *input,
                                          Error_Closure closure,
@@ -782,6 +792,74 @@ static void tpg_rpc__configure_l3_gw(Warp17_Service *service __rte_unused,
     RPC_CLEANUP(L3GwArg, l3_gw_arg, Error, protoc_result);
 }
 
+/*****************************************************************************
+ * tpg_rpc__configure_l3_route()
+ ****************************************************************************/
+static void tpg_rpc__configure_l3_route(Warp17_Service *service __rte_unused,
+                                        const L3RouteArg *input,
+                                        Error_Closure closure,
+                                        void *closure_data)
+{
+    tpg_l3_route_arg_t l3_route_arg;
+    tpg_error_t        tpg_result;
+    Error              protoc_result;
+
+    RPC_INIT_DEFAULT(Error, &tpg_result);
+    if (RPC_REQUEST_INIT(L3RouteArg, input, &l3_route_arg))
+        return;
+
+    RPC_STORE_RETCODE(tpg_result,
+                      test_mgmt_add_port_cfg_l3_route(l3_route_arg.lra_eth_port,
+                                                      &l3_route_arg.lra_l3_route,
+                                                      NULL));
+    RPC_REPLY(Error, protoc_result, ERROR__INIT, tpg_result);
+    RPC_CLEANUP(L3RouteArg, l3_route_arg, Error, protoc_result);
+}
+
+/*****************************************************************************
+ * tpg_rpc__get_l3_routes()
+ ****************************************************************************/
+static void tpg_rpc__get_l3_routes(Warp17_Service *service __rte_unused,
+                                   const L3RoutesArg *input,
+                                   L3RoutesResult_Closure closure,
+                                   void *closure_data)
+{
+    tpg_l3_routes_arg_t     l3_routes_arg;
+    tpg_l3_routes_result_t  tpg_result;
+    L3RoutesResult          protoc_result;
+    const tpg_l3_route_t   *l3_routes;
+    uint32_t                count;
+    uint32_t                i;
+
+    RPC_INIT_DEFAULT(L3RoutesResult, &tpg_result);
+    if (RPC_REQUEST_INIT(L3RoutesArg, input, &l3_routes_arg))
+        return;
+
+    l3_routes = test_mgmt_get_port_cfg_l3_routes(l3_routes_arg.lrsa_eth_port,
+                                                 &count,
+                                                 NULL);
+    if (l3_routes) {
+        RPC_STORE_RETCODE(tpg_result.lrsr_error, 0);
+        tpg_result.lrsr_total = count;
+
+        /* Return one page of routes starting at lrsa_start. */
+        for (i = l3_routes_arg.lrsa_start;
+                i < count &&
+                tpg_result.lrsr_routes_count < TPG_L3_ROUTES_PER_PAGE;
+                i++) {
+            /* Struct copy. */
+            tpg_result.lrsr_routes[tpg_result.lrsr_routes_count] =
+                l3_routes[i];
+            tpg_result.lrsr_routes_count++;
+        }
+    } else {
+        RPC_STORE_RETCODE(tpg_result.lrsr_error, -ENOENT);
+    }
+    RPC_REPLY(L3RoutesResult, protoc_result, L3_ROUTES_RESULT__INIT,
+              tpg_result);
+    RPC_CLEANUP(L3RoutesArg, l3_routes_arg, L3RoutesResult, protoc_result);
+}
+
 /*****************************************************************************
  * tpg_rpc__update_test_case()
  ****************************************************************************/
@@ -67,6 +67,27 @@
  */
 STATS_DEFINE(tpg_tcp_statistics_t);
 
+/* Socket options used when replying on behalf of non-existent sessions. */
+static const sockopt_t tcp_closed_tcb_sockopt;
+
+/* TCBs that need an ACK at the end of the current RX burst. */
+static RTE_DEFINE_PER_LCORE(tcp_control_block_t *, tcp_ack_q)[TPG_RX_BURST_SIZE];
+static RTE_DEFINE_PER_LCORE(uint32_t, tcp_ack_q_len);
+
+/* TCBs closed by the application during the current RX burst that should be
+ * reset at the end of the burst.
+ */
+static RTE_DEFINE_PER_LCORE(tcp_control_block_t *, tcp_rst_q)[TPG_RX_BURST_SIZE];
+static RTE_DEFINE_PER_LCORE(uint32_t, tcp_rst_q_len);
+
+RTE_DEFINE_PER_LCORE(tcp_control_block_t *, tcp_rx_tcb);
+
+static const char *tcp_close_mode_names[TCP_CLOSE_MODE__TCP_CLOSE_MODE_MAX] = {
+    [TCP_CLOSE_MODE__GRACEFUL]       = "graceful",
+    [TCP_CLOSE_MODE__RST_AFTER_DATA] = "rst-after-data",
+    [TCP_CLOSE_MODE__RST_IMMEDIATE]  = "rst-immediate",
+};
+
 /*****************************************************************************
  * Forward declarations
  ****************************************************************************/
@@ -94,6 +115,9 @@ bool tcp_init(void)
         return false;
     }
 
+    tcp_syncookie_init();
+    tcp_fastopen_init();
+
     return true;
 }
 
@@ -257,8 +281,36 @@ void tcp_connection_cleanup(tcp_control_block_t *tcb)
 {
     TCB_CHECK(tcb);
 
-    /* Free any allocated memory. */
-    tlkp_free_tcb(tcb);
+    /* Free any allocated memory. Malloced TCBs are kept on the test case
+     * recycle stack so the next server session doesn't hit the mempool.
+     */
+    if (tcb->tcb_malloced)
+        tlkp_recycle_free_tcb(tcb);
+    else
+        tlkp_free_tcb(tcb);
+}
+
+/*****************************************************************************
+ * tcp_burst_dequeue()
+ *      Removes a tcb from the end of burst ACK and RST queues. The tcb might
+ *      still be in the ACK queue even if its ACK went out already with
+ *      another segment. The queues are empty outside RX bursts.
+ ****************************************************************************/
+static void tcp_burst_dequeue(tcp_control_block_t *tcb)
+{
+    uint32_t i;
+
+    for (i = 0; i < RTE_PER_LCORE(tcp_ack_q_len); i++) {
+        if (RTE_PER_LCORE(tcp_ack_q)[i] == tcb)
+            RTE_PER_LCORE(tcp_ack_q)[i] = NULL;
+    }
+
+    for (i = 0; i < RTE_PER_LCORE(tcp_rst_q_len); i++) {
+        if (RTE_PER_LCORE(tcp_rst_q)[i] == tcb)
+            RTE_PER_LCORE(tcp_rst_q)[i] = NULL;
+    }
+
+    tcb->tcb_ack_pending = false;
 }
 
 /*****************************************************************************
@@ -282,11 +334,14 @@ int tcp_close_connection(tcp_control_block_t *tcb, uint32_t flags)
         tlkp_delete_tcb(tcb);
 
         /* Cancel any scheduled timers. */
-        if (TCB_RTO_TMR_IS_SET(tcb))
-            tcp_timer_rto_cancel(&tcb->tcb_l4);
+        tcp_timer_rto_release(&tcb->tcb_l4);
         if (TCB_SLOW_TMR_IS_SET(tcb))
             tcp_timer_slow_cancel(&tcb->tcb_l4);
+        if (TCB_DELACK_TMR_IS_SET(tcb))
+            tcp_timer_delack_cancel(&tcb->tcb_l4);
 
+        /* The tcb might be freed before the end of the RX burst. */
+        tcp_burst_dequeue(tcb);
 
         /* Cleanup retrans queue. */
         if (tcb->tcb_retrans.tr_data_mbufs) {
@@ -295,12 +350,7 @@ int tcp_close_connection(tcp_control_block_t *tcb, uint32_t flags)
         }
 
         /* Cleanup recv buf. */
-        while (!LIST_EMPTY(&tcb->tcb_rcv_buf)) {
-            tcb_buf_hdr_t *recvbuf = tcb->tcb_rcv_buf.lh_first;
-
-            pkt_mbuf_free(recvbuf->tbh_mbuf);
-            LIST_REMOVE(recvbuf, tbh_entry);
-        }
+        tcp_data_rcvbuf_free(tcb);
 
         tcb->tcb_retrans.tr_data_mbufs = NULL;
         tcb->tcb_retrans.tr_total_size = 0;
@@ -333,13 +383,25 @@ void tcp_store_sockopt(tcp_sockopt_t *dest, const tpg_tcp_sockopt_t *options)
     dest->tcpo_data_retry_cnt = options->to_data_retry_cnt;
     dest->tcpo_retry_cnt = options->to_retry_cnt;
     dest->tcpo_rto = options->to_rto * 1000;
+    dest->tcpo_rto_min = options->to_rto_min * 1000;
+    dest->tcpo_rto_max = options->to_rto_max * 1000;
     dest->tcpo_fin_to = options->to_fin_to * 1000;
     dest->tcpo_twait_to = options->to_twait_to * 1000;
     dest->tcpo_orphan_to = options->to_orphan_to * 1000;
+    dest->tcpo_ack_delay_to = options->to_ack_delay_to * 1000;
+    dest->tcpo_cong_control = options->to_cong_control;
+    dest->tcpo_close_mode = options->to_close_mode;
+    dest->tcpo_win_scale = options->to_win_scale;
+    dest->tcpo_pmtu = options->to_pmtu;
 
     /* Bit flags. */
     dest->tcpo_skip_timewait = (options->to_skip_timewait > 0 ? true : false);
     dest->tcpo_ack_delay = (options->to_ack_delay > 0 ? true : false);
+    dest->tcpo_sack = (options->to_sack > 0 ? true : false);
+    dest->tcpo_timestamps = (options->to_timestamps > 0 ? true : false);
+    dest->tcpo_tso = (options->to_tso > 0 ? true : false);
+    dest->tcpo_syn_cookies = (options->to_syn_cookies > 0 ? true : false);
+    dest->tcpo_fast_open = (options->to_fast_open > 0 ? true : false);
 }
 
 /*****************************************************************************
@@ -359,18 +421,163 @@ void tcp_load_sockopt(tpg_tcp_sockopt_t *dest, const tcp_sockopt_t *options)
                                  options->tcpo_retry_cnt);
     TPG_XLATE_OPTIONAL_SET_FIELD(dest, to_rto,
                                  options->tcpo_rto / 1000);
+    TPG_XLATE_OPTIONAL_SET_FIELD(dest, to_rto_min,
+                                 options->tcpo_rto_min / 1000);
+    TPG_XLATE_OPTIONAL_SET_FIELD(dest, to_rto_max,
+                                 options->tcpo_rto_max / 1000);
     TPG_XLATE_OPTIONAL_SET_FIELD(dest, to_fin_to,
                                  options->tcpo_fin_to / 1000);
     TPG_XLATE_OPTIONAL_SET_FIELD(dest, to_twait_to,
                                  options->tcpo_twait_to / 1000);
     TPG_XLATE_OPTIONAL_SET_FIELD(dest, to_orphan_to,
                                  options->tcpo_orphan_to / 1000);
+    TPG_XLATE_OPTIONAL_SET_FIELD(dest, to_ack_delay_to,
+                                 options->tcpo_ack_delay_to / 1000);
+    TPG_XLATE_OPTIONAL_SET_FIELD(dest, to_cong_control,
+                                 options->tcpo_cong_control);
+    TPG_XLATE_OPTIONAL_SET_FIELD(dest, to_close_mode,
+                                 options->tcpo_close_mode);
+    TPG_XLATE_OPTIONAL_SET_FIELD(dest, to_win_scale,
+                                 options->tcpo_win_scale);
+    TPG_XLATE_OPTIONAL_SET_FIELD(dest, to_pmtu, options->tcpo_pmtu);
 
     /* Bit flags. */
     TPG_XLATE_OPTIONAL_SET_FIELD(dest, to_skip_timewait,
                                  options->tcpo_skip_timewait);
     TPG_XLATE_OPTIONAL_SET_FIELD(dest, to_ack_delay,
                                  options->tcpo_ack_delay);
+    TPG_XLATE_OPTIONAL_SET_FIELD(dest, to_sack,
+                                 options->tcpo_sack);
+    TPG_XLATE_OPTIONAL_SET_FIELD(dest, to_timestamps,
+                                 options->tcpo_timestamps);
+    TPG_XLATE_OPTIONAL_SET_FIELD(dest, to_tso,
+                                 options->tcpo_tso);
+    TPG_XLATE_OPTIONAL_SET_FIELD(dest, to_syn_cookies,
+                                 options->tcpo_syn_cookies);
+    TPG_XLATE_OPTIONAL_SET_FIELD(dest, to_fast_open,
+                                 options->tcpo_fast_open);
+}
+
+/*****************************************************************************
+ * tcp_close_mode_name()
+ ****************************************************************************/
+const char *tcp_close_mode_name(tpg_tcp_close_mode_t mode)
+{
+    if (mode >= TCP_CLOSE_MODE__TCP_CLOSE_MODE_MAX)
+        return "<unknown>";
+
+    return tcp_close_mode_names[mode];
+}
+
+/*****************************************************************************
+ * tcp_closed_tcb_init()
+ *      Initializes a (stack allocated) tcb that replies on behalf of a
+ *      session that doesn't exist (anymore).
+ ****************************************************************************/
+static void tcp_closed_tcb_init(tcp_control_block_t *closed_tcb,
+                                packet_control_block_t *pcb)
+{
+    bzero(closed_tcb, sizeof(*closed_tcb));
+
+    closed_tcb->tcb_l4.l4cb_valid = true;
+    closed_tcb->tcb_l4.l4cb_src_addr =
+        TPG_IPV4(rte_be_to_cpu_32(pcb->pcb_ipv4->dst_addr));
+    closed_tcb->tcb_l4.l4cb_dst_addr =
+        TPG_IPV4(rte_be_to_cpu_32(pcb->pcb_ipv4->src_addr));
+    closed_tcb->tcb_l4.l4cb_src_port = rte_be_to_cpu_16(pcb->pcb_tcp->dst_port);
+    closed_tcb->tcb_l4.l4cb_dst_port = rte_be_to_cpu_16(pcb->pcb_tcp->src_port);
+    closed_tcb->tcb_l4.l4cb_interface = pcb->pcb_port;
+    closed_tcb->tcb_l4.l4cb_domain = AF_INET;
+    closed_tcb->tcb_l4.l4cb_sockopt = &tcp_closed_tcb_sockopt;
+    closed_tcb->tcb_state = TS_CLOSED;
+}
+
+/*****************************************************************************
+ * tcp_listen_tcb_find()
+ ****************************************************************************/
+static tcp_control_block_t *tcp_listen_tcb_find(packet_control_block_t *pcb)
+{
+    tcp_control_block_t *tcb;
+    uint32_t             tcp_listen_hash;
+
+    tcp_listen_hash = tlkp_calc_pkt_hash(0, /* src_addr ANY */
+                                         pcb->pcb_ipv4->dst_addr,
+                                         0, /* src_port ANY */
+                                         pcb->pcb_tcp->dst_port);
+
+    tcb = tlkp_find_v4_tcb(pcb->pcb_port, tcp_listen_hash,
+                           rte_be_to_cpu_32(pcb->pcb_ipv4->dst_addr),
+                           0, /* src_addr ANY */
+                           rte_be_to_cpu_16(pcb->pcb_tcp->dst_port),
+                           0 /* src_port ANY */);
+
+    if (unlikely(tcb && tcb->tcb_state != TS_LISTEN)) {
+        TPG_ERROR_ABORT("[%d:%s()]expected tcb->s=%d found=%d\n",
+                        pcb->pcb_core_index,
+                        __func__,
+                        TS_LISTEN,
+                        tcb->tcb_state);
+    }
+
+    return tcb;
+}
+
+/*****************************************************************************
+ * tcp_receive_tw()
+ *      Processes segments for sessions that only have a TIME_WAIT record
+ *      left (RFC 793 [73], RFC 1122 4.2.2.13). Returns true if the segment
+ *      should be processed further (no record or a SYN reusing the tuple).
+ *      The 2MSL timeout is not restarted by retransmitted FINs, the record
+ *      doesn't store the timeout of the test case.
+ ****************************************************************************/
+static bool tcp_receive_tw(packet_control_block_t *pcb,
+                           tpg_tcp_statistics_t *stats)
+{
+    struct rte_tcp_hdr  *tcp_hdr = pcb->pcb_tcp;
+    tlkp_tw_entry_t     *tw;
+    tcp_control_block_t  tw_tcb;
+    uint32_t             seg_seq;
+
+    tw = tlkp_find_v4_tw(pcb->pcb_port,
+                         rte_be_to_cpu_32(pcb->pcb_ipv4->dst_addr),
+                         rte_be_to_cpu_32(pcb->pcb_ipv4->src_addr),
+                         rte_be_to_cpu_16(tcp_hdr->dst_port),
+                         rte_be_to_cpu_16(tcp_hdr->src_port));
+    if (likely(tw == NULL))
+        return true;
+
+    INC_STATS(stats, ts_tw_hits);
+
+    PKT_TRACE(pcb, TCP, DEBUG, "TIME_WAIT record found snd.nxt=%u rcv.nxt=%u",
+              tw->tw_snd_nxt,
+              tw->tw_rcv_nxt);
+
+    seg_seq = rte_be_to_cpu_32(tcp_hdr->sent_seq);
+
+    /* The window is 0 in TIME_WAIT so only an exact match is acceptable. */
+    if ((tcp_hdr->tcp_flags & RTE_TCP_RST_FLAG) != 0) {
+        INC_STATS(stats, ts_recv_rst);
+        if (SEG_EQ(seg_seq, tw->tw_rcv_nxt))
+            tlkp_delete_tw(tw);
+        return false;
+    }
+
+    /* A new incarnation of the session can reuse the tuple as long as it
+     * can't be confused with the old one.
+     */
+    if ((tcp_hdr->tcp_flags & RTE_TCP_SYN_FLAG) != 0 &&
+            SEG_GT(seg_seq, tw->tw_rcv_nxt)) {
+        tlkp_delete_tw(tw);
+        return true;
+    }
+
+    /* Send <SEQ=SND.NXT><ACK=RCV.NXT><CTL=ACK> */
+    tcp_closed_tcb_init(&tw_tcb, pcb);
+    tw_tcb.tcb_snd.nxt = tw->tw_snd_nxt;
+    tw_tcb.tcb_rcv.nxt = tw->tw_rcv_nxt;
+    tcp_send_ack_pkt(&tw_tcb);
+
+    return false;
 }
 
 /*****************************************************************************
@@ -540,39 +747,39 @@ struct rte_mbuf *tcp_receive_pkt(packet_control_block_t *pcb,
     pcb->pcb_mbuf = mbuf;
 
     /*
-     * First try known session lookup
+     * First try known session lookup. Most of the time the whole RX burst
+     * was already looked up by the packet loop.
      */
-    tcb = tlkp_find_v4_tcb(pcb->pcb_port, pcb->pcb_hash,
-                           rte_be_to_cpu_32(pcb->pcb_ipv4->dst_addr),
-                           rte_be_to_cpu_32(pcb->pcb_ipv4->src_addr),
-                           rte_be_to_cpu_16(tcp_hdr->dst_port),
-                           rte_be_to_cpu_16(tcp_hdr->src_port));
+    if (unlikely(!tlkp_pcb_tcb_get(pcb, &tcb))) {
+        tcb = tlkp_find_v4_tcb(pcb->pcb_port, pcb->pcb_hash,
+                               rte_be_to_cpu_32(pcb->pcb_ipv4->dst_addr),
+                               rte_be_to_cpu_32(pcb->pcb_ipv4->src_addr),
+                               rte_be_to_cpu_16(tcp_hdr->dst_port),
+                               rte_be_to_cpu_16(tcp_hdr->src_port));
+    }
+
+    /*
+     * Sessions in TIME_WAIT only have a compact record left.
+     */
+    if (tcb == NULL && !tcp_receive_tw(pcb, stats))
+        return mbuf;
 
     /*
      * If no existing tcb see if we have a server available that is
      * accepting new requests.
      */
     if (tcb == NULL && (tcp_hdr->tcp_flags & RTE_TCP_SYN_FLAG) != 0) {
-        uint32_t tcp_listen_hash;
-
-        tcp_listen_hash = tlkp_calc_pkt_hash(0, /* src_addr ANY */
-                                             pcb->pcb_ipv4->dst_addr,
-                                             0, /* src_port ANY */
-                                             tcp_hdr->dst_port);
-
-        tcb = tlkp_find_v4_tcb(pcb->pcb_port, tcp_listen_hash,
-                               rte_be_to_cpu_32(pcb->pcb_ipv4->dst_addr),
-                               0, /* src_addr ANY */
-                               rte_be_to_cpu_16(tcp_hdr->dst_port),
-                               0 /* src_port ANY */);
-
-        if (unlikely(tcb && tcb->tcb_state != TS_LISTEN)) {
-            TPG_ERROR_ABORT("[%d:%s()]expected tcb->s=%d found=%d\n",
-                            pcb->pcb_core_index,
-                            __func__,
-                            TS_LISTEN,
-                            tcb->tcb_state);
-        }
+        tcb = tcp_listen_tcb_find(pcb);
+    } else if (tcb == NULL &&
+               (tcp_hdr->tcp_flags & (RTE_TCP_ACK_FLAG | RTE_TCP_RST_FLAG)) ==
+                    RTE_TCP_ACK_FLAG) {
+        /* Servers using SYN cookies only allocate the tcb when the final
+         * ACK of the handshake arrives.
+         */
+        tcb = tcp_listen_tcb_find(pcb);
+        if (tcb != NULL &&
+                !tcp_get_sockopt(tcb->tcb_l4.l4cb_sockopt)->tcpo_syn_cookies)
+            tcb = NULL;
     }
 
     if (tcb != NULL) {
@@ -586,9 +793,13 @@ struct rte_mbuf *tcp_receive_pkt(packet_control_block_t *pcb,
 
         PKT_TRACE(pcb, TCP, DEBUG, "tcb found in state(%d)", tcb->tcb_state);
 
-        pcb->pcb_sockopt = &tcb->tcb_l4.l4cb_sockopt;
+        pcb->pcb_rx_cb = &tcb->tcb_l4;
 
-        tsm_dispatch_net_event(tcb, TE_SEGMENT_ARRIVES, pcb);
+        /* Header prediction first, the state machine handles the rest. */
+        RTE_PER_LCORE(tcp_rx_tcb) = tcb;
+        if (tcb->tcb_state != TS_ESTABLISHED || !tsm_fast_path(tcb, pcb))
+            tsm_dispatch_net_event(tcb, TE_SEGMENT_ARRIVES, pcb);
+        RTE_PER_LCORE(tcp_rx_tcb) = NULL;
 
         /* If the stack decided to keep this packet we shouldn' allow the
          * rest of the code to free it.
@@ -605,19 +816,7 @@ struct rte_mbuf *tcp_receive_pkt(packet_control_block_t *pcb,
 
         INC_STATS(stats, ts_tcb_not_found);
 
-        bzero(&closed_tcb, sizeof(closed_tcb));
-
-        closed_tcb.tcb_l4.l4cb_valid = true;
-        closed_tcb.tcb_l4.l4cb_src_addr =
-            TPG_IPV4(rte_be_to_cpu_32(pcb->pcb_ipv4->dst_addr));
-        closed_tcb.tcb_l4.l4cb_dst_addr =
-            TPG_IPV4(rte_be_to_cpu_32(pcb->pcb_ipv4->src_addr));
-        closed_tcb.tcb_l4.l4cb_src_port = rte_be_to_cpu_16(tcp_hdr->dst_port);
-        closed_tcb.tcb_l4.l4cb_dst_port = rte_be_to_cpu_16(tcp_hdr->src_port);
-        closed_tcb.tcb_l4.l4cb_interface = pcb->pcb_port;
-        closed_tcb.tcb_l4.l4cb_domain = AF_INET;
-        closed_tcb.tcb_state = TS_CLOSED;
-
+        tcp_closed_tcb_init(&closed_tcb, pcb);
         tsm_dispatch_net_event(&closed_tcb, TE_SEGMENT_ARRIVES, pcb);
     }
 
@@ -631,19 +830,22 @@ static struct rte_tcp_hdr *tcp_build_hdr(tcp_control_block_t *tcb,
                                          struct rte_mbuf *mbuf,
                                          struct rte_ipv4_hdr *ipv4_hdr,
                                          uint32_t sseq,
-                                         uint32_t flags)
+                                         uint32_t flags,
+                                         uint16_t opts_len)
 {
-    uint16_t            tcp_hdr_len = sizeof(struct rte_tcp_hdr);
+    uint16_t            tcp_hdr_len = sizeof(struct rte_tcp_hdr) + opts_len;
     uint16_t            tcp_hdr_offset = rte_pktmbuf_data_len(mbuf);
     struct rte_tcp_hdr *tcp_hdr;
     uint32_t            ip_hdr_len;
 
-    /* TODO: Support options, we need more room */
     tcp_hdr = (struct rte_tcp_hdr *) rte_pktmbuf_append(mbuf, tcp_hdr_len);
 
     if (unlikely(!tcp_hdr))
         return NULL;
 
+    if (unlikely(opts_len != 0))
+        tcp_hdr_opts_build(tcb, flags, (uint8_t *)(tcp_hdr + 1));
+
     tcp_hdr->src_port = rte_cpu_to_be_16(tcb->tcb_l4.l4cb_src_port);
     tcp_hdr->dst_port = rte_cpu_to_be_16(tcb->tcb_l4.l4cb_dst_port);
     if ((flags & TCP_BUILD_FLAG_USE_ISS) != 0)
@@ -653,22 +855,34 @@ static struct rte_tcp_hdr *tcp_build_hdr(tcp_control_block_t *tcb,
     tcp_hdr->recv_ack = rte_cpu_to_be_32(tcb->tcb_rcv.nxt);
     tcp_hdr->data_off = tcp_hdr_len >> 2 << 4;
     tcp_hdr->tcp_flags = flags & TCP_BUILD_FLAG_MASK;
-    tcp_hdr->rx_win = rte_cpu_to_be_16(tcb->tcb_rcv.wnd);
+    tcp_hdr->rx_win = rte_cpu_to_be_16(tcp_adv_wnd(tcb, flags));
     tcp_hdr->tcp_urp = rte_cpu_to_be_16(0); /* TODO: set correctly if urgen flag is set */
     mbuf->l4_len = tcp_hdr_len;
 
-    /*
-     * TODO: Do we want TCP segmentation offload, if so do it before
-     *       calculating the checksum!
+    ip_hdr_len = ((ipv4_hdr->version_ihl & 0x0F) << 2);
+
+    /* The NIC cuts the payload in segments of at most TCB_MTU() bytes
+     * (options included) and fixes up the IP/TCP headers of each of them.
+     * The pseudo header checksum must not include the length then.
      */
+    if (unlikely(flags & TCP_BUILD_FLAG_TSO)) {
+        uint32_t seg_len = TCB_MTU(tcb) - opts_len;
+
+        if (rte_be_to_cpu_16(ipv4_hdr->total_length) - ip_hdr_len -
+                tcp_hdr_len > seg_len) {
+            mbuf->ol_flags |= PKT_TX_TCP_SEG | PKT_TX_IPV4 | PKT_TX_IP_CKSUM;
+            mbuf->tso_segsz = seg_len;
+            tcp_hdr->cksum = ipv4_udptcp_phdr_cksum(ipv4_hdr, 0);
+            return tcp_hdr;
+        }
+    }
 
 #if !defined(TPG_SW_CHECKSUMMING)
     if (true) {
 #else
-    if (tcb->tcb_l4.l4cb_sockopt.so_eth.ethso_tx_offload_tcp_cksum) {
+    if (tcb->tcb_l4.l4cb_sockopt->so_eth.ethso_tx_offload_tcp_cksum) {
 #endif
         mbuf->ol_flags |= PKT_TX_TCP_CKSUM | PKT_TX_IPV4;
-        ip_hdr_len = ((ipv4_hdr->version_ihl & 0x0F) << 2);
         tcp_hdr->cksum =
             ipv4_udptcp_phdr_cksum(ipv4_hdr,
                                    rte_cpu_to_be_16(ipv4_hdr->total_length) -
@@ -698,14 +912,17 @@ static struct rte_mbuf *tcp_build_hdr_mbuf(tcp_control_block_t *tcb,
 {
     struct rte_mbuf *mbuf;
     struct rte_ipv4_hdr *ip_hdr;
+    uint16_t             opts_len;
 
     if (tcb->tcb_l4.l4cb_domain != AF_INET) {
         TPG_ERROR_ABORT("TODO: TCP = IPv4 only for now!\n");
         return NULL;
     }
 
+    opts_len = tcp_hdr_opts_len(tcb, flags);
+
     mbuf = ipv4_build_hdr_mbuf(&tcb->tcb_l4, IPPROTO_TCP,
-                               sizeof(struct rte_tcp_hdr) + l4_len,
+                               sizeof(struct rte_tcp_hdr) + opts_len + l4_len,
                                &ip_hdr);
     if (unlikely(!mbuf))
         return NULL;
@@ -714,7 +931,7 @@ static struct rte_mbuf *tcp_build_hdr_mbuf(tcp_control_block_t *tcb,
      * Build TCP header
      */
 
-    *tcp_hdr_p = tcp_build_hdr(tcb, mbuf, ip_hdr, sseq, flags);
+    *tcp_hdr_p = tcp_build_hdr(tcb, mbuf, ip_hdr, sseq, flags, opts_len);
     if (unlikely(!(*tcp_hdr_p))) {
         pkt_mbuf_free(mbuf);
         return NULL;
@@ -746,13 +963,23 @@ static bool tcp_send_pkt(tcp_control_block_t *tcb, uint32_t sseq,
         return false;
     }
 
+    /* Any segment we send acks everything received so far so pending
+     * (delayed) ACKs are not needed anymore.
+     */
+    if (likely(flags & RTE_TCP_ACK_FLAG)) {
+        tcb->tcb_rcv_acked = tcb->tcb_rcv.nxt;
+        tcb->tcb_ack_pending = false;
+        if (unlikely(TCB_DELACK_TMR_IS_SET(tcb)))
+            tcp_timer_delack_cancel(&tcb->tcb_l4);
+    }
+
     /* Perform TX timestamp propagation if needed. */
     if (data_pkt_len)
         tstamp_data_append(hdr, data_mbuf);
 
 #if defined(TPG_SW_CHECKSUMMING)
     if (data_mbuf &&
-            !tcb->tcb_l4.l4cb_sockopt.so_eth.ethso_tx_offload_tcp_cksum) {
+            !tcb->tcb_l4.l4cb_sockopt->so_eth.ethso_tx_offload_tcp_cksum) {
         if ((DATA_IS_TSTAMP(data_mbuf))) {
             tstamp_write_cksum_offset(hdr,
                                       hdr->pkt_len - sizeof(struct rte_tcp_hdr) +
@@ -776,7 +1003,7 @@ static bool tcp_send_pkt(tcp_control_block_t *tcb, uint32_t sseq,
     /* We need to update the checksum in the TCP part now the data has been added */
 #if defined(TPG_SW_CHECKSUMMING)
     if (data_mbuf &&
-            !tcb->tcb_l4.l4cb_sockopt.so_eth.ethso_tx_offload_tcp_cksum) {
+            !tcb->tcb_l4.l4cb_sockopt->so_eth.ethso_tx_offload_tcp_cksum) {
         tcp_hdr->cksum = ipv4_update_general_l4_cksum(tcp_hdr->cksum,
                                                       data_mbuf);
     }
@@ -889,6 +1116,113 @@ bool tcp_send_ack_pkt(tcp_control_block_t *tcb)
     return true;
 }
 
+/*****************************************************************************
+ * tcp_send_ack_burst()
+ *      Queues an ACK to be sent at the end of the current RX burst. All the
+ *      segments received for the tcb in the burst are acked at once.
+ ****************************************************************************/
+void tcp_send_ack_burst(tcp_control_block_t *tcb)
+{
+    uint32_t *ack_q_len = &RTE_PER_LCORE(tcp_ack_q_len);
+
+    TCB_CHECK(tcb);
+
+    if (tcb->tcb_ack_pending)
+        return;
+
+    if (unlikely(*ack_q_len == TPG_RX_BURST_SIZE)) {
+        tcp_send_ack_pkt(tcb);
+        return;
+    }
+
+    tcb->tcb_ack_pending = true;
+    RTE_PER_LCORE(tcp_ack_q)[(*ack_q_len)++] = tcb;
+}
+
+/*****************************************************************************
+ * tcp_send_ack_delayed()
+ *      RFC 1122 delayed ACK: ack at least every second full sized segment,
+ *      otherwise leave it to the delayed ACK timer (or to the next segment
+ *      we send).
+ ****************************************************************************/
+void tcp_send_ack_delayed(tcp_control_block_t *tcb)
+{
+    const tcp_sockopt_t *tcp_opts;
+
+    TCB_CHECK(tcb);
+
+    tcp_opts = tcp_get_sockopt(tcb->tcb_l4.l4cb_sockopt);
+
+    if (!tcp_opts->tcpo_ack_delay ||
+            SEG_DIFF(tcb->tcb_rcv.nxt, tcb->tcb_rcv_acked) >=
+                2 * TCB_LOCAL_MSS(tcb)) {
+        tcp_send_ack_burst(tcb);
+        return;
+    }
+
+    if (!TCB_DELACK_TMR_IS_SET(tcb) &&
+            tcp_timer_delack_set(&tcb->tcb_l4,
+                                 tcp_opts->tcpo_ack_delay_to) != 0) {
+        /* Better ack now than never. */
+        tcp_send_ack_burst(tcb);
+    }
+}
+
+/*****************************************************************************
+ * tcp_rst_close_burst()
+ *      Queues a tcb closed by the application while one of its segments was
+ *      being processed. The tcb is reset at the end of the RX burst.
+ ****************************************************************************/
+void tcp_rst_close_burst(tcp_control_block_t *tcb)
+{
+    uint32_t *rst_q_len = &RTE_PER_LCORE(tcp_rst_q_len);
+
+    TCB_CHECK(tcb);
+
+    /* Can't happen as a tcb is queued at most once and only while one of
+     * the burst segments is processed. If it does, the RST is sent once
+     * the peer acks the outstanding data.
+     */
+    if (unlikely(*rst_q_len == TPG_RX_BURST_SIZE))
+        return;
+
+    RTE_PER_LCORE(tcp_rst_q)[(*rst_q_len)++] = tcb;
+}
+
+/*****************************************************************************
+ * tcp_ack_flush()
+ *      Resets the sessions closed during the current RX burst and sends the
+ *      ACKs queued for the others. Freed TCBs are removed from both queues
+ *      so the resets go first.
+ ****************************************************************************/
+void tcp_ack_flush(void)
+{
+    uint32_t i;
+
+    for (i = 0; i < RTE_PER_LCORE(tcp_rst_q_len); i++) {
+        tcp_control_block_t *tcb = RTE_PER_LCORE(tcp_rst_q)[i];
+
+        if (tcb == NULL)
+            continue;
+
+        tsm_rst_close_deferred(tcb);
+    }
+
+    RTE_PER_LCORE(tcp_rst_q_len) = 0;
+
+    for (i = 0; i < RTE_PER_LCORE(tcp_ack_q_len); i++) {
+        tcp_control_block_t *tcb = RTE_PER_LCORE(tcp_ack_q)[i];
+
+        if (tcb == NULL || !tcb->tcb_ack_pending)
+            continue;
+
+        tcb->tcb_ack_pending = false;
+        tcp_send_ack_pkt(tcb);
+    }
+
+    RTE_PER_LCORE(tcp_ack_q_len) = 0;
+}
+
 /*****************************************************************************
  * tcb_clone()
  ****************************************************************************/
@@ -903,7 +1237,8 @@ tcp_control_block_t *tcb_clone(tcp_control_block_t *tcb)
 
     stats = STATS_LOCAL(tpg_tcp_statistics_t, tcb->tcb_l4.l4cb_interface);
 
-    new_tcb = tlkp_alloc_tcb();
+    new_tcb = tlkp_recycle_alloc_tcb(tcb->tcb_l4.l4cb_interface,
+                                     tcb->tcb_l4.l4cb_test_case_id);
     if (unlikely(new_tcb == NULL)) {
         INC_STATS(stats, ts_tcb_alloc_err);
         return NULL;
@@ -1102,6 +1437,67 @@ static void cmd_show_tcp_statistics_parsed(void *parsed_result __rte_unused,
                          option);
 
         cmdline_printf(cl, "\n");
+
+        SHOW_64BIT_STATS("TIME_WAIT records", tpg_tcp_statistics_t,
+                         ts_tw_added,
+                         port,
+                         option);
+
+        SHOW_64BIT_STATS("TIME_WAIT hits", tpg_tcp_statistics_t,
+                         ts_tw_hits,
+                         port,
+                         option);
+
+        SHOW_32BIT_STATS("TIME_WAIT table full", tpg_tcp_statistics_t,
+                         ts_tw_full,
+                         port,
+                         option);
+
+        cmdline_printf(cl, "\n");
+
+        SHOW_64BIT_STATS("SYN cookies sent", tpg_tcp_statistics_t,
+                         ts_syncookies_sent,
+                         port,
+                         option);
+
+        SHOW_64BIT_STATS("SYN cookies valid", tpg_tcp_statistics_t,
+                         ts_syncookies_ok,
+                         port,
+                         option);
+
+        SHOW_32BIT_STATS("SYN cookies invalid", tpg_tcp_statistics_t,
+                         ts_syncookies_bad,
+                         port,
+                         option);
+
+        cmdline_printf(cl, "\n");
+
+        SHOW_64BIT_STATS("TFO SYNs with data", tpg_tcp_statistics_t,
+                         ts_tfo_syn_data,
+                         port,
+                         option);
+
+        SHOW_64BIT_STATS("TFO SYN data acked", tpg_tcp_statistics_t,
+                         ts_tfo_syn_data_acked,
+                         port,
+                         option);
+
+        SHOW_64BIT_STATS("TFO cookies sent", tpg_tcp_statistics_t,
+                         ts_tfo_cookies_sent,
+                         port,
+                         option);
+
+        SHOW_64BIT_STATS("TFO SYN data accepted", tpg_tcp_statistics_t,
+                         ts_tfo_syn_data_ok,
+                         port,
+                         option);
+
+        SHOW_32BIT_STATS("TFO cookies invalid", tpg_tcp_statistics_t,
+                         ts_tfo_cookies_bad,
+                         port,
+                         option);
+
+        cmdline_printf(cl, "\n");
     }
 
 }
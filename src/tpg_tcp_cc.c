@@ -0,0 +1,374 @@
+/*
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER
+ *
+ * Copyright (c) 2026, Juniper Networks, Inc. All rights reserved.
+ *
+ *
+ * The contents of this file are subject to the terms of the BSD 3 clause
+ * License (the "License"). You may not use this file except in compliance
+ * with the License.
+ *
+ * You can obtain a copy of the license at
+ * https://github.com/Juniper/warp17/blob/master/LICENSE.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from this
+ * software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * File name:
+ *     tpg_tcp_cc.c
+ *
+ * Description:
+ *     TCP congestion control algorithms: NewReno (RFC 5681/6582) and
+ *     CUBIC (RFC 8312).
+ *
+ * Author:
+ *     Dumitru Ceara, Eelco Chaudron
+ *
+ * Initial Created:
+ *     10/17/2026
+ *
+ * Notes:
+ *     All windows are in bytes.
+ *
+ */
+
+/*****************************************************************************
+ * Include files
+ ****************************************************************************/
+#include "tcp_generator.h"
+
+/*****************************************************************************
+ * Local definitions
+ ****************************************************************************/
+/* CUBIC constants (RFC 8312): C = 0.4, beta = 0.7. */
+#define TCP_CUBIC_BETA_NUM        7
+#define TCP_CUBIC_BETA_DEN       10
+
+/* Fast convergence: W_max = cwnd * (1 + beta) / 2. */
+#define TCP_CUBIC_FC_NUM         17
+#define TCP_CUBIC_FC_DEN         20
+
+/* TCP friendly region: alpha = 3 * (1 - beta) / (1 + beta) = 9 / 17. */
+#define TCP_CUBIC_ALPHA_NUM       9
+#define TCP_CUBIC_ALPHA_DEN      17
+
+/* K^3 (ms^3) per millisegment of window reduction: 1e9 / C / 1000. */
+#define TCP_CUBIC_K3_PER_MSEG    2500000ULL
+
+/* Cap (ms) for |t - K| so that the cube can't overflow. */
+#define TCP_CUBIC_MAX_OFFS_MS    100000
+
+/*****************************************************************************
+ * tcp_cc_now_ms()
+ ****************************************************************************/
+static inline uint32_t tcp_cc_now_ms(void)
+{
+    return rte_get_timer_cycles() / cycles_per_us / 1000;
+}
+
+/*****************************************************************************
+ * tcp_cc_cbrt()
+ *      Integer cube root (Hacker's Delight, icbrt64).
+ ****************************************************************************/
+static uint32_t tcp_cc_cbrt(uint64_t x)
+{
+    uint64_t y = 0;
+    uint64_t b;
+    int      s;
+
+    for (s = 63; s >= 0; s -= 3) {
+        y += y;
+        b = 3 * y * (y + 1) + 1;
+        if ((x >> s) >= b) {
+            x -= b << s;
+            y++;
+        }
+    }
+
+    return y;
+}
+
+/*****************************************************************************
+ * tcp_cc_slow_start()
+ *      RFC 5681: cwnd += min(N, SMSS). Returns the acked bytes that weren't
+ *      used for slow start (if we just crossed ssthresh).
+ ****************************************************************************/
+static uint32_t tcp_cc_slow_start(tcp_control_block_t *tcb, uint32_t acked,
+                                  uint32_t mss)
+{
+    tcb_snd_t *snd = &tcb->tcb_snd;
+    uint32_t   incr = TPG_MIN(acked, mss);
+
+    if (snd->cwnd + incr > snd->ssthresh)
+        incr = snd->ssthresh - snd->cwnd;
+
+    snd->cwnd += incr;
+    return acked - incr;
+}
+
+/*****************************************************************************
+ * NewReno
+ ****************************************************************************/
+
+/*****************************************************************************
+ * tcp_newreno_init()
+ ****************************************************************************/
+static void tcp_newreno_init(tcp_control_block_t *tcb, uint32_t mss)
+{
+    tcb->tcb_snd.cwnd = TCP_CC_INIT_WND(mss);
+    tcb->tcb_snd.ssthresh = UINT32_MAX;
+    tcb->tcb_cc.cc_newreno.nr_bytes_acked = 0;
+}
+
+/*****************************************************************************
+ * tcp_newreno_ack()
+ *      Slow start below ssthresh, otherwise congestion avoidance with
+ *      appropriate byte counting: one MSS per cwnd worth of acked data.
+ ****************************************************************************/
+static void tcp_newreno_ack(tcp_control_block_t *tcb, uint32_t acked,
+                            uint32_t mss)
+{
+    tcb_snd_t        *snd = &tcb->tcb_snd;
+    tcb_cc_newreno_t *nr = &tcb->tcb_cc.cc_newreno;
+
+    if (snd->cwnd < snd->ssthresh) {
+        acked = tcp_cc_slow_start(tcb, acked, mss);
+        if (acked == 0)
+            return;
+    }
+
+    nr->nr_bytes_acked += acked;
+    if (nr->nr_bytes_acked >= snd->cwnd) {
+        nr->nr_bytes_acked -= snd->cwnd;
+        snd->cwnd += mss;
+    }
+}
+
+/*****************************************************************************
+ * tcp_newreno_loss()
+ ****************************************************************************/
+static void tcp_newreno_loss(tcp_control_block_t *tcb, uint32_t mss)
+{
+    tcb->tcb_snd.ssthresh = TCP_CC_LOSS_SSTHRESH(tcp_cc_flight_size(tcb),
+                                                 mss);
+    tcb->tcb_snd.cwnd = tcb->tcb_snd.ssthresh;
+    tcb->tcb_cc.cc_newreno.nr_bytes_acked = 0;
+}
+
+/*****************************************************************************
+ * tcp_newreno_rto()
+ ****************************************************************************/
+static void tcp_newreno_rto(tcp_control_block_t *tcb, bool first, uint32_t mss)
+{
+    /* RFC 5681: ssthresh must not be reduced again for consecutive timeouts
+     * of the same data.
+     */
+    if (first)
+        tcb->tcb_snd.ssthresh =
+            TCP_CC_LOSS_SSTHRESH(tcp_cc_flight_size(tcb), mss);
+
+    tcb->tcb_snd.cwnd = TCP_CC_LOSS_WND(mss);
+    tcb->tcb_cc.cc_newreno.nr_bytes_acked = 0;
+}
+
+static const tcp_cc_ops_t tcp_newreno_ops = {
+    .cco_init = tcp_newreno_init,
+    .cco_ack  = tcp_newreno_ack,
+    .cco_loss = tcp_newreno_loss,
+    .cco_rto  = tcp_newreno_rto,
+};
+
+/*****************************************************************************
+ * CUBIC
+ ****************************************************************************/
+
+/*****************************************************************************
+ * tcp_cubic_init()
+ ****************************************************************************/
+static void tcp_cubic_init(tcp_control_block_t *tcb, uint32_t mss)
+{
+    tcb->tcb_snd.cwnd = TCP_CC_INIT_WND(mss);
+    tcb->tcb_snd.ssthresh = UINT32_MAX;
+    bzero(&tcb->tcb_cc.cc_cubic, sizeof(tcb->tcb_cc.cc_cubic));
+}
+
+/*****************************************************************************
+ * tcp_cubic_epoch_start()
+ ****************************************************************************/
+static void tcp_cubic_epoch_start(tcp_control_block_t *tcb, uint32_t now_ms,
+                                  uint32_t mss)
+{
+    tcb_cc_cubic_t *cu = &tcb->tcb_cc.cc_cubic;
+    uint32_t        cwnd = tcb->tcb_snd.cwnd;
+
+    cu->cu_epoch_start = now_ms;
+    cu->cu_epoch_valid = true;
+    cu->cu_w_est = cwnd;
+
+    if (cwnd < cu->cu_w_max) {
+        /* K = cbrt((W_max - cwnd) / C), computed in milliseconds. */
+        cu->cu_k = tcp_cc_cbrt((uint64_t)(cu->cu_w_max - cwnd) * 1000 / mss *
+                               TCP_CUBIC_K3_PER_MSEG);
+    } else {
+        cu->cu_k = 0;
+        cu->cu_w_max = cwnd;
+    }
+}
+
+/*****************************************************************************
+ * tcp_cubic_target()
+ *      W_cubic(t) = C * (t - K)^3 + W_max
+ ****************************************************************************/
+static uint32_t tcp_cubic_target(const tcb_cc_cubic_t *cu, uint32_t t_ms,
+                                 uint32_t mss)
+{
+    uint64_t offs;
+    uint64_t delta;
+
+    offs = (t_ms > cu->cu_k) ? (t_ms - cu->cu_k) : (cu->cu_k - t_ms);
+    offs = TPG_MIN(offs, TCP_CUBIC_MAX_OFFS_MS);
+
+    /* C * offs^3 segments with offs in ms and C = 0.4 / 1e9 per ms^3. */
+    delta = (offs * offs * offs / 1000) * mss / TCP_CUBIC_K3_PER_MSEG;
+
+    if (t_ms < cu->cu_k)
+        return (delta < cu->cu_w_max) ? cu->cu_w_max - delta : 0;
+
+    return TPG_MIN((uint64_t)cu->cu_w_max + delta, UINT32_MAX);
+}
+
+/*****************************************************************************
+ * tcp_cubic_ack()
+ ****************************************************************************/
+static void tcp_cubic_ack(tcp_control_block_t *tcb, uint32_t acked,
+                          uint32_t mss)
+{
+    tcb_snd_t      *snd = &tcb->tcb_snd;
+    tcb_cc_cubic_t *cu = &tcb->tcb_cc.cc_cubic;
+    uint32_t        now_ms;
+    uint64_t        target;
+
+    if (snd->cwnd < snd->ssthresh) {
+        acked = tcp_cc_slow_start(tcb, acked, mss);
+        if (acked == 0)
+            return;
+    }
+
+    now_ms = tcp_cc_now_ms();
+    if (!cu->cu_epoch_valid)
+        tcp_cubic_epoch_start(tcb, now_ms, mss);
+
+    target = tcp_cubic_target(cu, now_ms - cu->cu_epoch_start, mss);
+
+    /* Don't grow by more than 50% per RTT. */
+    target = TPG_MIN(target, (uint64_t)snd->cwnd * 3 / 2);
+
+    /* TCP friendly region: grow at least as fast as AIMD would. */
+    cu->cu_w_est += (uint64_t)acked * mss * TCP_CUBIC_ALPHA_NUM /
+                        ((uint64_t)TCP_CUBIC_ALPHA_DEN * snd->cwnd);
+    if (cu->cu_w_est > target)
+        target = cu->cu_w_est;
+
+    if (target > snd->cwnd)
+        snd->cwnd += (target - snd->cwnd) * acked / snd->cwnd;
+    else
+        snd->cwnd += (uint64_t)acked * mss / (100ULL * snd->cwnd);
+}
+
+/*****************************************************************************
+ * tcp_cubic_reduce()
+ *      Multiplicative decrease and fast convergence.
+ ****************************************************************************/
+static void tcp_cubic_reduce(tcp_control_block_t *tcb, uint32_t mss)
+{
+    tcb_cc_cubic_t *cu = &tcb->tcb_cc.cc_cubic;
+    uint32_t        cwnd = tcb->tcb_snd.cwnd;
+
+    if (cwnd < cu->cu_w_max)
+        cu->cu_w_max = (uint64_t)cwnd * TCP_CUBIC_FC_NUM / TCP_CUBIC_FC_DEN;
+    else
+        cu->cu_w_max = cwnd;
+
+    cu->cu_epoch_valid = false;
+
+    tcb->tcb_snd.ssthresh =
+        TPG_MAX((uint64_t)cwnd * TCP_CUBIC_BETA_NUM / TCP_CUBIC_BETA_DEN,
+                2 * mss);
+}
+
+/*****************************************************************************
+ * tcp_cubic_loss()
+ ****************************************************************************/
+static void tcp_cubic_loss(tcp_control_block_t *tcb, uint32_t mss)
+{
+    tcp_cubic_reduce(tcb, mss);
+    tcb->tcb_snd.cwnd = tcb->tcb_snd.ssthresh;
+}
+
+/*****************************************************************************
+ * tcp_cubic_rto()
+ ****************************************************************************/
+static void tcp_cubic_rto(tcp_control_block_t *tcb, bool first, uint32_t mss)
+{
+    if (first)
+        tcp_cubic_reduce(tcb, mss);
+
+    tcb->tcb_cc.cc_cubic.cu_epoch_valid = false;
+    tcb->tcb_snd.cwnd = TCP_CC_LOSS_WND(mss);
+}
+
+static const tcp_cc_ops_t tcp_cubic_ops = {
+    .cco_init = tcp_cubic_init,
+    .cco_ack  = tcp_cubic_ack,
+    .cco_loss = tcp_cubic_loss,
+    .cco_rto  = tcp_cubic_rto,
+};
+
+/*****************************************************************************
+ * Global variables
+ ****************************************************************************/
+const tcp_cc_ops_t *tcp_cc_algos[TCP_CONG_CONTROL__TCP_CONG_CONTROL_MAX] = {
+    [TCP_CONG_CONTROL__NEW_RENO] = &tcp_newreno_ops,
+    [TCP_CONG_CONTROL__CUBIC]    = &tcp_cubic_ops,
+};
+
+static const char *tcp_cc_names[TCP_CONG_CONTROL__TCP_CONG_CONTROL_MAX] = {
+    [TCP_CONG_CONTROL__NEW_RENO] = "new-reno",
+    [TCP_CONG_CONTROL__CUBIC]    = "cubic",
+};
+
+/*****************************************************************************
+ * tcp_cc_name()
+ ****************************************************************************/
+const char *tcp_cc_name(tpg_tcp_cong_control_t algo)
+{
+    if (algo >= TCP_CONG_CONTROL__TCP_CONG_CONTROL_MAX)
+        return "<unknown>";
+
+    return tcp_cc_names[algo];
+}
+
@@ -59,6 +59,11 @@
  ****************************************************************************/
 #include "tcp_generator.h"
 
+/*****************************************************************************
+ * Forward declarations
+ ****************************************************************************/
+static uint32_t tcp_data_sack_pipe(tcp_control_block_t *tcb);
+
 /*****************************************************************************
  * tcp_data_store_send()
  ****************************************************************************/
@@ -101,37 +106,46 @@ static uint32_t tcp_data_get_unsent_size(tcp_control_block_t *tcb)
 }
 
 /*****************************************************************************
- * tcp_data_get_unsent()
- * WARNING: we can't return a clone here because dpdk doesn't support clones
- * of clones (i.e., indirect buffers referencing indirect buffers). The mbuf
- * chain we return here will be segmented later using rte_pktmbuf_clone!
- * This is why we return an offset inside the real data.
+ * tcp_data_seek()
+ *      Returns the mbuf in the retransmission queue that stores the byte at
+ *      'global_offset' (relative to SND.UNA) and the offset inside it.
  ****************************************************************************/
-static struct rte_mbuf *tcp_data_get_unsent(tcp_control_block_t *tcb,
-                                            uint32_t *mbuf_data_offset)
+static struct rte_mbuf *tcp_data_seek(tcp_control_block_t *tcb,
+                                      uint32_t global_offset,
+                                      uint32_t *mbuf_data_offset)
 {
     struct rte_mbuf *mbuf;
-    tcb_retrans_t   *retrans;
-    uint32_t         unsent_size;
-    uint32_t         unsent_global_offset;
     uint32_t         offset;
 
-    retrans = &tcb->tcb_retrans;
-    unsent_size = tcp_data_get_unsent_size(tcb);
-    unsent_global_offset = retrans->tr_total_size - unsent_size;
-
-    mbuf = retrans->tr_data_mbufs;
+    mbuf = tcb->tcb_retrans.tr_data_mbufs;
     offset = 0;
 
-    while (mbuf->data_len <= (unsent_global_offset - offset)) {
+    while (mbuf->data_len <= (global_offset - offset)) {
         offset += mbuf->data_len;
         mbuf = mbuf->next;
     }
 
-    *mbuf_data_offset = (unsent_global_offset - offset);
+    *mbuf_data_offset = (global_offset - offset);
     return mbuf;
 }
 
+/*****************************************************************************
+ * tcp_data_get_unsent()
+ * WARNING: we can't return a clone here because dpdk doesn't support clones
+ * of clones (i.e., indirect buffers referencing indirect buffers). The mbuf
+ * chain we return here will be segmented later using rte_pktmbuf_clone!
+ * This is why we return an offset inside the real data.
+ ****************************************************************************/
+static struct rte_mbuf *tcp_data_get_unsent(tcp_control_block_t *tcb,
+                                            uint32_t *mbuf_data_offset)
+{
+    uint32_t unsent_size;
+
+    unsent_size = tcp_data_get_unsent_size(tcb);
+    return tcp_data_seek(tcb, tcb->tcb_retrans.tr_total_size - unsent_size,
+                         mbuf_data_offset);
+}
+
 /*****************************************************************************
  * tcp_data_send_segment()
  ****************************************************************************/
@@ -155,10 +169,54 @@ static bool tcp_data_send_segment(tcp_control_block_t *tcb,
 }
 
 
+/*****************************************************************************
+ * tcp_data_tso_len()
+ *      Returns how much of the data at 'segs' + 'data_offset' can be sent in
+ *      a single TSO super packet without exceeding the number of segments
+ *      the NIC accepts per packet. Timestamped data must be segmented in
+ *      software as the timestamp would be written in the first segment only.
+ ****************************************************************************/
+static uint32_t tcp_data_tso_len(const tcp_control_block_t *tcb,
+                                 const struct rte_mbuf *segs,
+                                 uint32_t data_len,
+                                 uint32_t data_offset,
+                                 uint32_t max_seg_len)
+{
+    const port_info_t *port_info;
+    uint32_t           max_nb_segs;
+    uint32_t           len = 0;
+
+    port_info = &RTE_PER_LCORE(local_port_dev_info)[tcb->tcb_l4.l4cb_interface];
+
+    /* Leave room for the header mbuf. */
+    max_nb_segs = port_info->pi_dev_info.tx_desc_lim.nb_seg_max - 1;
+
+    data_len = TPG_MIN(data_len, TCP_LARGE_SEND_MAX_LEN);
+
+    while (segs && max_nb_segs && len < data_len) {
+        if (unlikely(DATA_IS_TSTAMP(segs)))
+            return 0;
+
+        len += segs->data_len - data_offset;
+        data_offset = 0;
+        segs = segs->next;
+        max_nb_segs--;
+    }
+
+    if (len >= data_len)
+        return data_len;
+
+    /* Only the last segment of the burst may be shorter. */
+    return len - len % max_seg_len;
+}
+
 /*****************************************************************************
  * tcp_data_send_segments()
  * NOTE:
- *      segs SHOULDN'T be freed so we clone the mbufs we need to send
+ *      segs SHOULDN'T be freed so we clone the mbufs we need to send.
+ *      With large sends enabled all the data (up to TCP_LARGE_SEND_MAX_LEN)
+ *      is sent in one pass: as TSO super packets if the NIC supports it,
+ *      segmented in software otherwise.
  ****************************************************************************/
 static uint32_t tcp_data_send_segments(tcp_control_block_t *tcb,
                                        struct rte_mbuf *segs,
@@ -169,19 +227,50 @@ static uint32_t tcp_data_send_segments(tcp_control_block_t *tcb,
 {
     uint32_t sent_segs = 0;
     uint32_t sent_data = 0;
+    uint32_t max_seg_len;
+    uint32_t max_segs = TCB_SEGS_PER_SEND;
+    bool     hw_tso = false;
+
+    /* Leave room for the options we'd add to the segments (e.g., SACK). */
+    max_seg_len = TCB_MTU(tcb) - tcp_hdr_opts_len(tcb, snd_flags);
 
-    while (sent_segs <= TCB_SEGS_PER_SEND && data_len > 0) {
+    if (TCP_LARGE_SEND(tcb->tcb_l4.l4cb_sockopt)) {
+        data_len = TPG_MIN(data_len, TCP_LARGE_SEND_MAX_LEN);
+        max_segs = UINT32_MAX;
+        hw_tso = TCP_HW_TSO(tcb->tcb_l4.l4cb_sockopt);
+    }
+
+    while (sent_segs <= max_segs && data_len > 0) {
+
+        uint32_t seg_data_len = 0;
+        uint32_t seg_flags = snd_flags;
 
-        uint32_t seg_data_len = TPG_MIN(data_len, TCB_MTU(tcb));
+        if (hw_tso) {
+            seg_data_len = tcp_data_tso_len(tcb, segs, data_len, data_offset,
+                                            max_seg_len);
+            if (seg_data_len > max_seg_len)
+                seg_flags |= TCP_BUILD_FLAG_TSO;
+        }
+
+        if (seg_data_len == 0)
+            seg_data_len = TPG_MIN(data_len, max_seg_len);
 
         if (!tcp_data_send_segment(tcb, segs, seg_data_len, data_offset, sseq,
-                                   snd_flags)) {
+                                   seg_flags)) {
             break;
         }
 
         /* Update the SND.NXT pointer with the data we sent. */
-        if (sseq == tcb->tcb_snd.nxt)
+        if (sseq == tcb->tcb_snd.nxt) {
+            /* Time this segment if we're not measuring the RTT already.
+             * With timestamps every ACK gives us a sample instead.
+             */
+            if (!tcb->tcb_ts_ok && tcb->tcb_rtt.trtt_start == 0) {
+                tcb->tcb_rtt.trtt_start = rte_get_timer_cycles();
+                tcb->tcb_rtt.trtt_seq = sseq + seg_data_len;
+            }
             tcb->tcb_snd.nxt += seg_data_len;
+        }
 
         sseq += seg_data_len;
         data_len -= seg_data_len;
@@ -209,16 +298,53 @@ static uint32_t tcp_data_send_segments(tcp_control_block_t *tcb,
 }
 
 /*****************************************************************************
- * tcp_data_send()
+ * tcp_data_send_unsent()
+ *      Sends as much of the unsent data as both the peer's window and the
+ *      congestion window allow us. Returns the number of bytes sent.
  ****************************************************************************/
-int tcp_data_send(tcp_control_block_t *tcb, tsm_data_arg_t *data)
+uint32_t tcp_data_send_unsent(tcp_control_block_t *tcb, uint32_t snd_flags)
 {
-    uint32_t         snd_flags = 0;
-    uint32_t         stored_bytes;
     struct rte_mbuf *data_to_send;
     uint32_t         unsent_size;
+    uint32_t         in_flight;
+    uint32_t         snd_wnd;
     uint32_t         data_offset = 0;
 
+    unsent_size = tcp_data_get_unsent_size(tcb);
+    if (unsent_size == 0)
+        return 0;
+
+    /* Don't send more than the window allows us! The congestion window might
+     * have shrunk below what's already in flight. During a SACK based
+     * recovery the lost holes don't count as in flight.
+     */
+    if (unlikely(tcb->tcb_in_recovery) && tcb->tcb_sack_ok)
+        in_flight = tcp_data_sack_pipe(tcb);
+    else
+        in_flight = SEG_DIFF(tcb->tcb_snd.nxt, tcb->tcb_snd.una);
+    snd_wnd = tcp_snd_wnd(tcb);
+    if (in_flight >= snd_wnd)
+        return 0;
+
+    unsent_size = TPG_MIN(unsent_size, snd_wnd - in_flight);
+
+    data_to_send = tcp_data_get_unsent(tcb, &data_offset);
+    if (unlikely(!data_to_send))
+        assert(data_to_send);
+
+    return tcp_data_send_segments(tcb, data_to_send, unsent_size, data_offset,
+                                  tcb->tcb_snd.nxt,
+                                  RTE_TCP_ACK_FLAG | snd_flags);
+}
+
+/*****************************************************************************
+ * tcp_data_send()
+ ****************************************************************************/
+int tcp_data_send(tcp_control_block_t *tcb, tsm_data_arg_t *data)
+{
+    uint32_t snd_flags = 0;
+    uint32_t stored_bytes;
+
     *data->tda_data_sent = 0;
 
     if (data->tda_push)
@@ -231,25 +357,61 @@ int tcp_data_send(tcp_control_block_t *tcb, tsm_data_arg_t *data)
     if (stored_bytes == 0)
         return -ENOMEM;
 
-    unsent_size = tcp_data_get_unsent_size(tcb);
-
-    if (unlikely(!data->tda_push && unsent_size < TCB_PSH_THRESH(tcb)))
+    if (unlikely(!data->tda_push &&
+                 tcp_data_get_unsent_size(tcb) < TCB_PSH_THRESH(tcb)))
         goto done;
 
-    /* Don't send more than the window allows us! */
-    unsent_size = TPG_MIN(unsent_size, SEG_DIFF(tcb->tcb_snd.wnd,
-                                                SEG_DIFF(tcb->tcb_snd.nxt,
-                                                         tcb->tcb_snd.una)));
+    tcp_data_send_unsent(tcb, snd_flags);
 
-    data_to_send = tcp_data_get_unsent(tcb, &data_offset);
-    if (unlikely(!data_to_send))
-        assert(data_to_send);
+done:
+    if (data->tda_data_len == stored_bytes) {
+        *data->tda_data_sent = stored_bytes;
+        return 0;
+    }
 
-    tcp_data_send_segments(tcb, data_to_send, unsent_size, data_offset,
-                           tcb->tcb_snd.nxt,
-                           RTE_TCP_ACK_FLAG | snd_flags);
+    return -EAGAIN;
+}
+
+/*****************************************************************************
+ * tcp_data_send_syn()
+ *      TCP Fast Open (RFC 7413): data sent before the session is
+ *      established. The first data goes out with the pending SYN (as much
+ *      as fits in one segment), the rest waits for the SYN/ACK.
+ ****************************************************************************/
+int tcp_data_send_syn(tcp_control_block_t *tcb, tsm_data_arg_t *data)
+{
+    uint32_t syn_flags = RTE_TCP_SYN_FLAG | TCP_BUILD_FLAG_USE_ISS;
+    uint32_t stored_bytes;
+    uint32_t syn_len;
+
+    *data->tda_data_sent = 0;
+
+    stored_bytes = tcp_data_store_send(tcb, data);
+    if (stored_bytes == 0)
+        return -ENOMEM;
+
+    if (tcb->tcb_tfo.tt_syn_pending) {
+        tcb->tcb_tfo.tt_syn_pending = false;
+
+        syn_len = TPG_MIN(tcb->tcb_retrans.tr_total_size,
+                          TCB_MTU(tcb) - tcp_hdr_opts_len(tcb, syn_flags));
+
+        /* SND.NXT is ISS + 1 so the data follows the SYN. */
+        if (tcp_data_send_segments(tcb, tcb->tcb_retrans.tr_data_mbufs,
+                                   syn_len, 0, tcb->tcb_snd.nxt,
+                                   syn_flags) != 0) {
+            tpg_tcp_statistics_t *stats;
+
+            stats = STATS_LOCAL(tpg_tcp_statistics_t,
+                                tcb->tcb_l4.l4cb_interface);
+            INC_STATS(stats, ts_sent_syn);
+            INC_STATS(stats, ts_tfo_syn_data);
+            tcb->tcb_tfo.tt_syn_data = true;
+        } else {
+            tcp_send_ctrl_pkt(tcb, syn_flags);
+        }
+    }
 
-done:
     if (data->tda_data_len == stored_bytes) {
         *data->tda_data_sent = stored_bytes;
         return 0;
@@ -258,6 +420,337 @@ done:
     return -EAGAIN;
 }
 
+/*****************************************************************************
+ * Receive buffer: AVL tree of disjoint, non adjacent out of order blocks
+ * keyed by their start sequence number. The tree nodes are the rcv_buf
+ * headers embedded in the first mbuf of each block so no memory is
+ * allocated. All the blocks are inside the receive window so comparing
+ * sequence numbers modulo 2^32 gives a total order.
+ ****************************************************************************/
+
+/*****************************************************************************
+ * tcp_rcvbuf_height()
+ ****************************************************************************/
+static inline uint32_t tcp_rcvbuf_height(const tcb_buf_hdr_t *node)
+{
+    return node ? node->tbh_height : 0;
+}
+
+/*****************************************************************************
+ * tcp_rcvbuf_fix_height()
+ ****************************************************************************/
+static inline void tcp_rcvbuf_fix_height(tcb_buf_hdr_t *node)
+{
+    node->tbh_height = TPG_MAX(tcp_rcvbuf_height(node->tbh_left),
+                               tcp_rcvbuf_height(node->tbh_right)) + 1;
+}
+
+/*****************************************************************************
+ * tcp_rcvbuf_rotate_right()
+ ****************************************************************************/
+static tcb_buf_hdr_t *tcp_rcvbuf_rotate_right(tcb_buf_hdr_t *node)
+{
+    tcb_buf_hdr_t *left = node->tbh_left;
+
+    node->tbh_left = left->tbh_right;
+    left->tbh_right = node;
+    tcp_rcvbuf_fix_height(node);
+    tcp_rcvbuf_fix_height(left);
+    return left;
+}
+
+/*****************************************************************************
+ * tcp_rcvbuf_rotate_left()
+ ****************************************************************************/
+static tcb_buf_hdr_t *tcp_rcvbuf_rotate_left(tcb_buf_hdr_t *node)
+{
+    tcb_buf_hdr_t *right = node->tbh_right;
+
+    node->tbh_right = right->tbh_left;
+    right->tbh_left = node;
+    tcp_rcvbuf_fix_height(node);
+    tcp_rcvbuf_fix_height(right);
+    return right;
+}
+
+/*****************************************************************************
+ * tcp_rcvbuf_balance()
+ *      Restores the AVL invariant for 'node' and returns the new subtree
+ *      root.
+ ****************************************************************************/
+static tcb_buf_hdr_t *tcp_rcvbuf_balance(tcb_buf_hdr_t *node)
+{
+    uint32_t lh = tcp_rcvbuf_height(node->tbh_left);
+    uint32_t rh = tcp_rcvbuf_height(node->tbh_right);
+
+    if (lh > rh + 1) {
+        if (tcp_rcvbuf_height(node->tbh_left->tbh_left) <
+                tcp_rcvbuf_height(node->tbh_left->tbh_right))
+            node->tbh_left = tcp_rcvbuf_rotate_left(node->tbh_left);
+        return tcp_rcvbuf_rotate_right(node);
+    }
+
+    if (rh > lh + 1) {
+        if (tcp_rcvbuf_height(node->tbh_right->tbh_right) <
+                tcp_rcvbuf_height(node->tbh_right->tbh_left))
+            node->tbh_right = tcp_rcvbuf_rotate_right(node->tbh_right);
+        return tcp_rcvbuf_rotate_left(node);
+    }
+
+    tcp_rcvbuf_fix_height(node);
+    return node;
+}
+
+/*****************************************************************************
+ * tcp_rcvbuf_insert_node()
+ ****************************************************************************/
+static tcb_buf_hdr_t *tcp_rcvbuf_insert_node(tcb_buf_hdr_t *root,
+                                             tcb_buf_hdr_t *node)
+{
+    if (root == NULL) {
+        node->tbh_left = NULL;
+        node->tbh_right = NULL;
+        node->tbh_height = 1;
+        return node;
+    }
+
+    if (SEG_LT(node->tbh_seg_seq, root->tbh_seg_seq))
+        root->tbh_left = tcp_rcvbuf_insert_node(root->tbh_left, node);
+    else
+        root->tbh_right = tcp_rcvbuf_insert_node(root->tbh_right, node);
+
+    return tcp_rcvbuf_balance(root);
+}
+
+/*****************************************************************************
+ * tcp_rcvbuf_remove_min_node()
+ *      Unlinks the first block of the subtree and stores it in 'min'.
+ ****************************************************************************/
+static tcb_buf_hdr_t *tcp_rcvbuf_remove_min_node(tcb_buf_hdr_t *root,
+                                                 tcb_buf_hdr_t **min)
+{
+    if (root->tbh_left == NULL) {
+        *min = root;
+        return root->tbh_right;
+    }
+
+    root->tbh_left = tcp_rcvbuf_remove_min_node(root->tbh_left, min);
+    return tcp_rcvbuf_balance(root);
+}
+
+/*****************************************************************************
+ * tcp_rcvbuf_remove_node()
+ ****************************************************************************/
+static tcb_buf_hdr_t *tcp_rcvbuf_remove_node(tcb_buf_hdr_t *root,
+                                             const tcb_buf_hdr_t *node)
+{
+    tcb_buf_hdr_t *min;
+
+    if (root == node) {
+        if (root->tbh_right == NULL)
+            return root->tbh_left;
+
+        root->tbh_right = tcp_rcvbuf_remove_min_node(root->tbh_right, &min);
+        min->tbh_left = root->tbh_left;
+        min->tbh_right = root->tbh_right;
+        return tcp_rcvbuf_balance(min);
+    }
+
+    if (SEG_LT(node->tbh_seg_seq, root->tbh_seg_seq))
+        root->tbh_left = tcp_rcvbuf_remove_node(root->tbh_left, node);
+    else
+        root->tbh_right = tcp_rcvbuf_remove_node(root->tbh_right, node);
+
+    return tcp_rcvbuf_balance(root);
+}
+
+/*****************************************************************************
+ * tcp_rcvbuf_insert()
+ *      Stores the header in the first mbuf of the block and links it in the
+ *      tree.
+ ****************************************************************************/
+static tcb_buf_hdr_t *tcp_rcvbuf_insert(tcp_control_block_t *tcb,
+                                        const tcb_buf_hdr_t *hdr)
+{
+    tcb_buf_hdr_t *node;
+
+    MBUF_STORE_RCVBUF_HDR(hdr->tbh_mbuf, hdr);
+    node = MBUF_TO_RCVBUF_HDR(hdr->tbh_mbuf);
+
+    tcb->tcb_rcv_buf.tbt_root =
+        tcp_rcvbuf_insert_node(tcb->tcb_rcv_buf.tbt_root, node);
+    tcb->tcb_rcv_buf.tbt_cnt++;
+    return node;
+}
+
+/*****************************************************************************
+ * tcp_rcvbuf_remove()
+ ****************************************************************************/
+static void tcp_rcvbuf_remove(tcp_control_block_t *tcb,
+                              const tcb_buf_hdr_t *node)
+{
+    tcb->tcb_rcv_buf.tbt_root =
+        tcp_rcvbuf_remove_node(tcb->tcb_rcv_buf.tbt_root, node);
+    tcb->tcb_rcv_buf.tbt_cnt--;
+}
+
+/*****************************************************************************
+ * tcp_rcvbuf_first()
+ ****************************************************************************/
+static tcb_buf_hdr_t *tcp_rcvbuf_first(const tcp_control_block_t *tcb)
+{
+    tcb_buf_hdr_t *node = tcb->tcb_rcv_buf.tbt_root;
+
+    while (node && node->tbh_left)
+        node = node->tbh_left;
+
+    return node;
+}
+
+/*****************************************************************************
+ * tcp_rcvbuf_floor()
+ *      Returns the last block that starts at or before 'seq'.
+ ****************************************************************************/
+static tcb_buf_hdr_t *tcp_rcvbuf_floor(const tcp_control_block_t *tcb,
+                                       uint32_t seq)
+{
+    tcb_buf_hdr_t *node = tcb->tcb_rcv_buf.tbt_root;
+    tcb_buf_hdr_t *floor = NULL;
+
+    while (node) {
+        if (SEG_LE(node->tbh_seg_seq, seq)) {
+            floor = node;
+            node = node->tbh_right;
+        } else {
+            node = node->tbh_left;
+        }
+    }
+
+    return floor;
+}
+
+/*****************************************************************************
+ * tcp_rcvbuf_next()
+ *      Returns the first block that starts after 'seq'.
+ ****************************************************************************/
+static tcb_buf_hdr_t *tcp_rcvbuf_next(const tcp_control_block_t *tcb,
+                                      uint32_t seq)
+{
+    tcb_buf_hdr_t *node = tcb->tcb_rcv_buf.tbt_root;
+    tcb_buf_hdr_t *next = NULL;
+
+    while (node) {
+        if (SEG_GT(node->tbh_seg_seq, seq)) {
+            next = node;
+            node = node->tbh_left;
+        } else {
+            node = node->tbh_right;
+        }
+    }
+
+    return next;
+}
+
+/*****************************************************************************
+ * tcp_data_rcvbuf_lookup()
+ *      Returns the block that contains 'seq' (if any).
+ ****************************************************************************/
+const tcb_buf_hdr_t *tcp_data_rcvbuf_lookup(const tcp_control_block_t *tcb,
+                                            uint32_t seq)
+{
+    const tcb_buf_hdr_t *floor = tcp_rcvbuf_floor(tcb, seq);
+
+    if (floor && SEG_LT(seq, TCB_RCVBUF_END(floor)))
+        return floor;
+
+    return NULL;
+}
+
+/*****************************************************************************
+ * tcp_rcvbuf_walk()
+ ****************************************************************************/
+static uint32_t tcp_rcvbuf_walk(const tcb_buf_hdr_t *node,
+                                const tcb_buf_hdr_t **blocks,
+                                uint32_t cnt, uint32_t max_cnt)
+{
+    if (node == NULL || cnt == max_cnt)
+        return cnt;
+
+    cnt = tcp_rcvbuf_walk(node->tbh_left, blocks, cnt, max_cnt);
+    if (cnt == max_cnt)
+        return cnt;
+
+    blocks[cnt++] = node;
+    return tcp_rcvbuf_walk(node->tbh_right, blocks, cnt, max_cnt);
+}
+
+/*****************************************************************************
+ * tcp_data_rcvbuf_blocks()
+ *      Fills 'blocks' with (at most 'max_cnt') first blocks in sequence
+ *      order. Returns the number of blocks filled in.
+ ****************************************************************************/
+uint32_t tcp_data_rcvbuf_blocks(const tcp_control_block_t *tcb,
+                                const tcb_buf_hdr_t **blocks,
+                                uint32_t max_cnt)
+{
+    return tcp_rcvbuf_walk(tcb->tcb_rcv_buf.tbt_root, blocks, 0, max_cnt);
+}
+
+/*****************************************************************************
+ * tcp_data_rcvbuf_free()
+ *      Frees all the out of order data.
+ ****************************************************************************/
+void tcp_data_rcvbuf_free(tcp_control_block_t *tcb)
+{
+    tcb_buf_hdr_t *min;
+
+    while (!TCB_RCVBUF_EMPTY(tcb)) {
+        tcb->tcb_rcv_buf.tbt_root =
+            tcp_rcvbuf_remove_min_node(tcb->tcb_rcv_buf.tbt_root, &min);
+        /* The header lives in the first mbuf, don't touch it after this. */
+        pkt_mbuf_free(min->tbh_mbuf);
+    }
+
+    tcb->tcb_rcv_buf.tbt_cnt = 0;
+}
+
+/*****************************************************************************
+ * tcp_rcvbuf_absorb_next()
+ *      Merges into 'seg' all the blocks that overlap with it or follow it
+ *      immediately. Blocks are stored disjoint and non adjacent so only the
+ *      last of them can extend beyond 'seg'.
+ ****************************************************************************/
+static void tcp_rcvbuf_absorb_next(tcp_control_block_t *tcb,
+                                   tcb_buf_hdr_t *seg)
+{
+    tcb_buf_hdr_t *next;
+
+    while ((next = tcp_rcvbuf_next(tcb, seg->tbh_seg_seq)) != NULL &&
+                SEG_LE(next->tbh_seg_seq, TCB_RCVBUF_END(seg))) {
+        uint32_t      seg_end = TCB_RCVBUF_END(seg);
+        tcb_buf_hdr_t old_hdr = *next;
+
+        tcp_rcvbuf_remove(tcb, next);
+
+        if (SEG_LE(TCB_RCVBUF_END(&old_hdr), seg_end)) {
+            pkt_mbuf_free(old_hdr.tbh_mbuf);
+            continue;
+        }
+
+        /* Keep only what's new, the header moves with the first mbuf. */
+        if (SEG_LT(old_hdr.tbh_seg_seq, seg_end)) {
+            old_hdr.tbh_mbuf = data_adj_chain(old_hdr.tbh_mbuf,
+                                              SEG_DIFF(seg_end,
+                                                       old_hdr.tbh_seg_seq));
+            if (unlikely(!old_hdr.tbh_mbuf))
+                assert(false);
+        }
+
+        tcb_buf_hdr_merge(seg, &old_hdr);
+        break;
+    }
+}
+
 /*****************************************************************************
  * tcp_data_handle()
  * NOTE:
@@ -266,7 +759,8 @@ done:
  *      Returns the number of bytes that were delivered.
  *      Should update tcb->tcb_rcv.nxt to the next missing sequence (even if
  *      we stored newer sequences than that).
- *      Merges the mbufs that are consecutive.
+ *      Merges the mbufs that are consecutive (no data is copied). Locating
+ *      the block a segment belongs to is O(log n) in the number of holes.
  ****************************************************************************/
 uint32_t tcp_data_handle(tcp_control_block_t *tcb, packet_control_block_t *pcb,
                          uint32_t seg_seq,
@@ -274,9 +768,8 @@ uint32_t tcp_data_handle(tcp_control_block_t *tcb, packet_control_block_t *pcb,
                          bool urgent __rte_unused)
 {
     tcb_buf_hdr_t     new_hdr;
-    tcb_buf_hdr_t    *cur;
-    tcb_buf_hdr_t    *prev = NULL;
-    tcb_buf_hdr_t    *seg  = NULL;
+    tcb_buf_hdr_t    *prev;
+    tcb_buf_hdr_t    *seg;
     uint32_t          delivered = 0;
     tpg_app_proto_t   app_id = tcb->tcb_l4.l4cb_app_data.ad_type;
     app_deliver_cb_t  app_deliver_cb;
@@ -298,100 +791,47 @@ uint32_t tcp_data_handle(tcp_control_block_t *tcb, packet_control_block_t *pcb,
         seg_seq = tcb->tcb_rcv.nxt;
     }
 
+    /* Needed for building the SACK option. */
+    tcb->tcb_rcv_buf_recent = seg_seq;
+
     tcb_buf_hdr_init(&new_hdr, pcb->pcb_mbuf, pcb->pcb_tstamp, seg_seq);
 
-    /* Walk the list of tcb buffers to see where the start of the seg fits.
-     * After this loop seg will point to the segment extended by the new data or
-     * NULL if the list is empty.
-     * This can also mean that the new segment was completely inserted as a
-     * separate node in the list (in case seg_seq falls in between two already
-     * existing segments).
+    /* Either the new data extends the block that starts before it or it
+     * becomes a block of its own. In both cases it might cover (some of) the
+     * blocks that follow.
      */
-    LIST_FOREACH(cur, &tcb->tcb_rcv_buf, tbh_entry) {
+    prev = tcp_rcvbuf_floor(tcb, seg_seq);
+    if (prev && SEG_GE(TCB_RCVBUF_END(prev), seg_seq)) {
         /* If it's already contained in a segment that we know then we can
          * safely try to deliver the data again.
          */
-        if (TCB_RCVBUF_CONTAINED(&new_hdr, cur))
+        if (SEG_LE(seg_seq + seg_len, TCB_RCVBUF_END(prev)))
             goto deliver_data;
 
-        /* Either we fit before the current buffer, immediately after or
-         * somewhere inside it.
-         */
-        if (SEG_LT(new_hdr.tbh_seg_seq, cur->tbh_seg_seq)) {
-            MBUF_STORE_RCVBUF_HDR(new_hdr.tbh_mbuf, &new_hdr);
-            seg = MBUF_TO_RCVBUF_HDR(new_hdr.tbh_mbuf);
-
-            if (prev == NULL)
-                LIST_INSERT_HEAD(&tcb->tcb_rcv_buf, seg, tbh_entry);
-            else
-                LIST_INSERT_AFTER(prev, seg, tbh_entry);
-
-            break;
-        } else if (SEG_EQ(cur->tbh_seg_seq + cur->tbh_mbuf->pkt_len,
-                          new_hdr.tbh_seg_seq)) {
-            data_mbuf_merge(cur->tbh_mbuf, new_hdr.tbh_mbuf);
-            seg = cur;
-            break;
-        } else if (SEG_LE(cur->tbh_seg_seq, new_hdr.tbh_seg_seq) &&
-                        SEG_LT(new_hdr.tbh_seg_seq,
-                               cur->tbh_seg_seq + cur->tbh_mbuf->pkt_len)) {
+        if (SEG_LT(seg_seq, TCB_RCVBUF_END(prev))) {
             new_hdr.tbh_mbuf = data_adj_chain(new_hdr.tbh_mbuf,
-                                              SEG_DIFF(cur->tbh_seg_seq +
-                                                       cur->tbh_mbuf->pkt_len,
-                                                       new_hdr.tbh_seg_seq));
+                                              SEG_DIFF(TCB_RCVBUF_END(prev),
+                                                       seg_seq));
             if (unlikely(!new_hdr.tbh_mbuf))
                 assert(false);
-
-            data_mbuf_merge(cur->tbh_mbuf, new_hdr.tbh_mbuf);
-            seg = cur;
-            break;
         }
 
-        prev = cur;
+        tcb_buf_hdr_merge(prev, &new_hdr);
+        seg = prev;
+    } else {
+        seg = tcp_rcvbuf_insert(tcb, &new_hdr);
     }
 
     /* Mark the pcb mbuf as stored so it doesn't get freed under our feet. */
     pcb->pcb_mbuf_stored = true;
 
-    if (!seg) {
-        MBUF_STORE_RCVBUF_HDR(new_hdr.tbh_mbuf, &new_hdr);
-        seg = MBUF_TO_RCVBUF_HDR(new_hdr.tbh_mbuf);
-
-        if (!prev)
-            LIST_INSERT_HEAD(&tcb->tcb_rcv_buf, seg, tbh_entry);
-        else
-            LIST_INSERT_AFTER(prev, seg, tbh_entry);
-    } else {
-        tcb_buf_hdr_t  *old_seg = seg->tbh_entry.le_next;
-        uint32_t        seg_end = seg->tbh_seg_seq + seg->tbh_mbuf->pkt_len;
-
-        /* Consume all the following segments which are included in this one. */
-        while (old_seg && SEG_GE(seg_end, old_seg->tbh_seg_seq)) {
-            tcb_buf_hdr_t *tmp;
-
-            /* If there's still something useful in the old seg then adj it. */
-            if (SEG_LT(seg_end, old_seg->tbh_seg_seq + old_seg->tbh_mbuf->pkt_len)) {
-                old_seg->tbh_mbuf =
-                    data_adj_chain(old_seg->tbh_mbuf,
-                                   SEG_DIFF(seg_end, old_seg->tbh_seg_seq));
-                if (unlikely(!old_seg->tbh_mbuf))
-                    assert(false);
-                break;
-            }
-
-            tmp = old_seg;
-            old_seg = old_seg->tbh_entry.le_next;
-
-            LIST_REMOVE(tmp, tbh_entry);
-            pkt_mbuf_free(tmp->tbh_mbuf);
-        }
-    }
+    tcp_rcvbuf_absorb_next(tcb, seg);
 
 deliver_data:
-    /* Check if the head of the list is the next sequence we were waiting for
+    /* Check if the first block is the next sequence we were waiting for
      * and then deliver the data.
      */
-    if (unlikely(LIST_EMPTY(&tcb->tcb_rcv_buf)))
+    if (unlikely(TCB_RCVBUF_EMPTY(tcb)))
         assert(false);
 
     app_deliver_cb = APP_CALL(deliver, app_id);
@@ -403,54 +843,399 @@ deliver_data:
     tc_info = TEST_GET_INFO(tcb->tcb_l4.l4cb_interface,
                             tcb->tcb_l4.l4cb_test_case_id);
 
-    while (!LIST_EMPTY(&tcb->tcb_rcv_buf) &&
-                SEG_EQ(tcb->tcb_rcv.nxt,
-                       tcb->tcb_rcv_buf.lh_first->tbh_seg_seq)) {
-        uint32_t seg_delivered;
+    while ((seg = tcp_rcvbuf_first(tcb)) != NULL &&
+                SEG_EQ(tcb->tcb_rcv.nxt, seg->tbh_seg_seq)) {
+        tcb_buf_hdr_t rest;
+        uint32_t      seg_delivered;
 
-        seg = tcb->tcb_rcv_buf.lh_first;
         seg_delivered = app_deliver_cb(&tcb->tcb_l4, &tcb->tcb_l4.l4cb_app_data,
                                        tc_info->tci_app_stats,
                                        seg->tbh_mbuf,
                                        seg->tbh_tstamp);
+        if (seg_delivered == 0)
+            break;
+
         delivered += seg_delivered;
         tcb->tcb_rcv.nxt += seg_delivered;
 
-        if (seg_delivered == seg->tbh_mbuf->pkt_len) {
-            LIST_REMOVE(seg, tbh_entry);
+        rest = *seg;
+        tcp_rcvbuf_remove(tcb, seg);
+
+        if (seg_delivered == rest.tbh_mbuf->pkt_len) {
             /* Free the whole chain. */
-            pkt_mbuf_free(seg->tbh_mbuf);
-        } else {
-            /* Advance in the segment with the data we delivered. */
-            seg->tbh_mbuf = data_adj_chain(seg->tbh_mbuf, seg_delivered);
-            break;
+            pkt_mbuf_free(rest.tbh_mbuf);
+            continue;
         }
+
+        /* Advance in the segment with the data we delivered. The first mbuf
+         * (and the header in it) might be gone so store it again.
+         */
+        rest.tbh_mbuf = data_adj_chain(rest.tbh_mbuf, seg_delivered);
+        rest.tbh_seg_seq = tcb->tcb_rcv.nxt;
+        tcp_rcvbuf_insert(tcb, &rest);
+        break;
     }
 
     return delivered;
 }
 
+/*****************************************************************************
+ * tcp_data_handle_in_order()
+ * NOTE:
+ *      Fast path version of tcp_data_handle(): the segment starts at RCV.NXT
+ *      and there's nothing in the receive buffer so the data is handed
+ *      directly to the application. Only what the application doesn't
+ *      consume is stored in the receive buffer.
+ *      Returns the number of bytes that were delivered.
+ ****************************************************************************/
+uint32_t tcp_data_handle_in_order(tcp_control_block_t *tcb,
+                                  packet_control_block_t *pcb,
+                                  uint32_t seg_len)
+{
+    tcb_buf_hdr_t     new_hdr;
+    uint32_t          delivered;
+    tpg_app_proto_t   app_id = tcb->tcb_l4.l4cb_app_data.ad_type;
+    test_case_info_t *tc_info;
+
+    /* Needed for building the SACK option. */
+    tcb->tcb_rcv_buf_recent = tcb->tcb_rcv.nxt;
+
+    tc_info = TEST_GET_INFO(tcb->tcb_l4.l4cb_interface,
+                            tcb->tcb_l4.l4cb_test_case_id);
+
+    delivered = APP_CALL(deliver, app_id)(&tcb->tcb_l4,
+                                          &tcb->tcb_l4.l4cb_app_data,
+                                          tc_info->tci_app_stats,
+                                          pcb->pcb_mbuf,
+                                          pcb->pcb_tstamp);
+    tcb->tcb_rcv.nxt += delivered;
+
+    /* Everything was consumed, the caller frees the mbuf. */
+    if (likely(delivered == seg_len))
+        return delivered;
+
+    /* Mark the pcb mbuf as stored so it doesn't get freed under our feet. */
+    pcb->pcb_mbuf_stored = true;
+
+    tcb_buf_hdr_init(&new_hdr, data_adj_chain(pcb->pcb_mbuf, delivered),
+                     pcb->pcb_tstamp,
+                     tcb->tcb_rcv.nxt);
+
+    tcp_rcvbuf_insert(tcb, &new_hdr);
+
+    return delivered;
+}
+
+/*****************************************************************************
+ * tcp_data_sack_prune()
+ *      Forgets the scoreboard blocks that were cumulatively acked.
+ ****************************************************************************/
+static void tcp_data_sack_prune(tcp_control_block_t *tcb)
+{
+    tcb_sack_t *sack = &tcb->tcb_sack;
+    uint32_t    i;
+
+    for (i = 0; i < sack->ts_cnt; i++) {
+        if (SEG_GT(sack->ts_blks[i].tsb_end, tcb->tcb_snd.una))
+            break;
+    }
+
+    if (i != 0) {
+        memmove(&sack->ts_blks[0], &sack->ts_blks[i],
+                (sack->ts_cnt - i) * sizeof(sack->ts_blks[0]));
+        sack->ts_cnt -= i;
+    }
+
+    if (sack->ts_cnt != 0 &&
+            SEG_LT(sack->ts_blks[0].tsb_start, tcb->tcb_snd.una))
+        sack->ts_blks[0].tsb_start = tcb->tcb_snd.una;
+}
+
+/*****************************************************************************
+ * tcp_data_sack_update()
+ *      Adds the [start, end) block reported by the peer to the scoreboard.
+ *      Overlapping and adjacent blocks are merged. If the scoreboard is full
+ *      the highest block is dropped (we'll just retransmit more than needed).
+ ****************************************************************************/
+void tcp_data_sack_update(tcp_control_block_t *tcb, uint32_t start,
+                          uint32_t end)
+{
+    tcb_sack_t *sack = &tcb->tcb_sack;
+    uint32_t    i;
+    uint32_t    j;
+
+    tcp_data_sack_prune(tcb);
+
+    /* Ignore blocks that don't make sense (RFC 2018 section 5). */
+    if (SEG_LT(start, tcb->tcb_snd.una))
+        start = tcb->tcb_snd.una;
+
+    if (SEG_GT(end, tcb->tcb_snd.nxt))
+        end = tcb->tcb_snd.nxt;
+
+    if (SEG_LE(end, start))
+        return;
+
+    /* First block that ends at or after the new one starts. */
+    for (i = 0; i < sack->ts_cnt; i++) {
+        if (SEG_GE(sack->ts_blks[i].tsb_end, start))
+            break;
+    }
+
+    /* Absorb all the blocks that overlap or touch the new one. */
+    for (j = i; j < sack->ts_cnt; j++) {
+        if (SEG_GT(sack->ts_blks[j].tsb_start, end))
+            break;
+
+        if (SEG_LT(sack->ts_blks[j].tsb_start, start))
+            start = sack->ts_blks[j].tsb_start;
+
+        if (SEG_GT(sack->ts_blks[j].tsb_end, end))
+            end = sack->ts_blks[j].tsb_end;
+    }
+
+    if (i == j) {
+        if (sack->ts_cnt == TCB_SACK_SCOREBOARD_SIZE) {
+            if (i == sack->ts_cnt)
+                return;
+            sack->ts_cnt--;
+        }
+
+        memmove(&sack->ts_blks[i + 1], &sack->ts_blks[i],
+                (sack->ts_cnt - i) * sizeof(sack->ts_blks[0]));
+        sack->ts_cnt++;
+    } else if (j - i > 1) {
+        memmove(&sack->ts_blks[i + 1], &sack->ts_blks[j],
+                (sack->ts_cnt - j) * sizeof(sack->ts_blks[0]));
+        sack->ts_cnt -= j - i - 1;
+    }
+
+    sack->ts_blks[i].tsb_start = start;
+    sack->ts_blks[i].tsb_end = end;
+}
+
+/*****************************************************************************
+ * tcp_data_sack_pipe()
+ *      RFC 6675 pipe estimate: the holes below the highest SACKed sequence
+ *      are considered lost, only the data above it and the retransmissions
+ *      of the holes are still in the network.
+ ****************************************************************************/
+static uint32_t tcp_data_sack_pipe(tcp_control_block_t *tcb)
+{
+    tcb_sack_t *sack = &tcb->tcb_sack;
+    uint32_t    hole_start = tcb->tcb_snd.una;
+    uint32_t    hole_end;
+    uint32_t    high_rxt;
+    uint32_t    pipe;
+    uint32_t    i;
+
+    tcp_data_sack_prune(tcb);
+
+    if (sack->ts_cnt == 0)
+        return SEG_DIFF(tcb->tcb_snd.nxt, tcb->tcb_snd.una);
+
+    high_rxt = SEG_GT(sack->ts_high_rxt, hole_start) ? sack->ts_high_rxt :
+                                                       hole_start;
+
+    pipe = SEG_DIFF(tcb->tcb_snd.nxt, sack->ts_blks[sack->ts_cnt - 1].tsb_end);
+
+    for (i = 0; i < sack->ts_cnt && SEG_LT(hole_start, high_rxt); i++) {
+        hole_end = SEG_LT(sack->ts_blks[i].tsb_start, high_rxt) ?
+                        sack->ts_blks[i].tsb_start : high_rxt;
+
+        if (SEG_LT(hole_start, hole_end))
+            pipe += SEG_DIFF(hole_end, hole_start);
+
+        hole_start = sack->ts_blks[i].tsb_end;
+    }
+
+    return pipe;
+}
+
+/*****************************************************************************
+ * tcp_data_retrans_holes()
+ *      Retransmits the holes below the highest SACKed sequence that weren't
+ *      retransmitted yet in the current recovery (RFC 6675 NextSeg). The
+ *      retransmissions add to the pipe and stop once it reaches the
+ *      congestion window. At least 'min_len' bytes are sent if there's a
+ *      hole left.
+ ****************************************************************************/
+static uint32_t tcp_data_retrans_holes(tcp_control_block_t *tcb,
+                                       uint32_t min_len)
+{
+    tcb_sack_t      *sack = &tcb->tcb_sack;
+    struct rte_mbuf *seg;
+    uint32_t         una = tcb->tcb_snd.una;
+    uint32_t         hole_start = una;
+    uint32_t         hole_end;
+    uint32_t         hole_len;
+    uint32_t         data_offset;
+    uint32_t         retrans_bytes = 0;
+    uint32_t         sent;
+    uint32_t         pipe;
+    uint32_t         budget;
+    uint32_t         i;
+
+    pipe = tcp_data_sack_pipe(tcb);
+
+    if (SEG_LT(sack->ts_high_rxt, una))
+        sack->ts_high_rxt = una;
+
+    budget = tcb->tcb_snd.cwnd > pipe ? tcb->tcb_snd.cwnd - pipe : 0;
+    budget = TPG_MAX(budget, min_len);
+
+    for (i = 0; i < sack->ts_cnt && retrans_bytes < budget; i++) {
+        hole_end = sack->ts_blks[i].tsb_start;
+
+        if (SEG_LT(hole_start, sack->ts_high_rxt))
+            hole_start = sack->ts_high_rxt;
+
+        if (SEG_LT(hole_start, hole_end)) {
+            hole_len = TPG_MIN(SEG_DIFF(hole_end, hole_start),
+                               budget - retrans_bytes);
+
+            seg = tcp_data_seek(tcb, SEG_DIFF(hole_start, una), &data_offset);
+            sent = tcp_data_send_segments(tcb, seg, hole_len, data_offset,
+                                          hole_start,
+                                          RTE_TCP_ACK_FLAG);
+            retrans_bytes += sent;
+            sack->ts_high_rxt = hole_start + sent;
+
+            /* Out of mbufs or the per call segment limit was reached. */
+            if (sent < hole_len)
+                break;
+        }
+
+        hole_start = sack->ts_blks[i].tsb_end;
+    }
+
+    return retrans_bytes;
+}
+
 /*****************************************************************************
  * tcp_data_retrans()
+ *      Called on timeout: all the data sent so far is considered lost
+ *      (go-back-N). Only what the collapsed congestion window allows is
+ *      resent now, the ACKs for it clock out the rest, see
+ *      tcp_data_retrans_next().
  ****************************************************************************/
 uint32_t tcp_data_retrans(tcp_control_block_t *tcb)
 {
     tcb_retrans_t *retrans;
+    uint32_t       data_end;
+
+    retrans = &tcb->tcb_retrans;
+    if (retrans->tr_data_mbufs == NULL)
+        return 0;
+
+    /* SND.NXT might also cover our FIN, that's resent separately. */
+    data_end = tcb->tcb_snd.una + retrans->tr_total_size;
+
+    tcb->tcb_rto_nxt = tcb->tcb_snd.una;
+    tcb->tcb_rto_end = SEG_LT(tcb->tcb_snd.nxt, data_end) ?
+                            tcb->tcb_snd.nxt : data_end;
+
+    return tcp_data_retrans_next(tcb);
+}
+
+/*****************************************************************************
+ * tcp_data_retrans_next()
+ *      Resends the data lost at the last timeout that wasn't resent yet, as
+ *      much as the congestion window allows. The retransmissions are the
+ *      only data in flight until the whole lost window is resent.
+ ****************************************************************************/
+uint32_t tcp_data_retrans_next(tcp_control_block_t *tcb)
+{
+    struct rte_mbuf *seg;
+    uint32_t         una = tcb->tcb_snd.una;
+    uint32_t         retrans_size;
+    uint32_t         retrans_bytes;
+    uint32_t         data_offset;
+    uint32_t         in_flight;
+    uint32_t         snd_wnd;
+
+    if (likely(SEG_EQ(tcb->tcb_rto_nxt, tcb->tcb_rto_end)))
+        return 0;
+
+    /* The peer might have had some of the data queued out of order. */
+    if (SEG_LT(tcb->tcb_rto_nxt, una))
+        tcb->tcb_rto_nxt = una;
+
+    if (SEG_GE(tcb->tcb_rto_nxt, tcb->tcb_rto_end) ||
+            tcb->tcb_retrans.tr_data_mbufs == NULL) {
+        tcb->tcb_rto_nxt = tcb->tcb_rto_end;
+        return 0;
+    }
+
+    in_flight = SEG_DIFF(tcb->tcb_rto_nxt, una);
+    snd_wnd = tcp_snd_wnd(tcb);
+    if (in_flight >= snd_wnd)
+        return 0;
+
+    retrans_size = TPG_MIN(SEG_DIFF(tcb->tcb_rto_end, tcb->tcb_rto_nxt),
+                           snd_wnd - in_flight);
+
+    seg = tcp_data_seek(tcb, in_flight, &data_offset);
+    retrans_bytes = tcp_data_send_segments(tcb, seg, retrans_size,
+                                           data_offset,
+                                           tcb->tcb_rto_nxt,
+                                           RTE_TCP_ACK_FLAG);
+    tcb->tcb_rto_nxt += retrans_bytes;
+
+    return retrans_bytes;
+}
+
+
+/*****************************************************************************
+ * tcp_data_fast_retrans()
+ *      Retransmits one segment starting at SND.UNA. With SACK this starts
+ *      a new recovery: the first hole is always retransmitted and the other
+ *      holes as the pipe allows.
+ ****************************************************************************/
+uint32_t tcp_data_fast_retrans(tcp_control_block_t *tcb)
+{
+    tcb_retrans_t *retrans;
+    uint32_t       retrans_size;
     uint32_t       retrans_bytes;
 
     retrans = &tcb->tcb_retrans;
     if (retrans->tr_data_mbufs == NULL)
         return 0;
 
+    retrans_size = TPG_MIN(retrans->tr_total_size,
+                           TCB_MTU(tcb) - tcp_hdr_opts_len(tcb,
+                                                           RTE_TCP_ACK_FLAG));
+    retrans_size = TPG_MIN(retrans_size,
+                           SEG_DIFF(tcb->tcb_snd.nxt, tcb->tcb_snd.una));
+
+    if (tcb->tcb_sack_ok) {
+        tcb->tcb_sack.ts_high_rxt = tcb->tcb_snd.una;
+        if (tcb->tcb_sack.ts_cnt != 0)
+            return tcp_data_retrans_holes(tcb, retrans_size);
+    }
+
     retrans_bytes = tcp_data_send_segments(tcb, retrans->tr_data_mbufs,
-                                           TPG_MIN(retrans->tr_total_size,
-                                                   tcb->tcb_snd.wnd),
+                                           retrans_size,
                                            0,
                                            tcb->tcb_snd.una,
                                            RTE_TCP_ACK_FLAG);
+    tcb->tcb_sack.ts_high_rxt += retrans_bytes;
+
     return retrans_bytes;
 }
 
+/*****************************************************************************
+ * tcp_data_sack_retrans()
+ *      Called for the ACKs received during a SACK based recovery: resends
+ *      the holes that weren't retransmitted yet as the pipe allows.
+ ****************************************************************************/
+uint32_t tcp_data_sack_retrans(tcp_control_block_t *tcb)
+{
+    if (tcb->tcb_retrans.tr_data_mbufs == NULL)
+        return 0;
+
+    return tcp_data_retrans_holes(tcb, 0);
+}
 
 /*****************************************************************************
  * tcp_data_walk_segs()
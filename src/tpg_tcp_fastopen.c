@@ -0,0 +1,196 @@
+/*
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER
+ *
+ * Copyright (c) 2026, Juniper Networks, Inc. All rights reserved.
+ *
+ *
+ * The contents of this file are subject to the terms of the BSD 3 clause
+ * License (the "License"). You may not use this file except in compliance
+ * with the License.
+ *
+ * You can obtain a copy of the license at
+ * https://github.com/Juniper/warp17/blob/master/LICENSE.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from this
+ * software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * File name:
+ *     tpg_tcp_fastopen.c
+ *
+ * Description:
+ *     TCP Fast Open (RFC 7413).
+ *
+ * Author:
+ *     Dumitru Ceara, Eelco Chaudron
+ *
+ * Initial Created:
+ *     10/17/2026
+ *
+ * Notes:
+ *
+ */
+
+/*****************************************************************************
+ * Include files
+ ****************************************************************************/
+#include <rte_jhash.h>
+
+#include "tcp_generator.h"
+
+/*****************************************************************************
+ * Global variables
+ ****************************************************************************/
+/* Set once at init, read only afterwards (shared by all lcores). */
+static uint32_t tcp_fastopen_secret[TCP_FASTOPEN_COOKIE_LEN / sizeof(uint32_t)];
+
+/* Cookies we got from servers. Sessions are always handled by the same
+ * core so there's no need to share them.
+ */
+static RTE_DEFINE_PER_LCORE(tcp_fastopen_cache_entry_t,
+                            tcp_fastopen_cache)[TCP_FASTOPEN_CACHE_SIZE];
+
+/*****************************************************************************
+ * tcp_fastopen_init()
+ ****************************************************************************/
+void tcp_fastopen_init(void)
+{
+    uint32_t i;
+
+    for (i = 0; i < RTE_DIM(tcp_fastopen_secret); i++)
+        tcp_fastopen_secret[i] = (uint32_t)rte_rand();
+}
+
+/*****************************************************************************
+ * tcp_fastopen_cookie_make()
+ *      RFC 7413 (4.1.2): the cookie only depends on the client IP.
+ ****************************************************************************/
+static void tcp_fastopen_cookie_make(uint32_t client_ip, uint8_t *cookie)
+{
+    uint32_t i;
+    uint32_t val;
+
+    for (i = 0; i < RTE_DIM(tcp_fastopen_secret); i++) {
+        val = rte_jhash_1word(client_ip, tcp_fastopen_secret[i]);
+        memcpy(cookie + i * sizeof(val), &val, sizeof(val));
+    }
+}
+
+/*****************************************************************************
+ * tcp_fastopen_cache_entry()
+ ****************************************************************************/
+static tcp_fastopen_cache_entry_t *
+tcp_fastopen_cache_entry(uint32_t client_ip, uint32_t server_ip)
+{
+    uint32_t idx;
+
+    idx = rte_jhash_2words(client_ip, server_ip, 0) &
+                (TCP_FASTOPEN_CACHE_SIZE - 1);
+
+    return &RTE_PER_LCORE(tcp_fastopen_cache)[idx];
+}
+
+/*****************************************************************************
+ * tcp_fastopen_open()
+ *      Called when a client session is opened. Sends the cookie we have for
+ *      the server or asks for one. With a cookie the SYN is held back for
+ *      the first data the application sends.
+ ****************************************************************************/
+void tcp_fastopen_open(tcp_control_block_t *tcb)
+{
+    tcp_fastopen_cache_entry_t *entry;
+    tcb_tfo_t                  *tfo = &tcb->tcb_tfo;
+
+    tfo->tt_send_opt = true;
+
+    entry = tcp_fastopen_cache_entry(tcb->tcb_l4.l4cb_src_addr.ip_v4,
+                                     tcb->tcb_l4.l4cb_dst_addr.ip_v4);
+    if (entry->tfc_cookie_len == 0 ||
+            entry->tfc_client_ip != tcb->tcb_l4.l4cb_src_addr.ip_v4 ||
+            entry->tfc_server_ip != tcb->tcb_l4.l4cb_dst_addr.ip_v4) {
+        tfo->tt_cookie_len = 0;
+        return;
+    }
+
+    memcpy(tfo->tt_cookie, entry->tfc_cookie, entry->tfc_cookie_len);
+    tfo->tt_cookie_len = entry->tfc_cookie_len;
+    tfo->tt_syn_pending = true;
+}
+
+/*****************************************************************************
+ * tcp_fastopen_negotiate()
+ *      Processes the TCP Fast Open option of a SYN (server) or SYN/ACK
+ *      (client).
+ ****************************************************************************/
+void tcp_fastopen_negotiate(tcp_control_block_t *tcb,
+                            const tcp_hdr_opts_t *opts)
+{
+    tcp_fastopen_cache_entry_t *entry;
+    tpg_tcp_statistics_t       *stats;
+    tcb_tfo_t                  *tfo = &tcb->tcb_tfo;
+    uint8_t                     cookie[TCP_FASTOPEN_COOKIE_LEN];
+
+    if (!opts->tho_tfo_present)
+        return;
+
+    /* Client: remember the cookie for the next sessions to this server. */
+    if (tcb->tcb_active) {
+        if (opts->tho_tfo_len < TCP_OPT_TFO_COOKIE_MIN ||
+                opts->tho_tfo_len > TCP_OPT_TFO_COOKIE_FIT)
+            return;
+
+        entry = tcp_fastopen_cache_entry(tcb->tcb_l4.l4cb_src_addr.ip_v4,
+                                         tcb->tcb_l4.l4cb_dst_addr.ip_v4);
+        entry->tfc_client_ip = tcb->tcb_l4.l4cb_src_addr.ip_v4;
+        entry->tfc_server_ip = tcb->tcb_l4.l4cb_dst_addr.ip_v4;
+        entry->tfc_cookie_len = opts->tho_tfo_len;
+        memcpy(entry->tfc_cookie, opts->tho_tfo_cookie, opts->tho_tfo_len);
+        return;
+    }
+
+    /* Server: accept the data in the SYN if the cookie is valid, otherwise
+     * send a new one in the SYN/ACK.
+     */
+    stats = STATS_LOCAL(tpg_tcp_statistics_t, tcb->tcb_l4.l4cb_interface);
+
+    tcp_fastopen_cookie_make(tcb->tcb_l4.l4cb_dst_addr.ip_v4, cookie);
+
+    if (opts->tho_tfo_len == TCP_FASTOPEN_COOKIE_LEN &&
+            memcmp(opts->tho_tfo_cookie, cookie, sizeof(cookie)) == 0) {
+        tfo->tt_cookie_ok = true;
+        return;
+    }
+
+    if (opts->tho_tfo_len != 0)
+        INC_STATS(stats, ts_tfo_cookies_bad);
+
+    memcpy(tfo->tt_cookie, cookie, sizeof(cookie));
+    tfo->tt_cookie_len = sizeof(cookie);
+    tfo->tt_send_opt = true;
+
+    INC_STATS(stats, ts_tfo_cookies_sent);
+}
+
@@ -63,8 +63,29 @@
 /*****************************************************************************
  * Global variables
  ****************************************************************************/
-/* Per core hashtable [port_cnt * TPG_TCP_HASH_BUCKET_SIZE] */
-static RTE_DEFINE_PER_LCORE(tlkp_hash_bucket_t *, tlkp_tcb_hash_table);
+/* Per core hashtable shared by all ports. */
+static RTE_DEFINE_PER_LCORE(tlkp_htable_t, tlkp_tcb_hash_table);
+
+/* Per core TIME_WAIT records shared by all ports. */
+typedef struct tlkp_tw_table_s {
+
+    tlkp_tw_entry_t *tt_entries;    /* FIFO ring. */
+    uint32_t        *tt_index;      /* Ring slot + 1, 0 if empty. */
+    uint32_t         tt_mask;       /* Ring size - 1. */
+    uint32_t         tt_index_mask; /* Index size - 1. */
+    uint32_t         tt_head;
+    uint32_t         tt_tail;
+    uint32_t         tt_count;      /* Records still in the index. */
+
+} tlkp_tw_table_t;
+
+static RTE_DEFINE_PER_LCORE(tlkp_tw_table_t, tlkp_tw_table);
+
+/* Per core array[port][tcid] of server TCB recycle stacks. */
+static RTE_DEFINE_PER_LCORE(tlkp_cb_recycle_t *, tlkp_tcb_recycle);
+
+#define TLKP_TCB_RECYCLE_GET(port, tcid) \
+    (RTE_PER_LCORE(tlkp_tcb_recycle) + (port) * TPG_TEST_MAX_ENTRIES + (tcid))
 
 rte_atomic16_t            *tlkp_tcb_mpool_alloc_in_use; /* array [cb_id] */
 uint32_t                   tcb_l4cb_max_id;
@@ -88,6 +109,23 @@ static bool tcb_trace_filter_match(trace_filter_t *filter,
                               tcb->tcb_l4.l4cb_dst_addr);
 }
 
+/*****************************************************************************
+ * tcb_trace_update()
+ *      If we found a TCB and we have TCB trace filters enabled then
+ *      check if we should update the tcb_trace flag.
+ ****************************************************************************/
+static inline void tcb_trace_update(tcp_control_block_t *tcb)
+{
+    if (unlikely(RTE_PER_LCORE(trace_filter).tf_enabled)) {
+        if (tcb_trace_filter_match(&RTE_PER_LCORE(trace_filter), tcb))
+            tcb->tcb_trace = true;
+        else
+            tcb->tcb_trace = false;
+
+    } else if (unlikely(tcb->tcb_trace == true))
+        tcb->tcb_trace = false;
+}
+
 /*****************************************************************************
  * tlkp_tcp_init()
  ****************************************************************************/
@@ -111,26 +149,46 @@ bool tlkp_tcp_init(void)
  ****************************************************************************/
 void tlkp_tcp_lcore_init(uint32_t lcore_id)
 {
-    uint32_t i;
+    tlkp_tw_table_t *tt = &RTE_PER_LCORE(tlkp_tw_table);
+    uint32_t         tw_cnt;
+    int              socket = rte_lcore_to_socket_id(lcore_id);
 
-    RTE_PER_LCORE(tlkp_tcb_hash_table) =
-        rte_zmalloc_socket("tcp_hash_table", rte_eth_dev_count_avail() *
-                           TPG_HASH_BUCKET_SIZE *
-                           sizeof(tlkp_hash_bucket_t),
-                           RTE_CACHE_LINE_SIZE,
-                           rte_lcore_to_socket_id(lcore_id));
-    if (RTE_PER_LCORE(tlkp_tcb_hash_table) == NULL) {
-        TPG_ERROR_ABORT("[%d]: Failed to allocate per lcore tcp htable!\n",
-                        rte_lcore_index(lcore_id));
+    /* Size the table for all the TCBs this lcore can allocate. */
+    tlkp_htable_init(&RTE_PER_LCORE(tlkp_tcb_hash_table), "tcp_hash_table",
+                     mem_get_tcb_pools()[lcore_id]->size,
+                     socket);
+
+    /* Same for the TIME_WAIT records. The index is kept at most half full
+     * so probe sequences stay short.
+     */
+    tw_cnt = rte_align32pow2(TPG_MAX(mem_get_tcb_pools()[lcore_id]->size,
+                                     (uint32_t)TLKP_HT_MIN_BUCKETS));
+
+    bzero(tt, sizeof(*tt));
+    tt->tt_mask = tw_cnt - 1;
+    tt->tt_index_mask = 2 * tw_cnt - 1;
+    tt->tt_entries = rte_zmalloc_socket("tcp_tw_entries",
+                                        tw_cnt * sizeof(*tt->tt_entries),
+                                        RTE_CACHE_LINE_SIZE,
+                                        socket);
+    tt->tt_index = rte_zmalloc_socket("tcp_tw_index",
+                                      2 * tw_cnt * sizeof(*tt->tt_index),
+                                      RTE_CACHE_LINE_SIZE,
+                                      socket);
+    if (tt->tt_entries == NULL || tt->tt_index == NULL) {
+        TPG_ERROR_ABORT("[%d]: Failed to allocate TIME_WAIT table (%"PRIu32" entries)!\n",
+                        rte_lcore_index(lcore_id), tw_cnt);
     }
 
-    for (i = 0; i < (uint32_t)(rte_eth_dev_count_avail() *
-                               TPG_HASH_BUCKET_SIZE);
-         i++) {
-        /*
-         * Initialize all list headers.
-         */
-        LIST_INIT((&RTE_PER_LCORE(tlkp_tcb_hash_table)[i]));
+    RTE_PER_LCORE(tlkp_tcb_recycle) =
+        rte_zmalloc_socket("tcp_tcb_recycle",
+                           rte_eth_dev_count_avail() * TPG_TEST_MAX_ENTRIES *
+                           sizeof(tlkp_cb_recycle_t),
+                           RTE_CACHE_LINE_SIZE,
+                           socket);
+    if (RTE_PER_LCORE(tlkp_tcb_recycle) == NULL) {
+        TPG_ERROR_ABORT("[%d]: Failed to allocate TCB recycle stacks!\n",
+                        rte_lcore_index(lcore_id));
     }
 }
 
@@ -240,6 +298,73 @@ void tlkp_free_tcb(tcp_control_block_t *tcb)
     rte_mempool_generic_put(mem_get_tcb_local_pool(), &tcb_p, 1, NULL);
 }
 
+/*****************************************************************************
+ * tlkp_recycle_alloc_tcb()
+ *      Same as tlkp_alloc_tcb() but takes the TCB from the test case recycle
+ *      stack. The caller is expected to fully (re)initialize the TCB.
+ ****************************************************************************/
+tcp_control_block_t *tlkp_recycle_alloc_tcb(uint32_t eth_port,
+                                            uint32_t test_case_id)
+{
+    tlkp_cb_recycle_t   *recycle;
+    tcp_control_block_t *tcb;
+
+    recycle = TLKP_TCB_RECYCLE_GET(eth_port, test_case_id);
+
+    if (unlikely(recycle->cr_count == 0)) {
+        /* If the pool can't provide a full bulk anymore get the last TCBs
+         * one by one.
+         */
+        if (tlkp_cb_recycle_refill(recycle, mem_get_tcb_local_pool(),
+                                   offsetof(tcp_control_block_t,
+                                            tcb_l4)) == 0)
+            return tlkp_alloc_tcb();
+    }
+
+    tcb = recycle->cr_cbs[--recycle->cr_count];
+
+    L4_CB_ALLOC_INIT(&tcb->tcb_l4, tlkp_tcb_mpool_alloc_in_use,
+                     tcb_l4cb_max_id);
+    return tcb;
+}
+
+/*****************************************************************************
+ * tlkp_recycle_free_tcb()
+ *      Pushes the TCB on the recycle stack of the test case it belongs to.
+ *      If the stack is full the oldest half goes back to the mempool.
+ ****************************************************************************/
+void tlkp_recycle_free_tcb(tcp_control_block_t *tcb)
+{
+    tlkp_cb_recycle_t *recycle;
+
+    recycle = TLKP_TCB_RECYCLE_GET(tcb->tcb_l4.l4cb_interface,
+                                   tcb->tcb_l4.l4cb_test_case_id);
+
+    L4_CB_FREE_DEINIT(&tcb->tcb_l4,
+                      tlkp_tcb_mpool_alloc_in_use,
+                      tcb_l4cb_max_id);
+
+    if (unlikely(recycle->cr_count == TLKP_CB_RECYCLE_SIZE)) {
+        tlkp_cb_recycle_drain(recycle, mem_get_tcb_local_pool(),
+                              TLKP_CB_RECYCLE_BULK);
+    }
+
+    recycle->cr_cbs[recycle->cr_count++] = tcb;
+}
+
+/*****************************************************************************
+ * tlkp_recycle_flush_tcbs()
+ *      Returns all the recycled TCBs of the test case to the mempool.
+ ****************************************************************************/
+void tlkp_recycle_flush_tcbs(uint32_t eth_port, uint32_t test_case_id)
+{
+    tlkp_cb_recycle_t *recycle;
+
+    recycle = TLKP_TCB_RECYCLE_GET(eth_port, test_case_id);
+    tlkp_cb_recycle_drain(recycle, mem_get_tcb_local_pool(),
+                          recycle->cr_count);
+}
+
 
 /*****************************************************************************
  * tlkp_total_tcbs_allocated()
@@ -269,7 +394,7 @@ tcp_control_block_t *tlkp_find_v4_tcb(uint32_t phys_port, uint32_t l4_hash,
               local_port,
               remote_port);
 
-    l4_cb = tlkp_find_v4_cb(RTE_PER_LCORE(tlkp_tcb_hash_table),
+    l4_cb = tlkp_find_v4_cb(&RTE_PER_LCORE(tlkp_tcb_hash_table),
                                           phys_port,
                                           l4_hash,
                                           local_addr,
@@ -282,22 +407,102 @@ tcp_control_block_t *tlkp_find_v4_tcb(uint32_t phys_port, uint32_t l4_hash,
 
     tcb = container_of(l4_cb, tcp_control_block_t, tcb_l4);
 
-    /*
-     * If we found a TCB and we have TCB trace filters enabled then
-     * check if we should update the tcb_trace flag.
-     */
-    if (unlikely(RTE_PER_LCORE(trace_filter).tf_enabled)) {
-        if (tcb_trace_filter_match(&RTE_PER_LCORE(trace_filter), tcb))
-            tcb->tcb_trace = true;
-        else
-            tcb->tcb_trace = false;
-
-    } else if (unlikely(tcb->tcb_trace == true))
-        tcb->tcb_trace = false;
+    tcb_trace_update(tcb);
 
     return tcb;
 }
 
+/*****************************************************************************
+ * tlkp_find_v4_tcb_bulk()
+ *      tcbs[i] is set to NULL if keys[i] is not found.
+ ****************************************************************************/
+void tlkp_find_v4_tcb_bulk(const tlkp_v4_key_t *keys,
+                           tcp_control_block_t **tcbs,
+                           uint32_t count)
+{
+    l4_control_block_t *l4_cbs[TLKP_HT_BULK_SIZE];
+    uint32_t            burst;
+    uint32_t            i;
+
+    while (count) {
+        burst = RTE_MIN(count, (uint32_t)TLKP_HT_BULK_SIZE);
+
+        tlkp_find_v4_cb_bulk(&RTE_PER_LCORE(tlkp_tcb_hash_table), keys,
+                             l4_cbs,
+                             burst);
+
+        for (i = 0; i < burst; i++) {
+            if (unlikely(l4_cbs[i] == NULL)) {
+                tcbs[i] = NULL;
+                continue;
+            }
+
+            tcbs[i] = container_of(l4_cbs[i], tcp_control_block_t, tcb_l4);
+            tcb_trace_update(tcbs[i]);
+        }
+
+        keys += burst;
+        tcbs += burst;
+        count -= burst;
+    }
+}
+
+
+/*****************************************************************************
+ * tlkp_rx_burst_tcb()
+ *      Resolves the tcbs of a whole RX burst at once and prefetches them.
+ *      The results are stored in the pcbs and picked up by
+ *      tlkp_pcb_tcb_get() when each packet is processed.
+ ****************************************************************************/
+void tlkp_rx_burst_tcb(packet_control_block_t **pcbs,
+                       const tlkp_v4_key_t *keys,
+                       uint32_t count)
+{
+    tcp_control_block_t *tcbs[TPG_RX_BURST_SIZE];
+    tlkp_htable_t       *htable = &RTE_PER_LCORE(tlkp_tcb_hash_table);
+    uint32_t             i;
+
+    count = RTE_MIN(count, (uint32_t)TPG_RX_BURST_SIZE);
+    tlkp_find_v4_tcb_bulk(keys, tcbs, count);
+
+    for (i = 0; i < count; i++) {
+        /* Lookup fields are in the first line (already cached by the
+         * lookup itself), the state machine needs the fast path line.
+         */
+        if (tcbs[i] != NULL)
+            rte_prefetch0(&tcbs[i]->tcb_state);
+
+        pcbs[i]->pcb_l4cb = tcbs[i];
+        pcbs[i]->pcb_l4cb_gen =
+            tlkp_ht_lookup_gen(htable,
+                               tcbs[i] != NULL ? &tcbs[i]->tcb_l4 : NULL);
+        pcbs[i]->pcb_l4cb_valid = true;
+    }
+}
+
+/*****************************************************************************
+ * tlkp_pcb_tcb_get()
+ *      Returns true and sets 'tcb' if the burst lookup result stored in the
+ *      pcb is still valid (i.e., no tcb was added/deleted that could change
+ *      it while processing the previous packets in the burst).
+ ****************************************************************************/
+bool tlkp_pcb_tcb_get(packet_control_block_t *pcb, tcp_control_block_t **tcb)
+{
+    tcp_control_block_t *cached;
+
+    if (!pcb->pcb_l4cb_valid)
+        return false;
+
+    cached = pcb->pcb_l4cb;
+    if (unlikely(pcb->pcb_l4cb_gen !=
+                    tlkp_ht_lookup_gen(&RTE_PER_LCORE(tlkp_tcb_hash_table),
+                                       cached != NULL ? &cached->tcb_l4 :
+                                                        NULL)))
+        return false;
+
+    *tcb = cached;
+    return true;
+}
 
 /*****************************************************************************
  * tlkp_add_tcb()
@@ -319,7 +524,7 @@ int tlkp_add_tcb(tcp_control_block_t *tcb)
               tcb->tcb_l4.l4cb_dst_port,
               tcb->tcb_l4.l4cb_src_port);
 
-    error = tlkp_add_cb(RTE_PER_LCORE(tlkp_tcb_hash_table), &tcb->tcb_l4);
+    error = tlkp_add_cb(&RTE_PER_LCORE(tlkp_tcb_hash_table), &tcb->tcb_l4);
     if (error)
         return error;
 
@@ -340,7 +545,7 @@ int tlkp_add_tcb(tcp_control_block_t *tcb)
  ****************************************************************************/
 int tlkp_delete_tcb(tcp_control_block_t *tcb)
 {
-    return tlkp_delete_cb(RTE_PER_LCORE(tlkp_tcb_hash_table), &tcb->tcb_l4);
+    return tlkp_delete_cb(&RTE_PER_LCORE(tlkp_tcb_hash_table), &tcb->tcb_l4);
 }
 
 /*****************************************************************************
@@ -348,6 +553,314 @@ int tlkp_delete_tcb(tcp_control_block_t *tcb)
  ****************************************************************************/
 void tlkp_walk_tcb(uint32_t phys_port, tlkp_walk_v4_cb_t callback, void *arg)
 {
-    tlkp_walk_v4(RTE_PER_LCORE(tlkp_tcb_hash_table), phys_port, callback, arg);
+    tlkp_walk_v4(&RTE_PER_LCORE(tlkp_tcb_hash_table), phys_port, callback, arg);
+}
+
+/*****************************************************************************
+ * tlkp_tw_now()
+ *      Current time in ms, truncated to the size of tw_expiry.
+ ****************************************************************************/
+static inline __attribute__((__always_inline__))
+uint32_t tlkp_tw_now(void)
+{
+    return (rte_get_timer_cycles() / cycles_per_us / 1000) &
+                TLKP_TW_EXPIRY_MASK;
+}
+
+/*****************************************************************************
+ * tlkp_tw_expired()
+ *      Serial number arithmetic on TLKP_TW_EXPIRY_BITS. Records are reclaimed
+ *      long before the timestamps could wrap (see tlkp_tw_expire()).
+ ****************************************************************************/
+static inline __attribute__((__always_inline__))
+bool tlkp_tw_expired(const tlkp_tw_entry_t *tw, uint32_t now)
+{
+    return ((now - tw->tw_expiry) & TLKP_TW_EXPIRY_MASK) <
+                (1u << (TLKP_TW_EXPIRY_BITS - 1));
+}
+
+/*****************************************************************************
+ * tlkp_tw_hash()
+ ****************************************************************************/
+static inline __attribute__((__always_inline__))
+uint32_t tlkp_tw_hash(uint32_t phys_port, uint32_t local_addr,
+                      uint32_t remote_addr,
+                      uint16_t local_port,
+                      uint16_t remote_port)
+{
+    uint64_t hash;
+
+    hash = (((uint64_t)local_addr << 32) | remote_addr) *
+                0x9E3779B97F4A7C15ULL;
+    hash ^= (((uint64_t)phys_port << 32) | ((uint32_t)local_port << 16) |
+                remote_port) * 0xC2B2AE3D27D4EB4FULL;
+
+    return (uint32_t)(hash >> 32) ^ (uint32_t)hash;
+}
+
+/*****************************************************************************
+ * tlkp_tw_entry_hash()
+ ****************************************************************************/
+static inline __attribute__((__always_inline__))
+uint32_t tlkp_tw_entry_hash(const tlkp_tw_entry_t *tw)
+{
+    return tlkp_tw_hash(tw->tw_phys_port, tw->tw_local_addr,
+                        tw->tw_remote_addr,
+                        tw->tw_local_port,
+                        tw->tw_remote_port);
+}
+
+/*****************************************************************************
+ * tlkp_tw_index_find()
+ *      Returns the index position pointing to the record or the empty
+ *      position where it should be added if there is no such record.
+ ****************************************************************************/
+static uint32_t tlkp_tw_index_find(const tlkp_tw_table_t *tt,
+                                   uint32_t phys_port,
+                                   uint32_t local_addr,
+                                   uint32_t remote_addr,
+                                   uint16_t local_port,
+                                   uint16_t remote_port)
+{
+    const tlkp_tw_entry_t *tw;
+    uint32_t               pos;
+
+    pos = tlkp_tw_hash(phys_port, local_addr, remote_addr, local_port,
+                       remote_port) & tt->tt_index_mask;
+
+    /* The index is never more than half full so this always terminates. */
+    for (;; pos = (pos + 1) & tt->tt_index_mask) {
+        if (tt->tt_index[pos] == 0)
+            return pos;
+
+        tw = &tt->tt_entries[tt->tt_index[pos] - 1];
+        if (tw->tw_phys_port == phys_port &&
+                tw->tw_local_addr == local_addr &&
+                tw->tw_remote_addr == remote_addr &&
+                tw->tw_local_port == local_port &&
+                tw->tw_remote_port == remote_port)
+            return pos;
+    }
+}
+
+/*****************************************************************************
+ * tlkp_tw_index_delete()
+ *      Backward shift deletion: entries following 'pos' in the same probe
+ *      sequence are moved back so lookups don't stop early at the hole.
+ ****************************************************************************/
+static void tlkp_tw_index_delete(tlkp_tw_table_t *tt, uint32_t pos)
+{
+    uint32_t mask = tt->tt_index_mask;
+    uint32_t next = pos;
+    uint32_t home;
+
+    for (;;) {
+        tt->tt_index[pos] = 0;
+
+        for (;;) {
+            next = (next + 1) & mask;
+            if (tt->tt_index[next] == 0)
+                return;
+
+            home = tlkp_tw_entry_hash(&tt->tt_entries[tt->tt_index[next] - 1]) &
+                        mask;
+
+            /* Can move back if 'pos' is between 'home' and 'next'. */
+            if (((next - home) & mask) >= ((next - pos) & mask))
+                break;
+        }
+
+        tt->tt_index[pos] = tt->tt_index[next];
+        pos = next;
+    }
+}
+
+/*****************************************************************************
+ * tlkp_tw_kill()
+ *      Removes the record from the index. The ring slot is reclaimed once
+ *      it reaches the head of the ring.
+ ****************************************************************************/
+static void tlkp_tw_kill(tlkp_tw_table_t *tt, uint32_t pos)
+{
+    tt->tt_entries[tt->tt_index[pos] - 1].tw_phys_port = TLKP_TW_PORT_INVALID;
+    tlkp_tw_index_delete(tt, pos);
+    tt->tt_count--;
+}
+
+/*****************************************************************************
+ * tlkp_tw_reclaim()
+ *      Records with different timeouts (test cases) can be interleaved in
+ *      the ring. A record that expires later than the ones behind it only
+ *      delays reclaiming them, lookups check the expiry of each record.
+ ****************************************************************************/
+static void tlkp_tw_reclaim(tlkp_tw_table_t *tt, uint32_t now)
+{
+    tlkp_tw_entry_t *tw;
+
+    while (tt->tt_head != tt->tt_tail) {
+        tw = &tt->tt_entries[tt->tt_head & tt->tt_mask];
+
+        if (tw->tw_phys_port != TLKP_TW_PORT_INVALID) {
+            if (!tlkp_tw_expired(tw, now))
+                return;
+
+            tlkp_tw_kill(tt, tlkp_tw_index_find(tt, tw->tw_phys_port,
+                                                tw->tw_local_addr,
+                                                tw->tw_remote_addr,
+                                                tw->tw_local_port,
+                                                tw->tw_remote_port));
+        }
+
+        tt->tt_head++;
+    }
+}
+
+/*****************************************************************************
+ * tlkp_add_tw()
+ *      Stores a TIME_WAIT record for the tcb. Returns false if there's no
+ *      room left in which case the caller should keep the tcb around.
+ ****************************************************************************/
+bool tlkp_add_tw(tcp_control_block_t *tcb, uint32_t timeout_us)
+{
+    tlkp_tw_table_t *tt = &RTE_PER_LCORE(tlkp_tw_table);
+    tlkp_tw_entry_t *tw;
+    uint32_t         slot;
+    uint32_t         pos;
+    uint32_t         now;
+
+    now = tlkp_tw_now();
+    tlkp_tw_reclaim(tt, now);
+
+    if (unlikely(tt->tt_tail - tt->tt_head > tt->tt_mask))
+        return false;
+
+    /* The tuple might still be in TIME_WAIT from a previous session. */
+    pos = tlkp_tw_index_find(tt, tcb->tcb_l4.l4cb_interface,
+                             tcb->tcb_l4.l4cb_src_addr.ip_v4,
+                             tcb->tcb_l4.l4cb_dst_addr.ip_v4,
+                             tcb->tcb_l4.l4cb_src_port,
+                             tcb->tcb_l4.l4cb_dst_port);
+    if (unlikely(tt->tt_index[pos] != 0)) {
+        tlkp_tw_kill(tt, pos);
+        pos = tlkp_tw_index_find(tt, tcb->tcb_l4.l4cb_interface,
+                                 tcb->tcb_l4.l4cb_src_addr.ip_v4,
+                                 tcb->tcb_l4.l4cb_dst_addr.ip_v4,
+                                 tcb->tcb_l4.l4cb_src_port,
+                                 tcb->tcb_l4.l4cb_dst_port);
+    }
+
+    slot = tt->tt_tail & tt->tt_mask;
+    tw = &tt->tt_entries[slot];
+
+    tw->tw_local_addr = tcb->tcb_l4.l4cb_src_addr.ip_v4;
+    tw->tw_remote_addr = tcb->tcb_l4.l4cb_dst_addr.ip_v4;
+    tw->tw_local_port = tcb->tcb_l4.l4cb_src_port;
+    tw->tw_remote_port = tcb->tcb_l4.l4cb_dst_port;
+    tw->tw_snd_nxt = tcb->tcb_snd.nxt;
+    tw->tw_rcv_nxt = tcb->tcb_rcv.nxt;
+    tw->tw_expiry = (now + (timeout_us + 999) / 1000) & TLKP_TW_EXPIRY_MASK;
+    tw->tw_phys_port = tcb->tcb_l4.l4cb_interface;
+    tw->tw_test_case_id = tcb->tcb_l4.l4cb_test_case_id;
+
+    tt->tt_index[pos] = slot + 1;
+    tt->tt_tail++;
+    tt->tt_count++;
+
+    TRACE_FMT(TLK, DEBUG,
+              "[%s()]: phys_port %u ladd/radd %08X/%08X lp/rp %u/%u",
+              __func__,
+              tw->tw_phys_port,
+              tw->tw_local_addr,
+              tw->tw_remote_addr,
+              tw->tw_local_port,
+              tw->tw_remote_port);
+
+    return true;
+}
+
+/*****************************************************************************
+ * tlkp_find_v4_tw()
+ *      Returns NULL if there is no TIME_WAIT record for the tuple or if the
+ *      record already expired.
+ ****************************************************************************/
+tlkp_tw_entry_t *tlkp_find_v4_tw(uint32_t phys_port, uint32_t local_addr,
+                                 uint32_t remote_addr,
+                                 uint16_t local_port,
+                                 uint16_t remote_port)
+{
+    tlkp_tw_table_t *tt = &RTE_PER_LCORE(tlkp_tw_table);
+    tlkp_tw_entry_t *tw;
+    uint32_t         pos;
+
+    if (tt->tt_count == 0)
+        return NULL;
+
+    pos = tlkp_tw_index_find(tt, phys_port, local_addr, remote_addr,
+                             local_port,
+                             remote_port);
+    if (tt->tt_index[pos] == 0)
+        return NULL;
+
+    tw = &tt->tt_entries[tt->tt_index[pos] - 1];
+    if (unlikely(tlkp_tw_expired(tw, tlkp_tw_now()))) {
+        tlkp_tw_kill(tt, pos);
+        return NULL;
+    }
+
+    return tw;
+}
+
+/*****************************************************************************
+ * tlkp_delete_tw()
+ ****************************************************************************/
+void tlkp_delete_tw(tlkp_tw_entry_t *tw)
+{
+    tlkp_tw_table_t *tt = &RTE_PER_LCORE(tlkp_tw_table);
+
+    tlkp_tw_kill(tt, tlkp_tw_index_find(tt, tw->tw_phys_port,
+                                        tw->tw_local_addr,
+                                        tw->tw_remote_addr,
+                                        tw->tw_local_port,
+                                        tw->tw_remote_port));
+}
+
+/*****************************************************************************
+ * tlkp_tw_expire()
+ *      Called periodically from the packet loop so expired records don't
+ *      stay around until the next session enters TIME_WAIT.
+ ****************************************************************************/
+void tlkp_tw_expire(void)
+{
+    tlkp_tw_table_t *tt = &RTE_PER_LCORE(tlkp_tw_table);
+
+    if (likely(tt->tt_head == tt->tt_tail))
+        return;
+
+    tlkp_tw_reclaim(tt, tlkp_tw_now());
+}
+
+/*****************************************************************************
+ * tlkp_tw_flush()
+ *      Drops all the TIME_WAIT records of the test case. Otherwise a later
+ *      test reusing the tuples would get ACKs for the old sessions.
+ ****************************************************************************/
+void tlkp_tw_flush(uint32_t eth_port, uint32_t test_case_id)
+{
+    tlkp_tw_table_t *tt = &RTE_PER_LCORE(tlkp_tw_table);
+    tlkp_tw_entry_t *tw;
+    uint32_t         idx;
+
+    for (idx = tt->tt_head; idx != tt->tt_tail; idx++) {
+        tw = &tt->tt_entries[idx & tt->tt_mask];
+
+        if (tw->tw_phys_port != eth_port ||
+                tw->tw_test_case_id != test_case_id)
+            continue;
+
+        tlkp_delete_tw(tw);
+    }
+
+    /* Give back the ring slots that are now unused. */
+    tlkp_tw_reclaim(tt, tlkp_tw_now());
 }
 
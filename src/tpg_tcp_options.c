@@ -0,0 +1,547 @@
+/*
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER
+ *
+ * Copyright (c) 2026, Juniper Networks, Inc. All rights reserved.
+ *
+ *
+ * The contents of this file are subject to the terms of the BSD 3 clause
+ * License (the "License"). You may not use this file except in compliance
+ * with the License.
+ *
+ * You can obtain a copy of the license at
+ * https://github.com/Juniper/warp17/blob/master/LICENSE.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from this
+ * software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * File name:
+ *     tpg_tcp_options.c
+ *
+ * Description:
+ *     TCP header options encoding/decoding.
+ *
+ * Author:
+ *     Dumitru Ceara, Eelco Chaudron
+ *
+ * Initial Created:
+ *     10/17/2026
+ *
+ * Notes:
+ *
+ */
+
+/*****************************************************************************
+ * Include files
+ ****************************************************************************/
+#include "tcp_generator.h"
+
+/*****************************************************************************
+ * tcp_hdr_opts_get32()
+ *      Options are not aligned in the packet.
+ ****************************************************************************/
+static inline uint32_t tcp_hdr_opts_get32(const uint8_t *buf)
+{
+    uint32_t val;
+
+    memcpy(&val, buf, sizeof(val));
+    return rte_be_to_cpu_32(val);
+}
+
+/*****************************************************************************
+ * tcp_hdr_opts_get16()
+ ****************************************************************************/
+static inline uint16_t tcp_hdr_opts_get16(const uint8_t *buf)
+{
+    uint16_t val;
+
+    memcpy(&val, buf, sizeof(val));
+    return rte_be_to_cpu_16(val);
+}
+
+/*****************************************************************************
+ * tcp_hdr_opts_put16()
+ ****************************************************************************/
+static inline uint8_t *tcp_hdr_opts_put16(uint8_t *buf, uint16_t val)
+{
+    val = rte_cpu_to_be_16(val);
+    memcpy(buf, &val, sizeof(val));
+    return buf + sizeof(val);
+}
+
+/*****************************************************************************
+ * tcp_hdr_opts_put32()
+ ****************************************************************************/
+static inline uint8_t *tcp_hdr_opts_put32(uint8_t *buf, uint32_t val)
+{
+    val = rte_cpu_to_be_32(val);
+    memcpy(buf, &val, sizeof(val));
+    return buf + sizeof(val);
+}
+
+/*****************************************************************************
+ * tcp_hdr_opts_ts_now()
+ *      Our timestamp clock ticks every microsecond.
+ ****************************************************************************/
+static inline uint64_t tcp_hdr_opts_ts_now(void)
+{
+    return rte_get_timer_cycles() / cycles_per_us;
+}
+
+/*****************************************************************************
+ * tcp_hdr_opts_parse()
+ *      Malformed options end the parsing, whatever was decoded until then is
+ *      still used.
+ ****************************************************************************/
+void tcp_hdr_opts_parse(const struct rte_tcp_hdr *tcp, tcp_hdr_opts_t *opts)
+{
+    const uint8_t *opt = (const uint8_t *)(tcp + 1);
+    uint32_t       len = ((tcp->data_off >> 4) << 2) - sizeof(*tcp);
+    uint32_t       opt_len;
+    uint32_t       i;
+
+    opts->tho_mss_present = false;
+    opts->tho_wscale_present = false;
+    opts->tho_sack_perm = false;
+    opts->tho_ts_present = false;
+    opts->tho_tfo_present = false;
+    opts->tho_sack_cnt = 0;
+
+    while (len > 0) {
+        if (opt[0] == TCP_OPT_KIND_EOL)
+            break;
+
+        if (opt[0] == TCP_OPT_KIND_NOP) {
+            opt++;
+            len--;
+            continue;
+        }
+
+        if (len < 2)
+            break;
+
+        opt_len = opt[1];
+        if (opt_len < 2 || opt_len > len)
+            break;
+
+        switch (opt[0]) {
+        case TCP_OPT_KIND_MSS:
+            if (opt_len != TCP_OPT_LEN_MSS)
+                break;
+            opts->tho_mss_present = true;
+            opts->tho_mss = tcp_hdr_opts_get16(opt + 2);
+            break;
+        case TCP_OPT_KIND_WSCALE:
+            if (opt_len != TCP_OPT_LEN_WSCALE)
+                break;
+            opts->tho_wscale_present = true;
+            opts->tho_wscale = opt[2];
+            break;
+        case TCP_OPT_KIND_SACK_PERM:
+            if (opt_len != TCP_OPT_LEN_SACK_PERM)
+                break;
+            opts->tho_sack_perm = true;
+            break;
+        case TCP_OPT_KIND_SACK:
+            if ((opt_len - 2) % TCP_OPT_LEN_SACK_BLK != 0)
+                break;
+            opts->tho_sack_cnt = TPG_MIN((opt_len - 2) / TCP_OPT_LEN_SACK_BLK,
+                                         TCP_OPT_SACK_MAX_BLKS);
+            for (i = 0; i < opts->tho_sack_cnt; i++) {
+                const uint8_t *blk = opt + 2 + i * TCP_OPT_LEN_SACK_BLK;
+
+                opts->tho_sack_blks[i].tsb_start = tcp_hdr_opts_get32(blk);
+                opts->tho_sack_blks[i].tsb_end = tcp_hdr_opts_get32(blk + 4);
+            }
+            break;
+        case TCP_OPT_KIND_TS:
+            if (opt_len != TCP_OPT_LEN_TS)
+                break;
+            opts->tho_ts_present = true;
+            opts->tho_tsval = tcp_hdr_opts_get32(opt + 2);
+            opts->tho_tsecr = tcp_hdr_opts_get32(opt + 6);
+            break;
+        case TCP_OPT_KIND_TFO:
+            /* An empty option is a cookie request. */
+            if (opt_len - 2 > TCP_FASTOPEN_COOKIE_MAX)
+                break;
+            opts->tho_tfo_present = true;
+            opts->tho_tfo_len = opt_len - 2;
+            memcpy(opts->tho_tfo_cookie, opt + 2, opts->tho_tfo_len);
+            break;
+        default:
+            /* Silently skip unknown options. */
+            break;
+        }
+
+        opt += opt_len;
+        len -= opt_len;
+    }
+}
+
+/*****************************************************************************
+ * tcp_hdr_opts_negotiate()
+ *      Called when a SYN is received. Stores the negotiated options in the
+ *      TCB.
+ ****************************************************************************/
+void tcp_hdr_opts_negotiate(tcp_control_block_t *tcb,
+                            const struct rte_tcp_hdr *tcp)
+{
+    const tcp_sockopt_t *tcp_opts = tcp_get_sockopt(tcb->tcb_l4.l4cb_sockopt);
+    tcp_hdr_opts_t       opts;
+    uint32_t             peer_mss;
+
+    tcp_hdr_opts_parse(tcp, &opts);
+
+    /* RFC 9293 (3.7.1), RFC 6691: never send segments bigger than the MSS
+     * the peer advertised. The congestion window is expressed in segments
+     * so it has to be recomputed.
+     */
+    peer_mss = opts.tho_mss_present ? opts.tho_mss : TCP_OPT_MSS_DEFAULT;
+    peer_mss = TPG_MAX(peer_mss, TCP_OPT_MSS_MIN);
+    if (peer_mss < tcb->tcb_snd_mss) {
+        tcb->tcb_snd_mss = peer_mss;
+        tcp_cc_init(tcb);
+    }
+
+    /* RFC 7323: window scaling is enabled only if both sides sent the
+     * option. A shift bigger than 14 must be treated as 14.
+     */
+    if (opts.tho_wscale_present && tcp_opts->tcpo_win_scale != 0) {
+        tcb->tcb_wscale_ok = true;
+        tcb->tcb_snd_wscale = TPG_MIN(opts.tho_wscale, TCP_MAX_WIN_SCALE);
+        tcb->tcb_rcv_wscale = tcp_opts->tcpo_win_scale;
+    } else {
+        tcb->tcb_wscale_ok = false;
+        tcb->tcb_snd_wscale = 0;
+        tcb->tcb_rcv_wscale = 0;
+
+        /* We can't advertise more than this without scaling. */
+        tcb->tcb_rcv.wnd = TPG_MIN(tcb->tcb_rcv.wnd,
+                                   TCP_MAX_UNSCALED_WINDOW_SIZE);
+    }
+
+    tcb->tcb_sack_ok = (opts.tho_sack_perm && tcp_opts->tcpo_sack);
+
+    tcb->tcb_ts_ok = (opts.tho_ts_present && tcp_opts->tcpo_timestamps);
+    if (tcb->tcb_ts_ok)
+        tcb->tcb_ts_recent = opts.tho_tsval;
+
+    if (unlikely(tcp_opts->tcpo_fast_open))
+        tcp_fastopen_negotiate(tcb, &opts);
+}
+
+/*****************************************************************************
+ * tcp_hdr_opts_process_ts()
+ *      RFC 7323 (4.3): remembers the peer timestamp for in order segments
+ *      (Last.ACK.sent is approximated by RCV.NXT). ACKs for new data echo
+ *      the time at which we sent the segment they acknowledge so they're
+ *      used for RTT samples and latency stats.
+ ****************************************************************************/
+static void tcp_hdr_opts_process_ts(tcp_control_block_t *tcb,
+                                    const struct rte_tcp_hdr *tcp,
+                                    const tcp_hdr_opts_t *opts)
+{
+    uint32_t seg_seq = rte_be_to_cpu_32(tcp->sent_seq);
+    uint32_t seg_ack;
+    uint64_t now;
+    uint32_t rtt;
+
+    if (SEG_LE(seg_seq, tcb->tcb_rcv.nxt))
+        tcb->tcb_ts_recent = opts->tho_tsval;
+
+    if ((tcp->tcp_flags & RTE_TCP_ACK_FLAG) == 0 || opts->tho_tsecr == 0)
+        return;
+
+    seg_ack = rte_be_to_cpu_32(tcp->recv_ack);
+    if (!SEG_GT(seg_ack, tcb->tcb_snd.una) ||
+            !SEG_LE(seg_ack, tcb->tcb_snd.nxt))
+        return;
+
+    now = tcp_hdr_opts_ts_now();
+    rtt = (uint32_t)now - opts->tho_tsecr;
+
+    /* Echoed values from the future are bogus. */
+    if (unlikely(rtt > TCP_MAX_RTO_MS * 1000))
+        return;
+
+    tsm_rtt_sample(tcb, rtt);
+    test_update_latency(&tcb->tcb_l4, now - rtt, now);
+}
+
+/*****************************************************************************
+ * tcp_hdr_opts_process()
+ *      Processes the options of a segment received on an established
+ *      session: SACK blocks are fed to the scoreboard and timestamps to the
+ *      RTT estimator.
+ ****************************************************************************/
+void tcp_hdr_opts_process(tcp_control_block_t *tcb,
+                          const packet_control_block_t *pcb)
+{
+    const struct rte_tcp_hdr *tcp = pcb->pcb_tcp;
+    tcp_hdr_opts_t            opts;
+    uint32_t                  i;
+
+    /* Most segments don't carry any options if timestamps are off. */
+    if (likely((tcp->data_off >> 4) << 2 == sizeof(*tcp)))
+        return;
+
+    tcp_hdr_opts_parse(tcp, &opts);
+
+    if (tcb->tcb_ts_ok && opts.tho_ts_present)
+        tcp_hdr_opts_process_ts(tcb, tcp, &opts);
+
+    if (!tcb->tcb_sack_ok || (tcp->tcp_flags & RTE_TCP_ACK_FLAG) == 0)
+        return;
+
+    for (i = 0; i < opts.tho_sack_cnt; i++)
+        tcp_data_sack_update(tcb, opts.tho_sack_blks[i].tsb_start,
+                             opts.tho_sack_blks[i].tsb_end);
+}
+
+/*****************************************************************************
+ * tcp_hdr_opts_wscale()
+ *      Returns true if the window scale option should be sent.
+ *      SYN: if we're configured to scale our window.
+ *      SYN/ACK: if the peer sent the option too.
+ ****************************************************************************/
+static bool tcp_hdr_opts_wscale(const tcp_control_block_t *tcb, uint32_t flags)
+{
+    if ((flags & RTE_TCP_ACK_FLAG) != 0)
+        return tcb->tcb_wscale_ok;
+
+    return tcp_get_sockopt(tcb->tcb_l4.l4cb_sockopt)->tcpo_win_scale != 0;
+}
+
+/*****************************************************************************
+ * tcp_hdr_opts_sack_perm()
+ *      Same logic as for tcp_hdr_opts_wscale().
+ ****************************************************************************/
+static bool tcp_hdr_opts_sack_perm(const tcp_control_block_t *tcb,
+                                   uint32_t flags)
+{
+    if ((flags & RTE_TCP_ACK_FLAG) != 0)
+        return tcb->tcb_sack_ok;
+
+    return tcp_get_sockopt(tcb->tcb_l4.l4cb_sockopt)->tcpo_sack;
+}
+
+/*****************************************************************************
+ * tcp_hdr_opts_ts()
+ *      Same logic as for tcp_hdr_opts_wscale() for SYNs. All the other
+ *      segments carry the option if it was negotiated.
+ ****************************************************************************/
+static bool tcp_hdr_opts_ts(const tcp_control_block_t *tcb, uint32_t flags)
+{
+    if ((flags & (RTE_TCP_SYN_FLAG | RTE_TCP_ACK_FLAG)) == RTE_TCP_SYN_FLAG)
+        return tcp_get_sockopt(tcb->tcb_l4.l4cb_sockopt)->tcpo_timestamps;
+
+    return tcb->tcb_ts_ok;
+}
+
+/*****************************************************************************
+ * tcp_hdr_opts_tfo()
+ *      Returns true if the TCP Fast Open option should be sent. Only SYNs
+ *      and SYN/ACKs carry it, see tcp_fastopen_negotiate().
+ ****************************************************************************/
+static bool tcp_hdr_opts_tfo(const tcp_control_block_t *tcb, uint32_t flags)
+{
+    return (flags & RTE_TCP_SYN_FLAG) != 0 && tcb->tcb_tfo.tt_send_opt;
+}
+
+/*****************************************************************************
+ * tcp_hdr_opts_sack_cnt()
+ *      Returns the number of SACK blocks we should report.
+ ****************************************************************************/
+static uint32_t tcp_hdr_opts_sack_cnt(const tcp_control_block_t *tcb,
+                                      uint32_t flags)
+{
+    uint32_t max_cnt;
+
+    if (likely(!tcb->tcb_sack_ok || TCB_RCVBUF_EMPTY(tcb)))
+        return 0;
+
+    if ((flags & RTE_TCP_ACK_FLAG) == 0)
+        return 0;
+
+    max_cnt = tcb->tcb_ts_ok ? TCP_OPT_SACK_MAX_BLKS_TS :
+                               TCP_OPT_SACK_MAX_BLKS;
+
+    return TPG_MIN(tcb->tcb_rcv_buf.tbt_cnt, max_cnt);
+}
+
+/*****************************************************************************
+ * tcp_hdr_opts_len()
+ *      Returns the length of the options (padded to 4 bytes) that will be
+ *      added to a segment with 'flags'.
+ ****************************************************************************/
+uint32_t tcp_hdr_opts_len(const tcp_control_block_t *tcb, uint32_t flags)
+{
+    uint32_t len = 0;
+    uint32_t sack_cnt;
+
+    if (tcp_hdr_opts_ts(tcb, flags))
+        len += TCP_OPT_LEN_TS + 2; /* NOP, NOP */
+
+    if (likely((flags & RTE_TCP_SYN_FLAG) == 0)) {
+        sack_cnt = tcp_hdr_opts_sack_cnt(tcb, flags);
+        if (likely(sack_cnt == 0))
+            return len;
+
+        return len + TCP_OPT_LEN_SACK(sack_cnt) + 2; /* NOP, NOP */
+    }
+
+    len += TCP_OPT_LEN_MSS;
+
+    if (tcp_hdr_opts_wscale(tcb, flags))
+        len += TCP_OPT_LEN_WSCALE + 1; /* NOP */
+
+    if (tcp_hdr_opts_sack_perm(tcb, flags))
+        len += TCP_OPT_LEN_SACK_PERM + 2; /* NOP, NOP */
+
+    if (unlikely(tcp_hdr_opts_tfo(tcb, flags)))
+        len += TCP_OPT_LEN_TFO(tcb->tcb_tfo.tt_cookie_len);
+
+    return RTE_ALIGN_CEIL(len, 4);
+}
+
+/*****************************************************************************
+ * tcp_hdr_opts_build_sack()
+ *      RFC 2018: the first block must contain the most recently received
+ *      segment, the others are reported in sequence order.
+ ****************************************************************************/
+static uint8_t *tcp_hdr_opts_build_sack(const tcp_control_block_t *tcb,
+                                        uint32_t sack_cnt,
+                                        uint8_t *opt)
+{
+    const tcb_buf_hdr_t *blocks[TCP_OPT_SACK_MAX_BLKS];
+    const tcb_buf_hdr_t *recent;
+    uint32_t             blk_cnt;
+    uint32_t             cnt = 0;
+    uint32_t             i;
+
+    *opt++ = TCP_OPT_KIND_NOP;
+    *opt++ = TCP_OPT_KIND_NOP;
+    *opt++ = TCP_OPT_KIND_SACK;
+    *opt++ = TCP_OPT_LEN_SACK(sack_cnt);
+
+    recent = tcp_data_rcvbuf_lookup(tcb, tcb->tcb_rcv_buf_recent);
+    if (recent) {
+        opt = tcp_hdr_opts_put32(opt, recent->tbh_seg_seq);
+        opt = tcp_hdr_opts_put32(opt, TCB_RCVBUF_END(recent));
+        cnt++;
+    }
+
+    blk_cnt = tcp_data_rcvbuf_blocks(tcb, blocks, sack_cnt);
+
+    for (i = 0; i < blk_cnt && cnt < sack_cnt; i++) {
+        if (blocks[i] == recent)
+            continue;
+
+        opt = tcp_hdr_opts_put32(opt, blocks[i]->tbh_seg_seq);
+        opt = tcp_hdr_opts_put32(opt, TCB_RCVBUF_END(blocks[i]));
+        cnt++;
+    }
+
+    return opt;
+}
+
+/*****************************************************************************
+ * tcp_hdr_opts_build_ts()
+ *      RFC 7323: TSecr is only valid if the ACK bit is set.
+ ****************************************************************************/
+static uint8_t *tcp_hdr_opts_build_ts(const tcp_control_block_t *tcb,
+                                      uint32_t flags,
+                                      uint8_t *opt)
+{
+    *opt++ = TCP_OPT_KIND_NOP;
+    *opt++ = TCP_OPT_KIND_NOP;
+    *opt++ = TCP_OPT_KIND_TS;
+    *opt++ = TCP_OPT_LEN_TS;
+
+    opt = tcp_hdr_opts_put32(opt, (uint32_t)tcp_hdr_opts_ts_now());
+    return tcp_hdr_opts_put32(opt, (flags & RTE_TCP_ACK_FLAG) ?
+                                   tcb->tcb_ts_recent : 0);
+}
+
+/*****************************************************************************
+ * tcp_hdr_opts_build()
+ *      Writes the options in 'buf'. The buffer must have room for
+ *      tcp_hdr_opts_len() bytes.
+ ****************************************************************************/
+void tcp_hdr_opts_build(const tcp_control_block_t *tcb, uint32_t flags,
+                        uint8_t *buf)
+{
+    const tcp_sockopt_t *tcp_opts;
+    uint8_t             *opt = buf;
+    uint32_t             sack_cnt;
+
+    /* SYNs always advertise our MSS, first, as most stacks do. */
+    if (unlikely(flags & RTE_TCP_SYN_FLAG)) {
+        *opt++ = TCP_OPT_KIND_MSS;
+        *opt++ = TCP_OPT_LEN_MSS;
+        opt = tcp_hdr_opts_put16(opt, TCB_LOCAL_MSS(tcb));
+    }
+
+    if (tcp_hdr_opts_ts(tcb, flags))
+        opt = tcp_hdr_opts_build_ts(tcb, flags, opt);
+
+    if (likely((flags & RTE_TCP_SYN_FLAG) == 0)) {
+        sack_cnt = tcp_hdr_opts_sack_cnt(tcb, flags);
+        if (sack_cnt != 0)
+            tcp_hdr_opts_build_sack(tcb, sack_cnt, opt);
+        return;
+    }
+
+    if (tcp_hdr_opts_wscale(tcb, flags)) {
+        tcp_opts = tcp_get_sockopt(tcb->tcb_l4.l4cb_sockopt);
+
+        *opt++ = TCP_OPT_KIND_NOP;
+        *opt++ = TCP_OPT_KIND_WSCALE;
+        *opt++ = TCP_OPT_LEN_WSCALE;
+        *opt++ = tcp_opts->tcpo_win_scale;
+    }
+
+    if (tcp_hdr_opts_sack_perm(tcb, flags)) {
+        *opt++ = TCP_OPT_KIND_NOP;
+        *opt++ = TCP_OPT_KIND_NOP;
+        *opt++ = TCP_OPT_KIND_SACK_PERM;
+        *opt++ = TCP_OPT_LEN_SACK_PERM;
+    }
+
+    /* Last, the EOL padding takes care of the alignment. */
+    if (unlikely(tcp_hdr_opts_tfo(tcb, flags))) {
+        *opt++ = TCP_OPT_KIND_TFO;
+        *opt++ = TCP_OPT_LEN_TFO(tcb->tcb_tfo.tt_cookie_len);
+        memcpy(opt, tcb->tcb_tfo.tt_cookie, tcb->tcb_tfo.tt_cookie_len);
+        opt += tcb->tcb_tfo.tt_cookie_len;
+    }
+
+    /* Pad with EOL. */
+    while (opt < buf + tcp_hdr_opts_len(tcb, flags))
+        *opt++ = TCP_OPT_KIND_EOL;
+}
+
@@ -185,12 +185,83 @@ static const char *eventNames[TE_MAX_EVENT] = {
               ts_recv_rst);
 
 /*****************************************************************************
- * tsm_schedule_retransmission()
+ * tsm_rtt_sample()
+ *      RFC 6298 (2.2, 2.3): updates SRTT/RTTVAR with a new measurement and
+ *      recomputes the RTO. The clock granularity is the RTO timer wheel step.
  ****************************************************************************/
-static void tsm_schedule_retransmission(tcp_control_block_t *tcb)
+void tsm_rtt_sample(tcp_control_block_t *tcb, uint32_t rtt_us)
 {
     const tcp_sockopt_t *tcp_opts;
+    tcb_rtt_t           *rtt = &tcb->tcb_rtt;
+    uint32_t             delta;
+    uint32_t             rto;
+
+    /* SRTT == 0 means we don't have any sample yet. */
+    rtt_us = TPG_MAX(rtt_us, 1);
+
+    if (rtt->trtt_srtt == 0) {
+        rtt->trtt_srtt = rtt_us;
+        rtt->trtt_rttvar = rtt_us / 2;
+    } else {
+        delta = (rtt->trtt_srtt > rtt_us ? rtt->trtt_srtt - rtt_us :
+                                           rtt_us - rtt->trtt_srtt);
+
+        /* beta = 1/4, alpha = 1/8 */
+        rtt->trtt_rttvar = (3 * rtt->trtt_rttvar + delta) / 4;
+        rtt->trtt_srtt = (7 * rtt->trtt_srtt + rtt_us) / 8;
+    }
+
+    tcp_opts = tcp_get_sockopt(tcb->tcb_l4.l4cb_sockopt);
+
+    rto = rtt->trtt_srtt + TPG_MAX(GCFG_RTO_TMR_STEP, 4 * rtt->trtt_rttvar);
+    rto = TPG_MAX(rto, tcp_opts->tcpo_rto_min);
+    rtt->trtt_rto = TPG_MIN(rto, tcp_opts->tcpo_rto_max);
+}
+
+/*****************************************************************************
+ * tsm_rtt_ack()
+ *      Takes an RTT sample if 'seg_ack' covers the segment being timed.
+ ****************************************************************************/
+static void tsm_rtt_ack(tcp_control_block_t *tcb, uint32_t seg_ack)
+{
+    tcb_rtt_t *rtt = &tcb->tcb_rtt;
 
+    if (rtt->trtt_start == 0 || SEG_LT(seg_ack, rtt->trtt_seq))
+        return;
+
+    tsm_rtt_sample(tcb, (rte_get_timer_cycles() - rtt->trtt_start) /
+                        cycles_per_us);
+    rtt->trtt_start = 0;
+}
+
+/*****************************************************************************
+ * tsm_rto_timeout()
+ *      RFC 6298 (5.5): the timer is backed off exponentially for every
+ *      retransmission of the same data.
+ ****************************************************************************/
+static uint32_t tsm_rto_timeout(tcp_control_block_t *tcb)
+{
+    const tcp_sockopt_t *tcp_opts;
+    uint32_t             rto = tcb->tcb_rtt.trtt_rto;
+    uint32_t             backoff = tcb->tcb_retrans_cnt;
+
+    tcp_opts = tcp_get_sockopt(tcb->tcb_l4.l4cb_sockopt);
+
+    if (backoff != 0) {
+        if (backoff >= 32 || rto > (tcp_opts->tcpo_rto_max >> backoff))
+            return tcp_opts->tcpo_rto_max;
+
+        rto <<= backoff;
+    }
+
+    return TPG_MIN(rto, tcp_opts->tcpo_rto_max);
+}
+
+/*****************************************************************************
+ * tsm_schedule_retransmission()
+ ****************************************************************************/
+static void tsm_schedule_retransmission(tcp_control_block_t *tcb)
+{
     TCB_CHECK(tcb);
 
     if (tcb->tcb_snd.una == tcb->tcb_snd.nxt &&
@@ -202,8 +273,7 @@ static void tsm_schedule_retransmission(tcp_control_block_t *tcb)
     if (TCB_RTO_TMR_IS_SET(tcb))
         return;
 
-    tcp_opts = tcp_get_sockopt(&tcb->tcb_l4.l4cb_sockopt);
-    tcp_timer_rto_set(&tcb->tcb_l4, tcp_opts->tcpo_rto);
+    tcp_timer_rto_set(&tcb->tcb_l4, tsm_rto_timeout(tcb));
 }
 
 /*****************************************************************************
@@ -229,6 +299,31 @@ static int tsm_send_data(tcp_control_block_t *tcb, tsm_data_arg_t *data)
     return status;
 }
 
+/*****************************************************************************
+ * tsm_send_unsent_data()
+ *      Called after processing an ACK: the send and congestion windows might
+ *      allow us to resend more of the data lost at the last timeout or to
+ *      send some of the data that was queued but not sent yet.
+ ****************************************************************************/
+static void tsm_send_unsent_data(tcp_control_block_t *tcb)
+{
+    uint32_t retrans_bytes;
+
+    retrans_bytes = tcp_data_retrans_next(tcb);
+    if (unlikely(retrans_bytes != 0)) {
+        INC_STATS_VAL(STATS_LOCAL(tpg_tsm_statistics_t,
+                                  tcb->tcb_l4.l4cb_interface),
+                      tsms_retrans_bytes,
+                      retrans_bytes);
+    }
+
+    if (tcp_data_send_unsent(tcb, RTE_TCP_PSH_FLAG) == 0 &&
+            retrans_bytes == 0)
+        return;
+
+    tsm_schedule_retransmission(tcb);
+}
+
 /*****************************************************************************
  * tsm_retrans_data()
  ****************************************************************************/
@@ -239,6 +334,24 @@ static void tsm_retrans_data(tcp_control_block_t *tcb)
 
     TCB_CHECK(tcb);
 
+    /* Only the first timeout for the same data reduces ssthresh. */
+    tcp_cc_rto(tcb, tcb->tcb_retrans_cnt <= 1);
+
+    /* Karn: don't measure the RTT on retransmitted data. */
+    tcb->tcb_rtt.trtt_start = 0;
+
+    /* RFC 6582 (4.2): a timeout ends fast recovery. Losses in the data
+     * sent so far shouldn't trigger a new one.
+     */
+    tcb->tcb_in_recovery = false;
+    tcb->tcb_dup_acks = 0;
+    tcb->tcb_recover = tcb->tcb_snd.nxt;
+
+    /* RFC 2018 (8): the receiver might have reneged, forget what it
+     * SACKed so far.
+     */
+    tcb->tcb_sack.ts_cnt = 0;
+
     retrans_bytes = tcp_data_retrans(tcb);
 
     INC_STATS_VAL(STATS_LOCAL(tpg_tsm_statistics_t, tcb->tcb_l4.l4cb_interface),
@@ -252,6 +365,154 @@ static void tsm_retrans_data(tcp_control_block_t *tcb)
     }
 }
 
+/*****************************************************************************
+ * tsm_fast_retrans()
+ *      Retransmits the first unacked segment without waiting for the RTO.
+ ****************************************************************************/
+static void tsm_fast_retrans(tcp_control_block_t *tcb)
+{
+    uint32_t retrans_bytes;
+
+    /* Karn: don't measure the RTT on retransmitted data. */
+    tcb->tcb_rtt.trtt_start = 0;
+
+    retrans_bytes = tcp_data_fast_retrans(tcb);
+
+    INC_STATS_VAL(STATS_LOCAL(tpg_tsm_statistics_t, tcb->tcb_l4.l4cb_interface),
+                  tsms_retrans_bytes,
+                  retrans_bytes);
+}
+
+/*****************************************************************************
+ * tsm_sack_retrans()
+ *      RFC 6675: during a SACK based recovery every ACK might allow us to
+ *      resend more of the holes.
+ ****************************************************************************/
+static void tsm_sack_retrans(tcp_control_block_t *tcb)
+{
+    uint32_t retrans_bytes;
+
+    /* Karn: don't measure the RTT on retransmitted data. */
+    tcb->tcb_rtt.trtt_start = 0;
+
+    retrans_bytes = tcp_data_sack_retrans(tcb);
+
+    INC_STATS_VAL(STATS_LOCAL(tpg_tsm_statistics_t, tcb->tcb_l4.l4cb_interface),
+                  tsms_retrans_bytes,
+                  retrans_bytes);
+}
+
+/*****************************************************************************
+ * tsm_is_dup_ack()
+ *      RFC 5681 (2): an ACK is a duplicate if it doesn't advance SND.UNA,
+ *      carries no data, SYN or FIN, doesn't change the window and we have
+ *      outstanding data.
+ ****************************************************************************/
+static inline bool tsm_is_dup_ack(const tcp_control_block_t *tcb,
+                                  const struct rte_tcp_hdr *tcp,
+                                  uint32_t seg_ack,
+                                  uint32_t seg_len,
+                                  uint32_t seg_wnd)
+{
+    return SEG_EQ(seg_ack, tcb->tcb_snd.una) &&
+           !SEG_EQ(tcb->tcb_snd.una, tcb->tcb_snd.nxt) &&
+           seg_len == 0 &&
+           seg_wnd == tcb->tcb_snd.wnd &&
+           !TCP_IS_FLAG_SET(tcp, RTE_TCP_SYN_FLAG | RTE_TCP_FIN_FLAG);
+}
+
+/*****************************************************************************
+ * tsm_dup_ack()
+ *      RFC 5681 (3.2), RFC 6582: fast retransmit after TCP_DUP_ACK_THRESH
+ *      duplicate ACKs. While in fast recovery every other duplicate ACK
+ *      inflates the congestion window as a segment left the network. With
+ *      SACK (RFC 6675) the window stays at ssthresh and the pipe estimate
+ *      accounts for what left the network instead.
+ ****************************************************************************/
+static void tsm_dup_ack(tcp_control_block_t *tcb)
+{
+    uint32_t mss = TCB_MTU(tcb);
+
+    tcb->tcb_dup_acks++;
+
+    if (tcb->tcb_in_recovery) {
+        if (tcb->tcb_sack_ok)
+            tsm_sack_retrans(tcb);
+        else
+            tcb->tcb_snd.cwnd += mss;
+
+        tsm_send_unsent_data(tcb);
+        return;
+    }
+
+    if (tcb->tcb_dup_acks != TCP_DUP_ACK_THRESH)
+        return;
+
+    /* RFC 6582 (4.1): the loss is in data sent before the last recovery
+     * (or timeout) so it was already handled.
+     */
+    if (SEG_LT(tcb->tcb_snd.una, tcb->tcb_recover))
+        return;
+
+    INC_STATS(STATS_LOCAL(tpg_tsm_statistics_t, tcb->tcb_l4.l4cb_interface),
+              tsms_fast_retrans);
+
+    tcb->tcb_in_recovery = true;
+    tcb->tcb_recover = tcb->tcb_snd.nxt;
+
+    tcp_cc_loss(tcb);
+
+    if (tcb->tcb_sack_ok) {
+        tcb->tcb_snd.cwnd = tcb->tcb_snd.ssthresh;
+        tsm_fast_retrans(tcb);
+    } else {
+        tsm_fast_retrans(tcb);
+        tcb->tcb_snd.cwnd = tcb->tcb_snd.ssthresh + TCP_DUP_ACK_THRESH * mss;
+    }
+
+    tsm_send_unsent_data(tcb);
+}
+
+/*****************************************************************************
+ * tsm_recovery_ack()
+ *      RFC 6582 (3.2): processes an ACK that covers new data while in fast
+ *      recovery. Must be called after SND.UNA was updated.
+ ****************************************************************************/
+static void tsm_recovery_ack(tcp_control_block_t *tcb, uint32_t acked)
+{
+    uint32_t mss = TCB_MTU(tcb);
+
+    if (SEG_GE(tcb->tcb_snd.una, tcb->tcb_recover)) {
+        /* Full acknowledgment: deflate the window and exit recovery. */
+        tcb->tcb_snd.cwnd = TPG_MIN(tcb->tcb_snd.ssthresh,
+                                    TPG_MAX(tcp_cc_flight_size(tcb), mss) +
+                                    mss);
+        tcb->tcb_in_recovery = false;
+        return;
+    }
+
+    /* With SACK the holes the peer still reports get resent as the pipe
+     * allows. Without blocks left only the first unacked segment is known
+     * to be lost. The window isn't inflated so it's not deflated either.
+     */
+    if (tcb->tcb_sack_ok) {
+        if (tcb->tcb_sack.ts_cnt != 0)
+            tsm_sack_retrans(tcb);
+        else
+            tsm_fast_retrans(tcb);
+        return;
+    }
+
+    /* Partial acknowledgment: the first unacked segment was lost too. */
+    tsm_fast_retrans(tcb);
+
+    tcb->tcb_snd.cwnd -= TPG_MIN(tcb->tcb_snd.cwnd, acked);
+    if (acked >= mss)
+        tcb->tcb_snd.cwnd += mss;
+
+    tcb->tcb_snd.cwnd = TPG_MAX(tcb->tcb_snd.cwnd, mss);
+}
+
 /*****************************************************************************
  * tsm_cleanup_retrans_queu()
  * NOTE:
@@ -310,16 +571,39 @@ static void tsm_cleanup_retrans_queu(tcp_control_block_t *tcb, uint32_t seg_ack)
     if (retrans->tr_data_mbufs == NULL) {
         retrans->tr_last_mbuf = NULL;
 
+        /* Nothing left to be selectively acked. */
+        tcb->tcb_sack.ts_cnt = 0;
+
         /* Everything was acked so we can cancel the retransmission timer. */
         tcp_timer_rto_cancel(&tcb->tcb_l4);
     }
 
+    tsm_rtt_ack(tcb, seg_ack);
+
+    acked_bytes = SEG_DIFF(seg_ack, tcb->tcb_snd.una);
+
+    /* Let the congestion control algorithm open the window. During fast
+     * recovery the window is managed by tsm_recovery_ack().
+     */
+    if (likely(!tcb->tcb_in_recovery))
+        tcp_cc_ack(tcb, acked_bytes);
+
     /* Update SND.UNA based on what was acked. */
     tcb->tcb_snd.una = seg_ack;
 
     /* The remote tcp endpoint is active so we can reset his retrans count. */
     tcb->tcb_retrans_cnt = 0;
 
+    tcb->tcb_dup_acks = 0;
+    if (unlikely(tcb->tcb_in_recovery))
+        tsm_recovery_ack(tcb, acked_bytes);
+
+    /* RFC 6298 (5.3): restart the timer for the data still in flight. */
+    if (TCB_RTO_TMR_IS_SET(tcb)) {
+        tcp_timer_rto_cancel(&tcb->tcb_l4);
+        tsm_schedule_retransmission(tcb);
+    }
+
     if (win_was_full && !tcp_snd_win_full(tcb)) {
         TCP_NOTIF(TEST_NOTIF_SESS_WIN_AVAIL, tcb);
 
@@ -349,7 +633,7 @@ static uint32_t tsm_handle_incoming(tcp_control_block_t *tcb,
      * either remove it or maybe refactor how we determine whether the counter
      * should be incremented.
      */
-    was_missing = !LIST_EMPTY(&tcb->tcb_rcv_buf);
+    was_missing = !TCB_RCVBUF_EMPTY(tcb);
 
     if (TCP_IS_FLAG_SET(pcb->pcb_tcp, RTE_TCP_URG_FLAG)) {
         /*
@@ -368,10 +652,10 @@ static uint32_t tsm_handle_incoming(tcp_control_block_t *tcb,
         delivered = tcp_data_handle(tcb, pcb, seg_seq, seg_len, false);
     }
 
-    if (!was_missing && !LIST_EMPTY(&tcb->tcb_rcv_buf)) {
+    if (!was_missing && !TCB_RCVBUF_EMPTY(tcb)) {
         INC_STATS(STATS_LOCAL(tpg_tsm_statistics_t, tcb->tcb_l4.l4cb_interface),
                   tsms_missing_seq);
-    } else if (was_missing && LIST_EMPTY(&tcb->tcb_rcv_buf)) {
+    } else if (was_missing && TCB_RCVBUF_EMPTY(tcb)) {
         DEC_STATS(STATS_LOCAL(tpg_tsm_statistics_t, tcb->tcb_l4.l4cb_interface),
                   tsms_missing_seq);
     }
@@ -411,24 +695,6 @@ static bool tsm_do_receive_acceptance_test(tcp_control_block_t *tcb,
     return rc;
 }
 
-/*****************************************************************************
- * tsm_need_ack()
- ****************************************************************************/
-static bool tsm_need_ack(tcp_control_block_t *tcb)
-{
-    const tcp_sockopt_t *tcp_opts;
-
-    tcp_opts = tcp_get_sockopt(&tcb->tcb_l4.l4cb_sockopt);
-
-    if (!tcp_opts->tcpo_ack_delay)
-        return true;
-
-    if (test_sm_has_data_pending(&tcb->tcb_l4))
-        return false;
-
-    return true;
-}
-
 /*****************************************************************************
  * tsm_str_to_state()
  ****************************************************************************/
@@ -479,11 +745,100 @@ int tsm_dispatch_net_event(tcp_control_block_t *tcb, tcpEvent_t event,
                   rte_be_to_cpu_32(pcb->pcb_tcp->recv_ack),
                   rte_be_to_cpu_16(pcb->pcb_tcp->rx_win),
                   rte_be_to_cpu_16(pcb->pcb_tcp->tcp_urp));
+
+        if (tcb->tcb_sack_ok || tcb->tcb_ts_ok)
+            tcp_hdr_opts_process(tcb, pcb);
     }
 
     return tsm_dispatch_event(tcb, event, pcb);
 }
 
+/*****************************************************************************
+ * tsm_fast_path()
+ *      Header prediction (Van Jacobson): in ESTABLISHED most segments are
+ *      either pure ACKs for new data or in order data. If the segment
+ *      carries RCV.NXT, no flags other than ACK/PSH, doesn't change the send
+ *      window and nothing unusual is going on (recovery, out of order data,
+ *      pending FIN) it's processed inline instead of going through the
+ *      generic state handler.
+ *      Returns false if the segment must take the slow path. In that case
+ *      the TCB wasn't changed.
+ ****************************************************************************/
+bool tsm_fast_path(tcp_control_block_t *tcb, packet_control_block_t *pcb)
+{
+    struct rte_tcp_hdr *tcp = pcb->pcb_tcp;
+    uint32_t            seg_len = pcb->pcb_l5_len;
+    uint32_t            seg_seq;
+    uint32_t            seg_ack;
+
+    if ((tcp->tcp_flags & ~RTE_TCP_PSH_FLAG) != RTE_TCP_ACK_FLAG)
+        return false;
+
+    if (unlikely(tcb->tcb_in_recovery || tcb->tcb_fin_rcvd ||
+                 tcb->tcb_rst_close || !TCB_RCVBUF_EMPTY(tcb)))
+        return false;
+
+    seg_seq = rte_be_to_cpu_32(tcp->sent_seq);
+    if (!SEG_EQ(seg_seq, tcb->tcb_rcv.nxt))
+        return false;
+
+    seg_ack = rte_be_to_cpu_32(tcp->recv_ack);
+    if (SEG_LT(seg_ack, tcb->tcb_snd.una) || SEG_GT(seg_ack, tcb->tcb_snd.nxt))
+        return false;
+
+    if (seg_len == 0) {
+        /* Duplicate ACKs and window updates take the slow path. */
+        if (SEG_EQ(seg_ack, tcb->tcb_snd.una))
+            return false;
+    } else if (seg_len > tcb->tcb_rcv.wnd) {
+        return false;
+    }
+
+    if (tcp_seg_wnd(tcb, tcp) != tcb->tcb_snd.wnd)
+        return false;
+
+    TCB_CHECK(tcb);
+
+    TCB_TRACE(tcb, TSM, DEBUG, "fast path: seq=%u, ack=%u, len=%u",
+              seg_seq, seg_ack, seg_len);
+
+    INC_STATS(STATS_LOCAL(tpg_tsm_statistics_t, tcb->tcb_l4.l4cb_interface),
+              tsms_fast_path);
+
+    if (tcb->tcb_sack_ok || tcb->tcb_ts_ok)
+        tcp_hdr_opts_process(tcb, pcb);
+
+    if (SEG_GT(seg_ack, tcb->tcb_snd.una)) {
+        /* Will update tcb_snd.una inside! */
+        tsm_cleanup_retrans_queu(tcb, seg_ack);
+
+        /* The window itself didn't change. */
+        if (SEG_GT(seg_seq, tcb->tcb_snd.wl1) ||
+                (SEG_EQ(seg_seq, tcb->tcb_snd.wl1) &&
+                 SEG_GE(seg_ack, tcb->tcb_snd.wl2))) {
+            tcb->tcb_snd.wl1 = seg_seq;
+            tcb->tcb_snd.wl2 = seg_ack;
+        }
+
+        /* The ACK might have opened the window for queued data. */
+        tsm_send_unsent_data(tcb);
+    }
+
+    if (seg_len == 0)
+        return true;
+
+    /* Data the application sends in the meantime carries the ACK. */
+    if (tcp_data_handle_in_order(tcb, pcb, seg_len) != 0)
+        tcp_send_ack_delayed(tcb);
+
+    /* The application didn't consume everything. */
+    if (unlikely(!TCB_RCVBUF_EMPTY(tcb))) {
+        INC_STATS(STATS_LOCAL(tpg_tsm_statistics_t, tcb->tcb_l4.l4cb_interface),
+                  tsms_missing_seq);
+    }
+
+    return true;
+}
 
 /*****************************************************************************
  * tsm_dispatch_event()
@@ -555,6 +910,58 @@ static int tsm_enter_state(tcp_control_block_t *tcb, tcpState_t state,
     return tsm_dispatch_event(tcb, TE_ENTER_STATE, tsm_arg);
 }
 
+/*****************************************************************************
+ * tsm_close_with_rst()
+ *      Returns true if the close mode of the session allows tearing it down
+ *      with a single RST right now. In rst-after-data mode that's only the
+ *      case once everything we sent was acked.
+ ****************************************************************************/
+static bool tsm_close_with_rst(tcp_control_block_t *tcb)
+{
+    const tcp_sockopt_t *tcp_opts;
+
+    tcp_opts = tcp_get_sockopt(tcb->tcb_l4.l4cb_sockopt);
+
+    switch (tcp_opts->tcpo_close_mode) {
+    case TCP_CLOSE_MODE__RST_IMMEDIATE:
+        return true;
+    case TCP_CLOSE_MODE__RST_AFTER_DATA:
+        return tcb->tcb_retrans.tr_total_size == 0;
+    default:
+        return false;
+    }
+}
+
+/*****************************************************************************
+ * tsm_rst_close()
+ *      Skips the FIN handshake (and TIME_WAIT): entering CLOSED sends the
+ *      RST and frees the tcb.
+ ****************************************************************************/
+static int tsm_rst_close(tcp_control_block_t *tcb, void *tsm_arg)
+{
+    INC_STATS(STATS_LOCAL(tpg_tsm_statistics_t, tcb->tcb_l4.l4cb_interface),
+              tsms_rst_close);
+
+    return tsm_enter_state(tcb, TS_CLOSED, tsm_arg);
+}
+
+/*****************************************************************************
+ * tsm_rst_close_deferred()
+ *      Called at the end of the RX burst for sessions the application closed
+ *      while their segments were being processed. Returns true if the tcb
+ *      was freed.
+ ****************************************************************************/
+bool tsm_rst_close_deferred(tcp_control_block_t *tcb)
+{
+    TCB_CHECK(tcb);
+
+    if (tcb->tcb_state != TS_ESTABLISHED || !tsm_close_with_rst(tcb))
+        return false;
+
+    tsm_rst_close(tcb, NULL);
+    return true;
+}
+
 
 /*****************************************************************************
  * tsm_initialize_minimal_statemachine()
@@ -581,19 +988,45 @@ void tsm_initialize_statemachine(tcp_control_block_t *tcb, bool active)
     tsm_initialize_minimal_statemachine(tcb, active);
     tcb->tcb_fin_rcvd = false;
     tcb->tcb_rst_rcvd = false;
+    tcb->tcb_rst_close = false;
     tcb->tcb_rcv_fin_seq = 0;
 
+    tcb->tcb_wscale_ok = false;
+    tcb->tcb_snd_wscale = 0;
+    tcb->tcb_rcv_wscale = 0;
+
+    tcb->tcb_sack_ok = false;
+    bzero(&tcb->tcb_sack, sizeof(tcb_sack_t));
+
+    tcb->tcb_ts_ok = false;
+    tcb->tcb_ts_recent = 0;
+
+    bzero(&tcb->tcb_tfo, sizeof(tcb_tfo_t));
+
+    tcb->tcb_in_recovery = false;
+    tcb->tcb_dup_acks = 0;
+
+    /* Lowered when the peer advertises its MSS. */
+    tcb->tcb_snd_mss = TCB_LOCAL_MSS(tcb);
+
     bzero(&tcb->tcb_snd, sizeof(tcb_snd_t));
+    tcp_cc_init(tcb);
 
     bzero(&tcb->tcb_rcv, sizeof(tcb_rcv_t));
 
-    tcp_opts = tcp_get_sockopt(&tcb->tcb_l4.l4cb_sockopt);
+    tcp_opts = tcp_get_sockopt(tcb->tcb_l4.l4cb_sockopt);
     tcb->tcb_rcv.wnd = tcp_opts->tcpo_win_size;
 
+    /* RFC 6298 (2.1): use the configured RTO until we have a sample. */
+    bzero(&tcb->tcb_rtt, sizeof(tcb_rtt_t));
+    tcb->tcb_rtt.trtt_rto = TPG_MIN(TPG_MAX(tcp_opts->tcpo_rto,
+                                            tcp_opts->tcpo_rto_min),
+                                    tcp_opts->tcpo_rto_max);
+
     tcb->tcb_retrans_cnt = 0;
 
     bzero(&tcb->tcb_retrans, sizeof(tcb_retrans_t));
-    LIST_INIT(&tcb->tcb_rcv_buf);
+    bzero(&tcb->tcb_rcv_buf, sizeof(tcb_buf_tree_t));
 
     tcb->tcb_trace = false;
 
@@ -633,9 +1066,16 @@ static int tsm_SF_init(tcp_control_block_t *tcb, tcpEvent_t event,
              */
             tcb->tcb_snd.una = tcb->tcb_snd.iss;
             tcb->tcb_snd.nxt = tcb->tcb_snd.iss + 1;
+            tcb->tcb_recover = tcb->tcb_snd.iss;
+            tcb->tcb_rto_nxt = tcb->tcb_snd.iss;
+            tcb->tcb_rto_end = tcb->tcb_snd.iss;
 
-            /* Send <SEQ=ISS><CTL=SYN> */
-            tcp_send_ctrl_pkt(tcb, RTE_TCP_SYN_FLAG | TCP_BUILD_FLAG_USE_ISS);
+            if (unlikely(tcp_get_sockopt(tcb->tcb_l4.l4cb_sockopt)->tcpo_fast_open))
+                tcp_fastopen_open(tcb);
+
+            /* Send <SEQ=ISS><CTL=SYN> (unless it waits for TFO data). */
+            if (likely(!tcb->tcb_tfo.tt_syn_pending))
+                tcp_send_ctrl_pkt(tcb, RTE_TCP_SYN_FLAG | TCP_BUILD_FLAG_USE_ISS);
 
             /* Always return after calling tsm_enter_state() */
             return tsm_enter_state(tcb, TS_SYN_SENT, NULL);
@@ -668,6 +1108,167 @@ static int tsm_SF_init(tcp_control_block_t *tcb, tcpEvent_t event,
     return 0;
 }
 
+/*****************************************************************************
+ * tsm_listen_set_peer()
+ *      Points a tcb cloned (or copied) from a listening tcb to the peer that
+ *      sent 'pcb'.
+ ****************************************************************************/
+static void tsm_listen_set_peer(tcp_control_block_t *tcb,
+                                const packet_control_block_t *pcb)
+{
+    tcb->tcb_l4.l4cb_dst_addr =
+        TPG_IPV4(rte_be_to_cpu_32(pcb->pcb_ipv4->src_addr));
+    tcb->tcb_l4.l4cb_dst_port = rte_be_to_cpu_16(pcb->pcb_tcp->src_port);
+
+    /* Recompute the hash before adding the tcb to the htable. */
+    l4_cb_calc_connection_hash(&tcb->tcb_l4);
+
+    /* The listen tcb headers were built for another peer. */
+    l4_cb_hdr_tmpl_invalidate(&tcb->tcb_l4);
+}
+
+/*****************************************************************************
+ * tsm_listen_syncookie_syn()
+ *      Replies to a SYN with a SYN/ACK carrying a cookie as ISN. Nothing is
+ *      allocated, a stack copy of the listening tcb is used for building the
+ *      reply.
+ ****************************************************************************/
+static int tsm_listen_syncookie_syn(tcp_control_block_t *tcb,
+                                    packet_control_block_t *pcb)
+{
+    tcp_control_block_t syn_tcb;
+    uint32_t            seg_seq = rte_be_to_cpu_32(pcb->pcb_tcp->sent_seq);
+
+    rte_memcpy(&syn_tcb, tcb, sizeof(syn_tcb));
+    tsm_listen_set_peer(&syn_tcb, pcb);
+
+    syn_tcb.tcb_rcv.nxt = seg_seq + 1;
+    syn_tcb.tcb_rcv.irs = seg_seq;
+    tcp_hdr_opts_negotiate(&syn_tcb, pcb->pcb_tcp);
+
+    syn_tcb.tcb_snd.iss = tcp_syncookie_make(&syn_tcb);
+    syn_tcb.tcb_snd.una = syn_tcb.tcb_snd.iss;
+    syn_tcb.tcb_snd.nxt = syn_tcb.tcb_snd.iss + 1;
+
+    INC_STATS(STATS_LOCAL(tpg_tcp_statistics_t, tcb->tcb_l4.l4cb_interface),
+              ts_syncookies_sent);
+
+    /* No retransmissions, the peer retransmits the SYN if needed. */
+    tcp_send_ctrl_pkt(&syn_tcb,
+                      RTE_TCP_SYN_FLAG | RTE_TCP_ACK_FLAG |
+                      TCP_BUILD_FLAG_USE_ISS);
+    return 0;
+}
+
+/*****************************************************************************
+ * tsm_listen_syncookie_ack()
+ *      Allocates the tcb only if the ACK echoes a valid cookie. The segment
+ *      is then processed in SYN_RECV as if the tcb had been there all along.
+ ****************************************************************************/
+static int tsm_listen_syncookie_ack(tcp_control_block_t *tcb,
+                                    packet_control_block_t *pcb)
+{
+    const tcp_sockopt_t  *tcp_opts = tcp_get_sockopt(tcb->tcb_l4.l4cb_sockopt);
+    tpg_tcp_statistics_t *stats;
+    tcp_control_block_t   syn_tcb;
+    tcp_control_block_t  *new_tcb;
+    tcp_hdr_opts_t        opts;
+    uint32_t              seg_seq = rte_be_to_cpu_32(pcb->pcb_tcp->sent_seq);
+    uint32_t              seg_ack = rte_be_to_cpu_32(pcb->pcb_tcp->recv_ack);
+    int                   error;
+
+    stats = STATS_LOCAL(tpg_tcp_statistics_t, tcb->tcb_l4.l4cb_interface);
+
+    rte_memcpy(&syn_tcb, tcb, sizeof(syn_tcb));
+    tsm_listen_set_peer(&syn_tcb, pcb);
+
+    syn_tcb.tcb_rcv.irs = seg_seq - 1;
+    syn_tcb.tcb_rcv.nxt = seg_seq;
+
+    if (!tcp_syncookie_check(&syn_tcb, seg_ack - 1)) {
+        INC_STATS(stats, ts_syncookies_bad);
+
+        /* Same as for segments that don't match any session:
+         * <SEQ=SEG.ACK><CTL=RST>
+         */
+        syn_tcb.tcb_snd.nxt = seg_ack;
+        tcp_send_ctrl_pkt(&syn_tcb, RTE_TCP_RST_FLAG);
+        return 0;
+    }
+
+    INC_STATS(stats, ts_syncookies_ok);
+
+    /* The peer only sends timestamps if our SYN/ACK had them. */
+    tcp_hdr_opts_parse(pcb->pcb_tcp, &opts);
+    syn_tcb.tcb_ts_ok = (opts.tho_ts_present && tcp_opts->tcpo_timestamps);
+    if (syn_tcb.tcb_ts_ok)
+        syn_tcb.tcb_ts_recent = opts.tho_tsval;
+
+    syn_tcb.tcb_snd.iss = seg_ack - 1;
+    syn_tcb.tcb_snd.una = syn_tcb.tcb_snd.iss;
+    syn_tcb.tcb_snd.nxt = seg_ack;
+    syn_tcb.tcb_recover = syn_tcb.tcb_snd.iss;
+    syn_tcb.tcb_rto_nxt = syn_tcb.tcb_snd.iss;
+    syn_tcb.tcb_rto_end = syn_tcb.tcb_snd.iss;
+
+    new_tcb = tcb_clone(&syn_tcb);
+    if (unlikely(new_tcb == NULL))
+        return -ENOMEM;
+
+    error = tlkp_add_tcb(new_tcb);
+    if (error) {
+        TCB_TRACE(tcb, TSM, ERROR, "[%s()] failed to add clone tcb: %s(%d).",
+                  __func__, rte_strerror(-error), -error);
+        return -ENOMEM;
+    }
+
+    if (unlikely(new_tcb->tcb_trace))
+        pcb->pcb_trace = true;
+
+    pcb->pcb_rx_cb = &new_tcb->tcb_l4;
+
+    error = tsm_enter_state(new_tcb, TS_SYN_RECV, pcb);
+    if (unlikely(error))
+        return error;
+
+    return tsm_dispatch_net_event(new_tcb, TE_SEGMENT_ARRIVES, pcb);
+}
+
+/*****************************************************************************
+ * tsm_listen_fastopen_syn()
+ *      RFC 7413: the SYN had a valid cookie so its data is delivered right
+ *      away and acked by the SYN/ACK. The server can then reply before the
+ *      handshake completes.
+ ****************************************************************************/
+static int tsm_listen_fastopen_syn(tcp_control_block_t *tcb,
+                                   packet_control_block_t *pcb)
+{
+    uint32_t seg_seq = rte_be_to_cpu_32(pcb->pcb_tcp->sent_seq);
+    int      error;
+
+    /* Windows in SYNs are never scaled. */
+    tcb->tcb_snd.wnd = rte_be_to_cpu_16(pcb->pcb_tcp->rx_win);
+    tcb->tcb_snd.wl1 = seg_seq;
+    tcb->tcb_snd.wl2 = tcb->tcb_snd.iss;
+
+    pcb->pcb_rx_cb = &tcb->tcb_l4;
+
+    /* The application must know about the session before getting data. */
+    error = tsm_enter_state(tcb, TS_SYN_RECV, pcb);
+    if (unlikely(error))
+        return error;
+
+    tcb->tcb_tfo.tt_syn_data = true;
+    tsm_handle_incoming(tcb, pcb, seg_seq + 1, pcb->pcb_l5_len);
+
+    INC_STATS(STATS_LOCAL(tpg_tcp_statistics_t, tcb->tcb_l4.l4cb_interface),
+              ts_tfo_syn_data_ok);
+
+    tcp_send_ctrl_pkt(tcb, RTE_TCP_SYN_FLAG | RTE_TCP_ACK_FLAG |
+                           TCP_BUILD_FLAG_USE_ISS);
+    return 0;
+}
+
 /*****************************************************************************
  * tsm_SF_listen()
  ****************************************************************************/
@@ -720,12 +1321,23 @@ static int tsm_SF_listen(tcp_control_block_t *tcb, tcpEvent_t event,
             *   <SEQ=SEG.ACK><CTL=RST>
             */
             if (TCP_IS_FLAG_SET(tcp, RTE_TCP_ACK_FLAG)) {
+                /* With SYN cookies the final ACK of the handshake is the
+                 * first segment we see for the session.
+                 */
+                if (!TCP_IS_FLAG_SET(tcp, RTE_TCP_SYN_FLAG) &&
+                        tcp_get_sockopt(tcb->tcb_l4.l4cb_sockopt)->tcpo_syn_cookies)
+                    return tsm_listen_syncookie_ack(tcb, pcb);
+
                 tcp_send_ctrl_pkt(tcb, RTE_TCP_ACK_FLAG | RTE_TCP_RST_FLAG);
                 return 0;
             }
 
             if (likely(TCP_IS_FLAG_SET(tcp, RTE_TCP_SYN_FLAG))) {
                 TCP_RECV_SYN_INC_STAT(tcb);
+
+                if (tcp_get_sockopt(tcb->tcb_l4.l4cb_sockopt)->tcpo_syn_cookies)
+                    return tsm_listen_syncookie_syn(tcb, pcb);
+
                 /* Keep the old tcb in the LISTEN state and continue using
                  * a clone.
                  */
@@ -737,13 +1349,7 @@ static int tsm_SF_listen(tcp_control_block_t *tcb, tcpEvent_t event,
                     /* TODO: how do we handle server allocation errors? */
                     return -ENOMEM;
                 }
-                new_tcb->tcb_l4.l4cb_dst_addr =
-                    TPG_IPV4(rte_be_to_cpu_32(pcb->pcb_ipv4->src_addr));
-                new_tcb->tcb_l4.l4cb_dst_port =
-                    rte_be_to_cpu_16(pcb->pcb_tcp->src_port);
-
-                /* Recompute the hash and add the new_tcb to the htable. */
-                l4_cb_calc_connection_hash(&new_tcb->tcb_l4);
+                tsm_listen_set_peer(new_tcb, pcb);
 
                 /* TODO: No need to compute the hash, we can use it from the incomming packet,
                  *       however its messing up the performance numbers :( Need to make time
@@ -777,6 +1383,9 @@ static int tsm_SF_listen(tcp_control_block_t *tcb, tcpEvent_t event,
                 new_tcb->tcb_rcv.nxt = seg_seq + 1;
                 new_tcb->tcb_rcv.irs = seg_seq;
 
+                /* Process the options in the SYN before replying. */
+                tcp_hdr_opts_negotiate(new_tcb, tcp);
+
                 /* TODO: queuue control/text for later */
 
                 /* No need to do this as it was already done at pool creation:
@@ -784,6 +1393,13 @@ static int tsm_SF_listen(tcp_control_block_t *tcb, tcpEvent_t event,
                  */
                 new_tcb->tcb_snd.una = new_tcb->tcb_snd.iss;
                 new_tcb->tcb_snd.nxt = new_tcb->tcb_snd.iss + 1;
+                new_tcb->tcb_recover = new_tcb->tcb_snd.iss;
+                new_tcb->tcb_rto_nxt = new_tcb->tcb_snd.iss;
+                new_tcb->tcb_rto_end = new_tcb->tcb_snd.iss;
+
+                if (unlikely(new_tcb->tcb_tfo.tt_cookie_ok) &&
+                        pcb->pcb_l5_len != 0)
+                    return tsm_listen_fastopen_syn(new_tcb, pcb);
 
                 tcp_send_ctrl_pkt(new_tcb,
                     RTE_TCP_SYN_FLAG | RTE_TCP_ACK_FLAG | TCP_BUILD_FLAG_USE_ISS);
@@ -825,6 +1441,25 @@ static int tsm_SF_syn_sent(tcp_control_block_t *tcb, tcpEvent_t event,
     switch (event) {
     case TE_ENTER_STATE:
         TCP_NOTIF(TEST_NOTIF_SESS_CONNECTING, tcb);
+
+        /* RFC 7413: with a cookie the application can send right away, its
+         * first data goes out with the SYN. If it has nothing to send the
+         * SYN isn't delayed.
+         */
+        if (unlikely(tcb->tcb_tfo.tt_syn_pending)) {
+            tcb->tcb_tfo.tt_early_conn = true;
+            TCP_NOTIF(TEST_NOTIF_SESS_CONNECTED, tcb);
+
+            if (tcb->tcb_state != TS_SYN_SENT)
+                break;
+
+            if (!test_sm_has_data_pending(&tcb->tcb_l4)) {
+                tcb->tcb_tfo.tt_syn_pending = false;
+                tcp_send_ctrl_pkt(tcb, RTE_TCP_SYN_FLAG |
+                                       TCP_BUILD_FLAG_USE_ISS);
+            }
+        }
+
         /* Starting here on we need to do retrans. */
         tsm_schedule_retransmission(tcb);
         break;
@@ -833,6 +1468,16 @@ static int tsm_SF_syn_sent(tcp_control_block_t *tcb, tcpEvent_t event,
         break;
 
     case TE_SEND:
+        if (unlikely(tcb->tcb_tfo.tt_early_conn) && likely(tsm_arg != NULL)) {
+            int status = tcp_data_send_syn(tcb, tsm_arg);
+
+            /* Nothing else goes out until the SYN/ACK opens the window. */
+            TCP_NOTIF(TEST_NOTIF_SESS_WIN_UNAVAIL, tcb);
+            return status;
+        }
+
+        return -ENOTCONN;
+
     case TE_RECEIVE:
         return -ENOTCONN;
 
@@ -856,7 +1501,7 @@ static int tsm_SF_syn_sent(tcp_control_block_t *tcb, tcpEvent_t event,
 
             seg_ack = rte_be_to_cpu_32(tcp->recv_ack);
             seg_seq = rte_be_to_cpu_32(tcp->sent_seq);
-            seg_wnd = rte_be_to_cpu_16(tcp->rx_win);
+            seg_wnd = tcp_seg_wnd(tcb, tcp);
             seg_len = pcb->pcb_l5_len;
 
             /*
@@ -930,6 +1575,8 @@ static int tsm_SF_syn_sent(tcp_control_block_t *tcb, tcpEvent_t event,
                  */
                 tcb->tcb_rcv.nxt = seg_seq + 1;
                 tcb->tcb_rcv.irs = seg_seq;
+                tcp_hdr_opts_negotiate(tcb, tcp);
+
                 if (TCP_IS_FLAG_SET(tcp, RTE_TCP_ACK_FLAG)) {
                     /* Increment tcb_snd.una so we take into account the ack for
                      * the SYN we sent. There might be some data segments that
@@ -958,10 +1605,28 @@ static int tsm_SF_syn_sent(tcp_control_block_t *tcb, tcpEvent_t event,
                         tcb->tcb_snd.wl1 = seg_seq;
                         tcb->tcb_snd.wl2 = seg_ack;
 
+                        /* RFC 7413: data the server didn't ack with the
+                         * SYN is sent again once established.
+                         */
+                        if (unlikely(tcb->tcb_tfo.tt_syn_data)) {
+                            if (SEG_LT(tcb->tcb_snd.una, tcb->tcb_snd.nxt)) {
+                                tcb->tcb_snd.nxt = tcb->tcb_snd.una;
+                                tcb->tcb_rtt.trtt_start = 0;
+                            } else {
+                                INC_STATS(STATS_LOCAL(tpg_tcp_statistics_t,
+                                                      tcb->tcb_l4.l4cb_interface),
+                                          ts_tfo_syn_data_acked);
+                            }
+                        }
+
                         /* We can already receive data on the session so
-                         * let's notify that the session is connected.
+                         * let's notify that the session is connected (TFO
+                         * sessions already are).
                          */
-                        TCP_NOTIF(TEST_NOTIF_SESS_CONNECTED, tcb);
+                        if (likely(!tcb->tcb_tfo.tt_early_conn))
+                            TCP_NOTIF(TEST_NOTIF_SESS_CONNECTED, tcb);
+                        else
+                            TCP_NOTIF(TEST_NOTIF_SESS_WIN_AVAIL, tcb);
 
                         /*
                          * sixth, check the URG bit, [77]
@@ -977,14 +1642,17 @@ static int tsm_SF_syn_sent(tcp_control_block_t *tcb, tcpEvent_t event,
                          * enter_state but in this case we know for sure the
                          * tcb is still valid (nothing happens in
                          * tsm_SF_estab(enter_state))!
-                         * We might be able to delay this ACK so do that if
-                         * the application is about to send more data.
+                         * The ACK goes out at the end of the RX burst so
+                         * data the application sends right away carries it.
                          */
                         ret = tsm_enter_state(tcb, TS_ESTABLISHED, NULL);
 
                         /* Send <SEQ=SND.NXT><ACK=RCV.NXT><CTL=ACK> */
-                        if (tsm_need_ack(tcb))
-                            tcp_send_ack_pkt(tcb);
+                        tcp_send_ack_burst(tcb);
+
+                        /* TFO data that didn't make it in the SYN. */
+                        if (unlikely(tcb->tcb_retrans.tr_total_size != 0))
+                            tsm_send_unsent_data(tcb);
 
                         return ret;
                     }
@@ -1008,7 +1676,18 @@ static int tsm_SF_syn_sent(tcp_control_block_t *tcb, tcpEvent_t event,
     case TE_USER_TIMEOUT:
         break;
     case TE_RETRANSMISSION_TIMEOUT:
-        tcp_opts = tcp_get_sockopt(&tcb->tcb_l4.l4cb_sockopt);
+        /* TFO: the application didn't send anything yet, don't wait for it
+         * anymore. This isn't a retransmission.
+         */
+        if (unlikely(tcb->tcb_tfo.tt_syn_pending)) {
+            tcb->tcb_tfo.tt_syn_pending = false;
+            tcb->tcb_retrans_cnt = 0;
+            tcp_send_ctrl_pkt(tcb, RTE_TCP_SYN_FLAG | TCP_BUILD_FLAG_USE_ISS);
+            tsm_schedule_retransmission(tcb);
+            break;
+        }
+
+        tcp_opts = tcp_get_sockopt(tcb->tcb_l4.l4cb_sockopt);
         if (TCP_TOO_MANY_RETRIES(tcb, tcp_opts->tcpo_syn_retry_cnt,
                                  tsms_syn_to)) {
             /*
@@ -1056,6 +1735,14 @@ static int tsm_SF_syn_recv(tcp_control_block_t *tcb, tcpEvent_t event,
         break;
 
     case TE_SEND:
+        /* RFC 7413: replies to data accepted with the SYN don't have to wait
+         * for the handshake to complete.
+         */
+        if (unlikely(tcb->tcb_tfo.tt_syn_data) && likely(tsm_arg != NULL))
+            return tsm_send_data(tcb, tsm_arg);
+
+        return -ENOTCONN;
+
     case TE_RECEIVE:
         return -ENOTCONN;
 
@@ -1073,7 +1760,7 @@ static int tsm_SF_syn_recv(tcp_control_block_t *tcb, tcpEvent_t event,
             uint32_t                seg_len = pcb->pcb_l5_len;
             uint32_t                seg_seq = rte_be_to_cpu_32(tcp->sent_seq);
             uint32_t                seg_ack = rte_be_to_cpu_32(tcp->recv_ack);
-            uint32_t                seg_wnd = rte_be_to_cpu_16(tcp->rx_win);
+            uint32_t                seg_wnd = tcp_seg_wnd(tcb, tcp);
             bool                    seg_ok;
 
             /*
@@ -1199,13 +1886,13 @@ static int tsm_SF_syn_recv(tcp_control_block_t *tcb, tcpEvent_t event,
              * seventh, process the segment text,
              */
             if (seg_len && tsm_handle_incoming(tcb, pcb, seg_seq, seg_len)) {
-                /* Delay the single TCP ack if possible (if the APP is about
-                 * to send out more data).
+                /* Send <SEQ=SND.NXT><ACK=RCV.NXT><CTL=ACK> (maybe delayed). */
+                tcp_send_ack_delayed(tcb);
+            } else if (seg_len && !TCB_RCVBUF_EMPTY(tcb)) {
+                /* RFC 5681: out of order segments should be acked right
+                 * away. The duplicate ACK also carries the SACK blocks.
                  */
-
-                /* Send <SEQ=SND.NXT><ACK=RCV.NXT><CTL=ACK> */
-                if (tsm_need_ack(tcb))
-                    tcp_send_ack_pkt(tcb);
+                tcp_send_ack_pkt(tcb);
             }
 
             /*
@@ -1222,8 +1909,13 @@ static int tsm_SF_syn_recv(tcp_control_block_t *tcb, tcpEvent_t event,
                 return tsm_enter_state(tcb, TS_CLOSE_WAIT, NULL);
             }
 
-            /* No need to retransmit the syn-ack. */
+            /* No need to retransmit the syn-ack. Data we sent before the
+             * handshake completed (TFO) might still be in flight though.
+             */
             tcp_timer_rto_cancel(&tcb->tcb_l4);
+            if (unlikely(tcb->tcb_tfo.tt_syn_data))
+                tsm_schedule_retransmission(tcb);
+
             return tsm_enter_state(tcb, TS_ESTABLISHED, NULL);
         }
         break;
@@ -1231,7 +1923,7 @@ static int tsm_SF_syn_recv(tcp_control_block_t *tcb, tcpEvent_t event,
     case TE_USER_TIMEOUT:
         break;
     case TE_RETRANSMISSION_TIMEOUT:
-        tcp_opts = tcp_get_sockopt(&tcb->tcb_l4.l4cb_sockopt);
+        tcp_opts = tcp_get_sockopt(tcb->tcb_l4.l4cb_sockopt);
         if (TCP_TOO_MANY_RETRIES(tcb,
                                  tcp_opts->tcpo_syn_ack_retry_cnt,
                                  tsms_synack_to)) {
@@ -1284,9 +1976,31 @@ static int tsm_SF_estab(tcp_control_block_t *tcb, tcpEvent_t event,
     case TE_RECEIVE:
         break;
     case TE_CLOSE:
+        /* Already waiting to send the RST. */
+        if (tcb->tcb_rst_close)
+            break;
+
         /* Starting to close the session so send out the notification. */
         TCP_NOTIF(TEST_NOTIF_SESS_CLOSING, tcb);
-        return tsm_enter_state(tcb, TS_FIN_WAIT_I, NULL);
+
+        tcp_opts = tcp_get_sockopt(tcb->tcb_l4.l4cb_sockopt);
+        if (tcp_opts->tcpo_close_mode == TCP_CLOSE_MODE__GRACEFUL)
+            return tsm_enter_state(tcb, TS_FIN_WAIT_I, NULL);
+
+        /* The tcb can't be freed under the segment processing code if the
+         * application closes while receiving data. Wait for the end of the
+         * burst in that case.
+         */
+        tcb->tcb_rst_close = true;
+        if (unlikely(RTE_PER_LCORE(tcp_rx_tcb) == tcb)) {
+            tcp_rst_close_burst(tcb);
+            break;
+        }
+
+        /* Otherwise reset now unless there's unacked data left. */
+        if (tsm_close_with_rst(tcb))
+            return tsm_rst_close(tcb, NULL);
+        break;
     case TE_ABORT:
     case TE_STATUS:
         break;
@@ -1298,7 +2012,7 @@ static int tsm_SF_estab(tcp_control_block_t *tcb, tcpEvent_t event,
             uint32_t                seg_len = pcb->pcb_l5_len;
             uint32_t                seg_seq = rte_be_to_cpu_32(tcp->sent_seq);
             uint32_t                seg_ack = rte_be_to_cpu_32(tcp->recv_ack);
-            uint32_t                seg_wnd = rte_be_to_cpu_16(tcp->rx_win);
+            uint32_t                seg_wnd = tcp_seg_wnd(tcb, tcp);
             bool                    seg_ok;
 
             /*
@@ -1357,6 +2071,8 @@ static int tsm_SF_estab(tcp_control_block_t *tcb, tcpEvent_t event,
                 SEG_LE(seg_ack, tcb->tcb_snd.nxt)) {
                 /* Will update tcb_snd.una inside! */
                 tsm_cleanup_retrans_queu(tcb, seg_ack);
+            } else if (tsm_is_dup_ack(tcb, tcp, seg_ack, seg_len, seg_wnd)) {
+                tsm_dup_ack(tcb);
             }
 
             /*
@@ -1381,6 +2097,17 @@ static int tsm_SF_estab(tcp_control_block_t *tcb, tcpEvent_t event,
                 tcb->tcb_snd.wl2 = seg_ack;
             }
 
+            /* The ACK might have opened the window for queued data. */
+            tsm_send_unsent_data(tcb);
+
+            /* Closed in rst-after-data mode: reset once everything was
+             * acked or as soon as the peer starts closing too.
+             */
+            if (unlikely(tcb->tcb_rst_close) &&
+                    (tsm_close_with_rst(tcb) || tcb->tcb_fin_rcvd ||
+                     TCP_IS_FLAG_SET(tcp, RTE_TCP_FIN_FLAG)))
+                return tsm_rst_close(tcb, pcb);
+
             /* TODO: No receive window update, as we keep it at max for auto consume */
 
             /*
@@ -1388,14 +2115,18 @@ static int tsm_SF_estab(tcp_control_block_t *tcb, tcpEvent_t event,
              * seventh, process the segment text,
              */
             if (seg_len && tsm_handle_incoming(tcb, pcb, seg_seq, seg_len)) {
-                /* If the application isn't going to send data in the near
-                 * future then send out the ACK now.
+                /* RFC 1122: ack every second full sized segment, the
+                 * delayed ACK timer (or our own data) takes care of the
+                 * rest.
                  *
                  * send <SEQ=SND.NXT><ACK=RCV.NXT><CTL=ACK>
                  */
-
-                if (tsm_need_ack(tcb))
-                    tcp_send_ack_pkt(tcb);
+                tcp_send_ack_delayed(tcb);
+            } else if (seg_len && !TCB_RCVBUF_EMPTY(tcb)) {
+                /* RFC 5681: out of order segments should be acked right
+                 * away. The duplicate ACK also carries the SACK blocks.
+                 */
+                tcp_send_ack_pkt(tcb);
             }
 
             /*
@@ -1451,7 +2182,7 @@ static int tsm_SF_estab(tcp_control_block_t *tcb, tcpEvent_t event,
     case TE_USER_TIMEOUT:
         break;
     case TE_RETRANSMISSION_TIMEOUT:
-        tcp_opts = tcp_get_sockopt(&tcb->tcb_l4.l4cb_sockopt);
+        tcp_opts = tcp_get_sockopt(tcb->tcb_l4.l4cb_sockopt);
         if (TCP_TOO_MANY_RETRIES(tcb, tcp_opts->tcpo_data_retry_cnt,
                                  tsms_retry_to)) {
             /* Starting to close the session so send out the
@@ -1496,7 +2227,7 @@ static int tsm_SF_fin_wait_I(tcp_control_block_t *tcb, tcpEvent_t event,
         tsm_schedule_retransmission(tcb);
 
         /* Schedule the orphan timer so we don't stay in FIN-WAIT-I forever. */
-        tcp_opts = tcp_get_sockopt(&tcb->tcb_l4.l4cb_sockopt);
+        tcp_opts = tcp_get_sockopt(tcb->tcb_l4.l4cb_sockopt);
         tcp_timer_slow_set(&tcb->tcb_l4, tcp_opts->tcpo_orphan_to);
         break;
 
@@ -1517,7 +2248,7 @@ static int tsm_SF_fin_wait_I(tcp_control_block_t *tcb, tcpEvent_t event,
             uint32_t                seg_len = pcb->pcb_l5_len;
             uint32_t                seg_seq = rte_be_to_cpu_32(tcp->sent_seq);
             uint32_t                seg_ack = rte_be_to_cpu_32(tcp->recv_ack);
-            uint32_t                seg_wnd = rte_be_to_cpu_16(tcp->rx_win);
+            uint32_t                seg_wnd = tcp_seg_wnd(tcb, tcp);
             bool                    seg_ok;
             bool                    our_fin_acked = false;
 
@@ -1650,8 +2381,8 @@ static int tsm_SF_fin_wait_I(tcp_control_block_t *tcb, tcpEvent_t event,
                     if (SEG_EQ(tcb->tcb_rcv.nxt, tcb->tcb_rcv_fin_seq))
                         tcb->tcb_rcv.nxt++;
                 }
-                /* Send <SEQ=SND.NXT><ACK=RCV.NXT><CTL=ACK> */
-                tcp_send_ack_pkt(tcb);
+                /* Send <SEQ=SND.NXT><ACK=RCV.NXT><CTL=ACK> once per burst. */
+                tcp_send_ack_burst(tcb);
             } else {
                 uint32_t fin_seq = seg_seq + seg_len;
                 TCP_RECV_FIN_INC_STAT(tcb);
@@ -1703,7 +2434,7 @@ static int tsm_SF_fin_wait_I(tcp_control_block_t *tcb, tcpEvent_t event,
     case TE_USER_TIMEOUT:
         break;
     case TE_RETRANSMISSION_TIMEOUT:
-        tcp_opts = tcp_get_sockopt(&tcb->tcb_l4.l4cb_sockopt);
+        tcp_opts = tcp_get_sockopt(tcb->tcb_l4.l4cb_sockopt);
         if (TCP_TOO_MANY_RETRIES(tcb, tcp_opts->tcpo_retry_cnt,
                                  tsms_retry_to)) {
             /* Cancel the orphan timer first. */
@@ -1761,7 +2492,7 @@ static int tsm_SF_fin_wait_II(tcp_control_block_t *tcb, tcpEvent_t event,
         /* Schedule the fin timeout timer so we don't stay in FIN-WAIT-II
          * forever.
          */
-        tcp_opts = tcp_get_sockopt(&tcb->tcb_l4.l4cb_sockopt);
+        tcp_opts = tcp_get_sockopt(tcb->tcb_l4.l4cb_sockopt);
         tcp_timer_slow_set(&tcb->tcb_l4, tcp_opts->tcpo_fin_to);
         break;
 
@@ -1782,7 +2513,7 @@ static int tsm_SF_fin_wait_II(tcp_control_block_t *tcb, tcpEvent_t event,
             uint32_t                seg_len = pcb->pcb_l5_len;
             uint32_t                seg_seq = rte_be_to_cpu_32(tcp->sent_seq);
             uint32_t                seg_ack = rte_be_to_cpu_32(tcp->recv_ack);
-            uint32_t                seg_wnd = rte_be_to_cpu_16(tcp->rx_win);
+            uint32_t                seg_wnd = tcp_seg_wnd(tcb, tcp);
             bool                    seg_ok;
 
             /*
@@ -1895,8 +2626,8 @@ static int tsm_SF_fin_wait_II(tcp_control_block_t *tcb, tcpEvent_t event,
              * eighth, check the FIN bit,
              */
             if (!TCP_IS_FLAG_SET(tcp, RTE_TCP_FIN_FLAG)) {
-                /* Send <SEQ=SND.NXT><ACK=RCV.NXT><CTL=ACK> */
-                tcp_send_ack_pkt(tcb);
+                /* Send <SEQ=SND.NXT><ACK=RCV.NXT><CTL=ACK> once per burst. */
+                tcp_send_ack_burst(tcb);
             } else {
                 TCP_RECV_FIN_INC_STAT(tcb);
                 /* Cancel the fin timer first. */
@@ -2039,7 +2770,7 @@ static int tsm_SF_last_ack(tcp_control_block_t *tcb, tcpEvent_t event,
     case TE_USER_TIMEOUT:
         break;
     case TE_RETRANSMISSION_TIMEOUT:
-        tcp_opts = tcp_get_sockopt(&tcb->tcb_l4.l4cb_sockopt);
+        tcp_opts = tcp_get_sockopt(tcb->tcb_l4.l4cb_sockopt);
         if (TCP_TOO_MANY_RETRIES(tcb, tcp_opts->tcpo_retry_cnt,
                                  tsms_retry_to)) {
             /*
@@ -2102,7 +2833,7 @@ static int tsm_SF_closing(tcp_control_block_t *tcb, tcpEvent_t event,
             uint32_t                seg_len = pcb->pcb_l5_len;
             uint32_t                seg_seq = rte_be_to_cpu_32(tcp->sent_seq);
             uint32_t                seg_ack = rte_be_to_cpu_32(tcp->recv_ack);
-            uint32_t                seg_wnd = rte_be_to_cpu_16(tcp->rx_win);
+            uint32_t                seg_wnd = tcp_seg_wnd(tcb, tcp);
             bool                    seg_ok;
 
             /*
@@ -2211,7 +2942,7 @@ static int tsm_SF_closing(tcp_control_block_t *tcb, tcpEvent_t event,
     case TE_USER_TIMEOUT:
         break;
     case TE_RETRANSMISSION_TIMEOUT:
-        tcp_opts = tcp_get_sockopt(&tcb->tcb_l4.l4cb_sockopt);
+        tcp_opts = tcp_get_sockopt(tcb->tcb_l4.l4cb_sockopt);
         if (TCP_TOO_MANY_RETRIES(tcb, tcp_opts->tcpo_retry_cnt,
                                  tsms_retry_to)) {
             /*
@@ -2261,11 +2992,39 @@ static int tsm_SF_time_wait(tcp_control_block_t *tcb, tcpEvent_t event,
         if (TCB_SLOW_TMR_IS_SET(tcb))
             tcp_timer_slow_cancel(&tcb->tcb_l4);
 
-        tcp_opts = tcp_get_sockopt(&tcb->tcb_l4.l4cb_sockopt);
+        tcp_opts = tcp_get_sockopt(tcb->tcb_l4.l4cb_sockopt);
         if (tcp_opts->tcpo_skip_timewait)
             return tsm_enter_state(tcb, TS_CLOSED, NULL);
-        else
+
+        /* Client TCBs are reused by the test case: freeing them early would
+         * only reopen the same tuple right away. Keep them on the timer.
+         */
+        if (!tcb->tcb_malloced) {
             tcp_timer_slow_set(&tcb->tcb_l4, tcp_opts->tcpo_twait_to);
+            break;
+        }
+
+        /* Server sessions only keep a compact record for the rest of
+         * TIME_WAIT and free the tcb. If the table is full the tcb stays
+         * until the timeout.
+         */
+        if (likely(tlkp_add_tw(tcb, tcp_opts->tcpo_twait_to))) {
+            INC_STATS(STATS_LOCAL(tpg_tcp_statistics_t,
+                                  tcb->tcb_l4.l4cb_interface),
+                      ts_tw_added);
+
+            /* The session isn't over on the wire: the record still has to
+             * re-ACK a retransmitted FIN so the silent close mustn't reset
+             * the peer. Same as when closing after a received RST.
+             */
+            tcb->tcb_rst_rcvd = true;
+            return tsm_enter_state(tcb, TS_CLOSED, NULL);
+        }
+
+        INC_STATS(STATS_LOCAL(tpg_tcp_statistics_t,
+                              tcb->tcb_l4.l4cb_interface),
+                  ts_tw_full);
+        tcp_timer_slow_set(&tcb->tcb_l4, tcp_opts->tcpo_twait_to);
         break;
 
     case TE_OPEN:
@@ -2334,7 +3093,7 @@ static int tsm_SF_time_wait(tcp_control_block_t *tcb, tcpEvent_t event,
 
             assert(TCB_SLOW_TMR_IS_SET(tcb));
 
-            tcp_opts = tcp_get_sockopt(&tcb->tcb_l4.l4cb_sockopt);
+            tcp_opts = tcp_get_sockopt(tcb->tcb_l4.l4cb_sockopt);
             tcp_timer_slow_cancel(&tcb->tcb_l4);
             tcp_timer_slow_set(&tcb->tcb_l4, tcp_opts->tcpo_twait_to);
         }
@@ -2368,6 +3127,13 @@ static int tsm_SF_close_wait(tcp_control_block_t *tcb, tcpEvent_t event,
     switch (event) {
     case TE_ENTER_STATE:
         if (tcb->tcb_consume_all_data) {
+            /* The peer is closing anyway, skip LAST_ACK if the close mode
+             * allows it. With data still in flight in rst-after-data mode
+             * our FIN follows the data as usual.
+             */
+            if (tsm_close_with_rst(tcb))
+                return tsm_rst_close(tcb, NULL);
+
             /* TODO: we should wait for all our sent data to be acked at least.. */
 
             /* Send <SEQ=SND.NXT><ACK=RCV.NXT><CTL=FIN,ACK>
@@ -2409,7 +3175,7 @@ static int tsm_SF_close_wait(tcp_control_block_t *tcb, tcpEvent_t event,
             uint32_t                seg_len = pcb->pcb_l5_len;
             uint32_t                seg_seq = rte_be_to_cpu_32(tcp->sent_seq);
             uint32_t                seg_ack = rte_be_to_cpu_32(tcp->recv_ack);
-            uint32_t                seg_wnd = rte_be_to_cpu_16(tcp->rx_win);
+            uint32_t                seg_wnd = tcp_seg_wnd(tcb, tcp);
             bool                    seg_ok;
 
             /*
@@ -2464,6 +3230,8 @@ static int tsm_SF_close_wait(tcp_control_block_t *tcb, tcpEvent_t event,
                 SEG_LE(seg_ack, tcb->tcb_snd.nxt)) {
                 /* Will update tcb_snd.una inside! */
                 tsm_cleanup_retrans_queu(tcb, seg_ack);
+            } else if (tsm_is_dup_ack(tcb, tcp, seg_ack, seg_len, seg_wnd)) {
+                tsm_dup_ack(tcb);
             }
 
             /*
@@ -2489,6 +3257,9 @@ static int tsm_SF_close_wait(tcp_control_block_t *tcb, tcpEvent_t event,
                 tcb->tcb_snd.wl2 = seg_ack;
             }
 
+            /* The ACK might have opened the window for queued data. */
+            tsm_send_unsent_data(tcb);
+
             /* Wait for the user to issue CLOSE and then send our FIN. */
         }
         break;
@@ -2496,7 +3267,7 @@ static int tsm_SF_close_wait(tcp_control_block_t *tcb, tcpEvent_t event,
     case TE_USER_TIMEOUT:
         break;
     case TE_RETRANSMISSION_TIMEOUT:
-        tcp_opts = tcp_get_sockopt(&tcb->tcb_l4.l4cb_sockopt);
+        tcp_opts = tcp_get_sockopt(tcb->tcb_l4.l4cb_sockopt);
         if (TCP_TOO_MANY_RETRIES(tcb, tcp_opts->tcpo_retry_cnt,
                                  tsms_retry_to)) {
             /*
@@ -2547,14 +3318,14 @@ static int tsm_SF_closed(tcp_control_block_t *tcb, tcpEvent_t event,
          * any memory we allocated for it. This is equivalent to a silent
          * close call.
          *
-         * Here we set pcb->pcb_sockopt to NULL because after tcp session
+         * Here we set pcb->pcb_rx_cb to NULL because after tcp session
          * will be closed it won't be valid anymore.
          */
         if (likely(tsm_arg != NULL)) {
             packet_control_block_t *pcb;
 
             pcb = tsm_arg;
-            pcb->pcb_sockopt = NULL;
+            pcb->pcb_rx_cb = NULL;
         }
         return tcp_close_connection(tcb, TCG_SILENT_CLOSE);
 
@@ -2754,6 +3525,18 @@ static void cmd_show_tsm_statistics_parsed(void *parsed_result,
                          tsms_snd_win_full,
                          port,
                          option);
+        SHOW_32BIT_STATS("Fast retrans", tpg_tsm_statistics_t,
+                         tsms_fast_retrans,
+                         port,
+                         option);
+        SHOW_64BIT_STATS("Fast path", tpg_tsm_statistics_t,
+                         tsms_fast_path,
+                         port,
+                         option);
+        SHOW_64BIT_STATS("RST close", tpg_tsm_statistics_t,
+                         tsms_rst_close,
+                         port,
+                         option);
 
         cmdline_printf(cl, "\n");
     }
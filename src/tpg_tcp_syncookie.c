@@ -0,0 +1,193 @@
+/*
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER
+ *
+ * Copyright (c) 2026, Juniper Networks, Inc. All rights reserved.
+ *
+ *
+ * The contents of this file are subject to the terms of the BSD 3 clause
+ * License (the "License"). You may not use this file except in compliance
+ * with the License.
+ *
+ * You can obtain a copy of the license at
+ * https://github.com/Juniper/warp17/blob/master/LICENSE.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from this
+ * software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *
+ * File name:
+ *     tpg_tcp_syncookie.c
+ *
+ * Description:
+ *     Stateless TCP SYN cookies.
+ *
+ * Author:
+ *     Dumitru Ceara, Eelco Chaudron
+ *
+ * Initial Created:
+ *     10/17/2026
+ *
+ * Notes:
+ *
+ */
+
+/*****************************************************************************
+ * Include files
+ ****************************************************************************/
+#include <rte_jhash.h>
+
+#include "tcp_generator.h"
+
+/*****************************************************************************
+ * Global variables
+ ****************************************************************************/
+/* Set once at init, read only afterwards (shared by all lcores). */
+static uint32_t tcp_syncookie_secret[2];
+
+/* Sorted, the cookie stores the index of the biggest value that doesn't
+ * exceed the negotiated MSS.
+ */
+static const uint16_t tcp_syncookie_mss_tbl[1 << TCP_SYNCOOKIE_MSS_BITS] = {
+    TCP_OPT_MSS_MIN, TCP_OPT_MSS_DEFAULT, 1220, 1300, 1440, 1460, 4096, 8960
+};
+
+/*****************************************************************************
+ * tcp_syncookie_init()
+ ****************************************************************************/
+void tcp_syncookie_init(void)
+{
+    tcp_syncookie_secret[0] = (uint32_t)rte_rand();
+    tcp_syncookie_secret[1] = (uint32_t)rte_rand();
+}
+
+/*****************************************************************************
+ * tcp_syncookie_count()
+ ****************************************************************************/
+static inline uint32_t tcp_syncookie_count(void)
+{
+    return (rte_get_timer_cycles() / cycles_per_us / 1000000 /
+                TCP_SYNCOOKIE_PERIOD_S) & TCP_SYNCOOKIE_COUNT_MASK;
+}
+
+/*****************************************************************************
+ * tcp_syncookie_hash()
+ ****************************************************************************/
+static inline uint32_t tcp_syncookie_hash(const tcp_control_block_t *tcb,
+                                          uint32_t count, uint32_t idx)
+{
+    uint32_t words[4];
+
+    words[0] = tcb->tcb_l4.l4cb_src_addr.ip_v4;
+    words[1] = tcb->tcb_l4.l4cb_dst_addr.ip_v4;
+    words[2] = ((uint32_t)tcb->tcb_l4.l4cb_src_port << 16) |
+                    tcb->tcb_l4.l4cb_dst_port;
+    words[3] = count;
+
+    return rte_jhash_32b(words, RTE_DIM(words), tcp_syncookie_secret[idx]);
+}
+
+/*****************************************************************************
+ * tcp_syncookie_make()
+ *      The tuple, IRS and the negotiated options must already be set in the
+ *      tcb.
+ ****************************************************************************/
+uint32_t tcp_syncookie_make(const tcp_control_block_t *tcb)
+{
+    uint32_t count = tcp_syncookie_count();
+    uint32_t mss_idx;
+    uint32_t wscale;
+    uint32_t data;
+
+    for (mss_idx = RTE_DIM(tcp_syncookie_mss_tbl) - 1; mss_idx > 0; mss_idx--) {
+        if (tcp_syncookie_mss_tbl[mss_idx] <= tcb->tcb_snd_mss)
+            break;
+    }
+
+    wscale = tcb->tcb_wscale_ok ? tcb->tcb_snd_wscale :
+                                  TCP_SYNCOOKIE_WSCALE_NONE;
+
+    data = mss_idx |
+           (wscale << TCP_SYNCOOKIE_MSS_BITS) |
+           ((uint32_t)tcb->tcb_sack_ok <<
+                (TCP_SYNCOOKIE_MSS_BITS + TCP_SYNCOOKIE_WSCALE_BITS));
+
+    return tcp_syncookie_hash(tcb, 0, 0) + tcb->tcb_rcv.irs +
+           (count << TCP_SYNCOOKIE_BITS) +
+           ((tcp_syncookie_hash(tcb, count, 1) + data) & TCP_SYNCOOKIE_MASK);
+}
+
+/*****************************************************************************
+ * tcp_syncookie_check()
+ *      Validates the cookie echoed by the peer (SEG.ACK - 1) against the
+ *      tuple and IRS (SEG.SEQ - 1) already set in the tcb. On success the
+ *      options encoded in the cookie are restored in the tcb.
+ ****************************************************************************/
+bool tcp_syncookie_check(tcp_control_block_t *tcb, uint32_t cookie)
+{
+    const tcp_sockopt_t *tcp_opts;
+    uint32_t             count;
+    uint32_t             data;
+    uint32_t             mss;
+    uint32_t             wscale;
+
+    cookie -= tcp_syncookie_hash(tcb, 0, 0) + tcb->tcb_rcv.irs;
+
+    count = cookie >> TCP_SYNCOOKIE_BITS;
+    if (((tcp_syncookie_count() - count) & TCP_SYNCOOKIE_COUNT_MASK) >
+            TCP_SYNCOOKIE_MAX_AGE)
+        return false;
+
+    data = (cookie - tcp_syncookie_hash(tcb, count, 1)) & TCP_SYNCOOKIE_MASK;
+    if (data >= (1u << TCP_SYNCOOKIE_DATA_BITS))
+        return false;
+
+    tcp_opts = tcp_get_sockopt(tcb->tcb_l4.l4cb_sockopt);
+
+    mss = tcp_syncookie_mss_tbl[data & ((1u << TCP_SYNCOOKIE_MSS_BITS) - 1)];
+    if (mss < tcb->tcb_snd_mss) {
+        tcb->tcb_snd_mss = mss;
+        tcp_cc_init(tcb);
+    }
+
+    wscale = (data >> TCP_SYNCOOKIE_MSS_BITS) &
+                TCP_SYNCOOKIE_WSCALE_NONE;
+    if (wscale != TCP_SYNCOOKIE_WSCALE_NONE) {
+        tcb->tcb_wscale_ok = true;
+        tcb->tcb_snd_wscale = TPG_MIN(wscale, TCP_MAX_WIN_SCALE);
+        tcb->tcb_rcv_wscale = tcp_opts->tcpo_win_scale;
+    } else {
+        tcb->tcb_wscale_ok = false;
+        tcb->tcb_snd_wscale = 0;
+        tcb->tcb_rcv_wscale = 0;
+        tcb->tcb_rcv.wnd = TPG_MIN(tcb->tcb_rcv.wnd,
+                                   TCP_MAX_UNSCALED_WINDOW_SIZE);
+    }
+
+    tcb->tcb_sack_ok = ((data >> (TCP_SYNCOOKIE_MSS_BITS +
+                                  TCP_SYNCOOKIE_WSCALE_BITS)) & 1) &&
+                       tcp_opts->tcpo_sack;
+
+    return true;
+}
+
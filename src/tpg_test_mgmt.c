@@ -961,6 +961,14 @@ static int test_start_cb(uint16_t msgid, uint16_t lcore __rte_unused, void *msg)
                           i);
     }
 
+    /* Initialize static routes. */
+    for (i = 0; i < tenv->te_l3_routes_count; i++) {
+        route_v4_static_add(start_msg->tssm_eth_port,
+                            tenv->te_l3_routes[i].l3r_net,
+                            tenv->te_l3_routes[i].l3r_mask,
+                            tenv->te_l3_routes[i].l3r_gw);
+    }
+
     if (pcfg->pc_def_gw.ip_v4 != 0)
         route_v4_gw_add(start_msg->tssm_eth_port, pcfg->pc_def_gw);
 
@@ -1060,6 +1068,14 @@ static int test_stop_cb(uint16_t msgid, uint16_t lcore __rte_unused, void *msg)
     if (pcfg->pc_def_gw.ip_v4 != 0)
         route_v4_gw_del(stop_msg->tssm_eth_port, pcfg->pc_def_gw);
 
+    /* Delete static routes. */
+    for (i = 0; i < tenv->te_l3_routes_count; i++) {
+        route_v4_static_del(stop_msg->tssm_eth_port,
+                            tenv->te_l3_routes[i].l3r_net,
+                            tenv->te_l3_routes[i].l3r_mask,
+                            tenv->te_l3_routes[i].l3r_gw);
+    }
+
     /* Delete L3 interfaces. */
     for (i = 0; i < pcfg->pc_l3_intfs_count; i++) {
         route_v4_intf_del(stop_msg->tssm_eth_port,
@@ -1118,6 +1134,9 @@ int test_mgmt_loop(void *arg __rte_unused)
  ****************************************************************************/
 static bool test_mgmt_init_env(void)
 {
+    tpg_l3_route_t *l3_routes;
+    uint32_t        eth_port;
+
     /*
      * Allocate port test configuration array.
      */
@@ -1125,8 +1144,25 @@ static bool test_mgmt_init_env(void)
                                   rte_eth_dev_count_avail() * sizeof(*test_env),
                                   0,
                                   rte_lcore_to_socket_id(rte_lcore_id()));
+    if (!test_env)
+        return false;
 
-    return test_env != NULL;
+    /*
+     * Allocate the static route arrays for all ports.
+     */
+    l3_routes = rte_zmalloc_socket("test_env_l3_routes",
+                                   rte_eth_dev_count_avail() *
+                                   TPG_TEST_MAX_L3_ROUTE * sizeof(*l3_routes),
+                                   0,
+                                   rte_lcore_to_socket_id(rte_lcore_id()));
+    if (!l3_routes)
+        return false;
+
+    for (eth_port = 0; eth_port < rte_eth_dev_count_avail(); eth_port++)
+        test_env[eth_port].te_l3_routes =
+            &l3_routes[eth_port * TPG_TEST_MAX_L3_ROUTE];
+
+    return true;
 }
 
 /*****************************************************************************
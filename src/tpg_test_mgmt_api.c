@@ -203,6 +203,14 @@ static void test_init_sockopt_defaults(sockopt_t *sockopt,
     else
         sockopt->so_eth.ethso_tx_offload_udp_cksum = false;
 
+    /* TSO also needs the NIC to compute the IP and TCP checksums. */
+    if ((port_dev_info[te->tc_eth_port].pi_dev_info.tx_offload_capa & DEV_TX_OFFLOAD_TCP_TSO) != 0 &&
+            sockopt->so_eth.ethso_tx_offload_ipv4_cksum &&
+            sockopt->so_eth.ethso_tx_offload_tcp_cksum)
+        sockopt->so_eth.ethso_tx_offload_tcp_tso = true;
+    else
+        sockopt->so_eth.ethso_tx_offload_tcp_tso = false;
+
     /*
     * Setup L2 socket options.
     */
@@ -514,6 +522,38 @@ test_mgmt_validate_test_case(const tpg_test_case_t *cfg,
     }
 }
 
+/*****************************************************************************
+ * test_mgmt_validate_l3_route()
+ ****************************************************************************/
+static bool test_mgmt_validate_l3_route(const tpg_l3_route_t *route,
+                                        printer_arg_t *printer_arg)
+{
+    uint32_t host_mask;
+
+    if (route->l3r_net.ip_version != IP_V__IPV4 ||
+            route->l3r_mask.ip_version != IP_V__IPV4 ||
+            route->l3r_gw.ip_version != IP_V__IPV4) {
+        tpg_printf(printer_arg, "ERROR: IPv6 not supported yet!\n");
+        return false;
+    }
+
+    /* The LPM needs contiguous masks and can't store /0 routes (use the
+     * default gateway for that).
+     */
+    host_mask = ~route->l3r_mask.ip_v4;
+    if (route->l3r_mask.ip_v4 == 0 || (host_mask & (host_mask + 1)) != 0) {
+        tpg_printf(printer_arg, "ERROR: Invalid L3 route mask!\n");
+        return false;
+    }
+
+    if (route->l3r_gw.ip_v4 == 0) {
+        tpg_printf(printer_arg, "ERROR: Invalid L3 route gateway!\n");
+        return false;
+    }
+
+    return true;
+}
+
 /*****************************************************************************
  * test_mgmt_validate_port_options()
  ****************************************************************************/
@@ -531,6 +571,16 @@ static bool test_mgmt_validate_port_options(const tpg_port_options_t *options,
         return false;
     }
 
+    if (options->has_po_arp_table_size &&
+            (options->po_arp_table_size < TPG_ARP_TABLE_SIZE_MIN ||
+             options->po_arp_table_size > TPG_ARP_TABLE_SIZE_MAX)) {
+        tpg_printf(printer_arg,
+                   "ERROR: Invalid ARP table size. Supported range: %u -> %u\n",
+                   TPG_ARP_TABLE_SIZE_MIN,
+                   TPG_ARP_TABLE_SIZE_MAX);
+        return false;
+    }
+
     return true;
 }
 
@@ -548,6 +598,24 @@ static bool test_mgmt_validate_tcp_sockopt(const tpg_tcp_sockopt_t *options,
         return false;
     }
 
+    if (options->has_to_win_scale &&
+            options->to_win_scale > TCP_MAX_WIN_SCALE) {
+        tpg_printf(printer_arg,
+                   "ERROR: Invalid TCP window scale. Max allowed: %u\n",
+                   TCP_MAX_WIN_SCALE);
+        return false;
+    }
+
+    /* The window must be representable with the configured scale. */
+    if (options->has_to_win_size && options->to_win_size >
+            (TCP_MAX_UNSCALED_WINDOW_SIZE << options->to_win_scale)) {
+        tpg_printf(printer_arg,
+                   "ERROR: TCP window size too big for window scale %u. Max allowed: %u\n",
+                   options->to_win_scale,
+                   TCP_MAX_UNSCALED_WINDOW_SIZE << options->to_win_scale);
+        return false;
+    }
+
     if (options->has_to_syn_retry_cnt &&
             options->to_syn_retry_cnt > TCP_MAX_RETRY_CNT) {
         tpg_printf(printer_arg,
@@ -587,6 +655,20 @@ static bool test_mgmt_validate_tcp_sockopt(const tpg_tcp_sockopt_t *options,
         return false;
     }
 
+    if (options->has_to_rto_max && options->to_rto_max > TCP_MAX_RTO_MS) {
+        tpg_printf(printer_arg,
+                   "ERROR: Invalid TCP max retransmission timeout. Max allowed: %ums\n",
+                   TCP_MAX_RTO_MS);
+        return false;
+    }
+
+    if (options->has_to_rto_min && options->has_to_rto_max &&
+            options->to_rto_min > options->to_rto_max) {
+        tpg_printf(printer_arg,
+                   "ERROR: TCP min retransmission timeout bigger than max retransmission timeout!\n");
+        return false;
+    }
+
     if (options->has_to_fin_to && options->to_fin_to > TCP_MAX_FIN_TO_MS) {
         tpg_printf(printer_arg,
                    "ERROR: Invalid TCP FIN timeout. Max allowed: %ums\n",
@@ -610,6 +692,46 @@ static bool test_mgmt_validate_tcp_sockopt(const tpg_tcp_sockopt_t *options,
         return false;
     }
 
+    if (options->has_to_ack_delay_to &&
+            (options->to_ack_delay_to == 0 ||
+             options->to_ack_delay_to > TCP_MAX_ACK_DELAY_MS)) {
+        tpg_printf(printer_arg,
+                   "ERROR: Invalid TCP delayed ACK timeout. Allowed: 1-%ums\n",
+                   TCP_MAX_ACK_DELAY_MS);
+        return false;
+    }
+
+    /* A delayed ACK shouldn't trigger retransmissions on the peer side. */
+    if (options->has_to_ack_delay && options->to_ack_delay &&
+            options->has_to_ack_delay_to && options->has_to_rto_min &&
+            options->to_ack_delay_to >= options->to_rto_min) {
+        tpg_printf(printer_arg,
+                   "ERROR: TCP delayed ACK timeout must be smaller than the min retransmission timeout!\n");
+        return false;
+    }
+
+    if (options->has_to_cong_control &&
+            options->to_cong_control >= TCP_CONG_CONTROL__TCP_CONG_CONTROL_MAX) {
+        tpg_printf(printer_arg,
+                   "ERROR: Invalid TCP congestion control algorithm!\n");
+        return false;
+    }
+
+    if (options->has_to_close_mode &&
+            options->to_close_mode >= TCP_CLOSE_MODE__TCP_CLOSE_MODE_MAX) {
+        tpg_printf(printer_arg, "ERROR: Invalid TCP close mode!\n");
+        return false;
+    }
+
+    if (options->has_to_pmtu && options->to_pmtu != 0 &&
+            (options->to_pmtu < TCP_MIN_PMTU ||
+             options->to_pmtu > PORT_MAX_MTU)) {
+        tpg_printf(printer_arg,
+                   "ERROR: Invalid TCP path MTU. Allowed: 0 or %u-%u\n",
+                   (uint32_t)TCP_MIN_PMTU, PORT_MAX_MTU);
+        return false;
+    }
+
     return true;
 }
 
@@ -869,6 +991,9 @@ static void test_mgmt_clear_tsm_statistics(uint32_t eth_port)
         stats->tsms_retrans_bytes = 0;
         stats->tsms_missing_seq = 0;
         stats->tsms_snd_win_full = 0;
+        stats->tsms_fast_retrans = 0;
+        stats->tsms_fast_path = 0;
+        stats->tsms_rst_close = 0;
     }
 }
 
@@ -911,7 +1036,8 @@ void test_init_defaults(tpg_test_case_t *te, tpg_test_case_type_t type,
 int test_mgmt_add_port_cfg(uint32_t eth_port, const tpg_port_cfg_t *cfg,
                            printer_arg_t *printer_arg)
 {
-    int err;
+    test_env_t *tenv;
+    int         err;
 
     if (!cfg)
         return -EINVAL;
@@ -920,8 +1046,13 @@ int test_mgmt_add_port_cfg(uint32_t eth_port, const tpg_port_cfg_t *cfg,
     if (err != 0)
         return err;
 
+    tenv = test_mgmt_get_port_env(eth_port);
+
     /* Struct copy. */
-    test_mgmt_get_port_env(eth_port)->te_port_cfg = *cfg;
+    tenv->te_port_cfg = *cfg;
+
+    /* The static routes were validated against the old interfaces. */
+    tenv->te_l3_routes_count = 0;
 
     return 0;
 }
@@ -995,6 +1126,88 @@ int test_mgmt_add_port_cfg_l3_gw(uint32_t eth_port, tpg_ip_t *gw,
     return 0;
 }
 
+/*****************************************************************************
+ * test_mgmt_add_port_cfg_l3_route()
+ ****************************************************************************/
+int test_mgmt_add_port_cfg_l3_route(uint32_t eth_port,
+                                    const tpg_l3_route_t *l3_route,
+                                    printer_arg_t *printer_arg)
+{
+    test_env_t     *tenv;
+    tpg_port_cfg_t *pcfg;
+    int             err;
+    uint32_t        i;
+
+    if (!l3_route)
+        return -EINVAL;
+
+    err = test_mgmt_add_port_cfg_check(eth_port, printer_arg);
+    if (err != 0)
+        return err;
+
+    if (!test_mgmt_validate_l3_route(l3_route, printer_arg))
+        return -EINVAL;
+
+    tenv = test_mgmt_get_port_env(eth_port);
+    pcfg = &tenv->te_port_cfg;
+
+    /* The gateway must be directly reachable through one of the L3
+     * interfaces configured on the port.
+     */
+    for (i = 0; i < pcfg->pc_l3_intfs_count; i++) {
+        if ((pcfg->pc_l3_intfs[i].l3i_ip.ip_v4 &
+                pcfg->pc_l3_intfs[i].l3i_mask.ip_v4) ==
+                (l3_route->l3r_gw.ip_v4 &
+                 pcfg->pc_l3_intfs[i].l3i_mask.ip_v4))
+            break;
+    }
+
+    if (i == pcfg->pc_l3_intfs_count) {
+        tpg_printf(printer_arg,
+                   "ERROR: L3 route gateway not on a local interface!\n");
+        return -EINVAL;
+    }
+
+    for (i = 0; i < tenv->te_l3_routes_count; i++) {
+        if (TPG_IP_EQ(&tenv->te_l3_routes[i].l3r_mask, &l3_route->l3r_mask) &&
+                (tenv->te_l3_routes[i].l3r_net.ip_v4 &
+                 l3_route->l3r_mask.ip_v4) ==
+                (l3_route->l3r_net.ip_v4 & l3_route->l3r_mask.ip_v4)) {
+            tpg_printf(printer_arg, "ERROR: L3 route already configured!\n");
+            return -EEXIST;
+        }
+    }
+
+    if (tenv->te_l3_routes_count == TPG_TEST_MAX_L3_ROUTE)
+        return -ENOMEM;
+
+    /* Struct copy. */
+    tenv->te_l3_routes[tenv->te_l3_routes_count] = *l3_route;
+    tenv->te_l3_routes_count++;
+    return 0;
+}
+
+/*****************************************************************************
+ * test_mgmt_get_port_cfg_l3_routes()
+ ****************************************************************************/
+const tpg_l3_route_t *
+test_mgmt_get_port_cfg_l3_routes(uint32_t eth_port, uint32_t *count,
+                                 printer_arg_t *printer_arg)
+{
+    test_env_t *tenv;
+
+    if (!count)
+        return NULL;
+
+    if (!test_mgmt_validate_port_id(eth_port, printer_arg))
+        return NULL;
+
+    tenv = test_mgmt_get_port_env(eth_port);
+
+    *count = tenv->te_l3_routes_count;
+    return tenv->te_l3_routes;
+}
+
 /*****************************************************************************
  * test_mgmt_add_test_case()
  ****************************************************************************/
@@ -1454,11 +1667,13 @@ test_mgmt_set_port_options(uint32_t eth_port, tpg_port_options_t *opts,
     port_get_conn_options(eth_port, &old_opts);
 
     TPG_XLATE_OPTIONAL_COPY_FIELD(&old_opts, opts, po_mtu);
+    TPG_XLATE_OPTIONAL_COPY_FIELD(&old_opts, opts, po_arp_table_size);
+    TPG_XLATE_OPTIONAL_COPY_FIELD(&old_opts, opts, po_gro);
 
-    if (!test_mgmt_validate_port_options(opts, printer_arg, eth_port))
+    if (!test_mgmt_validate_port_options(&old_opts, printer_arg, eth_port))
         return -EINVAL;
 
-    err = port_set_conn_options(eth_port, opts);
+    err = port_set_conn_options(eth_port, &old_opts);
     if (err != 0)
         return err;
 
@@ -1529,6 +1744,18 @@ test_mgmt_set_tcp_sockopt(uint32_t eth_port, uint32_t test_case_id,
     TPG_XLATE_OPTIONAL_COPY_FIELD(&old_opts, opts, to_orphan_to);
     TPG_XLATE_OPTIONAL_COPY_FIELD(&old_opts, opts, to_skip_timewait);
     TPG_XLATE_OPTIONAL_COPY_FIELD(&old_opts, opts, to_ack_delay);
+    TPG_XLATE_OPTIONAL_COPY_FIELD(&old_opts, opts, to_cong_control);
+    TPG_XLATE_OPTIONAL_COPY_FIELD(&old_opts, opts, to_win_scale);
+    TPG_XLATE_OPTIONAL_COPY_FIELD(&old_opts, opts, to_sack);
+    TPG_XLATE_OPTIONAL_COPY_FIELD(&old_opts, opts, to_rto_min);
+    TPG_XLATE_OPTIONAL_COPY_FIELD(&old_opts, opts, to_rto_max);
+    TPG_XLATE_OPTIONAL_COPY_FIELD(&old_opts, opts, to_timestamps);
+    TPG_XLATE_OPTIONAL_COPY_FIELD(&old_opts, opts, to_pmtu);
+    TPG_XLATE_OPTIONAL_COPY_FIELD(&old_opts, opts, to_tso);
+    TPG_XLATE_OPTIONAL_COPY_FIELD(&old_opts, opts, to_syn_cookies);
+    TPG_XLATE_OPTIONAL_COPY_FIELD(&old_opts, opts, to_ack_delay_to);
+    TPG_XLATE_OPTIONAL_COPY_FIELD(&old_opts, opts, to_close_mode);
+    TPG_XLATE_OPTIONAL_COPY_FIELD(&old_opts, opts, to_fast_open);
 
     if (!test_mgmt_validate_tcp_sockopt(&old_opts, printer_arg))
         return -EINVAL;
@@ -1843,6 +2070,7 @@ int test_mgmt_get_port_stats(uint32_t eth_port,
         total_stats->ps_received_ring_if_failed +=
             port_stats->ps_received_ring_if_failed;
         total_stats->ps_sent_sim_failure += port_stats->ps_sent_sim_failure;
+        total_stats->ps_gro_merged += port_stats->ps_gro_merged;
 
     }
 
@@ -1969,6 +2197,7 @@ int test_mgmt_get_arp_stats(uint32_t eth_port,
             arp_stats->as_invalid_proto_space;
         total_stats->as_invalid_proto_len += arp_stats->as_invalid_proto_len;
         total_stats->as_req_not_mine += arp_stats->as_req_not_mine;
+        total_stats->as_tbl_full += arp_stats->as_tbl_full;
     }
 
     return 0;
@@ -1994,6 +2223,8 @@ int test_mgmt_get_route_stats(uint32_t eth_port,
         total_stats->rs_intf_del += route_stats->rs_intf_del;
         total_stats->rs_gw_add += route_stats->rs_gw_add;
         total_stats->rs_gw_del += route_stats->rs_gw_del;
+        total_stats->rs_route_add += route_stats->rs_route_add;
+        total_stats->rs_route_del += route_stats->rs_route_del;
 
         total_stats->rs_tbl_full += route_stats->rs_tbl_full;
         total_stats->rs_intf_nomem += route_stats->rs_intf_nomem;
@@ -2001,6 +2232,7 @@ int test_mgmt_get_route_stats(uint32_t eth_port,
         total_stats->rs_gw_nointf += route_stats->rs_gw_nointf;
         total_stats->rs_nh_not_found += route_stats->rs_nh_not_found;
         total_stats->rs_route_not_found += route_stats->rs_route_not_found;
+        total_stats->rs_route_exists += route_stats->rs_route_exists;
     }
 
     return 0;
@@ -2122,6 +2354,19 @@ int test_mgmt_get_tcp_stats(uint32_t eth_port,
         total_stats->ts_sent_fin += tcp_stats->ts_sent_fin;
         total_stats->ts_recv_rst += tcp_stats->ts_recv_rst;
         total_stats->ts_sent_rst += tcp_stats->ts_sent_rst;
+
+        total_stats->ts_tw_added += tcp_stats->ts_tw_added;
+        total_stats->ts_tw_hits += tcp_stats->ts_tw_hits;
+        total_stats->ts_tw_full += tcp_stats->ts_tw_full;
+
+        total_stats->ts_syncookies_sent += tcp_stats->ts_syncookies_sent;
+        total_stats->ts_syncookies_ok += tcp_stats->ts_syncookies_ok;
+        total_stats->ts_syncookies_bad += tcp_stats->ts_syncookies_bad;
+        total_stats->ts_tfo_syn_data += tcp_stats->ts_tfo_syn_data;
+        total_stats->ts_tfo_syn_data_acked += tcp_stats->ts_tfo_syn_data_acked;
+        total_stats->ts_tfo_cookies_sent += tcp_stats->ts_tfo_cookies_sent;
+        total_stats->ts_tfo_syn_data_ok += tcp_stats->ts_tfo_syn_data_ok;
+        total_stats->ts_tfo_cookies_bad += tcp_stats->ts_tfo_cookies_bad;
     }
 
     return 0;
@@ -2155,6 +2400,9 @@ int test_mgmt_get_tsm_stats(uint32_t eth_port,
         total_stats->tsms_retrans_bytes += tsm_stats->tsms_retrans_bytes;
         total_stats->tsms_missing_seq += tsm_stats->tsms_missing_seq;
         total_stats->tsms_snd_win_full += tsm_stats->tsms_snd_win_full;
+        total_stats->tsms_fast_retrans += tsm_stats->tsms_fast_retrans;
+        total_stats->tsms_fast_path += tsm_stats->tsms_fast_path;
+        total_stats->tsms_rst_close += tsm_stats->tsms_rst_close;
 
     }
 
@@ -2222,6 +2470,15 @@ int test_mgmt_get_timer_stats(uint32_t eth_port,
             timer_stats->tts_l4cb_invalid_flags;
         total_stats->tts_timeout_overflow +=
             timer_stats->tts_timeout_overflow;
+        total_stats->tts_budget_exhausted +=
+            timer_stats->tts_budget_exhausted;
+        total_stats->tts_rto_deferred += timer_stats->tts_rto_deferred;
+
+        total_stats->tts_delack_set += timer_stats->tts_delack_set;
+        total_stats->tts_delack_cancelled +=
+            timer_stats->tts_delack_cancelled;
+        total_stats->tts_delack_fired += timer_stats->tts_delack_fired;
+        total_stats->tts_delack_failed += timer_stats->tts_delack_failed;
     }
 
     return 0;
@@ -2286,6 +2543,10 @@ bool test_mgmt_rx_tstamp_enabled(const tpg_test_case_t *entry)
     if (sockopt->so_ipv4.ip4so_rx_tstamp)
         return true;
 
+    /* TCP timestamps echoed by the peer give us RTT based latency samples. */
+    if (sockopt->so_tcp.tcpo_timestamps)
+        return true;
+
     switch (entry->tc_app.app_proto) {
     case APP_PROTO__RAW_CLIENT:
         return TPG_XLATE_OPT_BOOL(&entry->tc_app.app_raw_client, rc_rx_tstamp);
@@ -780,6 +780,99 @@ cmdline_parse_inst_t cmd_tests_add_l3_gw = {
     },
 };
 
+/****************************************************************************
+ * - "add tests l3_route port <eth_port> net <ip> mask <mask> gw <gw>"
+ ****************************************************************************/
+ struct cmd_tests_add_l3_route_result {
+    cmdline_fixed_string_t add;
+    cmdline_fixed_string_t tests;
+    cmdline_fixed_string_t l3_route;
+    cmdline_fixed_string_t port_kw;
+    uint32_t               port;
+    cmdline_fixed_string_t net_kw;
+    cmdline_ipaddr_t       net;
+    cmdline_fixed_string_t mask_kw;
+    cmdline_ipaddr_t       mask;
+    cmdline_fixed_string_t gw_kw;
+    cmdline_ipaddr_t       gw;
+};
+
+static cmdline_parse_token_string_t cmd_tests_add_l3_route_T_add =
+    TOKEN_STRING_INITIALIZER(struct cmd_tests_add_l3_route_result, add, "add");
+static cmdline_parse_token_string_t cmd_tests_add_l3_route_T_tests =
+    TOKEN_STRING_INITIALIZER(struct cmd_tests_add_l3_route_result, tests, "tests");
+static cmdline_parse_token_string_t cmd_tests_add_l3_route_T_l3_route =
+    TOKEN_STRING_INITIALIZER(struct cmd_tests_add_l3_route_result, l3_route, "l3_route");
+static cmdline_parse_token_string_t cmd_tests_add_l3_route_T_port_kw =
+    TOKEN_STRING_INITIALIZER(struct cmd_tests_add_l3_route_result, port_kw, "port");
+static cmdline_parse_token_num_t cmd_tests_add_l3_route_T_port =
+    TOKEN_NUM_INITIALIZER(struct cmd_tests_add_l3_route_result, port, UINT32);
+static cmdline_parse_token_string_t cmd_tests_add_l3_route_T_net_kw =
+    TOKEN_STRING_INITIALIZER(struct cmd_tests_add_l3_route_result, net_kw, "net");
+static cmdline_parse_token_ipaddr_t cmd_tests_add_l3_route_T_net =
+    TOKEN_IPADDR_INITIALIZER(struct cmd_tests_add_l3_route_result, net);
+static cmdline_parse_token_string_t cmd_tests_add_l3_route_T_mask_kw =
+    TOKEN_STRING_INITIALIZER(struct cmd_tests_add_l3_route_result, mask_kw, "mask");
+static cmdline_parse_token_ipaddr_t cmd_tests_add_l3_route_T_mask =
+    TOKEN_IPADDR_INITIALIZER(struct cmd_tests_add_l3_route_result, mask);
+static cmdline_parse_token_string_t cmd_tests_add_l3_route_T_gw_kw =
+    TOKEN_STRING_INITIALIZER(struct cmd_tests_add_l3_route_result, gw_kw, "gw");
+static cmdline_parse_token_ipaddr_t cmd_tests_add_l3_route_T_gw =
+    TOKEN_IPADDR_INITIALIZER(struct cmd_tests_add_l3_route_result, gw);
+
+static void cmd_tests_add_l3_route_parsed(void *parsed_result,
+                                          struct cmdline *cl,
+                                          void *data __rte_unused)
+{
+    printer_arg_t                         parg;
+    struct cmd_tests_add_l3_route_result *pr;
+    tpg_l3_route_t                        l3_route;
+
+    parg = TPG_PRINTER_ARG(cli_printer, cl);
+    pr = parsed_result;
+
+    if (pr->net.family != AF_INET || pr->gw.family != AF_INET) {
+        cmdline_printf(cl, "ERROR: IPv6 not supported yet!\n");
+        return;
+    }
+
+    if (pr->net.family != pr->mask.family) {
+        cmdline_printf(cl, "ERROR: Mixing IPv4 and IPv6..\n");
+        return;
+    }
+
+    l3_route = (tpg_l3_route_t){
+        .l3r_net = TPG_IPV4(rte_be_to_cpu_32(pr->net.addr.ipv4.s_addr)),
+        .l3r_mask = TPG_IPV4(rte_be_to_cpu_32(pr->mask.addr.ipv4.s_addr)),
+        .l3r_gw = TPG_IPV4(rte_be_to_cpu_32(pr->gw.addr.ipv4.s_addr)),
+    };
+
+    if (test_mgmt_add_port_cfg_l3_route(pr->port, &l3_route, &parg) == 0)
+        cmdline_printf(cl, "L3 route successfully added.\n");
+    else
+        cmdline_printf(cl, "ERROR: Failed to add L3 route!\n");
+}
+
+cmdline_parse_inst_t cmd_tests_add_l3_route = {
+    .f = cmd_tests_add_l3_route_parsed,
+    .data = NULL,
+    .help_str = "add tests l3_route port <eth_port> net <ip> mask <mask> gw <gw>",
+    .tokens = {
+        (void *)&cmd_tests_add_l3_route_T_add,
+        (void *)&cmd_tests_add_l3_route_T_tests,
+        (void *)&cmd_tests_add_l3_route_T_l3_route,
+        (void *)&cmd_tests_add_l3_route_T_port_kw,
+        (void *)&cmd_tests_add_l3_route_T_port,
+        (void *)&cmd_tests_add_l3_route_T_net_kw,
+        (void *)&cmd_tests_add_l3_route_T_net,
+        (void *)&cmd_tests_add_l3_route_T_mask_kw,
+        (void *)&cmd_tests_add_l3_route_T_mask,
+        (void *)&cmd_tests_add_l3_route_T_gw_kw,
+        (void *)&cmd_tests_add_l3_route_T_gw,
+        NULL,
+    },
+};
+
 /****************************************************************************
  * - "add tests server tcp|udp port <eth_port>
       ips <ip_range> l4_ports <port_range>
@@ -1651,6 +1744,139 @@ cmdline_parse_inst_t cmd_tests_set_mtu = {
     },
 };
 
+/****************************************************************************
+ * - "set tests arp-table-size port <eth_port> <size>"
+ ****************************************************************************/
+ struct cmd_tests_set_arp_table_size_result {
+    cmdline_fixed_string_t set;
+    cmdline_fixed_string_t tests;
+    cmdline_fixed_string_t arp_table_size_kw;
+    cmdline_fixed_string_t port_kw;
+    uint32_t               port;
+    uint32_t               arp_table_size;
+};
+
+static cmdline_parse_token_string_t cmd_tests_set_arp_table_size_T_set =
+    TOKEN_STRING_INITIALIZER(struct cmd_tests_set_arp_table_size_result, set, "set");
+static cmdline_parse_token_string_t cmd_tests_set_arp_table_size_T_tests =
+    TOKEN_STRING_INITIALIZER(struct cmd_tests_set_arp_table_size_result, tests, "tests");
+static cmdline_parse_token_string_t cmd_tests_set_arp_table_size_T_arp_table_size_kw =
+    TOKEN_STRING_INITIALIZER(struct cmd_tests_set_arp_table_size_result, arp_table_size_kw, "arp-table-size");
+
+static cmdline_parse_token_string_t cmd_tests_set_arp_table_size_T_port_kw =
+    TOKEN_STRING_INITIALIZER(struct cmd_tests_set_arp_table_size_result, port_kw, "port");
+static cmdline_parse_token_num_t cmd_tests_set_arp_table_size_T_port =
+    TOKEN_NUM_INITIALIZER(struct cmd_tests_set_arp_table_size_result, port, UINT32);
+
+static cmdline_parse_token_num_t cmd_tests_set_arp_table_size_T_arp_table_size =
+    TOKEN_NUM_INITIALIZER(struct cmd_tests_set_arp_table_size_result, arp_table_size, UINT32);
+
+OPT_FILL_DEFINE(port, tpg_port_options_t, po_arp_table_size, uint32_t);
+
+static void cmd_tests_set_arp_table_size_parsed(void *parsed_result,
+                                                struct cmdline *cl,
+                                                void *data)
+{
+    printer_arg_t                               parg;
+    struct cmd_tests_set_arp_table_size_result *pr;
+    OPT_FILL_TYPE_NAME(port)                   *fill_param = data;
+    tpg_port_options_t                          port_opts;
+
+    parg = TPG_PRINTER_ARG(cli_printer, cl);
+    pr = parsed_result;
+    fill_param->opt_cb(&port_opts, &pr->arp_table_size);
+
+    if (test_mgmt_set_port_options(pr->port, &port_opts, &parg) == 0)
+        cmdline_printf(cl, "Port %"PRIu32" ARP table size updated!\n",
+                       pr->port);
+    else
+        cmdline_printf(cl,
+                       "ERROR: Failed updating ARP table size on port %"PRIu32"\n",
+                       pr->port);
+}
+
+cmdline_parse_inst_t cmd_tests_set_arp_table_size = {
+    .f = cmd_tests_set_arp_table_size_parsed,
+    .data = (void *) &OPT_FILL_PARAM_NAME(port, po_arp_table_size),
+    .help_str = "set tests arp-table-size port <eth_port> <size>",
+    .tokens = {
+        (void *)&cmd_tests_set_arp_table_size_T_set,
+        (void *)&cmd_tests_set_arp_table_size_T_tests,
+        (void *)&cmd_tests_set_arp_table_size_T_arp_table_size_kw,
+        (void *)&cmd_tests_set_arp_table_size_T_port_kw,
+        (void *)&cmd_tests_set_arp_table_size_T_port,
+        (void *)&cmd_tests_set_arp_table_size_T_arp_table_size,
+        NULL,
+    },
+};
+
+/****************************************************************************
+ * - "set tests gro port <eth_port> <1|0>"
+ ****************************************************************************/
+ struct cmd_tests_set_gro_result {
+    cmdline_fixed_string_t set;
+    cmdline_fixed_string_t tests;
+    cmdline_fixed_string_t gro_kw;
+    cmdline_fixed_string_t port_kw;
+    uint32_t               port;
+    uint8_t                gro;
+};
+
+static cmdline_parse_token_string_t cmd_tests_set_gro_T_set =
+    TOKEN_STRING_INITIALIZER(struct cmd_tests_set_gro_result, set, "set");
+static cmdline_parse_token_string_t cmd_tests_set_gro_T_tests =
+    TOKEN_STRING_INITIALIZER(struct cmd_tests_set_gro_result, tests, "tests");
+static cmdline_parse_token_string_t cmd_tests_set_gro_T_gro_kw =
+    TOKEN_STRING_INITIALIZER(struct cmd_tests_set_gro_result, gro_kw, "gro");
+static cmdline_parse_token_string_t cmd_tests_set_gro_T_port_kw =
+    TOKEN_STRING_INITIALIZER(struct cmd_tests_set_gro_result, port_kw, "port");
+static cmdline_parse_token_num_t cmd_tests_set_gro_T_port =
+    TOKEN_NUM_INITIALIZER(struct cmd_tests_set_gro_result, port, UINT32);
+
+static cmdline_parse_token_num_t cmd_tests_set_gro_T_gro =
+    TOKEN_NUM_INITIALIZER(struct cmd_tests_set_gro_result, gro, UINT8);
+
+OPT_FILL_DEFINE(port, tpg_port_options_t, po_gro, bool);
+
+static void cmd_tests_set_gro_parsed(void *parsed_result, struct cmdline *cl,
+                                     void *data)
+{
+    printer_arg_t                    parg;
+    struct cmd_tests_set_gro_result *pr;
+    OPT_FILL_TYPE_NAME(port)        *fill_param = data;
+    tpg_port_options_t               port_opts;
+    bool                             gro;
+
+    parg = TPG_PRINTER_ARG(cli_printer, cl);
+    pr = parsed_result;
+    gro = (pr->gro != 0);
+    fill_param->opt_cb(&port_opts, &gro);
+
+    if (test_mgmt_set_port_options(pr->port, &port_opts, &parg) == 0)
+        cmdline_printf(cl, "Port %"PRIu32" GRO %s!\n",
+                       pr->port,
+                       gro ? "enabled" : "disabled");
+    else
+        cmdline_printf(cl,
+                       "ERROR: Failed updating GRO on port %"PRIu32"\n",
+                       pr->port);
+}
+
+cmdline_parse_inst_t cmd_tests_set_gro = {
+    .f = cmd_tests_set_gro_parsed,
+    .data = (void *) &OPT_FILL_PARAM_NAME(port, po_gro),
+    .help_str = "set tests gro port <eth_port> <1|0>",
+    .tokens = {
+        (void *)&cmd_tests_set_gro_T_set,
+        (void *)&cmd_tests_set_gro_T_tests,
+        (void *)&cmd_tests_set_gro_T_gro_kw,
+        (void *)&cmd_tests_set_gro_T_port_kw,
+        (void *)&cmd_tests_set_gro_T_port,
+        (void *)&cmd_tests_set_gro_T_gro,
+        NULL,
+    },
+};
+
 /****************************************************************************
  * - "set tests tcp-options port <eth_port> test-case-id <tcid> option value"
  ****************************************************************************/
@@ -1668,16 +1894,29 @@ struct cmd_tests_set_tcp_opts_result {
     cmdline_fixed_string_t data_retry;
     cmdline_fixed_string_t retry;
     cmdline_fixed_string_t rto;
+    cmdline_fixed_string_t rto_min;
+    cmdline_fixed_string_t rto_max;
     cmdline_fixed_string_t fin_to;
     cmdline_fixed_string_t twait_to;
     cmdline_fixed_string_t orphan_to;
     cmdline_fixed_string_t twait_skip;
     cmdline_fixed_string_t ack_delay;
+    cmdline_fixed_string_t ack_delay_to;
+    cmdline_fixed_string_t cong_control;
+    cmdline_fixed_string_t win_scale;
+    cmdline_fixed_string_t sack;
+    cmdline_fixed_string_t timestamps;
+    cmdline_fixed_string_t pmtu;
+    cmdline_fixed_string_t tso;
+    cmdline_fixed_string_t syn_cookies;
+    cmdline_fixed_string_t close_mode;
+    cmdline_fixed_string_t fast_open;
 
     union {
-        uint32_t opt_val_32;
-        uint8_t  opt_val_8;
-        bool     opt_val_bool;
+        uint32_t               opt_val_32;
+        uint8_t                opt_val_8;
+        bool                   opt_val_bool;
+        cmdline_fixed_string_t opt_val_str;
     } opt_u;
 };
 
@@ -1710,6 +1949,10 @@ static cmdline_parse_token_string_t cmd_tests_set_tcp_opts_T_retry =
     TOKEN_STRING_INITIALIZER(struct cmd_tests_set_tcp_opts_result, retry, "retry");
 static cmdline_parse_token_string_t cmd_tests_set_tcp_opts_T_rto =
     TOKEN_STRING_INITIALIZER(struct cmd_tests_set_tcp_opts_result, rto, "rto");
+static cmdline_parse_token_string_t cmd_tests_set_tcp_opts_T_rto_min =
+    TOKEN_STRING_INITIALIZER(struct cmd_tests_set_tcp_opts_result, rto_min, "rto-min");
+static cmdline_parse_token_string_t cmd_tests_set_tcp_opts_T_rto_max =
+    TOKEN_STRING_INITIALIZER(struct cmd_tests_set_tcp_opts_result, rto_max, "rto-max");
 static cmdline_parse_token_string_t cmd_tests_set_tcp_opts_T_fin_to =
     TOKEN_STRING_INITIALIZER(struct cmd_tests_set_tcp_opts_result, fin_to, "fin-to");
 static cmdline_parse_token_string_t cmd_tests_set_tcp_opts_T_twait_to =
@@ -1720,6 +1963,26 @@ static cmdline_parse_token_string_t cmd_tests_set_tcp_opts_T_twait_skip =
     TOKEN_STRING_INITIALIZER(struct cmd_tests_set_tcp_opts_result, twait_skip, "twait-skip");
 static cmdline_parse_token_string_t cmd_tests_set_tcp_opts_T_ack_del =
     TOKEN_STRING_INITIALIZER(struct cmd_tests_set_tcp_opts_result, ack_delay, "ack-delay");
+static cmdline_parse_token_string_t cmd_tests_set_tcp_opts_T_ack_del_to =
+    TOKEN_STRING_INITIALIZER(struct cmd_tests_set_tcp_opts_result, ack_delay_to, "ack-delay-to");
+static cmdline_parse_token_string_t cmd_tests_set_tcp_opts_T_cong_control =
+    TOKEN_STRING_INITIALIZER(struct cmd_tests_set_tcp_opts_result, cong_control, "cong-control");
+static cmdline_parse_token_string_t cmd_tests_set_tcp_opts_T_win_scale =
+    TOKEN_STRING_INITIALIZER(struct cmd_tests_set_tcp_opts_result, win_scale, "win-scale");
+static cmdline_parse_token_string_t cmd_tests_set_tcp_opts_T_sack =
+    TOKEN_STRING_INITIALIZER(struct cmd_tests_set_tcp_opts_result, sack, "sack");
+static cmdline_parse_token_string_t cmd_tests_set_tcp_opts_T_timestamps =
+    TOKEN_STRING_INITIALIZER(struct cmd_tests_set_tcp_opts_result, timestamps, "timestamps");
+static cmdline_parse_token_string_t cmd_tests_set_tcp_opts_T_pmtu =
+    TOKEN_STRING_INITIALIZER(struct cmd_tests_set_tcp_opts_result, pmtu, "pmtu");
+static cmdline_parse_token_string_t cmd_tests_set_tcp_opts_T_tso =
+    TOKEN_STRING_INITIALIZER(struct cmd_tests_set_tcp_opts_result, tso, "tso");
+static cmdline_parse_token_string_t cmd_tests_set_tcp_opts_T_syn_cookies =
+    TOKEN_STRING_INITIALIZER(struct cmd_tests_set_tcp_opts_result, syn_cookies, "syn-cookies");
+static cmdline_parse_token_string_t cmd_tests_set_tcp_opts_T_close_mode =
+    TOKEN_STRING_INITIALIZER(struct cmd_tests_set_tcp_opts_result, close_mode, "close-mode");
+static cmdline_parse_token_string_t cmd_tests_set_tcp_opts_T_fast_open =
+    TOKEN_STRING_INITIALIZER(struct cmd_tests_set_tcp_opts_result, fast_open, "fast-open");
 
 static cmdline_parse_token_num_t cmd_tests_set_tcp_opts_T_opt_val_32 =
     TOKEN_NUM_INITIALIZER(struct cmd_tests_set_tcp_opts_result, opt_u.opt_val_32, UINT32);
@@ -1727,6 +1990,10 @@ static cmdline_parse_token_num_t cmd_tests_set_tcp_opts_T_opt_val_8 =
     TOKEN_NUM_INITIALIZER(struct cmd_tests_set_tcp_opts_result, opt_u.opt_val_8, UINT8);
 static cmdline_parse_token_num_t cmd_tests_set_tcp_opts_T_opt_val_bool =
     TOKEN_NUM_INITIALIZER(struct cmd_tests_set_tcp_opts_result, opt_u.opt_val_bool, UINT8);
+static cmdline_parse_token_string_t cmd_tests_set_tcp_opts_T_opt_val_cc =
+    TOKEN_STRING_INITIALIZER(struct cmd_tests_set_tcp_opts_result, opt_u.opt_val_str, "new-reno#cubic");
+static cmdline_parse_token_string_t cmd_tests_set_tcp_opts_T_opt_val_close =
+    TOKEN_STRING_INITIALIZER(struct cmd_tests_set_tcp_opts_result, opt_u.opt_val_str, "graceful#rst-after-data#rst-immediate");
 
 
 OPT_FILL_TYPEDEF(tcp, tpg_tcp_sockopt_t);
@@ -1737,11 +2004,61 @@ OPT_FILL_DEFINE(tcp, tpg_tcp_sockopt_t, to_syn_ack_retry_cnt, uint8_t);
 OPT_FILL_DEFINE(tcp, tpg_tcp_sockopt_t, to_data_retry_cnt, uint8_t);
 OPT_FILL_DEFINE(tcp, tpg_tcp_sockopt_t, to_retry_cnt, uint8_t);
 OPT_FILL_DEFINE(tcp, tpg_tcp_sockopt_t, to_rto, uint32_t);
+OPT_FILL_DEFINE(tcp, tpg_tcp_sockopt_t, to_rto_min, uint32_t);
+OPT_FILL_DEFINE(tcp, tpg_tcp_sockopt_t, to_rto_max, uint32_t);
 OPT_FILL_DEFINE(tcp, tpg_tcp_sockopt_t, to_fin_to, uint32_t);
 OPT_FILL_DEFINE(tcp, tpg_tcp_sockopt_t, to_twait_to, uint32_t);
 OPT_FILL_DEFINE(tcp, tpg_tcp_sockopt_t, to_orphan_to, uint32_t);
 OPT_FILL_DEFINE(tcp, tpg_tcp_sockopt_t, to_skip_timewait, bool);
 OPT_FILL_DEFINE(tcp, tpg_tcp_sockopt_t, to_ack_delay, bool);
+OPT_FILL_DEFINE(tcp, tpg_tcp_sockopt_t, to_ack_delay_to, uint32_t);
+OPT_FILL_DEFINE(tcp, tpg_tcp_sockopt_t, to_win_scale, uint8_t);
+OPT_FILL_DEFINE(tcp, tpg_tcp_sockopt_t, to_sack, bool);
+OPT_FILL_DEFINE(tcp, tpg_tcp_sockopt_t, to_timestamps, bool);
+OPT_FILL_DEFINE(tcp, tpg_tcp_sockopt_t, to_pmtu, uint32_t);
+OPT_FILL_DEFINE(tcp, tpg_tcp_sockopt_t, to_tso, bool);
+OPT_FILL_DEFINE(tcp, tpg_tcp_sockopt_t, to_syn_cookies, bool);
+OPT_FILL_DEFINE(tcp, tpg_tcp_sockopt_t, to_fast_open, bool);
+
+/* The congestion control algorithm is given by name so we need a custom fill
+ * callback.
+ */
+static void OPT_FILL_CB(tcp, to_cong_control)(tpg_tcp_sockopt_t *dest,
+                                              void *value)
+{
+    tpg_tcp_cong_control_t algo;
+
+    bzero(dest, sizeof(*dest));
+    for (algo = 0; algo < TCP_CONG_CONTROL__TCP_CONG_CONTROL_MAX; algo++) {
+        if (strcmp(value, tcp_cc_name(algo)) == 0)
+            break;
+    }
+
+    TPG_XLATE_OPTIONAL_SET_FIELD(dest, to_cong_control, algo);
+}
+
+static OPT_FILL_TYPE_NAME(tcp) OPT_FILL_PARAM_NAME(tcp, to_cong_control) = {
+    OPT_FILL_CB(tcp, to_cong_control)
+};
+
+/* Same for the close mode. */
+static void OPT_FILL_CB(tcp, to_close_mode)(tpg_tcp_sockopt_t *dest,
+                                            void *value)
+{
+    tpg_tcp_close_mode_t mode;
+
+    bzero(dest, sizeof(*dest));
+    for (mode = 0; mode < TCP_CLOSE_MODE__TCP_CLOSE_MODE_MAX; mode++) {
+        if (strcmp(value, tcp_close_mode_name(mode)) == 0)
+            break;
+    }
+
+    TPG_XLATE_OPTIONAL_SET_FIELD(dest, to_close_mode, mode);
+}
+
+static OPT_FILL_TYPE_NAME(tcp) OPT_FILL_PARAM_NAME(tcp, to_close_mode) = {
+    OPT_FILL_CB(tcp, to_close_mode)
+};
 
 static void cmd_tests_set_tcp_opts_parsed(void *parsed_result,
                                           struct cmdline *cl,
@@ -1877,6 +2194,42 @@ cmdline_parse_inst_t cmd_tests_set_tcp_opts_rto = {
     },
 };
 
+cmdline_parse_inst_t cmd_tests_set_tcp_opts_rto_min = {
+    .f = cmd_tests_set_tcp_opts_parsed,
+    .data = (void *) &OPT_FILL_PARAM_NAME(tcp, to_rto_min),
+    .help_str = "set tests tcp-options port <eth_port> test-case-id <tcid> rto-min <rto_min_ms>",
+    .tokens = {
+        (void *)&cmd_tests_set_tcp_opts_T_set,
+        (void *)&cmd_tests_set_tcp_opts_T_tests,
+        (void *)&cmd_tests_set_tcp_opts_T_tcp_options,
+        (void *)&cmd_tests_set_tcp_opts_T_port_kw,
+        (void *)&cmd_tests_set_tcp_opts_T_port,
+        (void *)&cmd_tests_set_tcp_opts_T_tcid_kw,
+        (void *)&cmd_tests_set_tcp_opts_T_tcid,
+        (void *)&cmd_tests_set_tcp_opts_T_rto_min,
+        (void *)&cmd_tests_set_tcp_opts_T_opt_val_32,
+        NULL,
+    },
+};
+
+cmdline_parse_inst_t cmd_tests_set_tcp_opts_rto_max = {
+    .f = cmd_tests_set_tcp_opts_parsed,
+    .data = (void *) &OPT_FILL_PARAM_NAME(tcp, to_rto_max),
+    .help_str = "set tests tcp-options port <eth_port> test-case-id <tcid> rto-max <rto_max_ms>",
+    .tokens = {
+        (void *)&cmd_tests_set_tcp_opts_T_set,
+        (void *)&cmd_tests_set_tcp_opts_T_tests,
+        (void *)&cmd_tests_set_tcp_opts_T_tcp_options,
+        (void *)&cmd_tests_set_tcp_opts_T_port_kw,
+        (void *)&cmd_tests_set_tcp_opts_T_port,
+        (void *)&cmd_tests_set_tcp_opts_T_tcid_kw,
+        (void *)&cmd_tests_set_tcp_opts_T_tcid,
+        (void *)&cmd_tests_set_tcp_opts_T_rto_max,
+        (void *)&cmd_tests_set_tcp_opts_T_opt_val_32,
+        NULL,
+    },
+};
+
 cmdline_parse_inst_t cmd_tests_set_tcp_opts_fin_to = {
     .f = cmd_tests_set_tcp_opts_parsed,
     .data = (void *) &OPT_FILL_PARAM_NAME(tcp, to_fin_to),
@@ -1967,6 +2320,186 @@ cmdline_parse_inst_t cmd_tests_set_tcp_opts_ack_del = {
     },
 };
 
+cmdline_parse_inst_t cmd_tests_set_tcp_opts_ack_del_to = {
+    .f = cmd_tests_set_tcp_opts_parsed,
+    .data = (void *) &OPT_FILL_PARAM_NAME(tcp, to_ack_delay_to),
+    .help_str = "set tests tcp-options port <eth_port> test-case-id <tcid> ack-delay-to <ack_delay_ms>",
+    .tokens = {
+        (void *)&cmd_tests_set_tcp_opts_T_set,
+        (void *)&cmd_tests_set_tcp_opts_T_tests,
+        (void *)&cmd_tests_set_tcp_opts_T_tcp_options,
+        (void *)&cmd_tests_set_tcp_opts_T_port_kw,
+        (void *)&cmd_tests_set_tcp_opts_T_port,
+        (void *)&cmd_tests_set_tcp_opts_T_tcid_kw,
+        (void *)&cmd_tests_set_tcp_opts_T_tcid,
+        (void *)&cmd_tests_set_tcp_opts_T_ack_del_to,
+        (void *)&cmd_tests_set_tcp_opts_T_opt_val_32,
+        NULL,
+    },
+};
+
+cmdline_parse_inst_t cmd_tests_set_tcp_opts_cong_control = {
+    .f = cmd_tests_set_tcp_opts_parsed,
+    .data = (void *) &OPT_FILL_PARAM_NAME(tcp, to_cong_control),
+    .help_str = "set tests tcp-options port <eth_port> test-case-id <tcid> cong-control <new-reno|cubic>",
+    .tokens = {
+        (void *)&cmd_tests_set_tcp_opts_T_set,
+        (void *)&cmd_tests_set_tcp_opts_T_tests,
+        (void *)&cmd_tests_set_tcp_opts_T_tcp_options,
+        (void *)&cmd_tests_set_tcp_opts_T_port_kw,
+        (void *)&cmd_tests_set_tcp_opts_T_port,
+        (void *)&cmd_tests_set_tcp_opts_T_tcid_kw,
+        (void *)&cmd_tests_set_tcp_opts_T_tcid,
+        (void *)&cmd_tests_set_tcp_opts_T_cong_control,
+        (void *)&cmd_tests_set_tcp_opts_T_opt_val_cc,
+        NULL,
+    },
+};
+
+cmdline_parse_inst_t cmd_tests_set_tcp_opts_win_scale = {
+    .f = cmd_tests_set_tcp_opts_parsed,
+    .data = (void *) &OPT_FILL_PARAM_NAME(tcp, to_win_scale),
+    .help_str = "set tests tcp-options port <eth_port> test-case-id <tcid> win-scale <shift>",
+    .tokens = {
+        (void *)&cmd_tests_set_tcp_opts_T_set,
+        (void *)&cmd_tests_set_tcp_opts_T_tests,
+        (void *)&cmd_tests_set_tcp_opts_T_tcp_options,
+        (void *)&cmd_tests_set_tcp_opts_T_port_kw,
+        (void *)&cmd_tests_set_tcp_opts_T_port,
+        (void *)&cmd_tests_set_tcp_opts_T_tcid_kw,
+        (void *)&cmd_tests_set_tcp_opts_T_tcid,
+        (void *)&cmd_tests_set_tcp_opts_T_win_scale,
+        (void *)&cmd_tests_set_tcp_opts_T_opt_val_8,
+        NULL,
+    },
+};
+
+cmdline_parse_inst_t cmd_tests_set_tcp_opts_sack = {
+    .f = cmd_tests_set_tcp_opts_parsed,
+    .data = (void *) &OPT_FILL_PARAM_NAME(tcp, to_sack),
+    .help_str = "set tests tcp-options port <eth_port> test-case-id <tcid> sack <1|0>",
+    .tokens = {
+        (void *)&cmd_tests_set_tcp_opts_T_set,
+        (void *)&cmd_tests_set_tcp_opts_T_tests,
+        (void *)&cmd_tests_set_tcp_opts_T_tcp_options,
+        (void *)&cmd_tests_set_tcp_opts_T_port_kw,
+        (void *)&cmd_tests_set_tcp_opts_T_port,
+        (void *)&cmd_tests_set_tcp_opts_T_tcid_kw,
+        (void *)&cmd_tests_set_tcp_opts_T_tcid,
+        (void *)&cmd_tests_set_tcp_opts_T_sack,
+        (void *)&cmd_tests_set_tcp_opts_T_opt_val_bool,
+        NULL,
+    },
+};
+
+cmdline_parse_inst_t cmd_tests_set_tcp_opts_timestamps = {
+    .f = cmd_tests_set_tcp_opts_parsed,
+    .data = (void *) &OPT_FILL_PARAM_NAME(tcp, to_timestamps),
+    .help_str = "set tests tcp-options port <eth_port> test-case-id <tcid> timestamps <1|0>",
+    .tokens = {
+        (void *)&cmd_tests_set_tcp_opts_T_set,
+        (void *)&cmd_tests_set_tcp_opts_T_tests,
+        (void *)&cmd_tests_set_tcp_opts_T_tcp_options,
+        (void *)&cmd_tests_set_tcp_opts_T_port_kw,
+        (void *)&cmd_tests_set_tcp_opts_T_port,
+        (void *)&cmd_tests_set_tcp_opts_T_tcid_kw,
+        (void *)&cmd_tests_set_tcp_opts_T_tcid,
+        (void *)&cmd_tests_set_tcp_opts_T_timestamps,
+        (void *)&cmd_tests_set_tcp_opts_T_opt_val_bool,
+        NULL,
+    },
+};
+
+cmdline_parse_inst_t cmd_tests_set_tcp_opts_pmtu = {
+    .f = cmd_tests_set_tcp_opts_parsed,
+    .data = (void *) &OPT_FILL_PARAM_NAME(tcp, to_pmtu),
+    .help_str = "set tests tcp-options port <eth_port> test-case-id <tcid> pmtu <mtu>",
+    .tokens = {
+        (void *)&cmd_tests_set_tcp_opts_T_set,
+        (void *)&cmd_tests_set_tcp_opts_T_tests,
+        (void *)&cmd_tests_set_tcp_opts_T_tcp_options,
+        (void *)&cmd_tests_set_tcp_opts_T_port_kw,
+        (void *)&cmd_tests_set_tcp_opts_T_port,
+        (void *)&cmd_tests_set_tcp_opts_T_tcid_kw,
+        (void *)&cmd_tests_set_tcp_opts_T_tcid,
+        (void *)&cmd_tests_set_tcp_opts_T_pmtu,
+        (void *)&cmd_tests_set_tcp_opts_T_opt_val_32,
+        NULL,
+    },
+};
+
+cmdline_parse_inst_t cmd_tests_set_tcp_opts_tso = {
+    .f = cmd_tests_set_tcp_opts_parsed,
+    .data = (void *) &OPT_FILL_PARAM_NAME(tcp, to_tso),
+    .help_str = "set tests tcp-options port <eth_port> test-case-id <tcid> tso <1|0>",
+    .tokens = {
+        (void *)&cmd_tests_set_tcp_opts_T_set,
+        (void *)&cmd_tests_set_tcp_opts_T_tests,
+        (void *)&cmd_tests_set_tcp_opts_T_tcp_options,
+        (void *)&cmd_tests_set_tcp_opts_T_port_kw,
+        (void *)&cmd_tests_set_tcp_opts_T_port,
+        (void *)&cmd_tests_set_tcp_opts_T_tcid_kw,
+        (void *)&cmd_tests_set_tcp_opts_T_tcid,
+        (void *)&cmd_tests_set_tcp_opts_T_tso,
+        (void *)&cmd_tests_set_tcp_opts_T_opt_val_bool,
+        NULL,
+    },
+};
+
+cmdline_parse_inst_t cmd_tests_set_tcp_opts_syn_cookies = {
+    .f = cmd_tests_set_tcp_opts_parsed,
+    .data = (void *) &OPT_FILL_PARAM_NAME(tcp, to_syn_cookies),
+    .help_str = "set tests tcp-options port <eth_port> test-case-id <tcid> syn-cookies <1|0>",
+    .tokens = {
+        (void *)&cmd_tests_set_tcp_opts_T_set,
+        (void *)&cmd_tests_set_tcp_opts_T_tests,
+        (void *)&cmd_tests_set_tcp_opts_T_tcp_options,
+        (void *)&cmd_tests_set_tcp_opts_T_port_kw,
+        (void *)&cmd_tests_set_tcp_opts_T_port,
+        (void *)&cmd_tests_set_tcp_opts_T_tcid_kw,
+        (void *)&cmd_tests_set_tcp_opts_T_tcid,
+        (void *)&cmd_tests_set_tcp_opts_T_syn_cookies,
+        (void *)&cmd_tests_set_tcp_opts_T_opt_val_bool,
+        NULL,
+    },
+};
+
+cmdline_parse_inst_t cmd_tests_set_tcp_opts_close_mode = {
+    .f = cmd_tests_set_tcp_opts_parsed,
+    .data = (void *) &OPT_FILL_PARAM_NAME(tcp, to_close_mode),
+    .help_str = "set tests tcp-options port <eth_port> test-case-id <tcid> close-mode <graceful|rst-after-data|rst-immediate>",
+    .tokens = {
+        (void *)&cmd_tests_set_tcp_opts_T_set,
+        (void *)&cmd_tests_set_tcp_opts_T_tests,
+        (void *)&cmd_tests_set_tcp_opts_T_tcp_options,
+        (void *)&cmd_tests_set_tcp_opts_T_port_kw,
+        (void *)&cmd_tests_set_tcp_opts_T_port,
+        (void *)&cmd_tests_set_tcp_opts_T_tcid_kw,
+        (void *)&cmd_tests_set_tcp_opts_T_tcid,
+        (void *)&cmd_tests_set_tcp_opts_T_close_mode,
+        (void *)&cmd_tests_set_tcp_opts_T_opt_val_close,
+        NULL,
+    },
+};
+
+cmdline_parse_inst_t cmd_tests_set_tcp_opts_fast_open = {
+    .f = cmd_tests_set_tcp_opts_parsed,
+    .data = (void *) &OPT_FILL_PARAM_NAME(tcp, to_fast_open),
+    .help_str = "set tests tcp-options port <eth_port> test-case-id <tcid> fast-open <1|0>",
+    .tokens = {
+        (void *)&cmd_tests_set_tcp_opts_T_set,
+        (void *)&cmd_tests_set_tcp_opts_T_tests,
+        (void *)&cmd_tests_set_tcp_opts_T_tcp_options,
+        (void *)&cmd_tests_set_tcp_opts_T_port_kw,
+        (void *)&cmd_tests_set_tcp_opts_T_port,
+        (void *)&cmd_tests_set_tcp_opts_T_tcid_kw,
+        (void *)&cmd_tests_set_tcp_opts_T_tcid,
+        (void *)&cmd_tests_set_tcp_opts_T_fast_open,
+        (void *)&cmd_tests_set_tcp_opts_T_opt_val_bool,
+        NULL,
+    },
+};
+
 /****************************************************************************
  * - "show tests tcp-options port <eth_port> test-case-id <tcid>"
  ****************************************************************************/
@@ -2011,20 +2544,32 @@ static void cmd_tests_show_tcp_opts_parsed(void *parsed_result,
     if (test_mgmt_get_tcp_sockopt(pr->port, pr->tcid, &tcp_sockopt, &parg) != 0)
         return;
 
-    cmdline_printf(cl, "  WIN SYN SYN/ACK DATA RETRY RTO(ms) FIN(ms) TW(ms)  ORP(ms) TW-SKIP ACK-DEL\n");
-    cmdline_printf(cl, "----- --- ------- ---- ----- ------- ------- ------- ------- ------- -------\n");
-    cmdline_printf(cl, "%5u %3u %7u %4u %5u %7u %7u %7u %7u %7u %7u\n",
+    cmdline_printf(cl, "     WIN WSCALE SYN SYN/ACK DATA RETRY RTO(ms) RTO-MIN RTO-MAX FIN(ms) TW(ms)  ORP(ms) TW-SKIP ACK-DEL ACK-DEL(ms)       CC SACK TS PMTU TSO COOKIES          CLOSE TFO\n");
+    cmdline_printf(cl, "-------- ------ --- ------- ---- ----- ------- ------- ------- ------- ------- ------- ------- ------- ----------- -------- ---- -- ---- --- ------- -------------- ---\n");
+    cmdline_printf(cl, "%8u %6u %3u %7u %4u %5u %7u %7u %7u %7u %7u %7u %7u %7u %11u %8s %4u %2u %4u %3u %7u %14s %3u\n",
                    tcp_sockopt.to_win_size,
+                   tcp_sockopt.to_win_scale,
                    tcp_sockopt.to_syn_retry_cnt,
                    tcp_sockopt.to_syn_ack_retry_cnt,
                    tcp_sockopt.to_data_retry_cnt,
                    tcp_sockopt.to_retry_cnt,
                    tcp_sockopt.to_rto,
+                   tcp_sockopt.to_rto_min,
+                   tcp_sockopt.to_rto_max,
                    tcp_sockopt.to_fin_to,
                    tcp_sockopt.to_twait_to,
                    tcp_sockopt.to_orphan_to,
                    tcp_sockopt.to_skip_timewait,
-                   tcp_sockopt.to_ack_delay);
+                   tcp_sockopt.to_ack_delay,
+                   tcp_sockopt.to_ack_delay_to,
+                   tcp_cc_name(tcp_sockopt.to_cong_control),
+                   tcp_sockopt.to_sack,
+                   tcp_sockopt.to_timestamps,
+                   tcp_sockopt.to_pmtu,
+                   tcp_sockopt.to_tso,
+                   tcp_sockopt.to_syn_cookies,
+                   tcp_close_mode_name(tcp_sockopt.to_close_mode),
+                   tcp_sockopt.to_fast_open);
     cmdline_printf(cl, "\n\n");
 }
 
@@ -2752,6 +3297,7 @@ static cmdline_parse_ctx_t cli_ctx[] = {
     &cmd_tests_add_l3_intf,
     &cmd_tests_add_l3_intf_vlan_id_gw,
     &cmd_tests_add_l3_gw,
+    &cmd_tests_add_l3_route,
     &cmd_tests_add_tcp_udp_server,
     &cmd_tests_add_client,
     &cmd_tests_del_test,
@@ -2763,6 +3309,8 @@ static cmdline_parse_ctx_t cli_ctx[] = {
     &cmd_tests_set_noasync,
     &cmd_tests_set_async,
     &cmd_tests_set_mtu,
+    &cmd_tests_set_arp_table_size,
+    &cmd_tests_set_gro,
     &cmd_tests_set_ip_opts_tx,
     &cmd_tests_set_ip_opts_rx,
     &cmd_tests_set_tcp_opts_win_size,
@@ -2771,11 +3319,23 @@ static cmdline_parse_ctx_t cli_ctx[] = {
     &cmd_tests_set_tcp_opts_data_retry,
     &cmd_tests_set_tcp_opts_retry,
     &cmd_tests_set_tcp_opts_rto,
+    &cmd_tests_set_tcp_opts_rto_min,
+    &cmd_tests_set_tcp_opts_rto_max,
     &cmd_tests_set_tcp_opts_fin_to,
     &cmd_tests_set_tcp_opts_twait_to,
     &cmd_tests_set_tcp_opts_orphan_to,
     &cmd_tests_set_tcp_opts_twait_skip,
     &cmd_tests_set_tcp_opts_ack_del,
+    &cmd_tests_set_tcp_opts_ack_del_to,
+    &cmd_tests_set_tcp_opts_cong_control,
+    &cmd_tests_set_tcp_opts_win_scale,
+    &cmd_tests_set_tcp_opts_sack,
+    &cmd_tests_set_tcp_opts_timestamps,
+    &cmd_tests_set_tcp_opts_pmtu,
+    &cmd_tests_set_tcp_opts_tso,
+    &cmd_tests_set_tcp_opts_syn_cookies,
+    &cmd_tests_set_tcp_opts_close_mode,
+    &cmd_tests_set_tcp_opts_fast_open,
     &cmd_tests_show_tcp_opts,
     &cmd_tests_set_ipv4_opts_tos,
     &cmd_tests_set_ipv4_opts_dscp_ecn,
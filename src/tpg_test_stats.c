@@ -280,12 +280,19 @@ void test_entry_quickstats(const tpg_test_case_t *entry,
 void test_config_show_port(uint32_t eth_port, printer_arg_t *printer_arg)
 {
     const tpg_port_cfg_t *pcfg;
+    const tpg_l3_route_t *l3_routes;
+    uint32_t              l3_routes_count;
     uint32_t              i;
 
     pcfg = test_mgmt_get_port_cfg(eth_port, printer_arg);
     if (!pcfg)
         return;
 
+    l3_routes = test_mgmt_get_port_cfg_l3_routes(eth_port, &l3_routes_count,
+                                                 printer_arg);
+    if (!l3_routes)
+        return;
+
     for (i = 0; i < pcfg->pc_l3_intfs_count; i++) {
         tpg_printf(printer_arg,
                    "%-15s: " TPG_IPV4_PRINT_FMT "/" TPG_IPV4_PRINT_FMT ", VLAN-ID: %4d, GW: " TPG_IPV4_PRINT_FMT "\n",
@@ -297,6 +304,14 @@ void test_config_show_port(uint32_t eth_port, printer_arg_t *printer_arg)
     }
     tpg_printf(printer_arg, "%-15s: " TPG_IPV4_PRINT_FMT "\n", "GW",
                TPG_IPV4_PRINT_ARGS(pcfg->pc_def_gw.ip_v4));
+    for (i = 0; i < l3_routes_count; i++) {
+        tpg_printf(printer_arg,
+                   "%-15s: " TPG_IPV4_PRINT_FMT "/" TPG_IPV4_PRINT_FMT ", GW: " TPG_IPV4_PRINT_FMT "\n",
+                   "L3 Route",
+                   TPG_IPV4_PRINT_ARGS(l3_routes[i].l3r_net.ip_v4),
+                   TPG_IPV4_PRINT_ARGS(l3_routes[i].l3r_mask.ip_v4),
+                   TPG_IPV4_PRINT_ARGS(l3_routes[i].l3r_gw.ip_v4));
+    }
     tpg_printf(printer_arg, "\n");
 }
 
@@ -163,6 +163,8 @@ static struct {
     test_case_session_close_cb_t sess_close;
     test_case_session_purge_cb_t sess_purge;
     test_case_htable_walk_cb_t   sess_htable_walk;
+    test_case_recycle_flush_cb_t sess_recycle_flush;
+    test_case_tw_flush_cb_t      sess_tw_flush;
 
 } test_callbacks[TEST_CASE_TYPE__MAX][L4_PROTO__L4_PROTO_MAX] = {
 
@@ -174,6 +176,8 @@ static struct {
         .sess_close = test_case_tcp_close,
         .sess_purge = test_case_tcp_purge,
         .sess_htable_walk = tlkp_walk_tcb,
+        .sess_recycle_flush = tlkp_recycle_flush_tcbs,
+        .sess_tw_flush = tlkp_tw_flush,
     },
     [TEST_CASE_TYPE__SERVER][L4_PROTO__UDP] = {
         .open = NULL,
@@ -183,6 +187,8 @@ static struct {
         .sess_close = test_case_udp_close,
         .sess_purge = test_case_udp_purge,
         .sess_htable_walk = tlkp_walk_ucb,
+        .sess_recycle_flush = tlkp_recycle_flush_ucbs,
+        .sess_tw_flush = NULL,
     },
     [TEST_CASE_TYPE__CLIENT][L4_PROTO__TCP] = {
         .open = test_case_tcp_client_open,
@@ -192,6 +198,8 @@ static struct {
         .sess_close = test_case_tcp_close,
         .sess_purge = test_case_tcp_purge,
         .sess_htable_walk = tlkp_walk_tcb,
+        .sess_recycle_flush = tlkp_recycle_flush_tcbs,
+        .sess_tw_flush = tlkp_tw_flush,
     },
     [TEST_CASE_TYPE__CLIENT][L4_PROTO__UDP] = {
         .open = test_case_udp_client_open,
@@ -201,6 +209,8 @@ static struct {
         .sess_close = test_case_udp_close,
         .sess_purge = test_case_udp_purge,
         .sess_htable_walk = tlkp_walk_ucb,
+        .sess_recycle_flush = tlkp_recycle_flush_ucbs,
+        .sess_tw_flush = NULL,
     },
 
 };
@@ -1419,6 +1429,13 @@ static void test_case_purge_cbs(test_case_info_t *tc_info)
     RTE_LOG(INFO, USER1,
             "lcore=%d Purged %u total sessions on eth_port %"PRIu32" tcid %"PRIu32"\n",
             lcore_id, purge_cnt, eth_port, tc_id);
+
+    /* All sessions are gone, give the recycled control blocks back. */
+    test_callbacks[tc_type][l4_proto].sess_recycle_flush(eth_port, tc_id);
+
+    /* Sessions that were in TIME_WAIT only left a record behind. */
+    if (test_callbacks[tc_type][l4_proto].sess_tw_flush)
+        test_callbacks[tc_type][l4_proto].sess_tw_flush(eth_port, tc_id);
 }
 
 /*****************************************************************************
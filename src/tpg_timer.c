@@ -65,6 +65,7 @@
  ****************************************************************************/
 static RTE_DEFINE_PER_LCORE(tmr_wheel_t *, tcp_slow_timer_wheel);
 static RTE_DEFINE_PER_LCORE(tmr_wheel_t *, tcp_rto_timer_wheel);
+static RTE_DEFINE_PER_LCORE(tmr_wheel_t *, tcp_delack_timer_wheel);
 static RTE_DEFINE_PER_LCORE(tmr_wheel_t *, l4cb_test_timer_wheel);
 
 /* Define TIMER global statistics. Each thread has its own set of locally
@@ -73,48 +74,278 @@ static RTE_DEFINE_PER_LCORE(tmr_wheel_t *, l4cb_test_timer_wheel);
 STATS_DEFINE(tpg_timer_statistics_t);
 
 /*****************************************************************************
- * Callbacks for processing the wheels in almost a generic way.
- * TODO: we should change the void * to a real timer structure but that would
- * require even more memory usage.
+ * Forward declarations
  ****************************************************************************/
+static cmdline_parse_ctx_t cli_ctx[];
 
-typedef void *(*tmr_nxt_cb_t)(void *entry);
+static void tcp_handle_slow_to(void *entry);
+static void tcp_handle_retrans_to(void *entry);
+static void tcp_handle_delack_to(void *entry);
+static void l4cb_handle_test_to(void *entry);
 
-typedef void (*tmr_cb_t)(void *entry);
+/*****************************************************************************
+ * tmr_entry()
+ ****************************************************************************/
+static inline __attribute__((always_inline))
+tmr_entry_t *tmr_entry(tmr_wheel_t *wheel, void *ctr)
+{
+    return (tmr_entry_t *)((char *)ctr + wheel->tw_entry_offset);
+}
 
 /*****************************************************************************
- * Forward declarations
+ * tmr_now_ticks()
  ****************************************************************************/
-static cmdline_parse_ctx_t cli_ctx[];
+static inline __attribute__((always_inline))
+uint64_t tmr_now_ticks(tmr_wheel_t *wheel, uint64_t now)
+{
+    return (now / cycles_per_us) / wheel->tw_step;
+}
+
+/*****************************************************************************
+ * tmr_bmp_next()
+ *      Returns the first (possibly) non-empty slot >= 'slot' in the level or
+ *      TMR_WHEEL_LEVEL_SLOTS if there is none.
+ ****************************************************************************/
+static uint32_t tmr_bmp_next(const tmr_wheel_level_t *level, uint32_t slot)
+{
+    uint32_t word;
+    uint64_t bits;
+
+    if (slot >= TMR_WHEEL_LEVEL_SLOTS)
+        return TMR_WHEEL_LEVEL_SLOTS;
+
+    word = slot / 64;
+    bits = level->twl_bmp[word] & (UINT64_MAX << (slot % 64));
+
+    for (;;) {
+        if (bits != 0)
+            return word * 64 + __builtin_ctzll(bits);
+
+        if (++word == TMR_WHEEL_LEVEL_SLOTS / 64)
+            return TMR_WHEEL_LEVEL_SLOTS;
+
+        bits = level->twl_bmp[word];
+    }
+}
+
+/*****************************************************************************
+ * tmr_wheel_link()
+ ****************************************************************************/
+static void tmr_wheel_link(tmr_wheel_t *wheel, uint32_t lvl, uint32_t slot,
+                           void *ctr)
+{
+    tmr_wheel_level_t *level = &wheel->tw_levels[lvl];
+    tmr_list_head_t   *head = &level->twl_slots[slot];
+    tmr_entry_t       *entry = tmr_entry(wheel, ctr);
+
+    entry->tle_next = head->tlh_first;
+    if (entry->tle_next != NULL)
+        tmr_entry(wheel, entry->tle_next)->tle_prev = &entry->tle_next;
+
+    head->tlh_first = ctr;
+    entry->tle_prev = &head->tlh_first;
+
+    level->twl_bmp[slot / 64] |= (1ULL << (slot % 64));
+}
+
+/*****************************************************************************
+ * tmr_wheel_unlink()
+ *      O(1), the slot bitmap is fixed up lazily by tmr_wheel_advance().
+ ****************************************************************************/
+static void tmr_wheel_unlink(tmr_wheel_t *wheel, void *ctr)
+{
+    tmr_entry_t *entry = tmr_entry(wheel, ctr);
+
+    if (entry->tle_next != NULL)
+        tmr_entry(wheel, entry->tle_next)->tle_prev = entry->tle_prev;
+
+    *entry->tle_prev = entry->tle_next;
+}
+
+/*****************************************************************************
+ * tmr_wheel_place()
+ *      Links the entry in the lowest level where its expiry and the current
+ *      tick of the wheel only differ in that level's bits. Like that, the
+ *      level N slot is always ahead of the current one and gets cascaded
+ *      before the entry expires.
+ ****************************************************************************/
+static void tmr_wheel_place(tmr_wheel_t *wheel, void *ctr)
+{
+    uint64_t expiry = tmr_entry(wheel, ctr)->tle_expiry;
+    uint64_t current = wheel->tw_current;
+    uint64_t top_delta;
+    uint32_t shift;
+    uint32_t lvl;
+
+    if (expiry <= current) {
+        tmr_wheel_link(wheel, 0, current & TMR_WHEEL_LEVEL_MASK, ctr);
+        return;
+    }
+
+    for (lvl = 0; lvl < TMR_WHEEL_LEVELS - 1; lvl++) {
+        if (((expiry ^ current) >> ((lvl + 1) * TMR_WHEEL_LEVEL_BITS)) == 0)
+            break;
+    }
+
+    shift = lvl * TMR_WHEEL_LEVEL_BITS;
+
+    if (likely(lvl < TMR_WHEEL_LEVELS - 1)) {
+        tmr_wheel_link(wheel, lvl, (expiry >> shift) & TMR_WHEEL_LEVEL_MASK,
+                       ctr);
+        return;
+    }
+
+    /* Top level: beyond the span of the wheel we just park the entry in the
+     * furthest slot, it will be placed again when that slot cascades.
+     */
+    top_delta = (expiry >> shift) - (current >> shift);
+    if (unlikely(top_delta > TMR_WHEEL_LEVEL_MASK))
+        top_delta = TMR_WHEEL_LEVEL_MASK;
+
+    tmr_wheel_link(wheel, lvl,
+                   ((current >> shift) + top_delta) & TMR_WHEEL_LEVEL_MASK,
+                   ctr);
+}
+
+/*****************************************************************************
+ * tmr_wheel_cascade()
+ *      Moves all the entries in the current slot of level 'lvl' to the lower
+ *      levels.
+ ****************************************************************************/
+static void tmr_wheel_cascade(tmr_wheel_t *wheel, uint32_t lvl)
+{
+    tmr_wheel_level_t *level = &wheel->tw_levels[lvl];
+    uint32_t           slot;
+    void              *ctr;
+
+    slot = (wheel->tw_current >> (lvl * TMR_WHEEL_LEVEL_BITS)) &
+                TMR_WHEEL_LEVEL_MASK;
+
+    if (!(level->twl_bmp[slot / 64] & (1ULL << (slot % 64))))
+        return;
+
+    ctr = level->twl_slots[slot].tlh_first;
+    TMR_LIST_INIT(&level->twl_slots[slot]);
+    level->twl_bmp[slot / 64] &= ~(1ULL << (slot % 64));
+
+    while (ctr != NULL) {
+        void *next = tmr_entry(wheel, ctr)->tle_next;
+
+        tmr_wheel_place(wheel, ctr);
+        ctr = next;
+    }
+}
+
+/*****************************************************************************
+ * tmr_wheel_set_current()
+ *      Moves the wheel to tick 'tick' cascading the upper levels if we
+ *      crossed into a new slot.
+ ****************************************************************************/
+static void tmr_wheel_set_current(tmr_wheel_t *wheel, uint64_t tick)
+{
+    int lvl;
+
+    wheel->tw_current = tick;
+
+    if ((tick & TMR_WHEEL_LEVEL_MASK) != 0)
+        return;
+
+    for (lvl = TMR_WHEEL_LEVELS - 1; lvl > 0; lvl--) {
+        uint64_t lvl_mask = (1ULL << (lvl * TMR_WHEEL_LEVEL_BITS)) - 1;
+
+        if ((tick & lvl_mask) == 0)
+            tmr_wheel_cascade(wheel, lvl);
+    }
+}
+
+/*****************************************************************************
+ * tmr_wheel_expiry()
+ *      Converts a relative timeout to an absolute expiry tick.
+ ****************************************************************************/
+static int tmr_wheel_expiry(tmr_wheel_t *wheel, uint32_t timeout_us,
+                            uint64_t *expiry)
+{
+    uint64_t now_us;
+
+    /*
+     * First validate that timeout isn't too late.
+     */
+    if (unlikely(timeout_us > wheel->tw_max_timeout_us)) {
+        INC_STATS(STATS_LOCAL(tpg_timer_statistics_t, 0), tts_timeout_overflow);
+        TRACE_FMT(TMR, ERROR, "[%s] Timeout exceeds limit %u > %"PRIu64,
+                  __func__,
+                  timeout_us,
+                  wheel->tw_max_timeout_us);
+        return -EINVAL;
+    }
+
+    now_us = rte_get_timer_cycles() / cycles_per_us;
+
+    *expiry = (now_us + timeout_us) / wheel->tw_step;
+    return 0;
+}
+
+/*****************************************************************************
+ * tmr_wheel_insert()
+ ****************************************************************************/
+static void tmr_wheel_insert(tmr_wheel_t *wheel, void *ctr, uint64_t expiry)
+{
+    tmr_entry(wheel, ctr)->tle_expiry = expiry;
+    tmr_wheel_place(wheel, ctr);
+    wheel->tw_count++;
+}
+
+/*****************************************************************************
+ * tmr_wheel_add()
+ ****************************************************************************/
+static int tmr_wheel_add(tmr_wheel_t *wheel, void *ctr, uint32_t timeout_us)
+{
+    uint64_t expiry;
+    int      status;
+
+    status = tmr_wheel_expiry(wheel, timeout_us, &expiry);
+    if (unlikely(status != 0))
+        return status;
+
+    tmr_wheel_insert(wheel, ctr, expiry);
+    return 0;
+}
+
+/*****************************************************************************
+ * tmr_wheel_del()
+ ****************************************************************************/
+static void tmr_wheel_del(tmr_wheel_t *wheel, void *ctr)
+{
+    tmr_wheel_unlink(wheel, ctr);
+    wheel->tw_count--;
+}
 
 /*****************************************************************************
  * timer_init_wheel()
  ****************************************************************************/
 static bool timer_init_wheel(uint32_t lcore_id, tmr_wheel_t **wheel_p,
-                             uint32_t size, uint32_t step)
+                             uint32_t step,
+                             uint64_t max_timeout_us,
+                             uint32_t entry_offset,
+                             uint32_t l4cb_offset,
+                             tmr_cb_t cb)
 {
     tmr_wheel_t *wheel;
-    uint32_t     i;
 
-    wheel = rte_zmalloc_socket("tmr_wheel_t", sizeof(*wheel), 0,
+    wheel = rte_zmalloc_socket("tmr_wheel_t", sizeof(*wheel),
+                               RTE_CACHE_LINE_SIZE,
                                rte_lcore_to_socket_id(lcore_id));
     if (!wheel)
         return false;
 
-    wheel->tw_size = size;
+    /* All the slots are already empty (zmalloc). */
     wheel->tw_step = step;
+    wheel->tw_entry_offset = entry_offset;
+    wheel->tw_l4cb_offset = l4cb_offset;
+    wheel->tw_max_timeout_us = max_timeout_us;
+    wheel->tw_cb = cb;
     wheel->tw_last_advance = 0;
-    wheel->tw_current = ((rte_get_timer_cycles() / cycles_per_us) / step) % size;
-    wheel->tw_wheel =
-        rte_zmalloc_socket("tpg_timer_wheel",
-                           wheel->tw_size * sizeof(*wheel->tw_wheel),
-                           0,
-                           rte_lcore_to_socket_id(lcore_id));
-    if (wheel->tw_wheel == NULL)
-        return false;
-
-    for (i = 0; i < wheel->tw_size; i++)
-        TMR_LIST_INIT(&wheel->tw_wheel[i]);
+    wheel->tw_current = tmr_now_ticks(wheel, rte_get_timer_cycles());
 
     *wheel_p = wheel;
 
@@ -159,24 +390,45 @@ void timer_lcore_init(uint32_t lcore_id)
         TPG_ERROR_ABORT("[%d] Cannot access config!\n", lcore_idx);
 
     if (timer_init_wheel(lcore_id, &RTE_PER_LCORE(tcp_slow_timer_wheel),
-                         cfg->gcfg_slow_tmr_max / cfg->gcfg_slow_tmr_step,
-                         cfg->gcfg_slow_tmr_step) == false) {
+                         cfg->gcfg_slow_tmr_step,
+                         cfg->gcfg_slow_tmr_max,
+                         offsetof(tcp_control_block_t, tcb_slow_tmr_entry),
+                         offsetof(tcp_control_block_t, tcb_l4),
+                         tcp_handle_slow_to) == false) {
         TPG_ERROR_ABORT("[%d] Failed allocating tcp slow timer wheel, %s(%d)!\n",
                         lcore_idx,
                         rte_strerror(rte_errno), rte_errno);
     }
 
     if (timer_init_wheel(lcore_id, &RTE_PER_LCORE(tcp_rto_timer_wheel),
-                         cfg->gcfg_rto_tmr_max / cfg->gcfg_rto_tmr_step,
-                         cfg->gcfg_rto_tmr_step) == false) {
+                         cfg->gcfg_rto_tmr_step,
+                         cfg->gcfg_rto_tmr_max,
+                         offsetof(tcp_control_block_t, tcb_retrans_tmr_entry),
+                         offsetof(tcp_control_block_t, tcb_l4),
+                         tcp_handle_retrans_to) == false) {
         TPG_ERROR_ABORT("[%d] Failed allocating tcp rto timer wheel, %s(%d)!\n",
                         lcore_idx,
                         rte_strerror(rte_errno), rte_errno);
     }
 
+    /* Delayed ACKs need the same granularity as the retransmissions. */
+    if (timer_init_wheel(lcore_id, &RTE_PER_LCORE(tcp_delack_timer_wheel),
+                         cfg->gcfg_rto_tmr_step,
+                         cfg->gcfg_rto_tmr_max,
+                         offsetof(tcp_control_block_t, tcb_delack_tmr_entry),
+                         offsetof(tcp_control_block_t, tcb_l4),
+                         tcp_handle_delack_to) == false) {
+        TPG_ERROR_ABORT("[%d] Failed allocating tcp delayed ack timer wheel, %s(%d)!\n",
+                        lcore_idx,
+                        rte_strerror(rte_errno), rte_errno);
+    }
+
     if (timer_init_wheel(lcore_id, &RTE_PER_LCORE(l4cb_test_timer_wheel),
-                         cfg->gcfg_test_tmr_max / cfg->gcfg_test_tmr_step,
-                         cfg->gcfg_test_tmr_step) == false) {
+                         cfg->gcfg_test_tmr_step,
+                         cfg->gcfg_test_tmr_max,
+                         offsetof(l4_control_block_t, l4cb_test_tmr_entry),
+                         0,
+                         l4cb_handle_test_to) == false) {
         TPG_ERROR_ABORT("[%d] Failed allocating cb test timer wheel, %s(%d)!\n",
                         lcore_idx,
                         rte_strerror(rte_errno), rte_errno);
@@ -191,108 +443,16 @@ void timer_lcore_init(uint32_t lcore_id)
     }
 }
 
-/*****************************************************************************
- * TIMER_SET()
- *   - get wheel where we need to insert timer.
- *   - add to the end of the bucket associated with the timeout.
- ****************************************************************************/
-#define TIMER_SET(wheel, ctr_type, entry, tmr_field, timeout_us, status)  \
-    do {                                                                  \
-        int tmr_bucket = tcp_timer_get_wheel_bucket((wheel), timeout_us); \
-        if (likely(tmr_bucket >= 0)) {                                    \
-            TMR_LIST_INSERT_HEAD(&(wheel)->tw_wheel[tmr_bucket],          \
-                                 ctr_type, (entry),                       \
-                                 tmr_field);                              \
-        } else {                                                          \
-            (status) = -EINVAL;                                           \
-        }                                                                 \
-    } while (0)
-
-/*****************************************************************************
- * TIMER_CANCEL()
- ****************************************************************************/
-/* Just quickly remove from the list and pray for the best.. */
-#define TIMER_CANCEL(ctr_type, entry, tmr_field)  \
-    TMR_LIST_REMOVE(ctr_type, (entry), tmr_field)
-
-/*****************************************************************************
- * TCP_TIMER_SET()
- *   - get wheel where we need to insert timer.
- *   - add to the end of the bucket associated with the timeout.
- ****************************************************************************/
-#define TCP_TIMER_SET(wheel, tcb, tmr_field, timeout_us, status)  \
-        TIMER_SET((wheel), tcp_control_block_t, (tcb), tmr_field, \
-                  (timeout_us), (status))
-
-
-/*****************************************************************************
- * TCP_TIMER_CANCEL()
- ****************************************************************************/
-/* Just quickly remove from the list and pray for the best.. */
-#define TCP_TIMER_CANCEL(tcb, tmr_field) \
-        TIMER_CANCEL(tcp_control_block_t, (tcb), tmr_field)
-
-/*****************************************************************************
- * L4CB_TIMER_SET()
- *   - get wheel where we need to insert timer.
- *   - add to the end of the bucket associated with the timeout.
- ****************************************************************************/
-#define L4CB_TIMER_SET(wheel, l4_cb, tmr_field, timeout_us, status) \
-        TIMER_SET((wheel), l4_control_block_t, (l4_cb), tmr_field,  \
-                  (timeout_us), (status))
-
-/*****************************************************************************
- * L4CB_TIMER_CANCEL()
- ****************************************************************************/
-/* Just quickly remove from the list and pray for the best.. */
-#define L4CB_TIMER_CANCEL(l4_cb, tmr_field) \
-        TIMER_CANCEL(l4_control_block_t, (l4_cb), tmr_field)
-
-/*****************************************************************************
- * tcp_tcb_slow_next()
- ****************************************************************************/
-static inline void *tcp_tcb_slow_next(void *entry)
-{
-    tcp_control_block_t *tcb = entry;
-
-    return tcb->tcb_slow_tmr_entry.tle_next;
-}
-
-/*****************************************************************************
- * tcp_tcb_rto_next()
- ****************************************************************************/
-static inline void *tcp_tcb_rto_next(void *entry)
-{
-    tcp_control_block_t *tcb = entry;
-
-    return tcb->tcb_retrans_tmr_entry.tle_next;
-}
-
-/*****************************************************************************
- * l4cb_test_next()
- ****************************************************************************/
-static inline void *l4cb_test_next(void *entry)
-{
-    l4_control_block_t *l4_cb = entry;
-
-    return l4_cb->l4cb_test_tmr_entry.tle_next;
-}
-
 /*****************************************************************************
  * tcp_handle_slow_to()
+ *      The wheel already unlinked the tcb (the event handler might re-add it).
  ****************************************************************************/
 static void tcp_handle_slow_to(void *entry)
 {
     tcp_control_block_t *tcb = entry;
 
-    /*
-     * Make sure we remove the tcb from the timer list first
-     * (in case the event handler re-adds it). It's fine to call cancel here
-     * because we know the timer just fired.
-     */
     INC_STATS(STATS_LOCAL(tpg_timer_statistics_t, tcb->tcb_l4.l4cb_interface),
               tts_slow_fired);
-    TCP_TIMER_CANCEL(tcb, tcb_slow_tmr_entry);
     tcb->tcb_on_slow_list = false;
 
     /*
@@ -330,19 +490,31 @@ static void tcp_handle_slow_to(void *entry)
 
 /*****************************************************************************
  * tcp_handle_retrans_to()
+ *      The wheel already unlinked the tcb (the event handler might re-add it).
+ *      RTO set/cancel are lazy so the entry might be stale: either the timer
+ *      was cancelled or it was rearmed to a later deadline in the meantime.
  ****************************************************************************/
 static void tcp_handle_retrans_to(void *entry)
 {
     tcp_control_block_t *tcb = entry;
 
-    /*
-     * Make sure we remove the tcb from the timer list first
-     * (in case the event handler readds it). It's fine to call cancel here
-     * because we know the timer just fired.
-     */
+    tcb->tcb_rto_linked = false;
+
+    if (!tcb->tcb_on_rto_list)
+        return;
+
+    if (tcb->tcb_rto_deadline > tcb->tcb_retrans_tmr_entry.tle_expiry) {
+        INC_STATS(STATS_LOCAL(tpg_timer_statistics_t,
+                              tcb->tcb_l4.l4cb_interface),
+                  tts_rto_deferred);
+        tmr_wheel_insert(RTE_PER_LCORE(tcp_rto_timer_wheel), tcb,
+                         tcb->tcb_rto_deadline);
+        tcb->tcb_rto_linked = true;
+        return;
+    }
+
     INC_STATS(STATS_LOCAL(tpg_timer_statistics_t, tcb->tcb_l4.l4cb_interface),
               tts_rto_fired);
-    TCP_TIMER_CANCEL(tcb, tcb_retrans_tmr_entry);
     tcb->tcb_on_rto_list = false;
 
     tcb->tcb_retrans_cnt++;
@@ -350,21 +522,32 @@ static void tcp_handle_retrans_to(void *entry)
     tsm_dispatch_event(tcb, TE_RETRANSMISSION_TIMEOUT, NULL);
 }
 
+/*****************************************************************************
+ * tcp_handle_delack_to()
+ *      The wheel already unlinked the tcb. Whatever was left unacknowledged
+ *      when the timer was armed is acked now.
+ ****************************************************************************/
+static void tcp_handle_delack_to(void *entry)
+{
+    tcp_control_block_t *tcb = entry;
+
+    INC_STATS(STATS_LOCAL(tpg_timer_statistics_t, tcb->tcb_l4.l4cb_interface),
+              tts_delack_fired);
+    tcb->tcb_on_delack_list = false;
+
+    tcp_send_ack_pkt(tcb);
+}
+
 /*****************************************************************************
  * l4cb_handle_test_to()
+ *      The wheel already unlinked the cb (the event handler might re-add it).
  ****************************************************************************/
 static void l4cb_handle_test_to(void *entry)
 {
     l4_control_block_t *l4_cb = entry;
 
-    /*
-     * Make sure we remove the cb from the timer list first
-     * (in case the event handler readds it). It's fine to call cancel here
-     * because we know the timer just fired.
-     */
     INC_STATS(STATS_LOCAL(tpg_timer_statistics_t, l4_cb->l4cb_interface),
               tts_test_fired);
-    L4CB_TIMER_CANCEL(l4_cb, l4cb_test_tmr_entry);
     l4_cb->l4cb_on_test_tmr_list = false;
 
     /*
@@ -374,95 +557,87 @@ static void l4cb_handle_test_to(void *entry)
 }
 
 /*****************************************************************************
- * tcp_timer_get_wheel_bucket()
- *   - check that timeout doesn't overflow tmr_wheel_current
- *   - return correct bucket where timer would go
+ * tpg_time_wheel_advance()
+ *  - Fire everything that expired up to 'now', at most GCFG_TMR_MAX_RUN_CNT
+ *    timers per call. If the budget runs out the wheel is marked as
+ *    backlogged and we continue from the same slot on the next call (i.e.,
+ *    the next packet loop iteration) so a mass expiry can't starve RX.
+ *  - Empty slots are skipped using the per level bitmaps.
+ *  - Check if processing took way too long and log if so.
  ****************************************************************************/
-static int tcp_timer_get_wheel_bucket(tmr_wheel_t *wheel, uint32_t timeout_us)
+static void tpg_time_wheel_advance(tmr_wheel_t *wheel, uint64_t now)
 {
-    uint64_t max_timeout_us;
-    uint64_t now_us;
+    tmr_wheel_level_t *level0 = &wheel->tw_levels[0];
+    uint64_t           now_tick = tmr_now_ticks(wheel, now);
+    uint64_t           start_tick = wheel->tw_current;
+    uint64_t           latest;
+    uint32_t           cnt = 0;
 
-    max_timeout_us = (uint64_t)wheel->tw_size * wheel->tw_step;
+    wheel->tw_last_advance = now;
+    wheel->tw_backlog = false;
 
-    /*
-     * First validate that timeout isn't too late.
-     */
-    if (unlikely(timeout_us > max_timeout_us)) {
-        INC_STATS(STATS_LOCAL(tpg_timer_statistics_t, 0), tts_timeout_overflow);
-        TRACE_FMT(TMR, ERROR, "[%s] Timeout exceeds limit %u > %"PRIu64,
-                  __func__,
-                  timeout_us,
-                  max_timeout_us);
-        return -EINVAL;
+    /* Nothing armed, just catch up. */
+    if (wheel->tw_count == 0) {
+        if (wheel->tw_current <= now_tick)
+            wheel->tw_current = now_tick + 1;
+        return;
     }
 
-    now_us = rte_get_timer_cycles() / cycles_per_us;
-
-    return ((now_us + timeout_us) / wheel->tw_step) % wheel->tw_size;
-}
-
-/*****************************************************************************
- * tpg_time_wheel_advance()
- *  - Take the current time slot and process upto GCFG_TMR_MAX_RUN_CNT (??).
- *  - Advance time pointer if we finished processing everything for the current time.
- *  - Check if the current time is way ahead of the time pointer and log if so. (5seconds should be fine)
- ****************************************************************************/
-static void tpg_time_wheel_advance(tmr_wheel_t *wheel,
-                                   tmr_nxt_cb_t nxt_cb,
-                                   tmr_cb_t cb,
-                                   uint64_t now)
-{
-    uint32_t now_idx;
-    uint32_t start_idx;
-    uint64_t latest;
-    uint32_t cnt = 0;
-    uint64_t now_us = now / cycles_per_us;
-
-    now_idx = (now_us / wheel->tw_step) % wheel->tw_size;
-    start_idx = wheel->tw_current;
-
-    for (;
-            wheel->tw_current != now_idx;
-            wheel->tw_current = (wheel->tw_current + 1) % wheel->tw_size) {
-        void *current;
-
-        /* NO LIST_FOREACH_SAFE available so we do it ourselves.. */
-        for (current = wheel->tw_wheel[wheel->tw_current].tlh_first;
-                current != NULL && cnt < GCFG_TMR_MAX_RUN_CNT;
-                /* Advance in the loop */) {
-            void *tmp;
-
-            tmp = nxt_cb(current);
-
-            /* The callback should remove the entry from the list. */
-            cb(current);
-            current = tmp;
+    while (wheel->tw_current <= now_tick) {
+        uint32_t         slot = wheel->tw_current & TMR_WHEEL_LEVEL_MASK;
+        tmr_list_head_t *head = &level0->twl_slots[slot];
+        uint64_t         next_tick;
+
+        while (head->tlh_first != NULL) {
+            void               *ctr;
+            l4_control_block_t *l4_cb;
+
+            if (unlikely(cnt == GCFG_TMR_MAX_RUN_CNT)) {
+                /* Account it on the port of the first deferred timer. */
+                l4_cb = RTE_PTR_ADD(head->tlh_first, wheel->tw_l4cb_offset);
+                INC_STATS(STATS_LOCAL(tpg_timer_statistics_t,
+                                      l4_cb->l4cb_interface),
+                          tts_budget_exhausted);
+                wheel->tw_backlog = true;
+                goto done;
+            }
+
+            ctr = head->tlh_first;
+            tmr_wheel_del(wheel, ctr);
+            wheel->tw_cb(ctr);
             cnt++;
         }
 
-        if (unlikely(cnt == GCFG_TMR_MAX_RUN_CNT))
-            break;
-    }
+        level0->twl_bmp[slot / 64] &= ~(1ULL << (slot % 64));
 
-    wheel->tw_last_advance = now;
+        /* Jump to the next slot that might hold timers (or to the next level
+         * 0 revolution, where we need to cascade).
+         */
+        next_tick = (wheel->tw_current & ~(uint64_t)TMR_WHEEL_LEVEL_MASK) +
+                        tmr_bmp_next(level0, slot + 1);
+        if (next_tick > now_tick + 1)
+            next_tick = now_tick + 1;
+
+        tmr_wheel_set_current(wheel, next_tick);
+    }
 
+done:
     latest = rte_get_timer_cycles();
 
 #if !defined(TPG_DEBUG)
     if ((TPG_TIME_DIFF(latest, now) / cycles_per_us) > GCFG_TMR_MAX_RUN_US) {
         RTE_LOG(ERR, USER1,
-                "[%d:%s] Timers hogging the CPU! cnt %"PRIu32" now_idx %"
-                PRIu32" start_idx %"PRIu32"\n",
+                "[%d:%s] Timers hogging the CPU! cnt %"PRIu32" now_tick %"
+                PRIu64" start_tick %"PRIu64"\n",
                 rte_lcore_index(rte_lcore_id()),
                 __func__,
                 cnt,
-                now_idx,
-                start_idx);
+                now_tick,
+                start_tick);
     }
 #else /* !defined(TPG_DEBUG) */
     (void)latest;
-    (void)start_idx;
+    (void)start_tick;
 #endif /* !defined(TPG_DEBUG) */
 }
 
@@ -474,7 +649,8 @@ bool tcp_time_should_advance(tmr_wheel_t *wheel, uint64_t now)
 {
     uint64_t diff = TPG_TIME_DIFF(now, wheel->tw_last_advance);
 
-    return (diff / cycles_per_us) > GCFG_TMR_STEP_ADVANCE;
+    return wheel->tw_backlog ||
+                (diff / cycles_per_us) > GCFG_TMR_STEP_ADVANCE;
 }
 
 /*****************************************************************************
@@ -486,35 +662,33 @@ void time_advance(void)
 
     now = rte_get_timer_cycles();
 
-    if (tcp_time_should_advance(RTE_PER_LCORE(tcp_slow_timer_wheel), now)) {
-        tpg_time_wheel_advance(RTE_PER_LCORE(tcp_slow_timer_wheel),
-                               tcp_tcb_slow_next,
-                               tcp_handle_slow_to,
-                               now);
-    }
+    if (tcp_time_should_advance(RTE_PER_LCORE(tcp_slow_timer_wheel), now))
+        tpg_time_wheel_advance(RTE_PER_LCORE(tcp_slow_timer_wheel), now);
 
-    if (tcp_time_should_advance(RTE_PER_LCORE(tcp_rto_timer_wheel), now)) {
-        tpg_time_wheel_advance(RTE_PER_LCORE(tcp_rto_timer_wheel),
-                               tcp_tcb_rto_next,
-                               tcp_handle_retrans_to,
-                               now);
-    }
+    if (tcp_time_should_advance(RTE_PER_LCORE(tcp_rto_timer_wheel), now))
+        tpg_time_wheel_advance(RTE_PER_LCORE(tcp_rto_timer_wheel), now);
 
-    if (tcp_time_should_advance(RTE_PER_LCORE(l4cb_test_timer_wheel), now)) {
-        tpg_time_wheel_advance(RTE_PER_LCORE(l4cb_test_timer_wheel),
-                               l4cb_test_next,
-                               l4cb_handle_test_to,
-                               now);
-    }
+    if (tcp_time_should_advance(RTE_PER_LCORE(tcp_delack_timer_wheel), now))
+        tpg_time_wheel_advance(RTE_PER_LCORE(tcp_delack_timer_wheel), now);
+
+    if (tcp_time_should_advance(RTE_PER_LCORE(l4cb_test_timer_wheel), now))
+        tpg_time_wheel_advance(RTE_PER_LCORE(l4cb_test_timer_wheel), now);
 }
 
 /*****************************************************************************
  * tcp_timer_rto_set()
+ *      If the tcb is still in the wheel (i.e., the timer was lazily cancelled
+ *      or it's being rearmed) we only move the deadline. The entry is
+ *      relinked only if the new deadline is earlier than the slot it's in,
+ *      otherwise tcp_handle_retrans_to() takes care of it when the slot
+ *      expires.
  ****************************************************************************/
 int tcp_timer_rto_set(l4_control_block_t *l4_cb, uint32_t timeout_us)
 {
     tcp_control_block_t *tcb;
-    int                  status = 0;
+    tmr_wheel_t         *wheel;
+    uint64_t             expiry;
+    int                  status;
 
     if (unlikely(l4_cb == NULL)) {
         INC_STATS(STATS_LOCAL(tpg_timer_statistics_t, 0), tts_l4cb_null);
@@ -533,26 +707,37 @@ int tcp_timer_rto_set(l4_control_block_t *l4_cb, uint32_t timeout_us)
         return -EINVAL;
     }
 
-    /* status is set inside! */
-    TCP_TIMER_SET(RTE_PER_LCORE(tcp_rto_timer_wheel), tcb,
-                  tcb_retrans_tmr_entry,
-                  timeout_us,
-                  status);
+    wheel = RTE_PER_LCORE(tcp_rto_timer_wheel);
 
-    if (likely(status == 0)) {
-        tcb->tcb_on_rto_list = true;
-        INC_STATS(STATS_LOCAL(tpg_timer_statistics_t, l4_cb->l4cb_interface),
-                  tts_rto_set);
-    } else {
+    status = tmr_wheel_expiry(wheel, timeout_us, &expiry);
+    if (unlikely(status != 0)) {
         INC_STATS(STATS_LOCAL(tpg_timer_statistics_t, l4_cb->l4cb_interface),
                   tts_rto_failed);
+        return status;
     }
 
-    return status;
+    tcb->tcb_rto_deadline = expiry;
+
+    if (!tcb->tcb_rto_linked) {
+        tmr_wheel_insert(wheel, tcb, expiry);
+        tcb->tcb_rto_linked = true;
+    } else if (expiry < tcb->tcb_retrans_tmr_entry.tle_expiry) {
+        tmr_wheel_del(wheel, tcb);
+        tmr_wheel_insert(wheel, tcb, expiry);
+    }
+
+    tcb->tcb_on_rto_list = true;
+    INC_STATS(STATS_LOCAL(tpg_timer_statistics_t, l4_cb->l4cb_interface),
+              tts_rto_set);
+
+    return 0;
 }
 
 /*****************************************************************************
  * tcp_timer_rto_cancel()
+ *      Lazy: the tcb stays in the wheel until its slot expires (or until
+ *      tcp_timer_rto_release()) so that a following tcp_timer_rto_set()
+ *      doesn't need to touch the wheel.
  ****************************************************************************/
 int tcp_timer_rto_cancel(l4_control_block_t *l4_cb)
 {
@@ -574,7 +759,6 @@ int tcp_timer_rto_cancel(l4_control_block_t *l4_cb)
         return -EINVAL;
     }
 
-    TCP_TIMER_CANCEL(tcb, tcb_retrans_tmr_entry);
     tcb->tcb_on_rto_list = false;
 
     INC_STATS(STATS_LOCAL(tpg_timer_statistics_t, l4_cb->l4cb_interface),
@@ -583,13 +767,34 @@ int tcp_timer_rto_cancel(l4_control_block_t *l4_cb)
     return 0;
 }
 
+/*****************************************************************************
+ * tcp_timer_rto_release()
+ *      Cancels the RTO timer (if armed) and removes the tcb from the wheel.
+ *      Must be called before the tcb is freed or reused.
+ ****************************************************************************/
+void tcp_timer_rto_release(l4_control_block_t *l4_cb)
+{
+    tcp_control_block_t *tcb;
+
+    L4_CB_CHECK(l4_cb);
+    tcb = container_of(l4_cb, tcp_control_block_t, tcb_l4);
+
+    if (TCB_RTO_TMR_IS_SET(tcb))
+        tcp_timer_rto_cancel(l4_cb);
+
+    if (tcb->tcb_rto_linked) {
+        tmr_wheel_del(RTE_PER_LCORE(tcp_rto_timer_wheel), tcb);
+        tcb->tcb_rto_linked = false;
+    }
+}
+
 /*****************************************************************************
  * tcp_timer_slow_set()
  ****************************************************************************/
 int tcp_timer_slow_set(l4_control_block_t *l4_cb, uint32_t timeout_us)
 {
     tcp_control_block_t *tcb;
-    int                  status = 0;
+    int                  status;
 
     if (unlikely(l4_cb == NULL)) {
         INC_STATS(STATS_LOCAL(tpg_timer_statistics_t, 0), tts_l4cb_null);
@@ -609,11 +814,8 @@ int tcp_timer_slow_set(l4_control_block_t *l4_cb, uint32_t timeout_us)
         return -EINVAL;
     }
 
-    /* status is set inside! */
-    TCP_TIMER_SET(RTE_PER_LCORE(tcp_slow_timer_wheel), tcb,
-                  tcb_slow_tmr_entry,
-                  timeout_us,
-                  status);
+    status = tmr_wheel_add(RTE_PER_LCORE(tcp_slow_timer_wheel), tcb,
+                           timeout_us);
 
     if (likely(status == 0)) {
         tcb->tcb_on_slow_list = true;
@@ -651,8 +853,7 @@ int tcp_timer_slow_cancel(l4_control_block_t *l4_cb)
         return -EINVAL;
     }
 
-
-    TCP_TIMER_CANCEL(tcb, tcb_slow_tmr_entry);
+    tmr_wheel_del(RTE_PER_LCORE(tcp_slow_timer_wheel), tcb);
     tcb->tcb_on_slow_list = false;
 
     INC_STATS(STATS_LOCAL(tpg_timer_statistics_t, l4_cb->l4cb_interface),
@@ -661,12 +862,86 @@ int tcp_timer_slow_cancel(l4_control_block_t *l4_cb)
     return 0;
 }
 
+/*****************************************************************************
+ * tcp_timer_delack_set()
+ ****************************************************************************/
+int tcp_timer_delack_set(l4_control_block_t *l4_cb, uint32_t timeout_us)
+{
+    tcp_control_block_t *tcb;
+    int                  status;
+
+    if (unlikely(l4_cb == NULL)) {
+        INC_STATS(STATS_LOCAL(tpg_timer_statistics_t, 0), tts_l4cb_null);
+        TRACE_FMT(TMR, ERROR, "[%s] tcb NULL", __func__);
+        return -EINVAL;
+    }
+
+    L4_CB_CHECK(l4_cb);
+
+    tcb = container_of(l4_cb, tcp_control_block_t, tcb_l4);
+
+    if (unlikely(TCB_DELACK_TMR_IS_SET(tcb))) {
+        INC_STATS(STATS_LOCAL(tpg_timer_statistics_t, l4_cb->l4cb_interface),
+                  tts_l4cb_invalid_flags);
+        TRACE_FMT(TMR, ERROR, "[%s] tcb already on delayed ack list.",
+                  __func__);
+        return -EINVAL;
+    }
+
+    status = tmr_wheel_add(RTE_PER_LCORE(tcp_delack_timer_wheel), tcb,
+                           timeout_us);
+
+    if (likely(status == 0)) {
+        tcb->tcb_on_delack_list = true;
+        INC_STATS(STATS_LOCAL(tpg_timer_statistics_t, l4_cb->l4cb_interface),
+                  tts_delack_set);
+    } else {
+        INC_STATS(STATS_LOCAL(tpg_timer_statistics_t, l4_cb->l4cb_interface),
+                  tts_delack_failed);
+    }
+
+    return status;
+}
+
+/*****************************************************************************
+ * tcp_timer_delack_cancel()
+ ****************************************************************************/
+int tcp_timer_delack_cancel(l4_control_block_t *l4_cb)
+{
+    tcp_control_block_t *tcb;
+
+    if (unlikely(l4_cb == NULL)) {
+        INC_STATS(STATS_LOCAL(tpg_timer_statistics_t, 0), tts_l4cb_null);
+        TRACE_FMT(TMR, ERROR, "[%s] tcb NULL", __func__);
+        return -EINVAL;
+    }
+
+    L4_CB_CHECK(l4_cb);
+
+    tcb = container_of(l4_cb, tcp_control_block_t, tcb_l4);
+
+    if (unlikely(!TCB_DELACK_TMR_IS_SET(tcb))) {
+        INC_STATS(STATS_LOCAL(tpg_timer_statistics_t, l4_cb->l4cb_interface),
+                  tts_l4cb_invalid_flags);
+        TRACE_FMT(TMR, ERROR, "[%s] tcb not on delayed ack list.", __func__);
+        return -EINVAL;
+    }
+
+    tmr_wheel_del(RTE_PER_LCORE(tcp_delack_timer_wheel), tcb);
+    tcb->tcb_on_delack_list = false;
+
+    INC_STATS(STATS_LOCAL(tpg_timer_statistics_t, l4_cb->l4cb_interface),
+              tts_delack_cancelled);
+
+    return 0;
+}
+
 /*****************************************************************************
  * l4cb_timer_test_set()
  ****************************************************************************/
 int l4cb_timer_test_set(l4_control_block_t *l4_cb, uint32_t timeout_us)
 {
-    int status = 0;
+    int status;
 
     L4_CB_CHECK(l4_cb);
 
@@ -683,11 +958,8 @@ int l4cb_timer_test_set(l4_control_block_t *l4_cb, uint32_t timeout_us)
         return -EINVAL;
     }
 
-    /* status is set inside! */
-    L4CB_TIMER_SET(RTE_PER_LCORE(l4cb_test_timer_wheel), l4_cb,
-                   l4cb_test_tmr_entry,
-                   timeout_us,
-                   status);
+    status = tmr_wheel_add(RTE_PER_LCORE(l4cb_test_timer_wheel), l4_cb,
+                           timeout_us);
 
     if (likely(status == 0)) {
         l4_cb->l4cb_on_test_tmr_list = true;
@@ -721,7 +993,7 @@ int l4cb_timer_test_cancel(l4_control_block_t *l4_cb)
         return -EINVAL;
     }
 
-    L4CB_TIMER_CANCEL(l4_cb, l4cb_test_tmr_entry);
+    tmr_wheel_del(RTE_PER_LCORE(l4cb_test_timer_wheel), l4_cb);
     l4_cb->l4cb_on_test_tmr_list = false;
 
     INC_STATS(STATS_LOCAL(tpg_timer_statistics_t, l4_cb->l4cb_interface),
@@ -815,6 +1087,23 @@ static void cmd_show_timer_statistics_parsed(void *parsed_result __rte_unused,
 
         cmdline_printf(cl, "\n");
 
+        SHOW_64BIT_STATS("Delayed ACK Timer Set", tpg_timer_statistics_t,
+                         tts_delack_set,
+                         port,
+                         option);
+
+        SHOW_64BIT_STATS("Delayed ACK Timer Cancelled", tpg_timer_statistics_t,
+                         tts_delack_cancelled,
+                         port,
+                         option);
+
+        SHOW_64BIT_STATS("Delayed ACK Timer Fired", tpg_timer_statistics_t,
+                         tts_delack_fired,
+                         port,
+                         option);
+
+        cmdline_printf(cl, "\n");
+
         SHOW_64BIT_STATS("Test Timer Set", tpg_timer_statistics_t, tts_test_set,
                          port,
                          option);
@@ -846,6 +1135,11 @@ static void cmd_show_timer_statistics_parsed(void *parsed_result __rte_unused,
                          port,
                          option);
 
+        SHOW_32BIT_STATS("Delayed ACK Timer Failed", tpg_timer_statistics_t,
+                         tts_delack_failed,
+                         port,
+                         option);
+
         SHOW_32BIT_STATS("TCB NULL", tpg_timer_statistics_t, tts_l4cb_null,
                          port,
                          option);
@@ -860,6 +1154,16 @@ static void cmd_show_timer_statistics_parsed(void *parsed_result __rte_unused,
                          port,
                          option);
 
+        SHOW_64BIT_STATS("RTO Timer Deferred", tpg_timer_statistics_t,
+                         tts_rto_deferred,
+                         port,
+                         option);
+
+        SHOW_64BIT_STATS("Budget Exhausted", tpg_timer_statistics_t,
+                         tts_budget_exhausted,
+                         port,
+                         option);
+
         cmdline_printf(cl, "\n");
     }
 }
@@ -162,7 +162,8 @@ static udp_control_block_t *ucb_clone(udp_control_block_t *ucb)
     UCB_CHECK(ucb);
 
     stats = STATS_LOCAL(tpg_udp_statistics_t, ucb->ucb_l4.l4cb_interface);
-    new_ucb = tlkp_alloc_ucb();
+    new_ucb = tlkp_recycle_alloc_ucb(ucb->ucb_l4.l4cb_interface,
+                                     ucb->ucb_l4.l4cb_test_case_id);
     if (unlikely(new_ucb == NULL)) {
         INC_STATS(stats, us_ucb_alloc_err);
         return NULL;
@@ -282,13 +283,16 @@ struct rte_mbuf *udp_receive_pkt(packet_control_block_t *pcb,
     pcb->pcb_mbuf = mbuf;
 
     /*
-     * First try known session lookup
+     * First try known session lookup. Most of the time the whole RX burst
+     * was already looked up by the packet loop.
      */
-    ucb = tlkp_find_v4_ucb(pcb->pcb_port, pcb->pcb_hash,
-                           rte_be_to_cpu_32(pcb->pcb_ipv4->dst_addr),
-                           rte_be_to_cpu_32(pcb->pcb_ipv4->src_addr),
-                           rte_be_to_cpu_16(udp_hdr->dst_port),
-                           rte_be_to_cpu_16(udp_hdr->src_port));
+    if (unlikely(!tlkp_pcb_ucb_get(pcb, &ucb))) {
+        ucb = tlkp_find_v4_ucb(pcb->pcb_port, pcb->pcb_hash,
+                               rte_be_to_cpu_32(pcb->pcb_ipv4->dst_addr),
+                               rte_be_to_cpu_32(pcb->pcb_ipv4->src_addr),
+                               rte_be_to_cpu_16(udp_hdr->dst_port),
+                               rte_be_to_cpu_16(udp_hdr->src_port));
+    }
 
     /*
      * If no existing ucb see if we have a server available that is
@@ -328,6 +332,9 @@ struct rte_mbuf *udp_receive_pkt(packet_control_block_t *pcb,
             /* Recompute the hash and add the new_tcb to the htable. */
             l4_cb_calc_connection_hash(&new_ucb->ucb_l4);
 
+            /* The listen ucb headers were built for another peer. */
+            l4_cb_hdr_tmpl_invalidate(&new_ucb->ucb_l4);
+
             error = tlkp_add_ucb(new_ucb);
             if (error) {
                 TRACE_FMT(UDP, ERROR, "[%s()] failed to add clone ucb: %s(%d).",
@@ -354,7 +361,7 @@ struct rte_mbuf *udp_receive_pkt(packet_control_block_t *pcb,
             pcb->pcb_trace = true;
 
         if (ucb != NULL)
-            pcb->pcb_sockopt = &ucb->ucb_l4.l4cb_sockopt;
+            pcb->pcb_rx_cb = &ucb->ucb_l4;
 
         udp_process_incoming(ucb, pcb);
 
@@ -398,7 +405,7 @@ static struct rte_udp_hdr *udp_build_hdr(udp_control_block_t *ucb,
 #if !defined(TPG_SW_CHECKSUMMING)
     if (true) {
 #else
-    if (ucb->ucb_l4.l4cb_sockopt.so_eth.ethso_tx_offload_udp_cksum) {
+    if (ucb->ucb_l4.l4cb_sockopt->so_eth.ethso_tx_offload_udp_cksum) {
 #endif
         mbuf->ol_flags |= PKT_TX_UDP_CKSUM | PKT_TX_IPV4;
 
@@ -472,7 +479,7 @@ udp_send_pkt(udp_control_block_t *ucb, struct rte_mbuf *hdr_mbuf,
 
 #if defined(TPG_SW_CHECKSUMMING)
     if (data_mbuf != NULL &&
-            !ucb->ucb_l4.l4cb_sockopt.so_eth.ethso_tx_offload_udp_cksum) {
+            !ucb->ucb_l4.l4cb_sockopt->so_eth.ethso_tx_offload_udp_cksum) {
         if (unlikely(DATA_IS_TSTAMP(data_mbuf))) {
             tstamp_write_cksum_offset(hdr_mbuf,
                                       hdr_mbuf->pkt_len -
@@ -500,7 +507,7 @@ udp_send_pkt(udp_control_block_t *ucb, struct rte_mbuf *hdr_mbuf,
      * added.
      */
 #if defined(TPG_SW_CHECKSUMMING)
-    if (!ucb->ucb_l4.l4cb_sockopt.so_eth.ethso_tx_offload_udp_cksum) {
+    if (!ucb->ucb_l4.l4cb_sockopt->so_eth.ethso_tx_offload_udp_cksum) {
         udp_hdr->dgram_cksum =
             ipv4_update_general_l4_cksum(udp_hdr->dgram_cksum, data_mbuf);
     }
@@ -642,8 +649,13 @@ void udp_connection_cleanup(udp_control_block_t *ucb)
 {
     UCB_CHECK(ucb);
 
-    /* Free any allocated memory. */
-    tlkp_free_ucb(ucb);
+    /* Free any allocated memory. Malloced UCBs are kept on the test case
+     * recycle stack so the next server session doesn't hit the mempool.
+     */
+    if (ucb->ucb_malloced)
+        tlkp_recycle_free_ucb(ucb);
+    else
+        tlkp_free_ucb(ucb);
 }
 
 /*****************************************************************************
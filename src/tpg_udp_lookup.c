@@ -66,8 +66,14 @@
 /*****************************************************************************
  * Global variables
  ****************************************************************************/
-/* Per core hashtable [port_cnt * TPG_TCP_HASH_BUCKET_SIZE] */
-static RTE_DEFINE_PER_LCORE(tlkp_hash_bucket_t *, tlkp_ucb_hash_table);
+/* Per core hashtable shared by all ports. */
+static RTE_DEFINE_PER_LCORE(tlkp_htable_t, tlkp_ucb_hash_table);
+
+/* Per core array[port][tcid] of server UCB recycle stacks. */
+static RTE_DEFINE_PER_LCORE(tlkp_cb_recycle_t *, tlkp_ucb_recycle);
+
+#define TLKP_UCB_RECYCLE_GET(port, tcid) \
+    (RTE_PER_LCORE(tlkp_ucb_recycle) + (port) * TPG_TEST_MAX_ENTRIES + (tcid))
 
 rte_atomic16_t            *tlkp_ucb_mpool_alloc_in_use; /* array[cb_id] */
 uint32_t                   ucb_l4cb_max_id;
@@ -86,6 +92,22 @@ static bool ucb_trace_filter_match(trace_filter_t *filter,
                               ucb->ucb_l4.l4cb_dst_addr);
 }
 
+/*****************************************************************************
+ * ucb_trace_update()
+ *      If we found a UCB and we have UCB trace filters enabled then
+ *      check if we should update the ucb_trace flag.
+ ****************************************************************************/
+static inline void ucb_trace_update(udp_control_block_t *ucb)
+{
+    if (unlikely(RTE_PER_LCORE(trace_filter).tf_enabled)) {
+        if (ucb_trace_filter_match(&RTE_PER_LCORE(trace_filter), ucb))
+            ucb->ucb_trace = true;
+        else
+            ucb->ucb_trace = false;
+    } else if (unlikely(ucb->ucb_trace == true))
+        ucb->ucb_trace = false;
+}
+
 /*****************************************************************************
  * tlkp_udp_init()
  ****************************************************************************/
@@ -109,25 +131,21 @@ bool tlkp_udp_init(void)
  ****************************************************************************/
 void tlkp_udp_lcore_init(uint32_t lcore_id)
 {
-    uint32_t i;
-
-    RTE_PER_LCORE(tlkp_ucb_hash_table) =
-        rte_zmalloc_socket("udp_hash_table", rte_eth_dev_count_avail() *
-                           TPG_HASH_BUCKET_SIZE *
-                           sizeof(tlkp_hash_bucket_t),
+    /* Size the table for all the UCBs this lcore can allocate. */
+    tlkp_htable_init(&RTE_PER_LCORE(tlkp_ucb_hash_table), "udp_hash_table",
+                     mem_get_ucb_pools()[lcore_id]->size,
+                     rte_lcore_to_socket_id(lcore_id));
+
+    RTE_PER_LCORE(tlkp_ucb_recycle) =
+        rte_zmalloc_socket("udp_ucb_recycle",
+                           rte_eth_dev_count_avail() * TPG_TEST_MAX_ENTRIES *
+                           sizeof(tlkp_cb_recycle_t),
                            RTE_CACHE_LINE_SIZE,
                            rte_lcore_to_socket_id(lcore_id));
-    if (RTE_PER_LCORE(tlkp_ucb_hash_table) == NULL) {
-        TPG_ERROR_ABORT("[%d]: Failed to allocate per lcore udp htable!\n",
+    if (RTE_PER_LCORE(tlkp_ucb_recycle) == NULL) {
+        TPG_ERROR_ABORT("[%d]: Failed to allocate UCB recycle stacks!\n",
                         rte_lcore_index(lcore_id));
     }
-
-    for (i = 0; i < (uint32_t)(rte_eth_dev_count_avail() * TPG_HASH_BUCKET_SIZE); i++) {
-        /*
-         * Initialize all list headers.
-         */
-        LIST_INIT((&RTE_PER_LCORE(tlkp_ucb_hash_table)[i]));
-    }
 }
 
 /*****************************************************************************
@@ -212,6 +230,72 @@ void tlkp_free_ucb(udp_control_block_t *ucb)
     rte_mempool_generic_put(mem_get_ucb_local_pool(), &ucb_p, 1, NULL);
 }
 
+/*****************************************************************************
+ * tlkp_recycle_alloc_ucb()
+ *      Same as tlkp_alloc_ucb() but takes the UCB from the test case recycle
+ *      stack. The caller is expected to fully (re)initialize the UCB.
+ ****************************************************************************/
+udp_control_block_t *tlkp_recycle_alloc_ucb(uint32_t eth_port,
+                                            uint32_t test_case_id)
+{
+    tlkp_cb_recycle_t   *recycle;
+    udp_control_block_t *ucb;
+
+    recycle = TLKP_UCB_RECYCLE_GET(eth_port, test_case_id);
+
+    if (unlikely(recycle->cr_count == 0)) {
+        /* If the pool can't provide a full bulk anymore get the last UCBs
+         * one by one.
+         */
+        if (tlkp_cb_recycle_refill(recycle, mem_get_ucb_local_pool(),
+                                   offsetof(udp_control_block_t,
+                                            ucb_l4)) == 0)
+            return tlkp_alloc_ucb();
+    }
+
+    ucb = recycle->cr_cbs[--recycle->cr_count];
+
+    L4_CB_ALLOC_INIT(&ucb->ucb_l4, tlkp_ucb_mpool_alloc_in_use,
+                     ucb_l4cb_max_id);
+    return ucb;
+}
+
+/*****************************************************************************
+ * tlkp_recycle_free_ucb()
+ *      Pushes the UCB on the recycle stack of the test case it belongs to.
+ *      If the stack is full the oldest half goes back to the mempool.
+ ****************************************************************************/
+void tlkp_recycle_free_ucb(udp_control_block_t *ucb)
+{
+    tlkp_cb_recycle_t *recycle;
+
+    recycle = TLKP_UCB_RECYCLE_GET(ucb->ucb_l4.l4cb_interface,
+                                   ucb->ucb_l4.l4cb_test_case_id);
+
+    L4_CB_FREE_DEINIT(&ucb->ucb_l4, tlkp_ucb_mpool_alloc_in_use,
+                      ucb_l4cb_max_id);
+
+    if (unlikely(recycle->cr_count == TLKP_CB_RECYCLE_SIZE)) {
+        tlkp_cb_recycle_drain(recycle, mem_get_ucb_local_pool(),
+                              TLKP_CB_RECYCLE_BULK);
+    }
+
+    recycle->cr_cbs[recycle->cr_count++] = ucb;
+}
+
+/*****************************************************************************
+ * tlkp_recycle_flush_ucbs()
+ *      Returns all the recycled UCBs of the test case to the mempool.
+ ****************************************************************************/
+void tlkp_recycle_flush_ucbs(uint32_t eth_port, uint32_t test_case_id)
+{
+    tlkp_cb_recycle_t *recycle;
+
+    recycle = TLKP_UCB_RECYCLE_GET(eth_port, test_case_id);
+    tlkp_cb_recycle_drain(recycle, mem_get_ucb_local_pool(),
+                          recycle->cr_count);
+}
+
 /*****************************************************************************
  * tlkp_total_ucbs_allocated()
  ****************************************************************************/
@@ -240,7 +324,7 @@ udp_control_block_t *tlkp_find_v4_ucb(uint32_t phys_port, uint32_t l4_hash,
               local_port,
               remote_port);
 
-    l4_cb = tlkp_find_v4_cb(RTE_PER_LCORE(tlkp_ucb_hash_table),
+    l4_cb = tlkp_find_v4_cb(&RTE_PER_LCORE(tlkp_ucb_hash_table),
                                           phys_port,
                                           l4_hash,
                                           local_addr,
@@ -252,21 +336,99 @@ udp_control_block_t *tlkp_find_v4_ucb(uint32_t phys_port, uint32_t l4_hash,
 
     ucb = container_of(l4_cb, udp_control_block_t, ucb_l4);
 
-    /*
-     * If we found a UCB and we have UCB trace filters enabled then
-     * check if we should update the ucb_trace flag.
-     */
-    if (unlikely(RTE_PER_LCORE(trace_filter).tf_enabled)) {
-        if (ucb_trace_filter_match(&RTE_PER_LCORE(trace_filter), ucb))
-            ucb->ucb_trace = true;
-        else
-            ucb->ucb_trace = false;
-    } else if (unlikely(ucb->ucb_trace == true))
-        ucb->ucb_trace = false;
+    ucb_trace_update(ucb);
 
     return ucb;
 }
 
+/*****************************************************************************
+ * tlkp_find_v4_ucb_bulk()
+ *      ucbs[i] is set to NULL if keys[i] is not found.
+ ****************************************************************************/
+void tlkp_find_v4_ucb_bulk(const tlkp_v4_key_t *keys,
+                           udp_control_block_t **ucbs,
+                           uint32_t count)
+{
+    l4_control_block_t *l4_cbs[TLKP_HT_BULK_SIZE];
+    uint32_t            burst;
+    uint32_t            i;
+
+    while (count) {
+        burst = RTE_MIN(count, (uint32_t)TLKP_HT_BULK_SIZE);
+
+        tlkp_find_v4_cb_bulk(&RTE_PER_LCORE(tlkp_ucb_hash_table), keys,
+                             l4_cbs,
+                             burst);
+
+        for (i = 0; i < burst; i++) {
+            if (unlikely(l4_cbs[i] == NULL)) {
+                ucbs[i] = NULL;
+                continue;
+            }
+
+            ucbs[i] = container_of(l4_cbs[i], udp_control_block_t, ucb_l4);
+            ucb_trace_update(ucbs[i]);
+        }
+
+        keys += burst;
+        ucbs += burst;
+        count -= burst;
+    }
+}
+
+/*****************************************************************************
+ * tlkp_rx_burst_ucb()
+ *      Resolves the ucbs of a whole RX burst at once and prefetches them.
+ *      The results are stored in the pcbs and picked up by
+ *      tlkp_pcb_ucb_get() when each packet is processed.
+ ****************************************************************************/
+void tlkp_rx_burst_ucb(packet_control_block_t **pcbs,
+                       const tlkp_v4_key_t *keys,
+                       uint32_t count)
+{
+    udp_control_block_t *ucbs[TPG_RX_BURST_SIZE];
+    tlkp_htable_t       *htable = &RTE_PER_LCORE(tlkp_ucb_hash_table);
+    uint32_t             i;
+
+    count = RTE_MIN(count, (uint32_t)TPG_RX_BURST_SIZE);
+    tlkp_find_v4_ucb_bulk(keys, ucbs, count);
+
+    for (i = 0; i < count; i++) {
+        if (ucbs[i] != NULL)
+            rte_prefetch0(ucbs[i]);
+
+        pcbs[i]->pcb_l4cb = ucbs[i];
+        pcbs[i]->pcb_l4cb_gen =
+            tlkp_ht_lookup_gen(htable,
+                               ucbs[i] != NULL ? &ucbs[i]->ucb_l4 : NULL);
+        pcbs[i]->pcb_l4cb_valid = true;
+    }
+}
+
+/*****************************************************************************
+ * tlkp_pcb_ucb_get()
+ *      Returns true and sets 'ucb' if the burst lookup result stored in the
+ *      pcb is still valid (i.e., no ucb was added/deleted that could change
+ *      it while processing the previous packets in the burst).
+ ****************************************************************************/
+bool tlkp_pcb_ucb_get(packet_control_block_t *pcb, udp_control_block_t **ucb)
+{
+    udp_control_block_t *cached;
+
+    if (!pcb->pcb_l4cb_valid)
+        return false;
+
+    cached = pcb->pcb_l4cb;
+    if (unlikely(pcb->pcb_l4cb_gen !=
+                    tlkp_ht_lookup_gen(&RTE_PER_LCORE(tlkp_ucb_hash_table),
+                                       cached != NULL ? &cached->ucb_l4 :
+                                                        NULL)))
+        return false;
+
+    *ucb = cached;
+    return true;
+}
+
 /*****************************************************************************
  * tlkp_add_ucb()
  ****************************************************************************/
@@ -287,7 +449,7 @@ int tlkp_add_ucb(udp_control_block_t *ucb)
               ucb->ucb_l4.l4cb_dst_port,
               ucb->ucb_l4.l4cb_src_port);
 
-    error = tlkp_add_cb(RTE_PER_LCORE(tlkp_ucb_hash_table), &ucb->ucb_l4);
+    error = tlkp_add_cb(&RTE_PER_LCORE(tlkp_ucb_hash_table), &ucb->ucb_l4);
     if (error)
         return error;
 
@@ -308,7 +470,7 @@ int tlkp_add_ucb(udp_control_block_t *ucb)
  ****************************************************************************/
 int tlkp_delete_ucb(udp_control_block_t *ucb)
 {
-    return tlkp_delete_cb(RTE_PER_LCORE(tlkp_ucb_hash_table), &ucb->ucb_l4);
+    return tlkp_delete_cb(&RTE_PER_LCORE(tlkp_ucb_hash_table), &ucb->ucb_l4);
 }
 
 /*****************************************************************************
@@ -316,6 +478,6 @@ int tlkp_delete_ucb(udp_control_block_t *ucb)
  ****************************************************************************/
 void tlkp_walk_ucb(uint32_t phys_port, tlkp_walk_v4_cb_t callback, void *arg)
 {
-    tlkp_walk_v4(RTE_PER_LCORE(tlkp_ucb_hash_table), phys_port, callback, arg);
+    tlkp_walk_v4(&RTE_PER_LCORE(tlkp_ucb_hash_table), phys_port, callback, arg);
 }
 
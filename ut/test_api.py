@@ -1270,6 +1270,122 @@ class TestPartialPortApi(Warp17UnitTestCase):
         self.warp17_call('DelTestCase',
                          TestCaseArg(tca_eth_port=0, tca_test_case_id=0))
 
+    def _get_l3_route(self, net, mask, gw=b2b_def_gw(0)):
+        return L3Route(l3r_net=Ip(ip_version=IPV4, ip_v4=net),
+                       l3r_mask=Ip(ip_version=IPV4, ip_v4=mask),
+                       l3r_gw=Ip(ip_version=IPV4, ip_v4=gw))
+
+    def _configure_l3_route_port(self):
+        # Route gateways are checked against the configured L3 interfaces.
+        self.assertEqual(self.warp17_call('ConfigurePort', self._pcfg).e_code,
+                         0,
+                         'Configure Port')
+
+    def test_configure_l3_route_valid(self):
+        """Tests the ConfigureL3Route API with valid config"""
+
+        self._configure_l3_route_port()
+
+        l3_route = self._get_l3_route(0x14000000, 0xFF000000)
+        l3_route_arg = L3RouteArg(lra_eth_port=0, lra_l3_route=l3_route)
+        self.assertEqual(self.warp17_call('ConfigureL3Route',
+                                          l3_route_arg).e_code, 0,
+                         'Configure Valid Route')
+        result = self.warp17_call('GetL3Routes',
+                                  L3RoutesArg(lrsa_eth_port=0, lrsa_start=0))
+        self.assertEqual(result.lrsr_error.e_code, 0, 'GetL3Routes Single')
+        self.assertEqual(result.lrsr_total, 1, 'L3Route Single Total')
+        self.assertEqual(len(result.lrsr_routes), 1, 'L3Route Single Cnt')
+        self.assertTrue(l3_route == result.lrsr_routes[0],
+                        'L3Route Single Eq')
+
+    def test_configure_l3_route_many(self):
+        """Tests the ConfigureL3Route API with more routes than fit in a
+        GetL3Routes page"""
+
+        self._configure_l3_route_port()
+
+        route_count = TPG_L3_ROUTES_PER_PAGE * 4
+        for i in range(route_count):
+            l3_route_arg = L3RouteArg(lra_eth_port=0,
+                                      lra_l3_route=self._get_l3_route(
+                                          0x14000000 + (i << 8), 0xFFFFFF00))
+            self.assertEqual(self.warp17_call('ConfigureL3Route',
+                                              l3_route_arg).e_code, 0,
+                             'Configure Route {}'.format(i))
+
+        routes = []
+        while len(routes) < route_count:
+            result = self.warp17_call('GetL3Routes',
+                                      L3RoutesArg(lrsa_eth_port=0,
+                                                  lrsa_start=len(routes)))
+            self.assertEqual(result.lrsr_error.e_code, 0, 'GetL3Routes Page')
+            self.assertEqual(result.lrsr_total, route_count,
+                             'L3Route Page Total')
+            self.assertTrue(len(result.lrsr_routes) > 0, 'L3Route Page Cnt')
+            routes.extend(result.lrsr_routes)
+
+        self.assertEqual(len(routes), route_count, 'L3Route Many Cnt')
+
+        # ConfigurePort replaces the whole port config, routes included.
+        self._configure_l3_route_port()
+        result = self.warp17_call('GetL3Routes',
+                                  L3RoutesArg(lrsa_eth_port=0, lrsa_start=0))
+        self.assertEqual(result.lrsr_total, 0, 'L3Route Flushed')
+
+    def test_configure_l3_route_duplicate(self):
+        """Tests the ConfigureL3Route API when trying to add a duplicate"""
+
+        self._configure_l3_route_port()
+
+        l3_route_arg = L3RouteArg(lra_eth_port=0,
+                                  lra_l3_route=self._get_l3_route(0x14000000,
+                                                                  0xFF000000))
+        self.assertEqual(self.warp17_call('ConfigureL3Route',
+                                          l3_route_arg).e_code, 0,
+                         'Configure First Route')
+
+        # Same prefix, different host bits.
+        l3_route_arg = L3RouteArg(lra_eth_port=0,
+                                  lra_l3_route=self._get_l3_route(0x14000001,
+                                                                  0xFF000000))
+        self.assertEqual(self.warp17_call('ConfigureL3Route',
+                                          l3_route_arg).e_code,
+                         -errno.EEXIST,
+                         'Configure Duplicate Route')
+
+    def test_configure_l3_route_invalid_mask(self):
+        """Tests the ConfigureL3Route API with invalid masks"""
+
+        self._configure_l3_route_port()
+
+        for mask in [0, 0xFF00FF00]:
+            l3_route_arg = L3RouteArg(lra_eth_port=0,
+                                      lra_l3_route=self._get_l3_route(
+                                          0x14000000, mask))
+            self.assertEqual(self.warp17_call('ConfigureL3Route',
+                                              l3_route_arg).e_code,
+                             -errno.EINVAL,
+                             'Configure Route mask {}'.format(mask))
+
+    def test_configure_l3_route_gw_not_local(self):
+        """Tests the ConfigureL3Route API with a gateway that is not on any
+        of the port L3 interfaces"""
+
+        self._configure_l3_route_port()
+
+        l3_route_arg = L3RouteArg(lra_eth_port=0,
+                                  lra_l3_route=self._get_l3_route(
+                                      0x14000000, 0xFF000000,
+                                      gw=0x1E000001))
+        self.assertEqual(self.warp17_call('ConfigureL3Route',
+                                          l3_route_arg).e_code,
+                         -errno.EINVAL,
+                         'Configure Route gw not local')
+        result = self.warp17_call('GetL3Routes',
+                                  L3RoutesArg(lrsa_eth_port=0, lrsa_start=0))
+        self.assertEqual(result.lrsr_total, 0, 'L3Route Rejected')
+
 
 class TestPartialApi(Warp17NoTrafficTestCase, Warp17UnitTestCase):
     """Tests the functionality of the partial update config APIs."""
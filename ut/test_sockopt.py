@@ -81,6 +81,16 @@ class TestPortSockOpt(Warp17PortTestCase, Warp17UnitTestCase):
             self.lh.info('MTU %(arg)u' % {'arg': mtu})
             yield (PortOptions(po_mtu=mtu), PortOptions(po_mtu=mtu))
 
+        for arp_size in [16, 65536, 1024]:
+            self.lh.info('ARP table size %(arg)u' % {'arg': arp_size})
+            yield (PortOptions(po_mtu=1500, po_arp_table_size=arp_size),
+                   PortOptions(po_mtu=1500, po_arp_table_size=arp_size))
+
+        for gro in [True, False]:
+            self.lh.info('GRO %(arg)s' % {'arg': gro})
+            yield (PortOptions(po_mtu=1500, po_gro=gro),
+                   PortOptions(po_mtu=1500, po_gro=gro))
+
     # We use to have many other testcases with highter mtu but since we don't
     #  force the Max mtu anymore and we are not yet able to determine in
     #  advace which NIC we are using, we cannot test the maximum anymore
@@ -88,6 +98,10 @@ class TestPortSockOpt(Warp17PortTestCase, Warp17UnitTestCase):
         for mtu in [0, 67]:
             yield (PortOptions(po_mtu=mtu), PortOptions(po_mtu=mtu))
 
+        for arp_size in [0, 15, 1024 * 1024 + 1]:
+            yield (PortOptions(po_arp_table_size=arp_size),
+                   PortOptions(po_arp_table_size=arp_size))
+
     def update(self, eth_port, port_opts, expected_err):
 
         port_arg = PortArg(pa_eth_port=eth_port)
@@ -100,6 +114,9 @@ class TestPortSockOpt(Warp17PortTestCase, Warp17UnitTestCase):
             port_opts_res = self.warp17_call('GetPortOptions', port_arg)
             self.assertEqual(port_opts_res.por_error.e_code, 0)
             self.assertEqual(port_opts_res.por_opts.po_mtu, port_opts.po_mtu)
+            self.assertEqual(port_opts_res.por_opts.po_arp_table_size,
+                             port_opts.po_arp_table_size)
+            self.assertEqual(port_opts_res.por_opts.po_gro, port_opts.po_gro)
 
     def update_client(self, tc_arg, cl_port_opts, expected_err=0):
         self.update(tc_arg.tca_eth_port, cl_port_opts, expected_err)
@@ -145,6 +162,12 @@ class TestTcpSockOpt(Warp17TrafficTestCase, Warp17UnitTestCase):
             self.lh.info('TCP RTO %(arg)u' % {'arg': rto})
             yield (TcpSockopt(to_rto=rto), TcpSockopt(to_rto=rto))
 
+        for rto_min, rto_max in [(1, 1000), (100, 100), (200, 10000)]:
+            self.lh.info('TCP RTO Min %(min)u Max %(max)u' %
+                         {'min': rto_min, 'max': rto_max})
+            yield (TcpSockopt(to_rto_min=rto_min, to_rto_max=rto_max),
+                   TcpSockopt(to_rto_min=rto_min, to_rto_max=rto_max))
+
         for fin_to in [100, 500, 1000]:
             self.lh.info('TCP FIN TO %(arg)u' % {'arg': fin_to})
             yield (TcpSockopt(to_fin_to=fin_to), TcpSockopt(to_fin_to=fin_to))
@@ -159,6 +182,56 @@ class TestTcpSockOpt(Warp17TrafficTestCase, Warp17UnitTestCase):
             yield (TcpSockopt(to_orphan_to=orphan_to),
                    TcpSockopt(to_orphan_to=orphan_to))
 
+        for win_scale in [0, 7, 14]:
+            self.lh.info('TCP Win Scale %(arg)u' % {'arg': win_scale})
+            yield (TcpSockopt(to_win_scale=win_scale),
+                   TcpSockopt(to_win_scale=win_scale))
+
+        for cong_control in [NEW_RENO, CUBIC]:
+            self.lh.info('TCP Cong Control %(arg)u' % {'arg': cong_control})
+            yield (TcpSockopt(to_cong_control=cong_control),
+                   TcpSockopt(to_cong_control=cong_control))
+
+        for sack in [True, False]:
+            self.lh.info('TCP SACK %(arg)s' % {'arg': sack})
+            yield (TcpSockopt(to_sack=sack), TcpSockopt(to_sack=sack))
+
+        for ts in [True, False]:
+            self.lh.info('TCP Timestamps %(arg)s' % {'arg': ts})
+            yield (TcpSockopt(to_timestamps=ts), TcpSockopt(to_timestamps=ts))
+
+        for pmtu in [0, 576, 1400, 9198]:
+            self.lh.info('TCP Path MTU %(arg)u' % {'arg': pmtu})
+            yield (TcpSockopt(to_pmtu=pmtu), TcpSockopt(to_pmtu=pmtu))
+
+        for tso in [True, False]:
+            self.lh.info('TCP TSO %(arg)s' % {'arg': tso})
+            yield (TcpSockopt(to_tso=tso), TcpSockopt(to_tso=tso))
+
+        for syn_cookies in [True, False]:
+            self.lh.info('TCP SYN Cookies %(arg)s' % {'arg': syn_cookies})
+            yield (TcpSockopt(to_syn_cookies=syn_cookies),
+                   TcpSockopt(to_syn_cookies=syn_cookies))
+
+        for close_mode in [GRACEFUL, RST_AFTER_DATA, RST_IMMEDIATE]:
+            self.lh.info('TCP Close Mode %(arg)u' % {'arg': close_mode})
+            yield (TcpSockopt(to_close_mode=close_mode),
+                   TcpSockopt(to_close_mode=close_mode))
+
+        for fast_open in [True, False]:
+            self.lh.info('TCP Fast Open %(arg)s' % {'arg': fast_open})
+            yield (TcpSockopt(to_fast_open=fast_open),
+                   TcpSockopt(to_fast_open=fast_open))
+
+        for ack_delay_to in [1, 5, 500]:
+            self.lh.info('TCP ACK Delay TO %(arg)u' % {'arg': ack_delay_to})
+            yield (TcpSockopt(to_ack_delay_to=ack_delay_to),
+                   TcpSockopt(to_ack_delay_to=ack_delay_to))
+
+        self.lh.info('TCP ACK Delay with ACK Delay TO < RTO Min')
+        yield (TcpSockopt(to_ack_delay=True, to_ack_delay_to=5),
+               TcpSockopt(to_ack_delay=True, to_ack_delay_to=5))
+
     def get_invalid_updates(self):
         self.lh.info('TCP Win Size')
         yield (TcpSockopt(to_win_size=65536),
@@ -180,6 +253,42 @@ class TestTcpSockOpt(Warp17TrafficTestCase, Warp17UnitTestCase):
         yield (TcpSockopt(to_retry_cnt=129),
                TcpSockopt(to_retry_cnt=129))
 
+        self.lh.info('TCP RTO Max')
+        yield (TcpSockopt(to_rto_max=10001), TcpSockopt(to_rto_max=10001))
+
+        self.lh.info('TCP RTO Min > RTO Max')
+        yield (TcpSockopt(to_rto_min=500, to_rto_max=100),
+               TcpSockopt(to_rto_min=500, to_rto_max=100))
+
+        self.lh.info('TCP Win Size > 16MB')
+        yield (TcpSockopt(to_win_size=16 * 1024 * 1024 + 1, to_win_scale=14),
+               TcpSockopt(to_win_size=16 * 1024 * 1024 + 1, to_win_scale=14))
+
+        self.lh.info('TCP Win Scale')
+        yield (TcpSockopt(to_win_scale=15), TcpSockopt(to_win_scale=15))
+
+        self.lh.info('TCP Cong Control')
+        yield (TcpSockopt(to_cong_control=TCP_CONG_CONTROL_MAX),
+               TcpSockopt(to_cong_control=TCP_CONG_CONTROL_MAX))
+
+        self.lh.info('TCP Close Mode')
+        yield (TcpSockopt(to_close_mode=TCP_CLOSE_MODE_MAX),
+               TcpSockopt(to_close_mode=TCP_CLOSE_MODE_MAX))
+
+        self.lh.info('TCP Path MTU')
+        yield (TcpSockopt(to_pmtu=100), TcpSockopt(to_pmtu=100))
+        yield (TcpSockopt(to_pmtu=9199), TcpSockopt(to_pmtu=9199))
+
+        self.lh.info('TCP ACK Delay TO')
+        yield (TcpSockopt(to_ack_delay_to=0), TcpSockopt(to_ack_delay_to=0))
+        yield (TcpSockopt(to_ack_delay_to=501), TcpSockopt(to_ack_delay_to=501))
+
+        self.lh.info('TCP ACK Delay with ACK Delay TO >= RTO Min')
+        yield (TcpSockopt(to_ack_delay=True, to_ack_delay_to=100,
+                          to_rto_min=50),
+               TcpSockopt(to_ack_delay=True, to_ack_delay_to=100,
+                          to_rto_min=50))
+
     def update(self, tc_arg, tcp_opts, expected_err):
         err = self.warp17_call('SetTcpSockopt',
                                TcpSockoptArg(toa_tc_arg=tc_arg,